@@ -0,0 +1,124 @@
+#include "ProgramGenerator.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+
+
+static void append(std::string &out, const char *format, ...)
+{
+    char buffer[256];
+
+    va_list args;
+    va_start(args, format);
+    vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+
+    out += buffer;
+}
+
+static void indent(std::string &out, uint32_t depth)
+{
+    out.append((depth + 1) * 4, ' ');
+}
+
+
+ProgramGenerator::ProgramGenerator(const ProgramShape &shape):
+    _shape(shape)
+{
+}
+
+std::string ProgramGenerator::generate() const
+{
+    std::string out;
+
+    for (uint32_t i=0; i<_shape.structs; i++) {
+        generateStruct(out, i);
+    }
+
+    for (uint32_t i=0; i<_shape.functions; i++) {
+        generateFunction(out, i);
+    }
+
+    generateMain(out);
+    return out;
+}
+
+void ProgramGenerator::generateStruct(std::string &out, uint32_t index) const
+{
+    append(out, "struct s%u {\n", index);
+    append(out, "    int a;\n");
+    append(out, "    int b;\n");
+    if (index > 0) {
+        append(out, "    struct s%u *prev;\n", index - 1);
+    }
+    append(out, "};\n\n");
+}
+
+void ProgramGenerator::generateFunction(std::string &out, uint32_t index) const
+{
+    append(out, "int f%u(int x)\n{\n", index);
+    append(out, "    int acc = x;\n");
+
+    if (_shape.structs > 0) {
+        append(out, "    struct s%u v;\n", index % _shape.structs);
+        append(out, "    v.a = x;\n");
+        append(out, "    v.b = v.a + %u;\n", index);
+        append(out, "    acc = acc + v.b;\n");
+    }
+
+    // Literal 'n' is given to function 'n % functions', and holds the
+    // text of literal 'n / 2', so half of the inserts are duplicates.
+    for (uint32_t i=index; i<_shape.stringLiterals; i+=_shape.functions) {
+        append(out, "    const char *str%u = \"literal number %u\";\n", i, i / 2);
+        append(out, "    acc = acc + str%u[0];\n", i);
+    }
+
+    for (uint32_t depth=0; depth<_shape.nestingDepth; depth++) {
+        indent(out, depth);
+        if (depth % 2 == 0) {
+            append(out, "if (acc >= %u) {\n", depth);
+        } else {
+            append(out, "while (acc < %u) {\n", depth);
+        }
+    }
+
+    for (uint32_t i=0; i<_shape.statements; i++) {
+        indent(out, _shape.nestingDepth);
+        switch (i % 3) {
+            case 0:
+                append(out, "int t%u = acc * %u;\n", i, i + 1);
+                break;
+            case 1:
+                append(out, "acc = acc + t%u %% 97;\n", i - 1);
+                break;
+            case 2:
+                append(out, "acc = (acc << 1) ^ %u;\n", i);
+                break;
+        }
+    }
+
+    for (uint32_t depth=_shape.nestingDepth; depth>0; depth--) {
+        if ((depth - 1) % 2 == 1) {
+            // Make sure the loop terminates
+            indent(out, depth);
+            append(out, "acc = %u;\n", depth - 1);
+        }
+
+        indent(out, depth - 1);
+        out += "}\n";
+    }
+
+    append(out, "    return acc;\n}\n\n");
+}
+
+void ProgramGenerator::generateMain(std::string &out) const
+{
+    append(out, "int main()\n{\n");
+    append(out, "    int sum = 0;\n");
+
+    for (uint32_t i=0; i<_shape.functions; i++) {
+        append(out, "    sum = sum + f%u(%u);\n", i, i);
+    }
+
+    append(out, "    return sum %% 2;\n}\n");
+}
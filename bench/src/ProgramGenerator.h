@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+
+/**
+ * The dimensions of a synthetic program. Every dimension can be grown
+ * independently of the others.
+ */
+struct ProgramShape
+{
+    uint32_t functions;
+
+    // Statements in the innermost block of every function
+    uint32_t statements;
+
+    // Literals spread over the functions, every literal occurs twice
+    uint32_t stringLiterals;
+
+    // Every struct has a pointer to the previous one
+    uint32_t structs;
+
+    // Blocks every function nests its statements in
+    uint32_t nestingDepth;
+};
+
+/**
+ * Generates a valid cish program of the given shape. The same shape
+ * always generates the same program.
+ */
+class ProgramGenerator
+{
+public:
+    ProgramGenerator(const ProgramShape &shape);
+
+    std::string generate() const;
+
+private:
+    const ProgramShape _shape;
+
+    void generateStruct(std::string &out, uint32_t index) const;
+    void generateFunction(std::string &out, uint32_t index) const;
+    void generateMain(std::string &out) const;
+};
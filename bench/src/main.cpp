@@ -0,0 +1,301 @@
+#include "ast/AstBuilder.h"
+#include "ast/Ast.h"
+#include "ast/ParseContext.h"
+#include "module/ModuleContext.h"
+
+#include "ProgramGenerator.h"
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**
+ * Measures how parsing and building the Ast scale as one dimension of a
+ * synthetic program grows. Every step doubles the measured dimension, so
+ * a linear phase roughly doubles in time, and a quadratic one roughly
+ * quadruples.
+ */
+
+struct BenchArgs
+{
+    cish::ast::ParseContext::Frontend frontend;
+    std::string dimension;
+    uint32_t steps;
+    uint32_t repeats;
+    uint32_t numThreads;
+    std::string dumpFile;
+};
+
+struct Dimension
+{
+    const char *name;
+    uint32_t ProgramShape::*field;
+};
+
+static const Dimension DIMENSIONS[] = {
+    { "functions",  &ProgramShape::functions },
+    { "statements", &ProgramShape::statements },
+    { "strings",    &ProgramShape::stringLiterals },
+    { "structs",    &ProgramShape::structs },
+    { "depth",      &ProgramShape::nestingDepth },
+};
+
+static const ProgramShape BASE_SHAPE = {
+    32,     // functions
+    12,     // statements
+    32,     // string literals
+    8,      // structs
+    2,      // nesting depth
+};
+
+// Doubling a dimension and slowing down by more than this is flagged
+static const double SUPERLINEAR_RATIO = 3.0;
+
+struct Measurement
+{
+    double parseMs;
+    double buildMs;
+    size_t arenaBytes;
+    long peakRssKb;
+};
+
+
+static double millisSince(std::chrono::steady_clock::time_point start)
+{
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::milli>(elapsed).count();
+}
+
+static Measurement measure(const BenchArgs &args, const std::string &source)
+{
+    Measurement best = { 0.0, 0.0, 0, 0 };
+
+    for (uint32_t i=0; i<args.repeats; i++) {
+        auto start = std::chrono::steady_clock::now();
+        cish::ast::ParseContext::Ptr parseContext =
+            cish::ast::ParseContext::parseSource(source, args.frontend, args.numThreads);
+        const double parseMs = millisSince(start);
+
+        start = std::chrono::steady_clock::now();
+        cish::ast::AstBuilder builder(parseContext, cish::module::ModuleContext::create());
+        cish::ast::Ast::Ptr ast = builder.buildAst();
+        const double buildMs = millisSince(start);
+
+        if (i == 0 || parseMs + buildMs < best.parseMs + best.buildMs) {
+            best.parseMs = parseMs;
+            best.buildMs = buildMs;
+            best.arenaBytes = 0;
+            for (const cish::ast::AstArena::Ptr &arena: ast->getArenas()) {
+                best.arenaBytes += arena->getBytesReserved();
+            }
+        }
+    }
+
+    return best;
+}
+
+/**
+ * Measure in a forked child, so that the peak RSS is that of the step
+ * alone rather than of every step run so far. Returns false if the step
+ * failed, which the child has reported.
+ */
+static bool measureInChild(const BenchArgs &args, const std::string &source, Measurement *m)
+{
+    int fds[2];
+    if (pipe(fds) != 0) {
+        perror("pipe");
+        return false;
+    }
+
+    fflush(nullptr);
+    const pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+
+    if (pid == 0) {
+        close(fds[0]);
+        int status = 1;
+        try {
+            const Measurement result = measure(args, source);
+            if (write(fds[1], &result, sizeof(result)) == sizeof(result)) {
+                status = 0;
+            }
+        } catch (cish::Exception &e) {
+            fprintf(stderr, "%s\n", e.userMessage());
+        }
+        fflush(nullptr);
+        _exit(status);
+    }
+
+    close(fds[1]);
+    const bool received = read(fds[0], m, sizeof(*m)) == sizeof(*m);
+    close(fds[0]);
+
+    int status;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0 || !received) {
+        return false;
+    }
+
+#ifdef __APPLE__
+    m->peakRssKb = usage.ru_maxrss / 1024;
+#else
+    m->peakRssKb = usage.ru_maxrss;
+#endif
+    return true;
+}
+
+static bool runDimension(const BenchArgs &args, const Dimension &dimension)
+{
+    printf("\n--- %s ---\n", dimension.name);
+    printf("%10s %10s %10s %10s %10s %10s %8s\n",
+           "size", "bytes", "parse ms", "build ms", "arena kb", "peak kb", "growth");
+
+    ProgramShape shape = BASE_SHAPE;
+    double previousMs = 0.0;
+    bool superlinear = false;
+
+    for (uint32_t step=0; step<args.steps; step++) {
+        const std::string source = ProgramGenerator(shape).generate();
+
+        if (!args.dumpFile.empty()) {
+            FILE *file = fopen(args.dumpFile.c_str(), "w");
+            if (file) {
+                fwrite(source.data(), 1, source.size(), file);
+                fclose(file);
+            }
+        }
+
+        Measurement m;
+        if (!measureInChild(args, source, &m)) {
+            fprintf(stderr, "%s=%u failed to build\n", dimension.name, shape.*dimension.field);
+            return false;
+        }
+
+        const double totalMs = m.parseMs + m.buildMs;
+        printf("%10u %10zu %10.2f %10.2f %10zu %10ld",
+               shape.*dimension.field, source.size(), m.parseMs, m.buildMs,
+               m.arenaBytes / 1024, m.peakRssKb);
+
+        if (step > 0 && previousMs > 0.0) {
+            const double ratio = totalMs / previousMs;
+            printf(" %7.2fx%s", ratio, ratio > SUPERLINEAR_RATIO ? " !" : "");
+            superlinear |= ratio > SUPERLINEAR_RATIO;
+        }
+
+        printf("\n");
+        fflush(stdout);
+
+        previousMs = totalMs;
+        shape.*dimension.field *= 2;
+    }
+
+    if (superlinear) {
+        printf("'!': more than %.1fx slower when doubling %s\n", SUPERLINEAR_RATIO, dimension.name);
+    }
+
+    return true;
+}
+
+static uint32_t parseIntArg(char option, const char *str)
+{
+    int value = atoi(str);
+    if (value <= 0) {
+        fprintf(stderr, "Argument '%s' is not valid for option '%c'\n", str, option);
+        exit(1);
+    }
+
+    return (uint32_t)value;
+}
+
+static bool parseArgs(int argc, char **argv, BenchArgs *args)
+{
+    args->frontend = cish::ast::ParseContext::Frontend::NATIVE;
+    args->dimension = "all";
+    args->steps = 6;
+    args->repeats = 3;
+    args->numThreads = 1;
+
+    int c;
+    while ((c = getopt(argc, argv, "p:d:n:r:j:o:")) != -1) {
+        switch (c) {
+            case 'p':
+                if (strcmp(optarg, "native") == 0) {
+                    args->frontend = cish::ast::ParseContext::Frontend::NATIVE;
+                } else if (strcmp(optarg, "antlr") == 0) {
+                    args->frontend = cish::ast::ParseContext::Frontend::ANTLR;
+                } else {
+                    fprintf(stderr, "Argument '%s' is not valid for option 'p'\n", optarg);
+                    return false;
+                }
+                break;
+            case 'd':
+                args->dimension = optarg;
+                break;
+            case 'n':
+                args->steps = parseIntArg(c, optarg);
+                break;
+            case 'r':
+                args->repeats = parseIntArg(c, optarg);
+                break;
+            case 'j':
+                args->numThreads = parseIntArg(c, optarg);
+                break;
+            case 'o':
+                args->dumpFile = optarg;
+                break;
+            default:
+                return false;
+        }
+    }
+
+    return true;
+}
+
+static void printUsage()
+{
+    fprintf(stderr,
+            "usage: cish_bench [-p native|antlr] [-d dimension] [-n steps] [-r repeats] [-j threads] [-o dump.c]\n"
+            "dimensions: all");
+    for (const Dimension &dimension: DIMENSIONS) {
+        fprintf(stderr, ", %s", dimension.name);
+    }
+    fprintf(stderr, "\n");
+}
+
+int main(int argc, char **argv)
+{
+    BenchArgs args;
+    if (!parseArgs(argc, argv, &args)) {
+        printUsage();
+        return 1;
+    }
+
+    bool found = false;
+    bool success = true;
+
+    for (const Dimension &dimension: DIMENSIONS) {
+        if (args.dimension == "all" || args.dimension == dimension.name) {
+            found = true;
+            success &= runDimension(args, dimension);
+        }
+    }
+
+    if (!found) {
+        printUsage();
+        return 1;
+    }
+
+    return success ? 0 : 1;
+}
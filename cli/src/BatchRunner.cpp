@@ -0,0 +1,236 @@
+#include "BatchRunner.h"
+
+#include "ast/AstBuilder.h"
+#include "vm/ExecutionContext.h"
+#include "vm/IStream.h"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <thread>
+
+
+/**
+ * Collects the output of a single VM.
+ */
+class CaptureStream: public cish::vm::IStream
+{
+public:
+    void write(const std::string &str) override
+    {
+        _output += str;
+    }
+
+    const std::string& getOutput() const
+    {
+        return _output;
+    }
+
+private:
+    std::string _output;
+};
+
+
+static bool readFile(const std::string &path, std::string *contents)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+
+    contents->assign((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return true;
+}
+
+// Messages end up in a tab separated file, so they must be a single field
+static std::string sanitize(std::string message)
+{
+    for (char &ch: message) {
+        if (ch == '\t' || ch == '\n' || ch == '\r') {
+            ch = ' ';
+        }
+    }
+    return message;
+}
+
+
+BatchRunner::BatchRunner(const cish::vm::VmOptions &opts,
+                         cish::ast::ParseContext::Frontend frontend,
+                         ModuleContextFactory moduleContextFactory):
+    _opts(opts),
+    _frontend(frontend),
+    _moduleContextFactory(moduleContextFactory)
+{
+}
+
+bool BatchRunner::loadManifest(const std::string &path)
+{
+    std::ifstream manifest(path);
+    if (!manifest) {
+        fprintf(stderr, "Unable to open manifest '%s'\n", path.c_str());
+        return false;
+    }
+
+    std::string line;
+    uint32_t lineNumber = 0;
+    while (std::getline(manifest, line)) {
+        lineNumber++;
+
+        std::istringstream fields(line);
+        std::vector<std::string> tokens;
+        std::string token;
+        while (fields >> token) {
+            tokens.push_back(token);
+        }
+
+        if (tokens.empty() || tokens[0][0] == '#') {
+            continue;
+        }
+
+        if (tokens.size() < 3) {
+            fprintf(stderr, "%s:%u: expected '<source> <stdin> <expected output> [args...]'\n",
+                    path.c_str(), lineNumber);
+            return false;
+        }
+
+        if (tokens[1] != "-") {
+            fprintf(stderr, "%s:%u: programs cannot read stdin, use '-'\n", path.c_str(), lineNumber);
+            return false;
+        }
+
+        Entry entry;
+        entry.line = lineNumber;
+        entry.source = tokens[0];
+        entry.expectedOutput = tokens[2] == "-" ? "" : tokens[2];
+        entry.args.assign(tokens.begin() + 3, tokens.end());
+        _entries.push_back(entry);
+    }
+
+    return true;
+}
+
+bool BatchRunner::run(uint32_t numThreads, FILE *results)
+{
+    // Compiling is done up front on this thread, the parser is not meant
+    // to be shared between threads.
+    std::map<std::string, Program> programs;
+    for (const Entry &entry: _entries) {
+        if (programs.count(entry.source) == 0) {
+            programs[entry.source] = compile(entry.source);
+        }
+    }
+
+    std::vector<Result> entryResults(_entries.size());
+    std::atomic<size_t> nextEntry(0);
+
+    auto worker = [&]() {
+        size_t index;
+        while ((index = nextEntry++) < _entries.size()) {
+            const Entry &entry = _entries[index];
+            entryResults[index] = runEntry(entry, programs.at(entry.source));
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (uint32_t i=0; i<std::max(1u, numThreads); i++) {
+        threads.emplace_back(worker);
+    }
+    for (std::thread &thread: threads) {
+        thread.join();
+    }
+
+    uint32_t passed = 0;
+    for (size_t i=0; i<_entries.size(); i++) {
+        const Result &result = entryResults[i];
+        fprintf(results, "%u\t%s\t%s\t%d\t%.3f\t%s\n",
+                _entries[i].line,
+                _entries[i].source.c_str(),
+                result.status,
+                result.exitCode,
+                result.millis,
+                sanitize(result.message).c_str());
+
+        if (strcmp(result.status, "PASS") == 0) {
+            passed++;
+        }
+    }
+
+    fflush(results);
+    fprintf(stderr, "%u of %zu entries passed\n", passed, _entries.size());
+
+    return passed == _entries.size();
+}
+
+BatchRunner::Program BatchRunner::compile(const std::string &path) const
+{
+    Program program;
+
+    std::string source;
+    if (!readFile(path, &source)) {
+        program.error = "Unable to read source";
+        return program;
+    }
+
+    try {
+        cish::ast::ParseContext::Ptr parseContext = cish::ast::ParseContext::parseSource(source, _frontend);
+        cish::ast::AstBuilder builder(parseContext, _moduleContextFactory());
+        program.snapshot = cish::vm::VirtualMachine::createSnapshot(_opts, builder.buildAst());
+    } catch (cish::Exception &e) {
+        program.error = e.userMessage();
+    } catch (std::exception &e) {
+        program.error = e.what();
+    }
+
+    return program;
+}
+
+BatchRunner::Result BatchRunner::runEntry(const Entry &entry, const Program &program) const
+{
+    Result result = { "ERROR", -1, 0.0, program.error };
+    if (!program.snapshot) {
+        return result;
+    }
+
+    std::string expectedOutput;
+    if (!entry.expectedOutput.empty() && !readFile(entry.expectedOutput, &expectedOutput)) {
+        result.message = "Unable to read expected output '" + entry.expectedOutput + "'";
+        return result;
+    }
+
+    cish::vm::VmOptions opts = _opts;
+    opts.args.clear();
+    opts.args.push_back(entry.source);
+    opts.args.insert(opts.args.end(), entry.args.begin(), entry.args.end());
+
+    const auto start = std::chrono::steady_clock::now();
+
+    try {
+        CaptureStream output;
+        cish::vm::VirtualMachine vm(opts, program.snapshot);
+        vm.getExecutionContext()->setStdout(&output);
+        vm.executeBlocking();
+
+        result.millis = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        if (vm.getRuntimeError()) {
+            result.message = vm.getRuntimeError()->userMessage();
+        } else {
+            result.exitCode = vm.getExitCode();
+            if (!entry.expectedOutput.empty() && output.getOutput() != expectedOutput) {
+                result.status = "FAIL";
+                result.message = "Output differs from '" + entry.expectedOutput + "'";
+            } else {
+                result.status = "PASS";
+                result.message = "";
+            }
+        }
+    } catch (cish::Exception &e) {
+        result.message = e.userMessage();
+    } catch (std::exception &e) {
+        result.message = e.what();
+    }
+
+    return result;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "ast/ParseContext.h"
+#include "module/ModuleContext.h"
+#include "vm/VirtualMachine.h"
+
+#include <stdint.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * Runs the entries of a manifest across a pool of worker threads.
+ *
+ * The manifest has one entry per line, '#' starts a comment line:
+ *
+ *   <source> <stdin> <expected output> [args...]
+ *
+ * <stdin> and <expected output> are file paths, or '-' for none. Cish
+ * programs have no way of reading stdin, so only '-' is accepted for it.
+ * Every distinct source is parsed and initialized once, and the VMs
+ * running it are forked off the resulting snapshot.
+ *
+ * The results are written as one tab separated line per entry, in the
+ * order of the manifest:
+ *
+ *   <line> <source> <PASS|FAIL|ERROR> <exit code> <milliseconds> <message>
+ *
+ * An entry fails if its output differs from the expected output, and is
+ * an error if it does not compile or terminates with a runtime error.
+ */
+class BatchRunner
+{
+public:
+    typedef std::function<cish::module::ModuleContext::Ptr()> ModuleContextFactory;
+
+    BatchRunner(const cish::vm::VmOptions &opts,
+                cish::ast::ParseContext::Frontend frontend,
+                ModuleContextFactory moduleContextFactory);
+
+    bool loadManifest(const std::string &path);
+
+    /**
+     * Run every entry and write the results. Returns true if every entry
+     * passed.
+     */
+    bool run(uint32_t numThreads, FILE *results);
+
+private:
+    struct Entry
+    {
+        uint32_t line;
+        std::string source;
+        std::string expectedOutput;
+        std::vector<std::string> args;
+    };
+
+    struct Program
+    {
+        cish::vm::VmSnapshot::Ptr snapshot;
+        std::string error;
+    };
+
+    struct Result
+    {
+        const char *status;
+        int exitCode;
+        double millis;
+        std::string message;
+    };
+
+    cish::vm::VmOptions _opts;
+    cish::ast::ParseContext::Frontend _frontend;
+    ModuleContextFactory _moduleContextFactory;
+    std::vector<Entry> _entries;
+
+    Program compile(const std::string &path) const;
+    Result runEntry(const Entry &entry, const Program &program) const;
+};
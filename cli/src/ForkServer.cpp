@@ -0,0 +1,336 @@
+#include "ForkServer.h"
+
+#include "Exception.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <iostream>
+
+// The number of standard streams passed along with a request
+static const int NUM_STREAMS = 3;
+
+// Requests are command lines, anything larger is not one
+static const uint32_t MAX_REQUEST_SIZE = 1 << 20;
+
+
+static bool makeAddress(const std::string &socketPath, sockaddr_un *addr)
+{
+    if (socketPath.size() >= sizeof(addr->sun_path)) {
+        fprintf(stderr, "Socket path '%s' is too long\n", socketPath.c_str());
+        return false;
+    }
+
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    strcpy(addr->sun_path, socketPath.c_str());
+    return true;
+}
+
+static bool writeAll(int fd, const void *data, size_t len)
+{
+    const uint8_t *ptr = (const uint8_t*)data;
+    while (len > 0) {
+        const ssize_t written = write(fd, ptr, len);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return false;
+        }
+
+        ptr += written;
+        len -= written;
+    }
+
+    return true;
+}
+
+static bool readAll(int fd, void *data, size_t len)
+{
+    uint8_t *ptr = (uint8_t*)data;
+    while (len > 0) {
+        const ssize_t bytesRead = read(fd, ptr, len);
+        if (bytesRead < 0 && errno == EINTR) {
+            continue;
+        }
+        if (bytesRead <= 0) {
+            return false;
+        }
+
+        ptr += bytesRead;
+        len -= bytesRead;
+    }
+
+    return true;
+}
+
+static void appendU32(std::vector<uint8_t> &buffer, uint32_t value)
+{
+    for (int i=0; i<4; i++) {
+        buffer.push_back((uint8_t)(value >> (i * 8)));
+    }
+}
+
+static uint32_t decodeU32(const uint8_t *data)
+{
+    return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+static bool decodeStrings(const std::vector<uint8_t> &payload, std::vector<std::string> *strings)
+{
+    size_t pos = 0;
+    if (payload.size() < 4) {
+        return false;
+    }
+
+    const uint32_t count = decodeU32(payload.data());
+    pos += 4;
+
+    for (uint32_t i=0; i<count; i++) {
+        if (payload.size() - pos < 4) {
+            return false;
+        }
+
+        const uint32_t len = decodeU32(payload.data() + pos);
+        pos += 4;
+        if (payload.size() - pos < len) {
+            return false;
+        }
+
+        strings->push_back(std::string((const char*)payload.data() + pos, len));
+        pos += len;
+    }
+
+    return true;
+}
+
+/**
+ * Receive the length of the request along with the standard streams of
+ * the client.
+ */
+static bool receiveHeader(int conn, uint32_t *length, int fds[NUM_STREAMS])
+{
+    uint8_t lengthBytes[4];
+    iovec iov = { lengthBytes, sizeof(lengthBytes) };
+
+    union {
+        cmsghdr header;
+        char buffer[CMSG_SPACE(sizeof(int) * NUM_STREAMS)];
+    } control;
+
+    msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buffer;
+    msg.msg_controllen = sizeof(control.buffer);
+
+    if (recvmsg(conn, &msg, 0) != sizeof(lengthBytes)) {
+        return false;
+    }
+
+    cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    if (!cmsg || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS ||
+        cmsg->cmsg_len != CMSG_LEN(sizeof(int) * NUM_STREAMS)) {
+        return false;
+    }
+
+    memcpy(fds, CMSG_DATA(cmsg), sizeof(int) * NUM_STREAMS);
+    *length = decodeU32(lengthBytes);
+    return true;
+}
+
+static void sendExitCode(int conn, int32_t exitCode)
+{
+    fflush(nullptr);
+
+    uint8_t response[4];
+    for (int i=0; i<4; i++) {
+        response[i] = (uint8_t)((uint32_t)exitCode >> (i * 8));
+    }
+    writeAll(conn, response, sizeof(response));
+}
+
+static int32_t runHandler(const ForkServerHandler &handler, std::vector<std::string> &args)
+{
+    try {
+        return handler(args);
+    } catch (cish::Exception &e) {
+        std::cerr << e.userMessage() << std::endl;
+    } catch (std::exception &e) {
+        std::cerr << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "unknown failure" << std::endl;
+    }
+    return 1;
+}
+
+static void handleConnection(int conn, const ForkServerHandler &handler)
+{
+    uint32_t length;
+    int fds[NUM_STREAMS];
+    if (!receiveHeader(conn, &length, fds) || length > MAX_REQUEST_SIZE) {
+        fprintf(stderr, "Received a malformed request\n");
+        sendExitCode(conn, 1);
+        return;
+    }
+
+    std::vector<uint8_t> payload(length);
+    std::vector<std::string> strings;
+    if (!readAll(conn, payload.data(), length) || !decodeStrings(payload, &strings) || strings.empty()) {
+        fprintf(stderr, "Received a malformed request\n");
+        sendExitCode(conn, 1);
+        return;
+    }
+
+    for (int i=0; i<NUM_STREAMS; i++) {
+        dup2(fds[i], i);
+        close(fds[i]);
+    }
+
+    if (chdir(strings[0].c_str()) != 0) {
+        fprintf(stderr, "Unable to change directory to '%s'\n", strings[0].c_str());
+        sendExitCode(conn, 1);
+        return;
+    }
+
+    std::vector<std::string> args(strings.begin() + 1, strings.end());
+    sendExitCode(conn, runHandler(handler, args));
+}
+
+
+int runForkServer(const std::string &socketPath, const ForkServerHandler &handler)
+{
+    sockaddr_un addr;
+    if (!makeAddress(socketPath, &addr)) {
+        return 1;
+    }
+
+    const int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        perror("socket");
+        return 1;
+    }
+
+    // A socket left behind by a previous server would make bind fail,
+    // but anything else at the path is not ours to remove
+    struct stat info;
+    if (lstat(socketPath.c_str(), &info) == 0) {
+        if (!S_ISSOCK(info.st_mode)) {
+            fprintf(stderr, "'%s' exists and is not a socket\n", socketPath.c_str());
+            close(listener);
+            return 1;
+        }
+        unlink(socketPath.c_str());
+    }
+
+    if (bind(listener, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(listener, SOMAXCONN) != 0) {
+        perror(socketPath.c_str());
+        close(listener);
+        return 1;
+    }
+
+    // Children are never waited for, so let the kernel reap them
+    signal(SIGCHLD, SIG_IGN);
+
+    while (true) {
+        const int conn = accept(listener, nullptr, nullptr);
+        if (conn < 0) {
+            if (errno != EINTR) {
+                perror("accept");
+            }
+            continue;
+        }
+
+        const pid_t pid = fork();
+        if (pid == 0) {
+            close(listener);
+            signal(SIGCHLD, SIG_DFL);
+            handleConnection(conn, handler);
+            _exit(0);
+        }
+
+        if (pid < 0) {
+            perror("fork");
+        }
+
+        close(conn);
+    }
+}
+
+int runForkClient(const std::string &socketPath, const std::vector<std::string> &args)
+{
+    sockaddr_un addr;
+    if (!makeAddress(socketPath, &addr)) {
+        return 1;
+    }
+
+    char cwd[PATH_MAX];
+    if (!getcwd(cwd, sizeof(cwd))) {
+        perror("getcwd");
+        return 1;
+    }
+
+    const int conn = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (conn < 0 || connect(conn, (sockaddr*)&addr, sizeof(addr)) != 0) {
+        perror(socketPath.c_str());
+        return 1;
+    }
+
+    std::vector<uint8_t> payload;
+    appendU32(payload, (uint32_t)args.size() + 1);
+    appendU32(payload, (uint32_t)strlen(cwd));
+    payload.insert(payload.end(), cwd, cwd + strlen(cwd));
+    for (const std::string &arg: args) {
+        appendU32(payload, (uint32_t)arg.size());
+        payload.insert(payload.end(), arg.begin(), arg.end());
+    }
+
+    std::vector<uint8_t> lengthBytes;
+    appendU32(lengthBytes, (uint32_t)payload.size());
+    iovec iov = { lengthBytes.data(), lengthBytes.size() };
+
+    union {
+        cmsghdr header;
+        char buffer[CMSG_SPACE(sizeof(int) * NUM_STREAMS)];
+    } control;
+    memset(&control, 0, sizeof(control));
+
+    msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buffer;
+    msg.msg_controllen = sizeof(control.buffer);
+
+    cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int) * NUM_STREAMS);
+    const int fds[NUM_STREAMS] = { STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO };
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+    if (sendmsg(conn, &msg, 0) != (ssize_t)lengthBytes.size() ||
+        !writeAll(conn, payload.data(), payload.size())) {
+        perror("sendmsg");
+        close(conn);
+        return 1;
+    }
+
+    uint8_t response[4];
+    if (!readAll(conn, response, sizeof(response))) {
+        fprintf(stderr, "The server did not report an exit code\n");
+        close(conn);
+        return 1;
+    }
+
+    close(conn);
+    return (int32_t)decodeU32(response);
+}
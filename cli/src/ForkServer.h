@@ -0,0 +1,44 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * The fork server keeps a warmed up interpreter resident and listens on a
+ * UNIX domain socket. Every connection is handled by a forked child, which
+ * inherits the parser caches and module definitions of the server instead
+ * of building them again.
+ *
+ * A request is the client's working directory and command line, with the
+ * client's stdin, stdout and stderr passed along as file descriptors, so
+ * the program reads and writes the client's streams directly. The child
+ * replies with the exit code once the program has terminated, or with 1
+ * if the request could not be run.
+ *
+ * All integers are little endian. The request is a u32 total length, sent
+ * together with the three descriptors, followed by a u32 string count and
+ * that many strings, each a u32 length and its bytes. The first string is
+ * the working directory, the rest is argv. The response is an i32 exit
+ * code.
+ */
+
+/**
+ * Called in the forked child with the argv of the client, after the
+ * working directory and the standard streams have been switched over.
+ * Returns the exit code.
+ */
+typedef std::function<int(std::vector<std::string> &args)> ForkServerHandler;
+
+/**
+ * Serve requests on 'socketPath' until the process is killed. Only returns
+ * if the socket cannot be set up. A socket left at the path is replaced,
+ * anything else is left alone and the server does not start.
+ */
+int runForkServer(const std::string &socketPath, const ForkServerHandler &handler);
+
+/**
+ * Send 'args' to the server on 'socketPath' and wait for the program to
+ * terminate. Returns the exit code of the program.
+ */
+int runForkClient(const std::string &socketPath, const std::vector<std::string> &args);
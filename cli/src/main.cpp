@@ -3,14 +3,19 @@
 
 #include "ast/AstBuilder.h"
 #include "ast/Ast.h"
-#include "ast/AntlrContext.h"
+#include "ast/ParseContext.h"
 
 #include "module/stdio/stdioModule.h"
 #include "module/stdlib/stdlibModule.h"
 #include "module/string/stringModule.h"
 
+#include "BatchRunner.h"
+#include "ForkServer.h"
+
 #include <iostream>
 #include <functional>
+#include <memory>
+#include <thread>
 #include <unistd.h>
 #include <vector>
 
@@ -18,6 +23,25 @@ struct CliArgs {
     uint32_t memorySize;
     uint32_t allocationSize;
     std::string fileName;
+    bool printMemoryStats;
+    bool printLeaks;
+    bool collectLeaks;
+    std::string allocationTraceFile;
+    std::string checkpointFile;
+    uint32_t checkpointInterval;
+    bool haltAfterExec;
+    cish::ast::ParseContext::Frontend frontend;
+
+    // Fork server socket to listen on, or to send the program to
+    std::string serverSocket;
+    std::string clientSocket;
+
+    // Manifest of programs to run in parallel, see BatchRunner
+    std::string batchManifest;
+    std::string resultsFile;
+
+    // Threads to run the batch on, or to parse a single program on
+    uint32_t numThreads;
 
     // Command line arguments to pass to the VM
     std::vector<std::string> args;
@@ -51,14 +75,68 @@ cish::module::ModuleContext::Ptr createModuleContext()
     return moduleContext;
 }
 
-int execute(const CliArgs& args)
+void printMemoryStats(const cish::vm::MemoryStats &stats)
+{
+    fprintf(stderr, "\n--- memory ---\n");
+    fprintf(stderr, "live bytes:        %llu\n", (unsigned long long)stats.liveBytes);
+    fprintf(stderr, "peak bytes:        %llu\n", (unsigned long long)stats.peakBytes);
+    fprintf(stderr, "committed bytes:   %llu\n", (unsigned long long)stats.committedBytes);
+    fprintf(stderr, "allocations:       %llu (%llu failed)\n",
+            (unsigned long long)stats.allocationCount,
+            (unsigned long long)stats.failedAllocationCount);
+    fprintf(stderr, "frees:             %llu\n", (unsigned long long)stats.freeCount);
+    fprintf(stderr, "free bytes:        %llu (largest block %llu, %.1f%% fragmented)\n",
+            (unsigned long long)stats.totalFreeBytes,
+            (unsigned long long)stats.largestFreeBlock,
+            stats.getFragmentation() * 100.0);
+    fprintf(stderr, "allocate time:     %.3f ms\n", stats.allocateNanos / 1e6);
+    fprintf(stderr, "free time:         %.3f ms\n", stats.freeNanos / 1e6);
+
+    for (uint32_t i=0; i<cish::vm::MemoryStats::NUM_SIZE_CLASSES; i++) {
+        if (stats.allocationsBySizeClass[i] == 0)
+            continue;
+
+        if (i + 1 < cish::vm::MemoryStats::NUM_SIZE_CLASSES) {
+            fprintf(stderr, "  <= %-10u    %llu\n", 8u << i,
+                    (unsigned long long)stats.allocationsBySizeClass[i]);
+        } else {
+            fprintf(stderr, "   > %-10u    %llu\n", 8u << (i - 1),
+                    (unsigned long long)stats.allocationsBySizeClass[i]);
+        }
+    }
+}
+
+void printLeakReport(const cish::vm::LeakReport &report)
+{
+    fprintf(stderr, "\n--- leaks ---\n");
+    fprintf(stderr, "%llu bytes in %zu blocks are unreachable\n",
+            (unsigned long long)report.leakedBytes, report.leaks.size());
+
+    for (const auto &site: report.getCallSiteSummary()) {
+        fprintf(stderr, "  %llu bytes in %u blocks allocated in %s\n",
+                (unsigned long long)site.bytes, site.count, site.callSite.c_str());
+    }
+}
+
+cish::vm::VmOptions createVmOptions(const CliArgs &args)
+{
+    cish::vm::VmOptions opts;
+    opts.heapSize = args.memorySize;
+    opts.minAllocSize = 4;
+    opts.timeAllocations = args.printMemoryStats;
+    opts.allocationTraceFile = args.allocationTraceFile;
+    opts.collectLeaks = args.collectLeaks;
+    opts.checkpointFile = args.checkpointFile;
+    opts.checkpointInterval = args.checkpointInterval;
+    return opts;
+}
+
+int execute(const CliArgs& args, cish::module::ModuleContext::Ptr moduleContext)
 {
     std::ifstream t(args.fileName);
     std::string source((std::istreambuf_iterator<char>(t)), std::istreambuf_iterator<char>());
 
-    cish::module::ModuleContext::Ptr moduleContext = createModuleContext();
-
-    cish::ast::ParseContext::Ptr parseContext = cish::ast::ParseContext::parseSource(source);
+    cish::ast::ParseContext::Ptr parseContext = cish::ast::ParseContext::parseSource(source, args.frontend, args.numThreads);
     cish::ast::AstBuilder builder(parseContext, std::move(moduleContext));
 
     cish::ast::Ast::Ptr ast;
@@ -67,18 +145,44 @@ int execute(const CliArgs& args)
         return 1;
     }
 
-    cish::vm::VmOptions opts;
-    opts.heapSize = args.memorySize;
-    opts.minAllocSize = 4;
+    cish::vm::VmOptions opts = createVmOptions(args);
     opts.args.push_back(args.fileName);
     for (const auto& a: args.args) {
         opts.args.push_back(a);
     }
 
-    cish::vm::VirtualMachine vm(opts, std::move(ast));
-    vm.executeBlocking();
+    // Resume from the checkpoint if the program has been interrupted
+    const bool resume = !args.checkpointFile.empty() && access(args.checkpointFile.c_str(), F_OK) == 0;
+
+    std::unique_ptr<cish::vm::VirtualMachine> vm;
+    if (!doTry([&]() {
+        if (resume) {
+            auto snapshot = cish::vm::VirtualMachine::loadCheckpoint(args.checkpointFile, ast);
+            vm = std::make_unique<cish::vm::VirtualMachine>(opts, snapshot);
+        } else {
+            vm = std::make_unique<cish::vm::VirtualMachine>(opts, std::move(ast));
+        }
+    })) {
+        return 1;
+    }
+
+    vm->executeBlocking();
+
+    // The program has run to its end, so a later run with the same
+    // checkpoint file must start over rather than resume it
+    if (!args.checkpointFile.empty()) {
+        cish::vm::VirtualMachine::removeCheckpoint(args.checkpointFile);
+    }
+
+    if (args.printMemoryStats) {
+        printMemoryStats(vm->getMemoryStats());
+    }
+
+    if (args.printLeaks) {
+        printLeakReport(vm->detectLeaks());
+    }
 
-    auto err = vm.getRuntimeError();
+    auto err = vm->getRuntimeError();
     if (err != nullptr) {
         std::cerr << err->userMessage() << std::endl;
         return 1;
@@ -87,7 +191,7 @@ int execute(const CliArgs& args)
     fflush(stdout);
     fflush(stderr);
 
-    return vm.getExitCode();
+    return vm->getExitCode();
 }
 
 
@@ -97,32 +201,103 @@ int parseIntArg(char option, const char *str)
 {
     int value = atoi(str);
     if (value == 0) {
-        fprintf(stderr, "Argument '%s' is not valid for option '%c'", str, option);
+        fprintf(stderr, "Argument '%s' is not valid for option '%c'\n", str, option);
         exit(1);
     }
 
     return value;
 }
 
-int main(int argc, char **argv)
+uint32_t parseSizeArg(char option, const char *str)
 {
-    bool haltAfterExec = false;
+    char *end = nullptr;
+    unsigned long long value = strtoull(str, &end, 10);
+
+    int shift = 0;
+    switch (*end) {
+        case 'k': case 'K': shift = 10; end++; break;
+        case 'm': case 'M': shift = 20; end++; break;
+        case 'g': case 'G': shift = 30; end++; break;
+    }
 
-    CliArgs args;
-    args.allocationSize = 4;
-    args.memorySize = 1 << 10;
+    const uint32_t maxValue = cish::vm::Memory::maxHeapSize();
+    if (value == 0 || *end != '\0' || value > (maxValue >> shift)) {
+        fprintf(stderr, "Argument '%s' is not valid for option '%c'\n", str, option);
+        exit(1);
+    }
+
+    return (uint32_t)(value << shift);
+}
+
+bool parseArgs(int argc, char **argv, CliArgs *args)
+{
+    args->allocationSize = 4;
+    args->memorySize = cish::vm::VmOptions().heapSize;
+    args->printMemoryStats = false;
+    args->printLeaks = false;
+    args->collectLeaks = false;
+    args->checkpointInterval = cish::vm::VmOptions().checkpointInterval;
+    args->haltAfterExec = false;
+    args->frontend = cish::ast::ParseContext::Frontend::ANTLR;
+    args->numThreads = std::max(1u, std::thread::hardware_concurrency());
+
+    // The fork server parses a command line for every request
+    optind = 1;
 
     int c;
-    while ((c = getopt (argc, argv, "ha:m:")) != -1) {
+    while ((c = getopt (argc, argv, "hslca:m:t:k:i:S:C:b:r:j:p:")) != -1) {
         switch (c) {
             case 'a':
-                args.allocationSize = parseIntArg(optopt, optarg);
+                args->allocationSize = parseIntArg('a', optarg);
                 break;
             case 'm':
-                args.memorySize = parseIntArg(optopt, optarg);
+                args->memorySize = parseSizeArg('m', optarg);
                 break;
             case 'h':
-                haltAfterExec = true;
+                args->haltAfterExec = true;
+                break;
+            case 's':
+                args->printMemoryStats = true;
+                break;
+            case 'l':
+                args->printLeaks = true;
+                break;
+            case 'c':
+                args->collectLeaks = true;
+                break;
+            case 't':
+                args->allocationTraceFile = optarg;
+                break;
+            case 'k':
+                args->checkpointFile = optarg;
+                break;
+            case 'i':
+                args->checkpointInterval = parseIntArg('i', optarg);
+                break;
+            case 'S':
+                args->serverSocket = optarg;
+                break;
+            case 'C':
+                args->clientSocket = optarg;
+                break;
+            case 'b':
+                args->batchManifest = optarg;
+                break;
+            case 'r':
+                args->resultsFile = optarg;
+                break;
+            case 'j':
+                args->numThreads = parseIntArg('j', optarg);
+                break;
+            case 'p':
+                if (strcmp(optarg, "native") == 0) {
+                    args->frontend = cish::ast::ParseContext::Frontend::NATIVE;
+                } else if (strcmp(optarg, "antlr") == 0) {
+                    args->frontend = cish::ast::ParseContext::Frontend::ANTLR;
+                } else {
+                    fprintf(stderr, "Argument '%s' is not valid for option 'p'\n", optarg);
+                    return false;
+                }
                 break;
             case '?':
                 if (isalpha(optopt))
@@ -131,26 +306,104 @@ int main(int argc, char **argv)
                     fprintf(stderr, "Unknown option `-%c'.\n", optopt);
                 else
                     fprintf(stderr, "Unknown option character `\\x%x'.\n", optopt);
-                return 1;
+                return false;
             default:
                 abort();
         }
     }
 
+    if (!args->serverSocket.empty() || !args->batchManifest.empty()) {
+        return true;
+    }
+
     if (optind == argc) {
         fprintf(stderr, "Missing source file to execute\n");
-        exit(1);
+        return false;
     }
 
-    args.fileName = argv[optind];
+    args->fileName = argv[optind];
 
     for (int i=optind+1; i<argc; i++) {
-        args.args.push_back(argv[i]);
+        args->args.push_back(argv[i]);
+    }
+
+    return true;
+}
+
+int serve(const std::string &socketPath)
+{
+    cish::ast::ParseContext::warmUp();
+    cish::module::ModuleContext::Ptr moduleContext = createModuleContext();
+
+    return runForkServer(socketPath, [&](std::vector<std::string> &requestArgs) {
+        std::vector<char*> argv;
+        for (std::string &arg: requestArgs) {
+            argv.push_back(&arg[0]);
+        }
+        argv.push_back(nullptr);
+
+        CliArgs args;
+        if (!parseArgs((int)requestArgs.size(), argv.data(), &args)) {
+            return 1;
+        }
+
+        return execute(args, std::move(moduleContext));
+    });
+}
+
+int runBatch(const CliArgs &args)
+{
+    // Every VM would write to the same file
+    if (!args.checkpointFile.empty() || !args.allocationTraceFile.empty()) {
+        fprintf(stderr, "Checkpoints and allocation traces are not supported in batch mode\n");
+        return 1;
+    }
+
+    BatchRunner runner(createVmOptions(args), args.frontend, createModuleContext);
+    if (!runner.loadManifest(args.batchManifest)) {
+        return 1;
+    }
+
+    FILE *results = stdout;
+    if (!args.resultsFile.empty()) {
+        results = fopen(args.resultsFile.c_str(), "w");
+        if (!results) {
+            perror(args.resultsFile.c_str());
+            return 1;
+        }
+    }
+
+    const bool passed = runner.run(args.numThreads, results);
+
+    if (results != stdout) {
+        fclose(results);
+    }
+
+    return passed ? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+    CliArgs args;
+    if (!parseArgs(argc, argv, &args)) {
+        return 1;
+    }
+
+    if (!args.serverSocket.empty()) {
+        return serve(args.serverSocket);
+    }
+
+    if (!args.clientSocket.empty()) {
+        return runForkClient(args.clientSocket, std::vector<std::string>(argv, argv + argc));
+    }
+
+    if (!args.batchManifest.empty()) {
+        return runBatch(args);
     }
 
-    int retval = execute(args);
+    int retval = execute(args, createModuleContext());
 
-    if (haltAfterExec) {
+    if (args.haltAfterExec) {
         getchar();
     }
 
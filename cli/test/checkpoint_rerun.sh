@@ -0,0 +1,54 @@
+#!/bin/bash
+#
+# Runs a program with a checkpoint file until it has been checkpointed,
+# lets it finish, and runs it again with the same checkpoint file. The
+# second run must start over rather than resume the finished one.
+#
+# usage: checkpoint_rerun.sh <path to cish_cli>
+
+CISH_CLI=$1
+TMPDIR=$(mktemp -d)
+trap "rm -rf $TMPDIR" EXIT
+
+CHECKPOINT=$TMPDIR/program.ckpt
+STOPFILE=$TMPDIR/stop
+
+term() {
+    echo "$@"
+    exit 1
+}
+
+# Spins in main until the stop file exists, then prints its first argument
+cat > $TMPDIR/program.c <<'PROGRAM'
+#include <stdio.h>
+
+int main(int argc, char **argv) {
+    void *stop = NULL;
+    while (stop == NULL) {
+        stop = fopen(argv[2], "r");
+    }
+    fclose(stop);
+    printf("%s\n", argv[1]);
+    return 0;
+}
+PROGRAM
+
+$CISH_CLI -k $CHECKPOINT -i 1 $TMPDIR/program.c first $STOPFILE > $TMPDIR/first.out &
+PID=$!
+
+for i in $(seq 1 300); do
+    [ -f $CHECKPOINT ] && break
+    sleep 0.1
+done
+[ -f $CHECKPOINT ] || term "no checkpoint was written"
+
+touch $STOPFILE
+wait $PID || term "first run failed"
+[ "$(cat $TMPDIR/first.out)" == "first" ] || term "first run printed '$(cat $TMPDIR/first.out)'"
+[ -e $CHECKPOINT ] && term "checkpoint was left behind by a finished run"
+[ -e $CHECKPOINT.tmp ] && term "partial checkpoint was left behind by a finished run"
+
+OUT=$($CISH_CLI -k $CHECKPOINT -i 1 $TMPDIR/program.c second $STOPFILE) || term "second run failed"
+[ "$OUT" == "second" ] || term "second run printed '$OUT', expected it to start over"
+
+exit 0
@@ -0,0 +1,74 @@
+#!/bin/bash
+#
+# Refuses to start a fork server on a path that holds something other
+# than a socket, and checks that a request the server can't run still
+# reports an exit code to the client.
+#
+# usage: fork_server.sh <path to cish_cli>
+
+CISH_CLI=$1
+TMPDIR=$(mktemp -d)
+SERVER=
+trap '[ -n "$SERVER" ] && kill $SERVER; rm -rf $TMPDIR' EXIT
+
+SOCKET=$TMPDIR/server.sock
+
+term() {
+    echo "$@"
+    exit 1
+}
+
+cat > $TMPDIR/program.c <<'PROGRAM'
+#include <stdio.h>
+
+int main() {
+    printf("served\n");
+    return 3;
+}
+PROGRAM
+
+cp $TMPDIR/program.c $TMPDIR/victim.c
+timeout 5 $CISH_CLI -S $TMPDIR/victim.c 2> /dev/null && term "server started on a regular file"
+cmp -s $TMPDIR/program.c $TMPDIR/victim.c || term "regular file at the socket path was changed"
+
+$CISH_CLI -S $SOCKET &
+SERVER=$!
+
+for i in $(seq 1 100); do
+    [ -S $SOCKET ] && break
+    sleep 0.1
+done
+[ -S $SOCKET ] || term "server did not create its socket"
+
+OUT=$($CISH_CLI -C $SOCKET $TMPDIR/program.c)
+STATUS=$?
+[ "$OUT" == "served" ] || term "program printed '$OUT'"
+[ $STATUS == 3 ] || term "program exited with $STATUS, expected 3"
+
+# The server can't change into a working directory that doesn't exist.
+# The client checks its own, so the request is sent by hand.
+STATUS=$(python3 - $SOCKET $TMPDIR/program.c 2> /dev/null <<'CLIENT'
+import socket, struct, sys
+
+strings = [b"/nonexistent", sys.argv[2].encode()]
+payload = struct.pack("<I", len(strings))
+for string in strings:
+    payload += struct.pack("<I", len(string)) + string
+
+conn = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+conn.connect(sys.argv[1])
+socket.send_fds(conn, [struct.pack("<I", len(payload))], [0, 1, 2])
+conn.sendall(payload)
+
+response = b""
+while len(response) < 4:
+    chunk = conn.recv(4 - len(response))
+    if not chunk:
+        break
+    response += chunk
+print(struct.unpack("<i", response)[0] if len(response) == 4 else "none")
+CLIENT
+)
+[ "$STATUS" == 1 ] || term "failed request reported exit code '$STATUS', expected 1"
+
+exit 0
@@ -0,0 +1,32 @@
+#include <stdio.h>
+
+int is_prime(int n)
+{
+    if (n < 2)
+        return 0;
+
+    for (int i = 2; i * i <= n; i++) {
+        if (n % i == 0)
+            return 0;
+    }
+    return 1;
+}
+
+int main()
+{
+    int count = 0;
+    int n = 0;
+
+    while (1) {
+        n++;
+        if (!is_prime(n))
+            continue;
+
+        printf("%d\n", n);
+        count++;
+        if (count == 10)
+            break;
+    }
+
+    return count;
+}
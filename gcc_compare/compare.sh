@@ -31,7 +31,7 @@ compare_file() {
     if [ $time == true ]; then
         echo -n "cish:"
     fi
-    CISH_OUT=$($timecmd cish_cli $CISH_ARGS $file $CLI_ARGS)
+    CISH_OUT=$($timecmd cish_cli $CISH_CLIENT $CISH_ARGS $file $CLI_ARGS)
     CISH_CODE=$?
 
     EMSG=""
@@ -57,6 +57,10 @@ compare_file() {
 
 which cish_cli > /dev/null || term "cish_cli must be on the path"
 
+if [ -n "$CISH_SERVER" ]; then
+    CISH_CLIENT="-C $CISH_SERVER"
+fi
+
 FILES=$(ls $DIR/*.c)
 GCCDIR=$DIR/.tmp
 
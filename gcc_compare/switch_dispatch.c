@@ -0,0 +1,61 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+// A tiny stack machine, dispatching on the opcode of each instruction
+int run(int *program, int length)
+{
+    int *stack = (int*)malloc(sizeof(int) * 16);
+    int sp = 0;
+    int result = -1;
+
+    for (int pc = 0; pc < length; pc++) {
+        switch (program[pc]) {
+            case 0:
+                stack[sp] = program[pc + 1];
+                sp++;
+                pc++;
+                break;
+            case 1:
+                sp--;
+                stack[sp - 1] = stack[sp - 1] + stack[sp];
+                break;
+            case 2:
+                sp--;
+                stack[sp - 1] = stack[sp - 1] * stack[sp];
+                break;
+            case 3:
+                printf("%d\n", stack[sp - 1]);
+                break;
+            case 1000:
+                pc = length;
+                break;
+            default:
+                printf("bad opcode %d\n", program[pc]);
+                free(stack);
+                return -1;
+        }
+    }
+
+    result = stack[sp - 1];
+    free(stack);
+    return result;
+}
+
+int main()
+{
+    int *program = (int*)malloc(sizeof(int) * 10);
+    program[0] = 0;
+    program[1] = 6;
+    program[2] = 0;
+    program[3] = 7;
+    program[4] = 2;
+    program[5] = 3;
+    program[6] = 0;
+    program[7] = 2;
+    program[8] = 1;
+    program[9] = 3;
+
+    int result = run(program, 10);
+    free(program);
+    return result;
+}
@@ -57,9 +57,12 @@ statement
     | variableDeclaration ';'
     | arithmeticAssignment ';'
     | returnStatement
+    | breakStatement
+    | continueStatement
     | forStatement
     | whileStatement
     | doWhileStatement
+    | switchStatement
     | expressionStatement
     | ';'
     ;
@@ -70,6 +73,12 @@ expressionStatement
 returnStatement
     : 'return' expression? ';'
     ;
+breakStatement
+    : 'break' ';'
+    ;
+continueStatement
+    : 'continue' ';'
+    ;
 ifStatement
     : 'if' '(' expression ')' '{' statement* '}' elseStatement?
     | 'if' '(' expression ')' statement elseStatement?
@@ -100,6 +109,16 @@ whileStatement
 doWhileStatement
     : 'do' '{' statement* '}' 'while' '(' expression ')' ';'
     ;
+switchStatement
+    : 'switch' '(' expression ')' '{' switchSection* '}'
+    ;
+switchSection
+    : switchLabel+ statement*
+    ;
+switchLabel
+    : 'case' expression ':'
+    | 'default' ':'
+    ;
 
 
 assignment
@@ -22,4 +22,14 @@ TypeDecl AddrofExpression::getType() const
     return _type;
 }
 
+const Lvalue* AddrofExpression::getLvalue() const
+{
+    return _lvalue.get();
+}
+
+void AddrofExpression::forEachChild(const ChildVisitor &visitor) const
+{
+    visitor(_lvalue.get());
+}
+
 }
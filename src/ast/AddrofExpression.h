@@ -14,6 +14,8 @@ public:
 
     ExpressionValue evaluate(vm::ExecutionContext *context) const override;
     TypeDecl getType() const override;
+    const Lvalue* getLvalue() const;
+    void forEachChild(const ChildVisitor &visitor) const override;
 
 private:
     Lvalue::Ptr _lvalue;
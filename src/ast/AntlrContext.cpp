@@ -1,4 +1,5 @@
 #include "AntlrContext.h"
+#include "TreeConverter.h"
 
 
 namespace cish::ast
@@ -9,7 +10,8 @@ AntlrContext::AntlrContext(const std::string &source):
     _lexer(nullptr),
     _tokenStream(nullptr),
     _parser(nullptr),
-    _tree(nullptr)
+    _tree(nullptr),
+    _fullContext(false)
 {
     _inputStream = new antlr4::ANTLRInputStream(source);
 
@@ -21,9 +23,29 @@ AntlrContext::AntlrContext(const std::string &source):
 
     _parser = new CMParser(_tokenStream);
     _parser->removeErrorListeners();
-    _parser->addErrorListener(this);
 
-    _tree = _parser->root();
+    // SLL prediction is a lot cheaper than full LL, and only fails on
+    // input which is either invalid or needs the full context to be
+    // predicted. The parser bails out at the first error, so that only
+    // those sources pay for parsing twice. The syntax errors are reported
+    // by the second pass, while lexer errors are reported as the tokens
+    // are read by the first one.
+    auto *interpreter = _parser->getInterpreter<antlr4::atn::ParserATNSimulator>();
+    interpreter->setPredictionMode(antlr4::atn::PredictionMode::SLL);
+    _parser->setErrorHandler(std::make_shared<antlr4::BailErrorStrategy>());
+
+    try {
+        _tree = _parser->root();
+    } catch (antlr4::ParseCancellationException &e) {
+        _fullContext = true;
+
+        _parser->reset();
+        _parser->addErrorListener(this);
+        _parser->setErrorHandler(std::make_shared<antlr4::DefaultErrorStrategy>());
+        interpreter->setPredictionMode(antlr4::atn::PredictionMode::LL);
+
+        _tree = _parser->root();
+    }
 }
 
 AntlrContext::~AntlrContext()
@@ -49,6 +71,17 @@ std::vector<CompilationError> AntlrContext::getErrors() const
     return _errors;
 }
 
+bool AntlrContext::usedFullContext() const
+{
+    return _fullContext;
+}
+
+Ast::Ptr AntlrContext::buildAst(module::ModuleContext::Ptr moduleContext)
+{
+    internal::TreeConverter converter(std::move(moduleContext));
+    return converter.convertTree(this);
+}
+
 antlr4::tree::ParseTree* AntlrContext::getParseTree() const
 {
     if (hasErrors()) {
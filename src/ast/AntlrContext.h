@@ -1,5 +1,6 @@
 #pragma once
 
+#include "Ast.h"
 #include "ParseContext.h"
 #include "../Exception.h"
 
@@ -13,9 +14,6 @@
 namespace cish::ast
 {
 
-DECLARE_EXCEPTION(SyntaxErrorException);
-
-
 class AntlrContext: public ParseContext, private antlr4::ANTLRErrorListener
 {
 public:
@@ -26,7 +24,16 @@ public:
 
     bool hasErrors() const override;
     std::vector<CompilationError> getErrors() const override;
-    antlr4::tree::ParseTree* getParseTree() const override;
+    Ast::Ptr buildAst(module::ModuleContext::Ptr moduleContext) override;
+
+    antlr4::tree::ParseTree* getParseTree() const;
+
+    /**
+     * Whether the source had to be parsed a second time using full LL
+     * prediction, either because of syntax errors or because SLL
+     * prediction was not sufficient.
+     */
+    bool usedFullContext() const;
 
 private:
     antlr4::ANTLRInputStream *_inputStream;
@@ -34,6 +41,7 @@ private:
     antlr4::CommonTokenStream *_tokenStream;
     CMParser *_parser;
     antlr4::tree::ParseTree *_tree;
+    bool _fullContext;
 
     std::vector<CompilationError> _errors;
 
@@ -14,12 +14,14 @@ ArithmeticAssignmentStatement::ArithmeticAssignmentStatement(Lvalue::Ptr lvalue,
     _expression(expr)
 {
     // Construct the BinaryExpression with dummy values to catch any type incompatibilities.
+    // The operands are evaluated by us, so that the statement holds no state
+    // between executions.
     ExpressionValue dummyLeft(lvalue->getType(), 0);
     ExpressionValue dummyRight(expr->getType(), 0);
 
-    _leftExpr = std::make_shared<MutableLiteralExpression>(dummyLeft);
-    _rightExpr = std::make_shared<MutableLiteralExpression>(dummyRight);
-    _binaryExpression = std::make_shared<BinaryExpression>(_operator, _leftExpr, _rightExpr);
+    _binaryExpression = std::make_shared<BinaryExpression>(_operator,
+                            std::make_shared<LiteralExpression>(dummyLeft),
+                            std::make_shared<LiteralExpression>(dummyRight));
 
     // Ensure that the lvalue is non-const
     if (_lvalue->getType().isConst()) {
@@ -40,18 +42,17 @@ ArithmeticAssignmentStatement::ArithmeticAssignmentStatement(Lvalue::Ptr lvalue,
     }
 }
 
-void ArithmeticAssignmentStatement::virtualExecute(vm::ExecutionContext *ctx) const
+Completion ArithmeticAssignmentStatement::virtualExecute(vm::ExecutionContext *ctx) const
 {
     vm::MemoryView memView = _lvalue->getMemoryView(ctx);
 
     ExpressionValue lhs = getLeftValue(memView);
     ExpressionValue rhs = _expression->evaluate(ctx);
 
-    ((MutableLiteralExpression*)_leftExpr.get())->setValue(lhs);
-    ((MutableLiteralExpression*)_rightExpr.get())->setValue(rhs);
-    ExpressionValue nval = _binaryExpression->evaluate(ctx);
+    ExpressionValue nval = _binaryExpression->evaluateOperands(lhs, rhs);
 
     writeResult(memView, nval);
+    return Completion::NORMAL;
 }
 
 ExpressionValue ArithmeticAssignmentStatement::getLeftValue(vm::MemoryView &memoryView) const
@@ -117,4 +118,20 @@ void ArithmeticAssignmentStatement::writeResult(vm::MemoryView &memView,
     }
 }
 
+const Lvalue* ArithmeticAssignmentStatement::getLvalue() const
+{
+    return _lvalue.get();
+}
+
+void ArithmeticAssignmentStatement::forEachChild(const ChildVisitor &visitor) const
+{
+    visitor(_lvalue.get());
+    visitor(_expression.get());
+}
+
+void ArithmeticAssignmentStatement::rewriteExpressions(const ExpressionRewriter &rewriter)
+{
+    rewriter(_expression);
+}
+
 }
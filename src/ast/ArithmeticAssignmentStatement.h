@@ -3,7 +3,6 @@
 #include "AstNodes.h"
 #include "Lvalue.h"
 #include "BinaryExpression.h"
-#include "MutableLiteralExpression.h"
 
 
 namespace cish::ast
@@ -15,19 +14,20 @@ public:
     ArithmeticAssignmentStatement(Lvalue::Ptr lvalue,
                                   BinaryExpression::Operator op,
                                   Expression::Ptr expr);
+    const Lvalue* getLvalue() const;
+    void forEachChild(const ChildVisitor &visitor) const override;
+    void rewriteExpressions(const ExpressionRewriter &rewriter) override;
 
 protected:
-    virtual void virtualExecute(vm::ExecutionContext*) const;
+    virtual Completion virtualExecute(vm::ExecutionContext*) const;
 
 private:
     Lvalue::Ptr _lvalue;
     BinaryExpression::Operator _operator;
     Expression::Ptr _expression;
 
-    BinaryExpression::Ptr _binaryExpression;
-    mutable MutableLiteralExpression::Ptr _leftExpr;
-    mutable MutableLiteralExpression::Ptr _rightExpr;
-
+    // Only used to apply the operator, the operands are placeholders
+    std::shared_ptr<BinaryExpression> _binaryExpression;
 
     ExpressionValue getLeftValue(vm::MemoryView &memoryView) const;
     void writeResult(vm::MemoryView &memView, const ExpressionValue &value) const;
@@ -3,6 +3,8 @@
 #include "FunctionDefinition.h"
 #include "FunctionDeclarationStatement.h"
 
+#include <algorithm>
+
 
 namespace cish::ast
 {
@@ -23,6 +25,7 @@ void Ast::addFunctionDefinition(vm::Callable::Ptr callable)
     }
 
     _funcDefs[funcName] = callable;
+    _funcIndex[Symbol::intern(funcName)] = callable;
 }
 
 void Ast::addModule(const module::Module::Ptr module)
@@ -40,6 +43,12 @@ const vm::Callable::Ptr Ast::getFunctionDefinition(const std::string &funcName)
     return _funcDefs[funcName];
 }
 
+const vm::Callable::Ptr Ast::getFunctionDefinition(SymbolId symbol) const
+{
+    const vm::Callable::Ptr *funcDef = _funcIndex.find(symbol);
+    return funcDef ? *funcDef : nullptr;
+}
+
 std::vector<vm::Callable::Ptr> Ast::getFunctionDefinitions() const
 {
     std::vector<vm::Callable::Ptr> funcs;
@@ -50,18 +59,25 @@ std::vector<vm::Callable::Ptr> Ast::getFunctionDefinitions() const
     return funcs;
 }
 
+void Ast::removeFunctionDefinition(const std::string &funcName)
+{
+    _funcDefs.erase(funcName);
+
+    vm::Callable::Ptr *funcDef = _funcIndex.find(Symbol::find(funcName));
+    if (funcDef) {
+        *funcDef = nullptr;
+    }
+}
+
 void Ast::addRootStatement(Statement::Ptr statement)
 {
     assert(statement != nullptr);
     _rootStatements.push_back(statement);
 }
 
-std::vector<Statement::Ptr> Ast::getRootStatements() const
+const std::vector<Statement::Ptr>& Ast::getRootStatements() const
 {
-    std::vector<Statement::Ptr> copy;
-    for (Statement::Ptr s: _rootStatements)
-        copy.push_back(s);
-    return copy;
+    return _rootStatements;
 }
 
 void Ast::setStringTable(StringTable::Ptr stringTable)
@@ -76,9 +92,77 @@ const StringTable* Ast::getStringTable() const
     return _stringTable.get();
 }
 
+StringTable* Ast::getStringTable()
+{
+    return _stringTable.get();
+}
+
+void Ast::setDataSegment(DataSegment::Ptr dataSegment)
+{
+    _dataSegment = std::move(dataSegment);
+}
+
+const DataSegment* Ast::getDataSegment() const
+{
+    return _dataSegment.get();
+}
+
+DataSegment* Ast::getDataSegment()
+{
+    return _dataSegment.get();
+}
+
 void Ast::addStructLayout(StructLayout::Ptr structLayout)
 {
     _structLayouts.push_back(structLayout);
 }
 
+const StructLayout* Ast::getStructLayout(const std::string &name) const
+{
+    for (const StructLayout::Ptr &structLayout: _structLayouts) {
+        if (structLayout->getName() == name) {
+            return structLayout.get();
+        }
+    }
+
+    return nullptr;
+}
+
+std::vector<const StructLayout*> Ast::getStructLayouts() const
+{
+    std::vector<const StructLayout*> structLayouts;
+    for (const StructLayout::Ptr &structLayout: _structLayouts) {
+        structLayouts.push_back(structLayout.get());
+    }
+
+    return structLayouts;
+}
+
+void Ast::removeStructLayout(const StructLayout *structLayout)
+{
+    for (auto it = _structLayouts.begin(); it != _structLayouts.end(); it++) {
+        if (it->get() == structLayout) {
+            _structLayouts.erase(it);
+            return;
+        }
+    }
+}
+
+void Ast::addArena(AstArena::Ptr arena)
+{
+    if (std::find(_arenas.begin(), _arenas.end(), arena) == _arenas.end()) {
+        _arenas.push_back(std::move(arena));
+    }
+}
+
+const AstArena* Ast::getArena() const
+{
+    return _arenas.empty() ? nullptr : _arenas.front().get();
+}
+
+const std::vector<AstArena::Ptr>& Ast::getArenas() const
+{
+    return _arenas;
+}
+
 }
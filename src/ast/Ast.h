@@ -1,9 +1,12 @@
 #pragma once
 
+#include "AstArena.h"
 #include "AstNodes.h"
 #include "FunctionDefinition.h"
 #include "StringTable.h"
+#include "DataSegment.h"
 #include "StructLayout.h"
+#include "Symbol.h"
 #include "../module/Module.h"
 #include "../vm/Callable.h"
 
@@ -25,20 +28,46 @@ public:
     void addFunctionDefinition(vm::Callable::Ptr funcDef);
     void addModule(const module::Module::Ptr module);
     const vm::Callable::Ptr getFunctionDefinition(const std::string &funcName);
+    const vm::Callable::Ptr getFunctionDefinition(SymbolId symbol) const;
     std::vector<vm::Callable::Ptr> getFunctionDefinitions() const;
+    void removeFunctionDefinition(const std::string &funcName);
 
     void addRootStatement(Statement::Ptr statement);
-    std::vector<Statement::Ptr> getRootStatements() const;
+    const std::vector<Statement::Ptr>& getRootStatements() const;
 
     void setStringTable(StringTable::Ptr stringTable);
     const StringTable* getStringTable() const;
+    StringTable* getStringTable();
+
+    void setDataSegment(DataSegment::Ptr dataSegment);
+    const DataSegment* getDataSegment() const;
+    DataSegment* getDataSegment();
 
     void addStructLayout(StructLayout::Ptr structLayout);
+    const StructLayout* getStructLayout(const std::string &name) const;
+    std::vector<const StructLayout*> getStructLayouts() const;
+    void removeStructLayout(const StructLayout *structLayout);
+
+    /**
+     * The arenas holding the nodes of the Ast, if it was built by a
+     * parser. Nodes don't keep their arena alive, so the Ast must own
+     * every arena its nodes were allocated from. getArena() is the arena
+     * of the parser which built the Ast, and null for Asts assembled by
+     * hand.
+     */
+    void addArena(AstArena::Ptr arena);
+    const AstArena* getArena() const;
+    const std::vector<AstArena::Ptr>& getArenas() const;
 
 private:
+    // The arenas must outlive every node, so they are declared first.
+    std::vector<AstArena::Ptr> _arenas;
+
     std::vector<Statement::Ptr> _rootStatements;
     std::map<std::string,vm::Callable::Ptr> _funcDefs;
+    SymbolMap<vm::Callable::Ptr> _funcIndex;
     StringTable::Ptr _stringTable;
+    DataSegment::Ptr _dataSegment;
 
     // Structs are stored in the Ast purely for keeping the objects
     // alive throughout this program's lifecycle.
@@ -0,0 +1,60 @@
+#include "AstArena.h"
+
+
+namespace cish::ast
+{
+
+AstArena::Ptr AstArena::create()
+{
+    return std::make_shared<AstArena>();
+}
+
+AstArena::AstArena():
+    _cursor(nullptr),
+    _end(nullptr),
+    _bytesAllocated(0),
+    _bytesReserved(0)
+{
+}
+
+void* AstArena::allocate(size_t size, size_t alignment)
+{
+    uintptr_t addr = ((uintptr_t)_cursor + alignment - 1) & ~(uintptr_t)(alignment - 1);
+
+    if (_cursor == nullptr || addr + size > (uintptr_t)_end) {
+        if (size + alignment > CHUNK_SIZE / 4) {
+            // Don't waste the rest of the current chunk on a large object
+            uint8_t *chunk = addChunk(size + alignment);
+            addr = ((uintptr_t)chunk + alignment - 1) & ~(uintptr_t)(alignment - 1);
+            _bytesAllocated += size;
+            return (void*)addr;
+        }
+
+        _cursor = addChunk(CHUNK_SIZE);
+        _end = _cursor + CHUNK_SIZE;
+        addr = ((uintptr_t)_cursor + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    }
+
+    _cursor = (uint8_t*)(addr + size);
+    _bytesAllocated += size;
+    return (void*)addr;
+}
+
+size_t AstArena::getBytesAllocated() const
+{
+    return _bytesAllocated;
+}
+
+size_t AstArena::getBytesReserved() const
+{
+    return _bytesReserved;
+}
+
+uint8_t* AstArena::addChunk(size_t size)
+{
+    _chunks.push_back(std::unique_ptr<uint8_t[]>(new uint8_t[size]));
+    _bytesReserved += size;
+    return _chunks.back().get();
+}
+
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <memory>
+#include <vector>
+
+
+namespace cish::ast
+{
+
+/**
+ * Bump allocator for the nodes of a single Ast.
+ *
+ * Nodes are carved out of large chunks in the order they are created, so
+ * the statements of a block and the expressions of a statement end up
+ * next to each other in memory. Nothing is returned to the arena when a
+ * node dies; the chunks are released in one go when the arena is.
+ *
+ * Nodes are still handed out as shared_ptrs, see AstArena::create(). The
+ * allocator stored in the shared state of every node only holds a plain
+ * pointer to the arena, so the arena must outlive its nodes. Parsers hand
+ * their arena to the Ast they build, see Ast::addArena().
+ *
+ * Allocating is not thread safe.
+ */
+class AstArena
+{
+public:
+    typedef std::shared_ptr<AstArena> Ptr;
+
+    static Ptr create();
+    AstArena();
+
+    AstArena(const AstArena&) = delete;
+    AstArena& operator=(const AstArena&) = delete;
+
+    template<typename T, typename... Args>
+    static std::shared_ptr<T> create(const Ptr &arena, Args&&... args);
+
+    void* allocate(size_t size, size_t alignment);
+
+    size_t getBytesAllocated() const;
+    size_t getBytesReserved() const;
+
+private:
+    static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+    std::vector<std::unique_ptr<uint8_t[]>> _chunks;
+    uint8_t *_cursor;
+    uint8_t *_end;
+    size_t _bytesAllocated;
+    size_t _bytesReserved;
+
+    uint8_t* addChunk(size_t size);
+};
+
+
+/**
+ * Standard allocator placing objects in an AstArena, for use with
+ * std::allocate_shared. Deallocation is a no-op.
+ */
+template<typename T>
+class ArenaAllocator
+{
+public:
+    typedef T value_type;
+
+    ArenaAllocator(AstArena *arena): _arena(arena) {}
+
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other): _arena(other._arena) {}
+
+    T* allocate(size_t n)
+    {
+        return static_cast<T*>(_arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T*, size_t) {}
+
+    template<typename U>
+    bool operator==(const ArenaAllocator<U> &other) const { return _arena == other._arena; }
+    template<typename U>
+    bool operator!=(const ArenaAllocator<U> &other) const { return _arena != other._arena; }
+
+private:
+    template<typename U>
+    friend class ArenaAllocator;
+
+    AstArena *_arena;
+};
+
+
+template<typename T, typename... Args>
+std::shared_ptr<T> AstArena::create(const Ptr &arena, Args&&... args)
+{
+    return std::allocate_shared<T>(ArenaAllocator<T>(arena.get()), std::forward<Args>(args)...);
+}
+
+}
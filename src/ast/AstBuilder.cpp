@@ -1,16 +1,14 @@
 #include "AstBuilder.h"
-#include "TreeConverter.h"
-
-#include "antlr/CMBaseVisitor.h"
-#include "AntlrContext.h"
 #include "ParseContext.h"
-
-#include <cassert>
+#include "DeadCodeEliminator.h"
+#include "FunctionInliner.h"
+#include "RedundancyEliminator.h"
+#include "RegisterAllocator.h"
 
 namespace cish::ast
 {
 
-AstBuilder::AstBuilder(const ParseContext::Ptr parseContext, ModuleContext::Ptr moduleContext):
+AstBuilder::AstBuilder(const ParseContext::Ptr parseContext, module::ModuleContext::Ptr moduleContext):
     _parseContext(parseContext),
     _moduleContext(std::move(moduleContext))
 {
@@ -18,26 +16,24 @@ AstBuilder::AstBuilder(const ParseContext::Ptr parseContext, ModuleContext::Ptr
 
 Ast::Ptr AstBuilder::buildAst()
 {
-    // TODO: Propagate these errors out of here in a more reasonable way
     if (_parseContext->hasErrors()) {
-        std::vector<ast::CompilationError> errors = _parseContext->getErrors();
+        ParseContext::throwSyntaxErrors(_parseContext->getErrors());
+    }
 
-        std::stringstream ss;
-        ss << "There are syntax errors:";
+    Ast::Ptr ast = _parseContext->buildAst(std::move(_moduleContext));
 
-        for (auto err: errors) {
-            ss  << std::endl
-                << "Syntax error on line "
-                << err.lineNumber << ", near char "
-                << err.charNumber << ":" << err.message;
-        }
+    DeadCodeEliminator eliminator(ast.get());
+    eliminator.run();
 
-        std::string errorStr = ss.str();
-        Throw(SyntaxErrorException, errorStr.c_str());
-    }
+    RedundancyEliminator redundancyEliminator(ast.get());
+    redundancyEliminator.run();
+
+    FunctionInliner inliner(ast.get());
+    inliner.run();
+
+    RegisterAllocator registerAllocator(ast.get());
+    registerAllocator.run();
 
-    internal::TreeConverter converter(std::move(_moduleContext));
-    Ast::Ptr ast = converter.convertTree(_parseContext.get());
     return ast;
 }
 
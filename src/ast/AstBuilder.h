@@ -9,7 +9,10 @@
 namespace cish::ast
 {
 
-class AntlrContext;
+DECLARE_EXCEPTION(AstNodeNotImplementedException);
+DECLARE_EXCEPTION(AstConversionException);
+DECLARE_EXCEPTION(FunctionNotDefinedException);
+DECLARE_EXCEPTION(ModuleNotFoundException);
 
 class AstBuilder
 {
@@ -6,32 +6,62 @@
 namespace cish::ast
 {
 
+Statement::Statement():
+    _firstCacheSlot(0),
+    _cacheSlotCount(0)
+{
+}
+
 Statement::~Statement()
 {
 }
 
-void Statement::execute(vm::ExecutionContext *context) const
+Completion Statement::execute(vm::ExecutionContext *context) const
 {
-    if (!context->currentFunctionHasReturned()) {
-        _ephemeralVariables.push(std::vector<std::unique_ptr<vm::Variable>>());
+    context->pushEphemeralFrame();
+
+    if (_cacheSlotCount != 0) {
+        context->invalidateCachedValues(_firstCacheSlot, _cacheSlotCount);
+    }
+
+    synchronize(context);
+    const Completion completion = virtualExecute(context);
+    desynchronize(context);
 
-        synchronize(context);
-        virtualExecute(context);
-        desynchronize(context);
+    context->popEphemeralFrame();
+    return completion;
+}
 
-        _ephemeralVariables.pop();
+Completion Statement::resume(vm::ExecutionContext *context, const ResumePath &path, uint32_t level) const
+{
+    context->pushEphemeralFrame();
+
+    if (_cacheSlotCount != 0) {
+        context->invalidateCachedValues(_firstCacheSlot, _cacheSlotCount);
     }
+
+    synchronize(context);
+    const Completion completion = virtualResume(context, path, level);
+    desynchronize(context);
+
+    context->popEphemeralFrame();
+    return completion;
 }
 
-vm::Variable* Statement::allocateEphemeral(vm::ExecutionContext *context, TypeDecl type) const
+bool Statement::getResumeIndex(const Statement*, uint32_t*) const
 {
-    vm::Allocation::Ptr alloc = context->getMemory()->allocate(type.getSize());
+    return false;
+}
 
-    auto var = std::make_unique<vm::Variable>(type, std::move(alloc));
-    auto raw = var.get();
-    _ephemeralVariables.top().push_back(std::move(var));
+void Statement::setCacheSlots(uint32_t first, uint32_t count)
+{
+    _firstCacheSlot = first;
+    _cacheSlotCount = count;
+}
 
-    return raw;
+Completion Statement::virtualResume(vm::ExecutionContext*, const ResumePath&, uint32_t) const
+{
+    Throw(InvalidStatementException, "Execution cannot be resumed inside this statement");
 }
 
 void Statement::synchronize(vm::ExecutionContext *context) const
@@ -44,9 +74,9 @@ void Statement::desynchronize(vm::ExecutionContext *context) const
     context->onStatementExit(this);
 }
 
-void NoOpStatement::virtualExecute(vm::ExecutionContext *context) const
+Completion NoOpStatement::virtualExecute(vm::ExecutionContext*) const
 {
-	Statement::execute(context);
+	return Completion::NORMAL;
 }
 
 }
@@ -3,7 +3,7 @@
 #include <stdint.h>
 #include <functional>
 #include <memory>
-#include <stack>
+#include <vector>
 
 #include "Type.h"
 #include "ExpressionValue.h"
@@ -27,11 +27,52 @@ DECLARE_EXCEPTION(InvalidStatementException);
 DECLARE_EXCEPTION(InvalidOperationException);
 
 
+/**
+ * How the execution of a statement ended. Anything but NORMAL causes the
+ * enclosing blocks to skip their remaining statements and pass it on
+ * until it reaches the statement that handles it: the innermost loop for
+ * BREAK and CONTINUE, and the function definition for RETURN.
+ */
+enum class Completion
+{
+    NORMAL,
+    RETURN,
+    BREAK,
+    CONTINUE,
+};
+
+
+/**
+ * The position of a statement within a function body, given as the index
+ * of the child statement entered at every level of nesting.
+ */
+typedef std::vector<uint32_t> ResumePath;
+
+class Expression;
+
+
 class AstNode {
 public:
     typedef std::shared_ptr<AstNode> Ptr;
+    typedef std::function<void(const AstNode*)> ChildVisitor;
+    typedef std::function<void(std::shared_ptr<Expression>&)> ExpressionRewriter;
 
     virtual ~AstNode() {};
+
+    /**
+     * Call 'visitor' with every node directly below this one, in the
+     * order they are executed. Passes over the finished tree, such as
+     * DeadCodeEliminator, recurse through this.
+     */
+    virtual void forEachChild(const ChildVisitor &visitor) const {}
+
+    /**
+     * Call 'rewriter' with every expression directly below this one that
+     * is evaluated for its value, allowing it to be replaced by another
+     * expression of the same type. Lvalues which are assigned to or whose
+     * address is taken are not passed, as they must remain lvalues.
+     */
+    virtual void rewriteExpressions(const ExpressionRewriter &rewriter) {}
 };
 
 
@@ -40,13 +81,35 @@ class Statement: public AstNode
 public:
     typedef std::shared_ptr<Statement> Ptr;
 
+    Statement();
     virtual ~Statement();
 
-    void execute(vm::ExecutionContext*) const;
-    vm::Variable* allocateEphemeral(vm::ExecutionContext *context, TypeDecl type) const;
+    Completion execute(vm::ExecutionContext*) const;
+
+    /**
+     * Continue an execution which was captured while inside this
+     * statement. The child at 'path[level]' is resumed if the path goes
+     * deeper, otherwise it is executed from the start. The scopes the
+     * statement had pushed must already have been restored.
+     */
+    Completion resume(vm::ExecutionContext*, const ResumePath &path, uint32_t level) const;
+
+    /**
+     * Find the index of a direct child in a ResumePath. Returns false if
+     * the child cannot be resumed at, which is the default.
+     */
+    virtual bool getResumeIndex(const Statement *child, uint32_t *index) const;
+
+    /**
+     * The statement owns the cached values in slots [first, first+count)
+     * of its function frame, and invalidates them whenever it is
+     * executed or resumed. See CachedExpression.
+     */
+    void setCacheSlots(uint32_t first, uint32_t count);
 
 protected:
-    virtual void virtualExecute(vm::ExecutionContext*) const = 0;
+    virtual Completion virtualExecute(vm::ExecutionContext*) const = 0;
+    virtual Completion virtualResume(vm::ExecutionContext*, const ResumePath &path, uint32_t level) const;
 
     /**
      * Synchronize execution with the execution thread. This method
@@ -65,9 +128,8 @@ protected:
     void desynchronize(vm::ExecutionContext *context) const;
 
 private:
-
-    mutable std::stack<std::vector<std::unique_ptr<vm::Variable>>> _ephemeralVariables;
-
+    uint32_t _firstCacheSlot;
+    uint32_t _cacheSlotCount;
 };
 
 class Expression: public AstNode
@@ -78,13 +140,26 @@ public:
     virtual ~Expression() {};
     virtual TypeDecl getType() const = 0;
     virtual ExpressionValue evaluate(vm::ExecutionContext*) const = 0;
+
+    /**
+     * Constant expressions depend on nothing but literals, and may be
+     * evaluated without an ExecutionContext while the tree is built.
+     */
+    virtual bool isConstant() const { return false; }
+
+    /**
+     * Whether 'other' is known to always evaluate to the same value as
+     * this expression when evaluated in the same state. Expressions are
+     * only ever equivalent to others of the same kind.
+     */
+    virtual bool isEquivalent(const Expression *other) const { return false; }
 };
 
 
 class NoOpStatement: public Statement
 {
 public:
-    virtual void virtualExecute(vm::ExecutionContext*) const override;
+    virtual Completion virtualExecute(vm::ExecutionContext*) const override;
 };
 
 }
@@ -105,34 +105,61 @@ ExpressionValue BinaryExpression::evaluate(vm::ExecutionContext *ctx) const
     }
 }
 
+ExpressionValue BinaryExpression::evaluateOperands(const ExpressionValue &left,
+                                                  const ExpressionValue &right) const
+{
+    switch (_workingType.getType()) {
+        case TypeDecl::BOOL:    return evaluateOperandsT<bool>(left, right);
+        case TypeDecl::CHAR:    return evaluateOperandsT<char>(left, right);
+        case TypeDecl::SHORT:   return evaluateOperandsT<short>(left, right);
+        case TypeDecl::INT:     return evaluateOperandsT<int>(left, right);
+        case TypeDecl::LONG:    return evaluateOperandsT<long>(left, right);
+        case TypeDecl::FLOAT:   return evaluateOperandsT<float>(left, right);
+        case TypeDecl::DOUBLE:  return evaluateOperandsT<double>(left, right);
+        case TypeDecl::POINTER: return evaluatePtrOperands(left, right);
+
+        default:
+            Throw(ExpressionTypeException,
+                "Unable to handle type in binary expression '%d'",
+                _workingType.getType());
+    }
+}
+
+bool BinaryExpression::isConstant() const
+{
+    return _left->isConstant() && _right->isConstant();
+}
+
 ExpressionValue BinaryExpression::evaluatePtrT(vm::ExecutionContext *ctx) const
+{
+    const ExpressionValue left = _left->evaluate(ctx);
+    const ExpressionValue right = _right->evaluate(ctx);
+    return evaluatePtrOperands(left, right);
+}
+
+ExpressionValue BinaryExpression::evaluatePtrOperands(const ExpressionValue &left,
+                                                      const ExpressionValue &right) const
 {
     // We're dealing with a few different cases here:
     //  - Comparison between pointers
     //  - Arithmetics performed on pointers
     // In either case, we know that at least one of the expressions is of type
     // pointer, while the other may be integral or a pointer.
-    Expression *ptr, *maybePtr;
-    if (_left->getType().getType() == TypeDecl::POINTER) {
-        ptr = _left.get();
-        maybePtr = _right.get();
-    } else {
-        ptr = _right.get();
-        maybePtr = _left.get();
-    }
+    const bool leftIsPtr = (_left->getType().getType() == TypeDecl::POINTER);
+    const TypeDecl &ptrType = (leftIsPtr ? _left->getType() : _right->getType());
+    const TypeDecl &otherType = (leftIsPtr ? _right->getType() : _left->getType());
 
-    // Evaluate both terms
-    const uint32_t ptrVal = ptr->evaluate(ctx).get<uint32_t>();
-    uint32_t otherVal = maybePtr->evaluate(ctx).get<uint32_t>();
+    const uint32_t ptrVal = (leftIsPtr ? left : right).get<uint32_t>();
+    uint32_t otherVal = (leftIsPtr ? right : left).get<uint32_t>();
 
     // If the other type is not of type pointer, and the operation is arithmetic
     // in nature, we need to multiply the non-pointer operand.
-    if (_operator < Operator::__BOOLEAN_BOUNDARY && maybePtr->getType().getType() != TypeDecl::POINTER) {
+    if (_operator < Operator::__BOOLEAN_BOUNDARY && otherType.getType() != TypeDecl::POINTER) {
         uint32_t sizeContext = 1;
-        if (ptr->getType().getReferencedType()->getType() == TypeDecl::VOID) {
+        if (ptrType.getReferencedType()->getType() == TypeDecl::VOID) {
             sizeContext = 1;
         } else {
-            sizeContext = ptr->getType().getReferencedType()->getSize();
+            sizeContext = ptrType.getReferencedType()->getSize();
         }
         otherVal *= sizeContext;
     }
@@ -141,7 +168,7 @@ ExpressionValue BinaryExpression::evaluatePtrT(vm::ExecutionContext *ctx) const
     // as the pointer-type.
     const uint32_t resultValue = evalPointerOperator(ptrVal, otherVal);
 
-    return ExpressionValue(ptr->getType(), resultValue);
+    return ExpressionValue(ptrType, resultValue);
 }
 
 void BinaryExpression::pointerSpecificChecks()
@@ -222,4 +249,25 @@ uint32_t BinaryExpression::evalPointerOperator(uint32_t a, uint32_t b) const
     throw std::runtime_error("Operator unhandled: " + std::to_string(_operator));
 }
 
+void BinaryExpression::forEachChild(const ChildVisitor &visitor) const
+{
+    visitor(_left.get());
+    visitor(_right.get());
+}
+
+bool BinaryExpression::isEquivalent(const Expression *other) const
+{
+    auto binary = dynamic_cast<const BinaryExpression*>(other);
+    return binary != nullptr
+        && binary->_operator == _operator
+        && _left->isEquivalent(binary->_left.get())
+        && _right->isEquivalent(binary->_right.get());
+}
+
+void BinaryExpression::rewriteExpressions(const ExpressionRewriter &rewriter)
+{
+    rewriter(_left);
+    rewriter(_right);
+}
+
 }
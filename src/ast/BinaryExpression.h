@@ -163,6 +163,17 @@ public:
 
     virtual TypeDecl getType() const override;
     virtual ExpressionValue evaluate(vm::ExecutionContext *ctx) const override;
+    virtual bool isConstant() const override;
+
+    /**
+     * Apply the operator to operands which have already been evaluated,
+     * and are of the types of the left and right expressions. Both
+     * operands are given, so logical operators do not short-circuit.
+     */
+    ExpressionValue evaluateOperands(const ExpressionValue &left, const ExpressionValue &right) const;
+    virtual void forEachChild(const ChildVisitor &visitor) const override;
+    virtual bool isEquivalent(const Expression *other) const override;
+    virtual void rewriteExpressions(const ExpressionRewriter &rewriter) override;
 
 private:
     Operator _operator;
@@ -180,6 +191,13 @@ private:
     ExpressionValue evaluateT(vm::ExecutionContext *ctx) const;
 
     ExpressionValue evaluatePtrT(vm::ExecutionContext *ctx) const;
+    ExpressionValue evaluatePtrOperands(const ExpressionValue &left, const ExpressionValue &right) const;
+
+    template<typename T>
+    ExpressionValue evaluateOperandsT(const ExpressionValue &left, const ExpressionValue &right) const;
+
+    template<typename T>
+    T evalOperator(const T &a, const T &b) const;
 
     template<typename T>
     T evalWithContext(vm::ExecutionContext *ctx) const;
@@ -253,6 +271,56 @@ T BinaryExpression::evalWithContext(vm::ExecutionContext *ctx) const
     throw std::runtime_error("Operator unhandled: " + std::to_string(_operator));
 }
 
+template<typename T>
+ExpressionValue BinaryExpression::evaluateOperandsT(const ExpressionValue &left,
+                                                   const ExpressionValue &right) const
+{
+    const T value = evalOperator<T>(left.get<T>(), right.get<T>());
+
+    if (_operator >= __BOOLEAN_BOUNDARY) {
+        return ExpressionValue(TypeDecl(TypeDecl::Type::BOOL), (bool)value);
+    } else {
+        return ExpressionValue(TypeDecl::getFromNative<T>(), value);
+    }
+}
+
+template<typename T>
+T BinaryExpression::evalOperator(const T &a, const T &b) const
+{
+    switch (_operator) {
+        case MULTIPLY:      return internal::multiply<T>(a, b);
+        case DIVIDE:        return internal::safe_div<T>(a, b);
+        case PLUS:          return internal::plus<T>(a, b);
+        case MINUS:         return internal::minus<T>(a, b);
+        case BITWISE_AND:   return internal::bitwiseAnd<int32_t>(a, b);
+        case BITWISE_XOR:   return internal::bitwiseXor<int32_t>(a, b);
+        case BITWISE_OR:    return internal::bitwiseOr<int32_t>(a, b);
+        case BITWISE_LSHIFT:return internal::lshift<int32_t>(a, b);
+        case BITWISE_RSHIFT:return internal::rshift<int32_t>(a, b);
+        case GT:            return internal::greater<T>(a, b);
+        case LT:            return internal::less<T>(a, b);
+        case GTE:           return internal::greaterEqual<T>(a, b);
+        case LTE:           return internal::lessEqual<T>(a, b);
+        case EQ:            return internal::equalTo<T>(a, b);
+        case NE:            return internal::notEqual<T>(a, b);
+        case LOGICAL_AND:   return internal::logicalAnd<T>(a, b);
+        case LOGICAL_OR:    return internal::logicalOr<T>(a, b);
+
+        case MODULO: break; /* Explicitly handled below */
+    }
+
+    if (_operator == MODULO) {
+        if constexpr (std::is_floating_point<T>()) {
+            // TODO: Make this a VM runtime error
+            throw std::runtime_error("Modulo attempted on floating point number");
+        } else {
+            return internal::safe_mod<T>(a, b);
+        }
+    }
+
+    throw std::runtime_error("Operator unhandled: " + std::to_string(_operator));
+}
+
 
 template<typename T>
 inline T BinaryExpression::op_multiply(vm::ExecutionContext *ctx) const
@@ -0,0 +1,43 @@
+#include "BreakStatement.h"
+
+#include "DeclarationContext.h"
+
+namespace cish::ast
+{
+
+/*
+==============
+BreakStatement
+==============
+*/
+BreakStatement::BreakStatement(DeclarationContext *context)
+{
+    if (!context->isInsideLoop() && !context->isInsideSwitch()) {
+        Throw(InvalidStatementException, "'break' is only allowed inside a loop or switch");
+    }
+}
+
+Completion BreakStatement::virtualExecute(vm::ExecutionContext*) const
+{
+    return Completion::BREAK;
+}
+
+
+/*
+==============
+ContinueStatement
+==============
+*/
+ContinueStatement::ContinueStatement(DeclarationContext *context)
+{
+    if (!context->isInsideLoop()) {
+        Throw(InvalidStatementException, "'continue' is only allowed inside a loop");
+    }
+}
+
+Completion ContinueStatement::virtualExecute(vm::ExecutionContext*) const
+{
+    return Completion::CONTINUE;
+}
+
+}
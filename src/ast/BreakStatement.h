@@ -0,0 +1,29 @@
+#pragma once
+
+#include "AstNodes.h"
+
+namespace cish::ast
+{
+
+class DeclarationContext;
+
+class BreakStatement: public Statement
+{
+public:
+    BreakStatement(DeclarationContext *context);
+
+protected:
+    virtual Completion virtualExecute(vm::ExecutionContext *context) const override;
+};
+
+
+class ContinueStatement: public Statement
+{
+public:
+    ContinueStatement(DeclarationContext *context);
+
+protected:
+    virtual Completion virtualExecute(vm::ExecutionContext *context) const override;
+};
+
+}
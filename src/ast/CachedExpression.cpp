@@ -0,0 +1,52 @@
+#include "CachedExpression.h"
+#include "../vm/ExecutionContext.h"
+
+
+namespace cish::ast
+{
+
+CachedExpression::CachedExpression(Expression::Ptr expression, uint32_t slot):
+    _expression(expression),
+    _slot(slot)
+{
+}
+
+TypeDecl CachedExpression::getType() const
+{
+    return _expression->getType();
+}
+
+ExpressionValue CachedExpression::evaluate(vm::ExecutionContext *context) const
+{
+    const ExpressionValue *cached = context->getCachedValue(_slot);
+    if (cached) {
+        return *cached;
+    }
+
+    ExpressionValue value = _expression->evaluate(context);
+    context->setCachedValue(_slot, value);
+    return value;
+}
+
+bool CachedExpression::isEquivalent(const Expression *other) const
+{
+    auto cached = dynamic_cast<const CachedExpression*>(other);
+    return _expression->isEquivalent(cached ? cached->_expression.get() : other);
+}
+
+void CachedExpression::forEachChild(const ChildVisitor &visitor) const
+{
+    visitor(_expression.get());
+}
+
+void CachedExpression::rewriteExpressions(const ExpressionRewriter &rewriter)
+{
+    rewriter(_expression);
+}
+
+uint32_t CachedExpression::getSlot() const
+{
+    return _slot;
+}
+
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "AstNodes.h"
+
+
+namespace cish::ast
+{
+
+/**
+ * Evaluates the wrapped expression the first time, and returns that
+ * value until the statement owning the cache slot invalidates it. Placed
+ * by the RedundancyEliminator around expressions which are known not to
+ * change for as long as the slot is valid.
+ */
+class CachedExpression: public Expression
+{
+public:
+    CachedExpression(Expression::Ptr expression, uint32_t slot);
+
+    virtual TypeDecl getType() const override;
+    virtual ExpressionValue evaluate(vm::ExecutionContext *context) const override;
+    virtual bool isEquivalent(const Expression *other) const override;
+    virtual void forEachChild(const ChildVisitor &visitor) const override;
+    virtual void rewriteExpressions(const ExpressionRewriter &rewriter) override;
+
+    uint32_t getSlot() const;
+
+private:
+    Expression::Ptr _expression;
+    uint32_t _slot;
+};
+
+}
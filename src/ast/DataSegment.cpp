@@ -0,0 +1,154 @@
+#include "DataSegment.h"
+#include "AstNodes.h"
+
+#include <algorithm>
+#include <cstring>
+
+
+namespace cish::ast
+{
+
+static const uint32_t NO_OFFSET = 0xFFFFFFFF;
+static const uint32_t MAX_ALIGNMENT = 8;
+
+DataSegment::DataSegment():
+    _stringsBegin(-1),
+    _stringsEnd(-1)
+{
+}
+
+uint32_t DataSegment::addObject(const TypeDecl &type)
+{
+    const uint32_t size = type.getSize();
+    return reserve(size, std::min(size, MAX_ALIGNMENT));
+}
+
+uint32_t DataSegment::addObject(const TypeDecl &type, const ExpressionValue &initialValue)
+{
+    const uint32_t offset = addObject(type);
+    uint8_t *dest = _image.data() + offset;
+
+    switch (type.getType()) {
+        case TypeDecl::BOOL: {
+            const bool value = initialValue.get<bool>();
+            memcpy(dest, &value, sizeof(value));
+            break;
+        }
+        case TypeDecl::CHAR: {
+            const char value = initialValue.get<char>();
+            memcpy(dest, &value, sizeof(value));
+            break;
+        }
+        case TypeDecl::SHORT: {
+            const short value = initialValue.get<short>();
+            memcpy(dest, &value, sizeof(value));
+            break;
+        }
+        case TypeDecl::INT: {
+            const int32_t value = initialValue.get<int32_t>();
+            memcpy(dest, &value, sizeof(value));
+            break;
+        }
+        case TypeDecl::LONG: {
+            const int64_t value = initialValue.get<int64_t>();
+            memcpy(dest, &value, sizeof(value));
+            break;
+        }
+        case TypeDecl::FLOAT: {
+            const float value = initialValue.get<float>();
+            memcpy(dest, &value, sizeof(value));
+            break;
+        }
+        case TypeDecl::DOUBLE: {
+            const double value = initialValue.get<double>();
+            memcpy(dest, &value, sizeof(value));
+            break;
+        }
+        case TypeDecl::POINTER: {
+            const uint32_t value = initialValue.get<uint32_t>();
+            memcpy(dest, &value, sizeof(value));
+            break;
+        }
+
+        default:
+            Throw(InvalidTypeException, "Cannot statically initialize object of type '%s'", type.getName());
+    }
+
+    return offset;
+}
+
+void DataSegment::addStrings(const StringTable *stringTable)
+{
+    const std::map<StringId,std::string> &strings = stringTable->getMap();
+    if (strings.empty()) {
+        return;
+    }
+
+    _stringOffsets.resize(std::max<size_t>(_stringOffsets.size(), strings.rbegin()->first + 1), NO_OFFSET);
+
+    if (_stringsBegin < 0) {
+        _stringsBegin = _image.size();
+    }
+
+    for (const auto &pair: strings) {
+        const uint32_t length = pair.second.length() + 1;
+        const uint32_t offset = reserve(length, 1);
+        memcpy(_image.data() + offset, pair.second.c_str(), length);
+        _stringOffsets[pair.first] = offset;
+    }
+
+    _stringsEnd = _image.size();
+}
+
+void DataSegment::replaceStrings(const StringTable *stringTable)
+{
+    if (_stringsBegin >= 0) {
+        if (_stringsEnd != (int64_t)_image.size()) {
+            Throw(Exception, "Cannot replace strings, objects have been added after them");
+        }
+
+        _image.resize(_stringsBegin);
+        _stringOffsets.clear();
+        _stringsBegin = -1;
+        _stringsEnd = -1;
+    }
+
+    addStrings(stringTable);
+}
+
+bool DataSegment::hasString(StringId stringId) const
+{
+    return stringId < _stringOffsets.size() && _stringOffsets[stringId] != NO_OFFSET;
+}
+
+uint32_t DataSegment::getStringOffset(StringId stringId) const
+{
+    if (!hasString(stringId)) {
+        Throw(Exception, "String reference not found: %d", stringId);
+    }
+
+    return _stringOffsets[stringId];
+}
+
+const uint8_t* DataSegment::getData() const
+{
+    return _image.data();
+}
+
+uint32_t DataSegment::getSize() const
+{
+    return _image.size();
+}
+
+uint32_t DataSegment::reserve(uint32_t size, uint32_t alignment)
+{
+    uint32_t offset = _image.size();
+    if (alignment > 1) {
+        offset = (offset + alignment - 1) / alignment * alignment;
+    }
+
+    _image.resize(offset + size, 0);
+    return offset;
+}
+
+}
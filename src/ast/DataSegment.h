@@ -0,0 +1,68 @@
+#pragma once
+
+#include "Type.h"
+#include "ExpressionValue.h"
+#include "StringTable.h"
+
+#include <stdint.h>
+#include <memory>
+#include <vector>
+
+
+namespace cish::ast
+{
+
+/**
+ * The initial contents of all statically allocated data of a program,
+ * i.e. string literals and globals initialized with constants.
+ *
+ * The image is laid out once while the tree is built, and installed into
+ * the memory of a VM with a single allocation and copy, no matter how
+ * many literals and globals it holds. Items are referred to by their
+ * offset from the start of the segment.
+ */
+class DataSegment
+{
+public:
+    typedef std::unique_ptr<DataSegment> Ptr;
+
+    DataSegment();
+
+    /**
+     * Append an object of the given type, either zero-initialized or
+     * holding 'initialValue' converted to the type.
+     */
+    uint32_t addObject(const TypeDecl &type);
+    uint32_t addObject(const TypeDecl &type, const ExpressionValue &initialValue);
+
+    /**
+     * Append every string of the table as a NUL-terminated string.
+     */
+    void addStrings(const StringTable *stringTable);
+
+    /**
+     * Replace the strings added by addStrings() with the strings of
+     * 'stringTable'. Nothing may have been added after the strings.
+     */
+    void replaceStrings(const StringTable *stringTable);
+    bool hasString(StringId stringId) const;
+    uint32_t getStringOffset(StringId stringId) const;
+
+    const uint8_t* getData() const;
+    uint32_t getSize() const;
+
+private:
+    std::vector<uint8_t> _image;
+
+    // Indexed by StringId. Ids are handed out sequentially, so this stays
+    // dense. Unknown ids map to NO_OFFSET.
+    std::vector<uint32_t> _stringOffsets;
+
+    // The range of the image holding the strings, if any were added
+    int64_t _stringsBegin;
+    int64_t _stringsEnd;
+
+    uint32_t reserve(uint32_t size, uint32_t alignment);
+};
+
+}
@@ -0,0 +1,166 @@
+#include "DeadCodeEliminator.h"
+#include "FunctionCallExpression.h"
+#include "FunctionDeclarationStatement.h"
+#include "FunctionDefinition.h"
+#include "StringLiteralExpression.h"
+#include "StructField.h"
+#include "VariableDeclarationStatement.h"
+
+
+namespace cish::ast
+{
+
+DeadCodeEliminator::DeadCodeEliminator(Ast *ast):
+    _ast(ast),
+    _removedFunctions(0),
+    _removedStructs(0),
+    _removedStrings(0)
+{
+}
+
+void DeadCodeEliminator::run()
+{
+    const vm::Callable::Ptr main = _ast->getFunctionDefinition("main");
+    if (!main) {
+        return;
+    }
+
+    for (const Statement::Ptr &statement: _ast->getRootStatements()) {
+        visit(statement.get());
+    }
+
+    reachFunction(main);
+
+    while (!_pendingFunctions.empty()) {
+        const FunctionDefinition *funcDef = _pendingFunctions.back();
+        _pendingFunctions.pop_back();
+        funcDef->forEachChild([this](const AstNode *child) { visit(child); });
+    }
+
+    removeUnreachedFunctions();
+    removeUnusedStructs();
+    removeUnusedStrings();
+}
+
+uint32_t DeadCodeEliminator::getRemovedFunctionCount() const
+{
+    return _removedFunctions;
+}
+
+uint32_t DeadCodeEliminator::getRemovedStructCount() const
+{
+    return _removedStructs;
+}
+
+uint32_t DeadCodeEliminator::getRemovedStringCount() const
+{
+    return _removedStrings;
+}
+
+void DeadCodeEliminator::visit(const AstNode *node)
+{
+    if (auto expr = dynamic_cast<const Expression*>(node)) {
+        useType(expr->getType());
+
+        if (auto call = dynamic_cast<const FunctionCallExpression*>(expr)) {
+            reachFunction(_ast->getFunctionDefinition(call->getFunctionSymbol()));
+        } else if (auto literal = dynamic_cast<const StringLiteralExpression*>(expr)) {
+            _usedStrings.insert(literal->getStringId());
+        }
+    } else if (auto varDecl = dynamic_cast<const VariableDeclarationStatement*>(node)) {
+        useType(varDecl->getDeclaredType());
+    } else if (auto funcDecl = dynamic_cast<const FunctionDeclarationStatement*>(node)) {
+        // Prototypes keep their types alive even if the function is
+        // removed, as they stay among the root statements
+        useType(funcDecl->getDeclaration()->returnType);
+        for (const VarDeclaration &param: funcDecl->getDeclaration()->params) {
+            useType(param.type);
+        }
+    }
+
+    node->forEachChild([this](const AstNode *child) { visit(child); });
+}
+
+void DeadCodeEliminator::reachFunction(const vm::Callable::Ptr &callable)
+{
+    if (!callable || !_reachedFunctions.insert(callable.get()).second) {
+        return;
+    }
+
+    const FuncDeclaration *decl = callable->getDeclaration();
+    useType(decl->returnType);
+    for (const VarDeclaration &param: decl->params) {
+        useType(param.type);
+    }
+
+    // Bodies are visited from run(), so that long call chains don't
+    // recurse once per function
+    if (auto funcDef = dynamic_cast<const FunctionDefinition*>(callable.get())) {
+        _pendingFunctions.push_back(funcDef);
+    }
+}
+
+void DeadCodeEliminator::useType(const TypeDecl &type)
+{
+    if (type == TypeDecl::POINTER) {
+        useType(*type.getReferencedType());
+    } else if (type == TypeDecl::STRUCT) {
+        const StructLayout *structLayout = type.getStructLayout();
+        if (_usedStructs.insert(structLayout).second) {
+            for (const StructField *field: structLayout->getFields()) {
+                useType(field->getType());
+            }
+        }
+    }
+}
+
+void DeadCodeEliminator::removeUnreachedFunctions()
+{
+    for (const vm::Callable::Ptr &callable: _ast->getFunctionDefinitions()) {
+        if (_reachedFunctions.count(callable.get()) == 0) {
+            _ast->removeFunctionDefinition(callable->getDeclaration()->name);
+            _removedFunctions++;
+        }
+    }
+}
+
+void DeadCodeEliminator::removeUnusedStructs()
+{
+    for (const StructLayout *structLayout: _ast->getStructLayouts()) {
+        if (_usedStructs.count(structLayout) == 0) {
+            _ast->removeStructLayout(structLayout);
+            _removedStructs++;
+        }
+    }
+}
+
+void DeadCodeEliminator::removeUnusedStrings()
+{
+    StringTable *stringTable = _ast->getStringTable();
+    if (stringTable == nullptr) {
+        return;
+    }
+
+    std::vector<StringId> unused;
+    for (const auto &pair: stringTable->getMap()) {
+        if (_usedStrings.count(pair.first) == 0) {
+            unused.push_back(pair.first);
+        }
+    }
+
+    if (unused.empty()) {
+        return;
+    }
+
+    for (StringId stringId: unused) {
+        stringTable->remove(stringId);
+    }
+
+    if (_ast->getDataSegment()) {
+        _ast->getDataSegment()->replaceStrings(stringTable);
+    }
+
+    _removedStrings = unused.size();
+}
+
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "Ast.h"
+#include "StringTable.h"
+
+#include <set>
+#include <vector>
+
+
+namespace cish::ast
+{
+
+/**
+ * Removes everything from an Ast that the program can't reach: functions
+ * which are never called from 'main' or the initializers of globals,
+ * including the unused functions of included modules, structs which no
+ * reachable code or global refers to, and string literals only used by
+ * removed functions.
+ *
+ * An Ast without 'main' is left alone, as anything may be called.
+ */
+class DeadCodeEliminator
+{
+public:
+    DeadCodeEliminator(Ast *ast);
+
+    void run();
+
+    uint32_t getRemovedFunctionCount() const;
+    uint32_t getRemovedStructCount() const;
+    uint32_t getRemovedStringCount() const;
+
+private:
+    Ast *_ast;
+
+    std::set<const vm::Callable*> _reachedFunctions;
+    std::vector<const FunctionDefinition*> _pendingFunctions;
+    std::set<const StructLayout*> _usedStructs;
+    std::set<StringId> _usedStrings;
+
+    uint32_t _removedFunctions;
+    uint32_t _removedStructs;
+    uint32_t _removedStrings;
+
+    void visit(const AstNode *node);
+    void reachFunction(const vm::Callable::Ptr &callable);
+    void useType(const TypeDecl &type);
+
+    void removeUnreachedFunctions();
+    void removeUnusedStructs();
+    void removeUnusedStrings();
+};
+
+}
@@ -8,7 +8,12 @@ namespace cish::ast
 {
 
 DeclarationContext::DeclarationContext():
-    _currentFunction(nullptr)
+    _currentFunction(nullptr),
+    _localCount(0),
+    _loopDepth(0),
+    _switchDepth(0),
+    _rootDeclarationCount(0),
+    _visibleRootDeclarations(UINT32_MAX)
 {
     _varScope.push_back(VariableScope());
 }
@@ -18,46 +23,89 @@ void DeclarationContext::declareVariable(TypeDecl type, const std::string &name)
     checkForReservedKeyword(name);
     checkIdentifierLength(name);
 
-    for (const auto &var: _varScope.back()) {
-        if (var.name == name) {
-            Throw(VariableAlreadyDeclaredException,
-                  "Variable '%s' is already declared in the current scope", name.c_str());
+    const SymbolId symbol = Symbol::intern(name);
+    const bool isRoot = (_varScope.size() == 1);
+
+    bool alreadyDeclared = false;
+    if (isRoot) {
+        alreadyDeclared = _rootVariableIndex.contains(symbol);
+    } else {
+        for (const ScopedVariable &var: _varScope.back()) {
+            alreadyDeclared |= (var.symbol == symbol);
         }
     }
 
-    _varScope.back().push_back(VarDeclaration { type, name });
+    if (alreadyDeclared) {
+        Throw(VariableAlreadyDeclaredException,
+              "Variable '%s' is already declared in the current scope", name.c_str());
+    }
+
+    uint32_t localIndex = NOT_LOCAL;
+    if (isRoot) {
+        _rootVariableIndex[symbol] = (uint32_t)_varScope[0].size();
+        _rootVariableOrder.push_back(_rootDeclarationCount++);
+    } else {
+        localIndex = _localCount++;
+    }
+
+    _varScope.back().push_back(ScopedVariable { symbol, VarDeclaration { type, name }, localIndex });
 }
 
 const VarDeclaration* DeclarationContext::getVariableDeclaration(const std::string &name) const
 {
-    for (int i=_varScope.size() - 1; i >= 0; i--) {
-        const VariableScope &scope = _varScope[i];
-        for (int j=0; j<scope.size(); j++) {
-            if (scope[j].name == name) {
-                return &scope[j];
+    const SymbolId symbol = Symbol::find(name);
+    return symbol != 0 ? getVariableDeclaration(symbol) : nullptr;
+}
+
+const VarDeclaration* DeclarationContext::getVariableDeclaration(SymbolId symbol) const
+{
+    for (size_t i=_varScope.size() - 1; i > 0; i--) {
+        for (const ScopedVariable &var: _varScope[i]) {
+            if (var.symbol == symbol) {
+                return &var.decl;
             }
         }
     }
 
+    const uint32_t *index = _rootVariableIndex.find(symbol);
+    if (index && _rootVariableOrder[*index] < _visibleRootDeclarations) {
+        return &_varScope[0][*index].decl;
+    }
+
     return nullptr;
 }
 
+uint32_t DeclarationContext::getLocalIndex(SymbolId symbol) const
+{
+    for (size_t i=_varScope.size() - 1; i > 0; i--) {
+        for (const ScopedVariable &var: _varScope[i]) {
+            if (var.symbol == symbol) {
+                return var.localIndex;
+            }
+        }
+    }
+
+    return NOT_LOCAL;
+}
+
 void DeclarationContext::declareStruct(const StructLayout *structLayout)
 {
     const std::string name = structLayout->getName();
-    if (_structs.count(name) != 0) {
+    const SymbolId symbol = Symbol::intern(name);
+    if (_structs.contains(symbol)) {
         Throw(StructAlreadyDeclaredException,
               "Struct with name '%s' already declared",
               name.c_str());
     }
 
-    _structs[name] = structLayout;
+    _structs[symbol] = DeclaredStruct { structLayout, _rootDeclarationCount++ };
 }
 
 const StructLayout* DeclarationContext::getStruct(const std::string &name) const
 {
-    if (_structs.count(name) != 0) {
-        return _structs.at(name);
+    const DeclaredStruct *declared = _structs.find(Symbol::find(name));
+    if (declared && declared->order < _visibleRootDeclarations) {
+        return declared->layout;
     }
 
     Throw(Exception, "Unable to resolve struct with name '%s'", name.c_str());
@@ -83,6 +131,49 @@ void DeclarationContext::popVariableScope()
     _varScope.pop_back();
 }
 
+bool DeclarationContext::currentScopeHasDeclarations() const
+{
+    return !_varScope.back().empty();
+}
+
+void DeclarationContext::enterLoop()
+{
+    _loopDepth++;
+}
+
+void DeclarationContext::exitLoop()
+{
+    if (_loopDepth == 0) {
+        Throw(InvalidDeclarationScope, "Cannot exit loop when not inside a loop");
+    }
+
+    _loopDepth--;
+}
+
+bool DeclarationContext::isInsideLoop() const
+{
+    return _loopDepth > 0;
+}
+
+void DeclarationContext::enterSwitch()
+{
+    _switchDepth++;
+}
+
+void DeclarationContext::exitSwitch()
+{
+    if (_switchDepth == 0) {
+        Throw(InvalidDeclarationScope, "Cannot exit switch when not inside a switch");
+    }
+
+    _switchDepth--;
+}
+
+bool DeclarationContext::isInsideSwitch() const
+{
+    return _switchDepth > 0;
+}
+
 void DeclarationContext::enterFunction(FunctionDefinition::Ptr funcDef)
 {
     if (_currentFunction) {
@@ -90,6 +181,7 @@ void DeclarationContext::enterFunction(FunctionDefinition::Ptr funcDef)
     }
 
     _currentFunction = funcDef;
+    _localCount = 0;
     _varScope.push_back(VariableScope());
 }
 
@@ -107,6 +199,26 @@ void DeclarationContext::exitFunction()
     _currentFunction = nullptr;
 }
 
+DeclarationContext::Nesting DeclarationContext::getNesting() const
+{
+    return Nesting { _varScope.size(), _loopDepth, _switchDepth, _currentFunction != nullptr };
+}
+
+void DeclarationContext::restoreNesting(const Nesting &nesting)
+{
+    if (nesting.numScopes > _varScope.size()) {
+        Throw(InvalidDeclarationScope, "Cannot restore scopes which have been popped");
+    }
+
+    _varScope.resize(nesting.numScopes);
+    _loopDepth = nesting.loopDepth;
+    _switchDepth = nesting.switchDepth;
+
+    if (!nesting.insideFunction) {
+        _currentFunction = nullptr;
+    }
+}
+
 FunctionDefinition::Ptr DeclarationContext::getCurrentFunction() const
 {
     return _currentFunction;
@@ -121,19 +233,32 @@ void DeclarationContext::declareFunction(FuncDeclaration func)
         checkIdentifierLength(param.name);
     }
 
-    const FuncDeclaration *existing = getFunctionDeclaration(func.name);
+    const SymbolId symbol = Symbol::intern(func.name);
+    DeclaredFunction *existing = _funcs.find(symbol);
     if (existing != nullptr) {
-        verifyIdenticalDeclarations(existing, &func);
+        verifyIdenticalDeclarations(&existing->decl, &func);
+        existing->decl = func;
+    } else {
+        _funcs[symbol] = DeclaredFunction { func, _rootDeclarationCount++ };
     }
-
-    _funcs[func.name] = func;
 }
 
 const FuncDeclaration* DeclarationContext::getFunctionDeclaration(const std::string &name) const
 {
-    if (_funcs.count(name) == 0)
+    const DeclaredFunction *declared = _funcs.find(Symbol::find(name));
+    if (!declared || declared->order >= _visibleRootDeclarations)
         return nullptr;
-    return &_funcs.at(name);
+    return &declared->decl;
+}
+
+uint32_t DeclarationContext::getRootDeclarationCount() const
+{
+    return _rootDeclarationCount;
+}
+
+void DeclarationContext::setVisibleRootDeclarations(uint32_t count)
+{
+    _visibleRootDeclarations = count;
 }
 
 void DeclarationContext::verifyIdenticalDeclarations(const FuncDeclaration *existing, const FuncDeclaration *redecl)
@@ -10,6 +10,7 @@
 #include "FuncDeclaration.h"
 #include "FunctionDefinition.h"
 #include "StructLayout.h"
+#include "Symbol.h"
 
 
 namespace cish::ast
@@ -40,6 +41,14 @@ public:
     // after the next call to 'popVariableScope', so take a copy if
     // you want to keep any of the values.
     const VarDeclaration* getVariableDeclaration(const std::string &name) const;
+    const VarDeclaration* getVariableDeclaration(SymbolId symbol) const;
+
+    // The locals of a function, its parameters included, are numbered in
+    // the order they are declared, so that a variable can be told apart
+    // from the other variables of the same name. Globals and undeclared
+    // variables are NOT_LOCAL.
+    static constexpr uint32_t NOT_LOCAL = UINT32_MAX;
+    uint32_t getLocalIndex(SymbolId symbol) const;
 
     // The DeclarationContext takes ownership of the StructLayout.
     void declareStruct(const StructLayout *structLayout);
@@ -48,21 +57,84 @@ public:
     void pushVariableScope();
     void popVariableScope();
 
+    // Whether any variables have been declared in the innermost scope.
+    // Blocks which declare nothing can execute without a runtime scope.
+    bool currentScopeHasDeclarations() const;
+
+    // Loops and switches are tracked so that 'break' and 'continue' can
+    // be rejected when they have nothing to jump out of.
+    void enterLoop();
+    void exitLoop();
+    bool isInsideLoop() const;
+
+    void enterSwitch();
+    void exitSwitch();
+    bool isInsideSwitch() const;
+
     void enterFunction(FunctionDefinition::Ptr funcDef);
     void exitFunction();
     FunctionDefinition::Ptr getCurrentFunction() const;
 
+    // How deeply scopes, loops and switches are nested. A parser which
+    // skips past a statement it failed to parse restores the nesting from
+    // before the statement, as the statement never left what it entered.
+    struct Nesting
+    {
+        size_t numScopes;
+        int loopDepth;
+        int switchDepth;
+        bool insideFunction;
+    };
+
+    Nesting getNesting() const;
+    void restoreNesting(const Nesting &nesting);
+
     void declareFunction(FuncDeclaration decl);
     const FuncDeclaration* getFunctionDeclaration(const std::string &name) const;
 
+    // Root level variables, structs and functions are numbered in the
+    // order they are declared. Hiding all but the first 'count' of them
+    // lets a copy of the complete context resolve names like the context
+    // did at the time it had made only 'count' declarations.
+    uint32_t getRootDeclarationCount() const;
+    void setVisibleRootDeclarations(uint32_t count);
+
 private:
-    typedef std::vector<VarDeclaration> VariableScope;
+    struct ScopedVariable
+    {
+        SymbolId symbol;
+        VarDeclaration decl;
+        uint32_t localIndex;
+    };
+
+    struct DeclaredFunction
+    {
+        FuncDeclaration decl;
+        uint32_t order;
+    };
+
+    struct DeclaredStruct
+    {
+        const StructLayout *layout;
+        uint32_t order;
+    };
+
+    // Function scopes are small and searched linearly, the root scope
+    // is also indexed by symbol as it holds every global.
+    typedef std::vector<ScopedVariable> VariableScope;
     std::vector<VariableScope> _varScope;
-    FunctionDefinition::Ptr _currentFunction;
-    std::map<std::string, FuncDeclaration> _funcs;
-    std::map<std::string, const StructLayout*> _structs;
+    SymbolMap<uint32_t> _rootVariableIndex;
 
-    VarDeclaration* findInScope(const std::string &name, VariableScope *scope);
+    FunctionDefinition::Ptr _currentFunction;
+    uint32_t _localCount;
+    int _loopDepth;
+    int _switchDepth;
+    SymbolMap<DeclaredFunction> _funcs;
+    SymbolMap<DeclaredStruct> _structs;
+
+    uint32_t _rootDeclarationCount;
+    uint32_t _visibleRootDeclarations;
+    std::vector<uint32_t> _rootVariableOrder;
     void verifyIdenticalDeclarations(const FuncDeclaration *existing, const FuncDeclaration *redecl);
     void checkForReservedKeyword(const std::string &identifier) const;
     void checkIdentifierLength(const std::string &identifier) const;
@@ -6,9 +6,26 @@
 namespace cish::ast
 {
 
-void ElseStatement::virtualExecute(vm::ExecutionContext *context) const
+Completion ElseStatement::virtualExecute(vm::ExecutionContext *context) const
 {
-	executeChildStatements(context);
+	if (!requiresScope()) {
+		return executeChildStatements(context);
+	}
+
+	context->pushScope();
+	const Completion completion = executeChildStatements(context);
+	context->popScope();
+	return completion;
+}
+
+Completion ElseStatement::virtualResume(vm::ExecutionContext *context, const ResumePath &path, uint32_t level) const
+{
+	const Completion completion = resumeChildStatements(context, path, level);
+	if (requiresScope()) {
+		context->popScope();
+	}
+
+	return completion;
 }
 
 }
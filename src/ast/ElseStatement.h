@@ -12,7 +12,8 @@ public:
     typedef std::shared_ptr<ElseStatement> Ptr;
 
 protected:
-	void virtualExecute(vm::ExecutionContext *context) const override;
+	Completion virtualExecute(vm::ExecutionContext *context) const override;
+	Completion virtualResume(vm::ExecutionContext *context, const ResumePath &path, uint32_t level) const override;
 };
 
 }
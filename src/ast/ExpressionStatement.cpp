@@ -9,9 +9,20 @@ ExpressionStatement::ExpressionStatement(Expression::Ptr expression):
     _expression(expression)
 { }
 
-void ExpressionStatement::virtualExecute(vm::ExecutionContext *context) const
+Completion ExpressionStatement::virtualExecute(vm::ExecutionContext *context) const
 {
     _expression->evaluate(context);
+    return Completion::NORMAL;
+}
+
+void ExpressionStatement::forEachChild(const ChildVisitor &visitor) const
+{
+    visitor(_expression.get());
+}
+
+void ExpressionStatement::rewriteExpressions(const ExpressionRewriter &rewriter)
+{
+    rewriter(_expression);
 }
 
 }
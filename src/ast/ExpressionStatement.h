@@ -10,9 +10,11 @@ class ExpressionStatement: public Statement
 {
 public:
     ExpressionStatement(Expression::Ptr expression);
+    void forEachChild(const ChildVisitor &visitor) const override;
+    void rewriteExpressions(const ExpressionRewriter &rewriter) override;
 
 protected:
-    void virtualExecute(vm::ExecutionContext *ctx) const override;
+    Completion virtualExecute(vm::ExecutionContext *ctx) const override;
 
 private:
     Expression::Ptr _expression;
@@ -11,10 +11,11 @@ namespace cish::ast
 
 ExpressionValue::ExpressionValue(const std::string& rawValue)
 {
-    const std::regex exprInt("[-]?[0-9]+");
-    const std::regex exprHex("0[xX][0-9a-fA-F]+");
-    const std::regex exprFloat("[-]?(\\.[0-9]+|[0-9]+(\\.[0-9]*)?)[fF]?");
-    const std::regex exprChar("'(\\\\.|[^'\\\\])'");
+    // Compiling the expressions costs far more than matching them
+    static const std::regex exprInt("[-]?[0-9]+");
+    static const std::regex exprHex("0[xX][0-9a-fA-F]+");
+    static const std::regex exprFloat("[-]?(\\.[0-9]+|[0-9]+(\\.[0-9]*)?)[fF]?");
+    static const std::regex exprChar("'(\\\\.|[^'\\\\])'");
 
     memset(&_value, 0, sizeof(_value));
 
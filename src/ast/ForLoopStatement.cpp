@@ -14,25 +14,65 @@ ForLoopStatement::ForLoopStatement(Statement::Ptr init, Expression::Ptr cond, St
 
 }
 
-void ForLoopStatement::virtualExecute(vm::ExecutionContext *context) const
+const Statement* ForLoopStatement::getInitialization() const
 {
-    context->pushScope();
+    return _initialization.get();
+}
+
+Completion ForLoopStatement::virtualExecute(vm::ExecutionContext *context) const
+{
+    if (requiresScope()) {
+        context->pushScope();
+    }
+
     if (_initialization) {
         _initialization->execute(context);
     }
 
+    const Completion completion = runLoop(context);
+
+    if (requiresScope()) {
+        context->popScope();
+    }
+
+    return completion;
+}
+
+Completion ForLoopStatement::virtualResume(vm::ExecutionContext *context, const ResumePath &path, uint32_t level) const
+{
+    // Finish the iteration which was captured, then carry on as usual
+    Completion completion = resumeChildStatements(context, path, level);
+    if (completion != Completion::BREAK && completion != Completion::RETURN) {
+        synchronize(context);
+        if (_iterator) {
+            _iterator->execute(context);
+        }
+        completion = runLoop(context);
+    }
+
+    if (requiresScope()) {
+        context->popScope();
+    }
+
+    return completion == Completion::RETURN ? Completion::RETURN : Completion::NORMAL;
+}
+
+Completion ForLoopStatement::runLoop(vm::ExecutionContext *context) const
+{
+    Completion completion = Completion::NORMAL;
     while (evaluateCondition(context)) {
-        executeChildStatements(context);
-        if (context->currentFunctionHasReturned())
+        completion = executeChildStatements(context);
+        if (completion == Completion::BREAK || completion == Completion::RETURN)
             break;
 
+        // CONTINUE falls through to the iterator, like in C
         synchronize(context);
         if (_iterator) {
             _iterator->execute(context);
         }
     }
 
-    context->popScope();
+    return completion == Completion::RETURN ? Completion::RETURN : Completion::NORMAL;
 }
 
 
@@ -43,4 +83,28 @@ bool ForLoopStatement::evaluateCondition(vm::ExecutionContext *context) const
     return _condition->evaluate(context).get<bool>();
 }
 
+void ForLoopStatement::forEachChild(const ChildVisitor &visitor) const
+{
+    if (_initialization) {
+        visitor(_initialization.get());
+    }
+
+    if (_condition) {
+        visitor(_condition.get());
+    }
+
+    if (_iterator) {
+        visitor(_iterator.get());
+    }
+
+    SuperStatement::forEachChild(visitor);
+}
+
+void ForLoopStatement::rewriteExpressions(const ExpressionRewriter &rewriter)
+{
+    if (_condition) {
+        rewriter(_condition);
+    }
+}
+
 }
@@ -15,12 +15,17 @@ public:
     ForLoopStatement(Statement::Ptr init,
                      Expression::Ptr condition,
                      Statement::Ptr iter);
+    const Statement* getInitialization() const;
+    void forEachChild(const ChildVisitor &visitor) const override;
+    void rewriteExpressions(const ExpressionRewriter &rewriter) override;
 
 protected:
-    void virtualExecute(vm::ExecutionContext *context) const override;
+    Completion virtualExecute(vm::ExecutionContext *context) const override;
+    Completion virtualResume(vm::ExecutionContext *context, const ResumePath &path, uint32_t level) const override;
 
 private:
     bool evaluateCondition(vm::ExecutionContext *context) const;
+    Completion runLoop(vm::ExecutionContext *context) const;
 
     Statement::Ptr _initialization;
     Expression::Ptr _condition;
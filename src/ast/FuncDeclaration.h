@@ -11,21 +11,45 @@ namespace cish::ast
 
 struct FuncDeclaration
 {
+    /**
+     * What a call to the function may do besides returning a value, from
+     * least to most. Functions defined by the program are always ANY,
+     * modules may declare their functions to be more restricted.
+     */
+    enum Effects
+    {
+        // Depends on nothing but the parameters, like GCC's 'const'
+        CONST,
+
+        // May also read memory, like GCC's 'pure'
+        PURE,
+
+        // May also have effects outside of the program, like writing to
+        // stdout, but writes no memory of the program
+        IO,
+
+        // May do anything
+        ANY,
+    };
+
     FuncDeclaration()
     {
         // backwards compatible default-value
         varargs = false;
+        effects = ANY;
     }
 
     FuncDeclaration(TypeDecl type,
                     std::string name,
                     std::vector<VarDeclaration> params = {},
-                    bool varargs = false)
+                    bool varargs = false,
+                    Effects effects = ANY)
     {
         this->returnType = type;
         this->name = name;
         this->params = params;
         this->varargs = varargs;
+        this->effects = effects;
     }
 
     TypeDecl returnType;
@@ -41,6 +65,8 @@ struct FuncDeclaration
     // be called with zero parameters, but it can be called with more
     // than one.
     bool varargs;
+
+    Effects effects;
 };
 
 }
@@ -8,7 +8,9 @@ namespace cish::ast
 FunctionCallExpression::FunctionCallExpression(DeclarationContext *context,
                                                const std::string &funName,
                                                std::vector<Expression::Ptr> params):
-    _params(params)
+    _params(params),
+    _funcSymbol(Symbol::intern(funName)),
+    _inlineBody(nullptr)
 {
     // First off, make sure that the function is actually declared
     const FuncDeclaration *decl = context->getFunctionDeclaration(funName);
@@ -29,22 +31,48 @@ TypeDecl FunctionCallExpression::getType() const
 
 ExpressionValue FunctionCallExpression::evaluate(vm::ExecutionContext *context) const
 {
-    const vm::Callable::Ptr funcDef = context->getFunctionDefinition(_funcDecl.name);
-
-    std::vector<ExpressionValue> params;
-    for (const Expression::Ptr& expr: _params) {
-        params.push_back(expr->evaluate(context));
+    // Calls from the initializers of globals have no frame to borrow
+    if (_inlineTarget && context->getCallDepth() != 0) {
+        return _inlineTarget->executeInline(context, _params, _inlineBody);
     }
 
     vm::Variable *returnBuffer = nullptr;
     if (_funcDecl.returnType == TypeDecl::STRUCT) {
-        const Statement *statement = context->getCurrentStatement();
-        returnBuffer = statement->allocateEphemeral(context, _funcDecl.returnType);
+        returnBuffer = context->allocateEphemeral(_funcDecl.returnType);
+    }
+
+    return evaluateInto(context, returnBuffer);
+}
+
+ExpressionValue FunctionCallExpression::evaluateInto(vm::ExecutionContext *context, vm::Variable *returnBuffer) const
+{
+    const vm::Callable::Ptr funcDef = context->getFunctionDefinition(_funcSymbol);
+
+    std::vector<ExpressionValue> params;
+    params.reserve(_params.size());
+    for (const Expression::Ptr& expr: _params) {
+        params.push_back(expr->evaluate(context));
     }
 
     return funcDef->execute(context, params, returnBuffer);
 }
 
+SymbolId FunctionCallExpression::getFunctionSymbol() const
+{
+    return _funcSymbol;
+}
+
+void FunctionCallExpression::inlineCall(std::shared_ptr<const FunctionDefinition> funcDef, const Expression *body)
+{
+    _inlineTarget = std::move(funcDef);
+    _inlineBody = body;
+}
+
+bool FunctionCallExpression::isInlined() const
+{
+    return _inlineTarget != nullptr;
+}
+
 void FunctionCallExpression::verifyParameterTypes()
 {
     if (!_funcDecl.varargs) {
@@ -72,4 +100,40 @@ void FunctionCallExpression::verifyParameterTypes()
     }
 }
 
+void FunctionCallExpression::forEachChild(const ChildVisitor &visitor) const
+{
+    for (const auto &param: _params) {
+        visitor(param.get());
+    }
+}
+
+bool FunctionCallExpression::isEquivalent(const Expression *other) const
+{
+    // Only calls which depend on nothing but memory and their parameters
+    // give the same result every time
+    auto call = dynamic_cast<const FunctionCallExpression*>(other);
+    if (call == nullptr || call->_funcSymbol != _funcSymbol || _funcDecl.effects > FuncDeclaration::PURE) {
+        return false;
+    }
+
+    if (call->_params.size() != _params.size()) {
+        return false;
+    }
+
+    for (size_t i=0; i<_params.size(); i++) {
+        if (!_params[i]->isEquivalent(call->_params[i].get())) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void FunctionCallExpression::rewriteExpressions(const ExpressionRewriter &rewriter)
+{
+    for (Expression::Ptr &param: _params) {
+        rewriter(param);
+    }
+}
+
 }
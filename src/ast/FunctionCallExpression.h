@@ -12,6 +12,8 @@ DECLARE_EXCEPTION(FunctionNotDeclaredException);
 DECLARE_EXCEPTION(InvalidParameterException);
 
 
+class FunctionDefinition;
+
 class FunctionCallExpression: public Expression
 {
 public:
@@ -21,12 +23,36 @@ public:
 
     virtual TypeDecl getType() const override;
     virtual ExpressionValue evaluate(vm::ExecutionContext*) const override;
+    SymbolId getFunctionSymbol() const;
+
+    /**
+     * Evaluate a call to a function returning a struct, which returns it
+     * straight into 'returnBuffer' rather than into an ephemeral variable.
+     */
+    ExpressionValue evaluateInto(vm::ExecutionContext *context, vm::Variable *returnBuffer) const;
+
+    /**
+     * Evaluate the call by evaluating 'body', the expression returned by
+     * 'funcDef', in place. See FunctionInliner.
+     */
+    void inlineCall(std::shared_ptr<const FunctionDefinition> funcDef, const Expression *body);
+    bool isInlined() const;
+
+    virtual void forEachChild(const ChildVisitor &visitor) const override;
+
+    virtual bool isEquivalent(const Expression *other) const override;
+
+    virtual void rewriteExpressions(const ExpressionRewriter &rewriter) override;
 
 private:
     void verifyParameterTypes();
 
     FuncDeclaration _funcDecl;
     std::vector<Expression::Ptr> _params;
+    SymbolId _funcSymbol;
+
+    std::shared_ptr<const FunctionDefinition> _inlineTarget;
+    const Expression *_inlineBody;
 };
 
 }
@@ -11,8 +11,14 @@ FunctionDeclarationStatement::FunctionDeclarationStatement(DeclarationContext *c
     context->declareFunction(_decl);
 }
 
-void FunctionDeclarationStatement::virtualExecute(vm::ExecutionContext *context) const
+const FuncDeclaration* FunctionDeclarationStatement::getDeclaration() const
 {
+    return &_decl;
+}
+
+Completion FunctionDeclarationStatement::virtualExecute(vm::ExecutionContext*) const
+{
+    return Completion::NORMAL;
 }
 
 }
@@ -11,8 +11,10 @@ class FunctionDeclarationStatement: public Statement
 public:
     FunctionDeclarationStatement(DeclarationContext *context, FuncDeclaration decl);
 
+    const FuncDeclaration* getDeclaration() const;
+
 protected:
-    virtual void virtualExecute(vm::ExecutionContext*) const override;
+    virtual Completion virtualExecute(vm::ExecutionContext*) const override;
 
 private:
     FuncDeclaration _decl;
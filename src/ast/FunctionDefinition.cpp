@@ -2,17 +2,26 @@
 
 #include "DeclarationContext.h"
 #include "FunctionCallExpression.h"
+#include "Lvalue.h"
 
 #include "../vm/ExecutionContext.h"
 
+#include <optional>
+
 namespace cish::ast
 {
 
 FunctionDefinition::FunctionDefinition(DeclarationContext *context,
                                        FuncDeclaration decl):
-    _decl(decl)
+    _decl(decl),
+    _paramRegisters(decl.params.size(), VariableReference::NO_REGISTER),
+    _registerCount(0)
 {
     context->declareFunction(decl);
+
+    for (const VarDeclaration &param: _decl.params) {
+        _paramSymbols.push_back(param.name.empty() ? 0 : Symbol::intern(param.name));
+    }
 }
 
 const FuncDeclaration* FunctionDefinition::getDeclaration() const
@@ -35,10 +44,9 @@ ExpressionValue FunctionDefinition::execute(vm::ExecutionContext *context,
         Throw(Exception, "No returnbuffer given to function with return-type '%s'", _decl.returnType.getName());
     }
 
-    context->pushFunctionFrame();
+    context->pushFunctionFrame(&_decl.name);
     context->setFunctionReturnBuffer(returnBuffer);
-    vm::Memory *memory = context->getMemory();
-    vm::Scope *scope = context->getScope();
+    context->allocateRegisters(_registerCount);
 
     for (int i=0; i<params.size(); i++) {
         if (!params[i].getIntrinsicType().castableTo(_decl.params[i].type)) {
@@ -50,11 +58,7 @@ ExpressionValue FunctionDefinition::execute(vm::ExecutionContext *context,
                 _decl.params[i].type.getName());
         }
 
-        const std::string varName = _decl.params[i].name;
-        if (varName != "") {
-            vm::Variable *var = convertToVariable(memory, _decl.params[i].type, params[i]);
-            scope->addVariable(varName, var);
-        }
+        bindParam(context, i, params[i]);
     }
 
     executeChildStatements(context);
@@ -64,56 +68,136 @@ ExpressionValue FunctionDefinition::execute(vm::ExecutionContext *context,
     return retVal;
 }
 
-void FunctionDefinition::virtualExecute(vm::ExecutionContext*) const
+ExpressionValue FunctionDefinition::resume(vm::ExecutionContext *context, const ResumePath &path) const
+{
+    synchronize(context);
+
+    if (path.empty()) {
+        executeChildStatements(context);
+    } else {
+        resumeChildStatements(context, path, 0);
+    }
+
+    ExpressionValue retVal = context->getCurrentFunctionReturnValue();
+    context->popFunctionFrame();
+    desynchronize(context);
+    return retVal;
+}
+
+ExpressionValue FunctionDefinition::executeInline(vm::ExecutionContext *context,
+                                                  const std::vector<Expression::Ptr> &args,
+                                                  const Expression *body) const
+{
+    if (args.size() != _decl.params.size() || args.size() > MAX_INLINE_PARAMS) {
+        Throw(InvalidParameterException, "Function '%s' cannot be inlined with %d params",
+                _decl.name.c_str(), args.size());
+    }
+
+    // The arguments must be evaluated before the parameters are in scope
+    std::optional<ExpressionValue> values[MAX_INLINE_PARAMS];
+    for (size_t i=0; i<args.size(); i++) {
+        values[i] = args[i]->evaluate(context);
+    }
+
+    context->pushInlineScope();
+    const uint32_t callerRegisterBase = context->pushRegisterWindow(_registerCount);
+
+    for (size_t i=0; i<args.size(); i++) {
+        bindParam(context, i, *values[i]);
+    }
+
+    ExpressionValue retVal = body->evaluate(context);
+    context->popRegisterWindow(callerRegisterBase);
+    context->popScope();
+    return retVal;
+}
+
+void FunctionDefinition::setRegisters(uint32_t registerCount, const std::vector<uint32_t> &paramRegisters)
+{
+    if (paramRegisters.size() != _decl.params.size()) {
+        Throw(InvalidParameterException, "Function '%s' has %d params, got %d registers",
+                _decl.name.c_str(), _decl.params.size(), paramRegisters.size());
+    }
+
+    _registerCount = registerCount;
+    _paramRegisters = paramRegisters;
+}
+
+uint32_t FunctionDefinition::getRegisterCount() const
+{
+    return _registerCount;
+}
+
+Completion FunctionDefinition::virtualExecute(vm::ExecutionContext*) const
 {
     Throw(Exception, "FunctionDefinition::virtualExecute should never be called");
 }
 
-vm::Variable* FunctionDefinition::convertToVariable(vm::Memory *memory,
-                                                    const TypeDecl &targetType,
-                                                    const ExpressionValue &sourceValue) const
+void FunctionDefinition::bindParam(vm::ExecutionContext *context, size_t index, const ExpressionValue &value) const
+{
+    if (_paramSymbols[index] == 0) {
+        return;
+    }
+
+    if (_paramRegisters[index] != VariableReference::NO_REGISTER) {
+        vm::MemoryView view = context->getRegisterView(_paramRegisters[index]);
+        convertInto(context->getMemory(), &view, _decl.params[index].type, value);
+    } else {
+        vm::Allocation::Ptr alloc = convertToAllocation(context->getMemory(), _decl.params[index].type, value);
+        context->getScope()->addVariable(_paramSymbols[index], value.getIntrinsicType(), std::move(alloc));
+    }
+}
+
+vm::Allocation::Ptr FunctionDefinition::convertToAllocation(vm::Memory *memory,
+                                                           const TypeDecl &targetType,
+                                                           const ExpressionValue &sourceValue) const
 {
-    TypeDecl sourceType = sourceValue.getIntrinsicType();
     vm::Allocation::Ptr alloc = memory->allocate(targetType.getSize());
+    convertInto(memory, alloc.get(), targetType, sourceValue);
+    return alloc;
+}
 
+void FunctionDefinition::convertInto(vm::Memory *memory,
+                                     vm::MemoryView *target,
+                                     const TypeDecl &targetType,
+                                     const ExpressionValue &sourceValue) const
+{
     switch (targetType.getType()) {
         case TypeDecl::BOOL:
-            alloc->write<bool>(sourceValue.get<bool>());
+            target->write<bool>(sourceValue.get<bool>());
             break;
         case TypeDecl::CHAR:
-            alloc->write<char>(sourceValue.get<char>());
+            target->write<char>(sourceValue.get<char>());
             break;
         case TypeDecl::SHORT:
-            alloc->write<short>(sourceValue.get<short>());
+            target->write<short>(sourceValue.get<short>());
             break;
         case TypeDecl::INT:
-            alloc->write<int>(sourceValue.get<int>());
+            target->write<int>(sourceValue.get<int>());
             break;
         case TypeDecl::LONG:
-            alloc->write<long>(sourceValue.get<long>());
+            target->write<long>(sourceValue.get<long>());
             break;
         case TypeDecl::FLOAT:
-            alloc->write<float>(sourceValue.get<float>());
+            target->write<float>(sourceValue.get<float>());
             break;
         case TypeDecl::DOUBLE:
-            alloc->write<double>(sourceValue.get<double>());
+            target->write<double>(sourceValue.get<double>());
             break;
         case TypeDecl::POINTER:
-            alloc->write<uint32_t>(sourceValue.get<uint32_t>());
+            target->write<uint32_t>(sourceValue.get<uint32_t>());
             break;
         case TypeDecl::STRUCT:
-            copyStruct(memory, alloc.get(), targetType, sourceValue);
+            copyStruct(memory, target, targetType, sourceValue);
             break;
         default:
             Throw(InvalidTypeException, "Unable to allocate variable of type '%s' for function '%s'",
                     targetType.getName(), _decl.name.c_str());
     }
-
-    return new vm::Variable(sourceType, std::move(alloc));
 }
 
 void FunctionDefinition::copyStruct(vm::Memory *memory,
-                                    vm::Allocation *target,
+                                    vm::MemoryView *target,
                                     const TypeDecl &targetType,
                                     const ExpressionValue &sourceValue) const
 {
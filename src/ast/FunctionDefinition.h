@@ -2,14 +2,15 @@
 
 #include "AstNodes.h"
 #include "SuperStatement.h"
+#include "Symbol.h"
 #include "../vm/Callable.h"
+#include "../vm/Allocation.h"
 
 
 namespace cish::vm
 {
 class Memory;
 class Variable;
-class Allocation;
 }
 
 namespace cish::ast
@@ -21,6 +22,8 @@ class FunctionDefinition: public SuperStatement, public vm::Callable
 public:
     typedef std::shared_ptr<FunctionDefinition> Ptr;
 
+    static const uint32_t MAX_INLINE_PARAMS = 8;
+
     FunctionDefinition(DeclarationContext *context, FuncDeclaration decl);
     virtual ~FunctionDefinition() = default;
 
@@ -30,14 +33,45 @@ public:
                             const std::vector<ExpressionValue>& params,
                             vm::Variable *returnBuffer) const override;
 
+    /**
+     * Continue an execution of the function which was captured at 'path'.
+     * The function frame and its scopes must already have been restored.
+     */
+    ExpressionValue resume(vm::ExecutionContext *context, const ResumePath &path) const;
+
+    /**
+     * Evaluate a call to the function in place: 'args' are evaluated in
+     * the caller's scope and bound to the parameters in a fresh scope,
+     * in which 'body', the expression the function returns, is then
+     * evaluated. No frame is pushed, so this is only valid for functions
+     * consisting of a single return statement, see FunctionInliner.
+     */
+    ExpressionValue executeInline(vm::ExecutionContext *context,
+                                  const std::vector<Expression::Ptr> &args,
+                                  const Expression *body) const;
+
+    /**
+     * Reserve 'registerCount' registers in the frame of every call, and
+     * keep the parameters in the registers given in 'paramRegisters',
+     * see RegisterAllocator. Parameters whose register is
+     * VariableReference::NO_REGISTER are allocated in memory.
+     */
+    void setRegisters(uint32_t registerCount, const std::vector<uint32_t> &paramRegisters);
+    uint32_t getRegisterCount() const;
+
 protected:
-    void virtualExecute(vm::ExecutionContext*) const override;
+    Completion virtualExecute(vm::ExecutionContext*) const override;
 
 private:
-    vm::Variable* convertToVariable(vm::Memory *memory, const TypeDecl &targetType, const ExpressionValue &sourceValue) const;
-    void copyStruct(vm::Memory *memory, vm::Allocation *target, const TypeDecl &targetType, const ExpressionValue &sourceValue) const;
+    vm::Allocation::Ptr convertToAllocation(vm::Memory *memory, const TypeDecl &targetType, const ExpressionValue &sourceValue) const;
+    void convertInto(vm::Memory *memory, vm::MemoryView *target, const TypeDecl &targetType, const ExpressionValue &sourceValue) const;
+    void copyStruct(vm::Memory *memory, vm::MemoryView *target, const TypeDecl &targetType, const ExpressionValue &sourceValue) const;
+    void bindParam(vm::ExecutionContext *context, size_t index, const ExpressionValue &value) const;
 
     FuncDeclaration _decl;
+    std::vector<SymbolId> _paramSymbols;
+    std::vector<uint32_t> _paramRegisters;
+    uint32_t _registerCount;
 };
 
 }
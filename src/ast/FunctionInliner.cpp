@@ -0,0 +1,135 @@
+#include "FunctionInliner.h"
+#include "CachedExpression.h"
+#include "FunctionCallExpression.h"
+#include "FunctionDefinition.h"
+#include "ReturnStatement.h"
+
+
+namespace cish::ast
+{
+
+static bool isPassedByValue(const TypeDecl &type)
+{
+    return type == TypeDecl::STRUCT;
+}
+
+static const Expression* getReturnedExpression(const FunctionDefinition *funcDef)
+{
+    const StatementList &statements = funcDef->getStatements();
+    if (statements.size() != 1) {
+        return nullptr;
+    }
+
+    auto returnStatement = dynamic_cast<const ReturnStatement*>(statements[0].get());
+    return returnStatement ? returnStatement->getExpression() : nullptr;
+}
+
+// Counts the nodes of 'node', or returns a number above 'limit' as soon as
+// it is exceeded, or a call or cached value which needs a frame of its own
+// is found
+static uint32_t measureLeaf(const AstNode *node, uint32_t limit)
+{
+    if (dynamic_cast<const FunctionCallExpression*>(node) || dynamic_cast<const CachedExpression*>(node)) {
+        return limit + 1;
+    }
+
+    uint32_t size = 1;
+    node->forEachChild([&](const AstNode *child) {
+        if (size <= limit) {
+            size += measureLeaf(child, limit - size);
+        }
+    });
+
+    return size;
+}
+
+static bool isInlinable(const FunctionDefinition *funcDef, const Expression *body)
+{
+    const FuncDeclaration *decl = funcDef->getDeclaration();
+
+    if (body == nullptr || decl->varargs || isPassedByValue(decl->returnType)) {
+        return false;
+    }
+
+    if (decl->params.size() > FunctionDefinition::MAX_INLINE_PARAMS) {
+        return false;
+    }
+
+    for (const VarDeclaration &param: decl->params) {
+        if (isPassedByValue(param.type)) {
+            return false;
+        }
+    }
+
+    return measureLeaf(body, FunctionInliner::MAX_INLINE_NODES) <= FunctionInliner::MAX_INLINE_NODES;
+}
+
+
+FunctionInliner::FunctionInliner(Ast *ast):
+    _ast(ast),
+    _inlinedCalls(0)
+{
+}
+
+void FunctionInliner::run()
+{
+    findCandidates();
+    if (_candidates.empty()) {
+        return;
+    }
+
+    for (const Statement::Ptr &statement: _ast->getRootStatements()) {
+        visit(statement.get());
+    }
+
+    for (const vm::Callable::Ptr &callable: _ast->getFunctionDefinitions()) {
+        if (auto funcDef = dynamic_cast<const FunctionDefinition*>(callable.get())) {
+            visit(funcDef);
+        }
+    }
+}
+
+uint32_t FunctionInliner::getInlinableFunctionCount() const
+{
+    return _candidates.size();
+}
+
+uint32_t FunctionInliner::getInlinedCallCount() const
+{
+    return _inlinedCalls;
+}
+
+void FunctionInliner::findCandidates()
+{
+    for (const vm::Callable::Ptr &callable: _ast->getFunctionDefinitions()) {
+        auto funcDef = dynamic_cast<const FunctionDefinition*>(callable.get());
+        if (funcDef == nullptr) {
+            continue;
+        }
+
+        const Expression *body = getReturnedExpression(funcDef);
+        if (isInlinable(funcDef, body)) {
+            _candidates[callable.get()] = body;
+        }
+    }
+}
+
+void FunctionInliner::visit(const AstNode *node)
+{
+    if (auto call = dynamic_cast<const FunctionCallExpression*>(node)) {
+        const vm::Callable::Ptr callable = _ast->getFunctionDefinition(call->getFunctionSymbol());
+        auto it = _candidates.find(callable.get());
+
+        if (it != _candidates.end()) {
+            // The nodes belong to the Ast being built, and are not shared
+            // with anything else yet
+            auto funcDef = std::dynamic_pointer_cast<const FunctionDefinition>(callable);
+            const_cast<FunctionCallExpression*>(call)->inlineCall(funcDef, it->second);
+            _inlinedCalls++;
+        }
+    }
+
+    node->forEachChild([this](const AstNode *child) { visit(child); });
+}
+
+}
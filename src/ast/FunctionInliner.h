@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Ast.h"
+
+#include <map>
+
+
+namespace cish::ast
+{
+
+/**
+ * Evaluates calls to small leaf functions in place rather than calling
+ * them, see FunctionCallExpression::inlineCall(). A function is inlined if
+ * its body is a single return statement whose expression is no larger
+ * than MAX_INLINE_NODES nodes and calls no other function, and it neither
+ * takes nor returns structs by value.
+ *
+ * The parameters of an inlined call are bound like any local variable,
+ * so the function behaves exactly as when called, without the frame.
+ */
+class FunctionInliner
+{
+public:
+    static const uint32_t MAX_INLINE_NODES = 24;
+
+    FunctionInliner(Ast *ast);
+
+    void run();
+
+    uint32_t getInlinableFunctionCount() const;
+    uint32_t getInlinedCallCount() const;
+
+private:
+    Ast *_ast;
+
+    // The inlinable functions, and the expressions they return
+    std::map<const vm::Callable*, const Expression*> _candidates;
+
+    uint32_t _inlinedCalls;
+
+    void findCandidates();
+    void visit(const AstNode *node);
+};
+
+}
@@ -14,17 +14,66 @@ IfStatement::IfStatement(Expression::Ptr expression, ElseStatement::Ptr elseStat
     }
 }
 
-void IfStatement::virtualExecute(vm::ExecutionContext *context) const
+Completion IfStatement::virtualExecute(vm::ExecutionContext *context) const
 {
-    context->pushScope();
-
     if (_expression->evaluate(context).get<bool>()) {
-        executeChildStatements(context);
+        if (!requiresScope()) {
+            return executeChildStatements(context);
+        }
+
+        context->pushScope();
+        const Completion completion = executeChildStatements(context);
+        context->popScope();
+        return completion;
     } else if (_elseStatement) {
-        _elseStatement->execute(context);
+        return _elseStatement->execute(context);
+    }
+
+    return Completion::NORMAL;
+}
+
+bool IfStatement::getResumeIndex(const Statement *child, uint32_t *index) const
+{
+    if (_elseStatement && child == _elseStatement.get()) {
+        *index = ELSE_INDEX;
+        return true;
+    }
+
+    return SuperStatement::getResumeIndex(child, index);
+}
+
+Completion IfStatement::virtualResume(vm::ExecutionContext *context, const ResumePath &path, uint32_t level) const
+{
+    // The condition was evaluated before the execution was captured
+    if (path[level] == ELSE_INDEX) {
+        if (level + 1 == path.size()) {
+            return _elseStatement->execute(context);
+        }
+        return _elseStatement->resume(context, path, level + 1);
     }
 
-    context->popScope();
+    const Completion completion = resumeChildStatements(context, path, level);
+    if (requiresScope()) {
+        context->popScope();
+    }
+
+    return completion;
+}
+
+void IfStatement::forEachChild(const ChildVisitor &visitor) const
+{
+    visitor(_expression.get());
+
+    SuperStatement::forEachChild(visitor);
+
+    if (_elseStatement) {
+        visitor(_elseStatement.get());
+    }
+}
+
+void IfStatement::rewriteExpressions(const ExpressionRewriter &rewriter)
+{
+    rewriter(_expression);
 }
 
 }
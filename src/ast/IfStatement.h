@@ -12,10 +12,18 @@ class IfStatement: public SuperStatement
 public:
     typedef std::shared_ptr<IfStatement> Ptr;
 
+    // The ResumePath index of the else branch
+    static const uint32_t ELSE_INDEX = UINT32_MAX;
+
     IfStatement(Expression::Ptr expression, ElseStatement::Ptr elseStatement);
 
+    bool getResumeIndex(const Statement *child, uint32_t *index) const override;
+    void forEachChild(const ChildVisitor &visitor) const override;
+    void rewriteExpressions(const ExpressionRewriter &rewriter) override;
+
 protected:
-    void virtualExecute(vm::ExecutionContext *context) const override;
+    Completion virtualExecute(vm::ExecutionContext *context) const override;
+    Completion virtualResume(vm::ExecutionContext *context, const ResumePath &path, uint32_t level) const override;
 
 private:
     Expression::Ptr _expression;
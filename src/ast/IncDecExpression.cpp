@@ -91,4 +91,14 @@ int IncDecExpression::getMutationValue() const
     return delta;
 }
 
+const Lvalue* IncDecExpression::getLvalue() const
+{
+    return _lvalue.get();
+}
+
+void IncDecExpression::forEachChild(const ChildVisitor &visitor) const
+{
+    visitor(_lvalue.get());
+}
+
 }
@@ -22,6 +22,8 @@ public:
 
     virtual TypeDecl getType() const override;
     virtual ExpressionValue evaluate(vm::ExecutionContext*) const override;
+    const Lvalue* getLvalue() const;
+    virtual void forEachChild(const ChildVisitor &visitor) const override;
 
 private:
     int getMutationValue() const;
@@ -0,0 +1,76 @@
+#include "IncrementalBuilder.h"
+#include "NativeLexer.h"
+#include "NativeParser.h"
+#include "DeadCodeEliminator.h"
+
+
+namespace cish::ast
+{
+
+static void releaseSparseArena(internal::BuildCache *cache)
+{
+    size_t numLiveBytes = 0;
+    for (const auto &pair: cache->functions) {
+        numLiveBytes += pair.second.numBytes;
+    }
+
+    if (numLiveBytes * 2 < cache->arena->getBytesAllocated()) {
+        cache->functions.clear();
+        cache->arena = AstArena::create();
+    }
+}
+
+
+IncrementalBuilder::IncrementalBuilder(ModuleContextFactory moduleContextFactory):
+    _moduleContextFactory(moduleContextFactory),
+    _buildCache(std::make_unique<internal::BuildCache>())
+{
+}
+
+IncrementalBuilder::~IncrementalBuilder()
+{
+}
+
+Ast::Ptr IncrementalBuilder::buildAst(const std::string &source)
+{
+    std::vector<CompilationError> errors;
+    internal::NativeLexer lexer(source);
+    std::vector<internal::Token> tokens = lexer.tokenize(&errors);
+
+    if (!errors.empty()) {
+        ParseContext::throwSyntaxErrors(errors);
+    }
+
+    internal::NativeParser parser(source, tokens, &errors, _moduleContextFactory(), _buildCache.get());
+    Ast::Ptr ast = parser.parse();
+
+    _buildCache = parser.takeBuildCache();
+    releaseSparseArena(_buildCache.get());
+
+    DeadCodeEliminator eliminator(ast.get());
+    eliminator.run();
+
+    return ast;
+}
+
+uint32_t IncrementalBuilder::getReusedFunctionCount() const
+{
+    return _buildCache->numReusedFunctions;
+}
+
+uint32_t IncrementalBuilder::getBuiltFunctionCount() const
+{
+    return _buildCache->numBuiltFunctions;
+}
+
+size_t IncrementalBuilder::getCachedArenaBytes() const
+{
+    return _buildCache->arena ? _buildCache->arena->getBytesAllocated() : 0;
+}
+
+size_t IncrementalBuilder::getCachedStringCount() const
+{
+    return _buildCache->stringTable ? _buildCache->stringTable->getMap().size() : 0;
+}
+
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "Ast.h"
+#include "ParseContext.h"
+
+#include "../module/ModuleContext.h"
+
+#include <functional>
+#include <memory>
+
+
+namespace cish::ast
+{
+
+namespace internal
+{
+struct BuildCache;
+}
+
+/**
+ * Builds successive versions of the same program, e.g. as it is being
+ * edited, reusing what has not changed since the previous build.
+ *
+ * The source is parsed with the hand written parser. Root items are
+ * compared with the previous build: a function whose body and preceding
+ * declarations are unchanged reuses its FunctionDefinition, and the same
+ * goes for structs and their StructLayout. Everything else is rebuilt,
+ * which is cheap for declarations.
+ *
+ * Changing a declaration (a global, struct, include or function
+ * signature) rebuilds every function defined after it. A failed build
+ * leaves the previous build to compare the next one with.
+ *
+ * The functions replaced by an edit stay in the arena the builds share
+ * until less than half of it is in use. The next build then starts over
+ * in a fresh arena and rebuilds every function, so the memory held for
+ * the cache is bounded by twice what the current program needs. Strings
+ * are removed from the cache once no function uses them.
+ */
+class IncrementalBuilder
+{
+public:
+    typedef std::function<module::ModuleContext::Ptr()> ModuleContextFactory;
+
+    IncrementalBuilder(ModuleContextFactory moduleContextFactory);
+    ~IncrementalBuilder();
+
+    Ast::Ptr buildAst(const std::string &source);
+
+    // Counts of the most recent successful build
+    uint32_t getReusedFunctionCount() const;
+    uint32_t getBuiltFunctionCount() const;
+
+    // What the builder holds on to for the next build
+    size_t getCachedArenaBytes() const;
+    size_t getCachedStringCount() const;
+
+private:
+    ModuleContextFactory _moduleContextFactory;
+    std::unique_ptr<internal::BuildCache> _buildCache;
+};
+
+}
@@ -18,4 +18,23 @@ ExpressionValue LiteralExpression::evaluate(vm::ExecutionContext*) const
     return _value;
 }
 
+bool LiteralExpression::isConstant() const
+{
+    return true;
+}
+
+bool LiteralExpression::isEquivalent(const Expression *other) const
+{
+    auto literal = dynamic_cast<const LiteralExpression*>(other);
+    if (literal == nullptr || literal->_value.getIntrinsicType() != _value.getIntrinsicType()) {
+        return false;
+    }
+
+    if (_value.getIntrinsicType().isFloating()) {
+        return literal->_value.get<double>() == _value.get<double>();
+    }
+
+    return literal->_value.get<uint64_t>() == _value.get<uint64_t>();
+}
+
 }
@@ -14,6 +14,8 @@ public:
 
     virtual TypeDecl getType() const override;
     virtual ExpressionValue evaluate(vm::ExecutionContext*) const override;
+    virtual bool isConstant() const override;
+    virtual bool isEquivalent(const Expression *other) const override;
 
 private:
     ExpressionValue _value;
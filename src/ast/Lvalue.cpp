@@ -20,9 +20,12 @@ ExpressionValue Lvalue::evaluate(vm::ExecutionContext *context) const
 VariableReference
 ==================
 */
-VariableReference::VariableReference(DeclarationContext *context, const std::string &varName)
+VariableReference::VariableReference(DeclarationContext *context, const std::string &varName):
+    _symbol(Symbol::intern(varName)),
+    _localIndex(context->getLocalIndex(_symbol)),
+    _register(NO_REGISTER)
 {
-    const VarDeclaration *decl = context->getVariableDeclaration(varName);
+    const VarDeclaration *decl = context->getVariableDeclaration(_symbol);
     if (decl == nullptr) {
         Throw(VariableNotDeclaredException,
               "Variable '%s' not declared in the current scope",
@@ -39,7 +42,11 @@ TypeDecl VariableReference::getType() const
 
 vm::MemoryView VariableReference::getMemoryView(vm::ExecutionContext *context) const
 {
-    vm::Variable *var = context->getScope()->getVariable(_varDecl.name);
+    if (_register != NO_REGISTER) {
+        return context->getRegisterView(_register);
+    }
+
+    vm::Variable *var = context->getScope()->getVariable(_symbol);
     if (!var) {
         Throw(VariableNotDefinedException,
               "Variable '%s' not defined",
@@ -49,6 +56,32 @@ vm::MemoryView VariableReference::getMemoryView(vm::ExecutionContext *context) c
     return context->getMemory()->getView(var->getAllocation()->getAddress());
 }
 
+SymbolId VariableReference::getSymbol() const
+{
+    return _symbol;
+}
+
+uint32_t VariableReference::getLocalIndex() const
+{
+    return _localIndex;
+}
+
+void VariableReference::setRegister(uint32_t reg)
+{
+    _register = reg;
+}
+
+uint32_t VariableReference::getRegister() const
+{
+    return _register;
+}
+
+bool VariableReference::isEquivalent(const Expression *other) const
+{
+    auto reference = dynamic_cast<const VariableReference*>(other);
+    return reference != nullptr && reference->_symbol == _symbol;
+}
+
 
 /*
 ==================
@@ -81,6 +114,22 @@ vm::MemoryView DereferenceExpression::getMemoryView(vm::ExecutionContext *contex
     return context->getMemory()->getView(addr);
 }
 
+void DereferenceExpression::forEachChild(const ChildVisitor &visitor) const
+{
+    visitor(_expr.get());
+}
+
+bool DereferenceExpression::isEquivalent(const Expression *other) const
+{
+    auto deref = dynamic_cast<const DereferenceExpression*>(other);
+    return deref != nullptr && _expr->isEquivalent(deref->_expr.get());
+}
+
+void DereferenceExpression::rewriteExpressions(const ExpressionRewriter &rewriter)
+{
+    rewriter(_expr);
+}
+
 
 /*
 ==================
@@ -119,4 +168,24 @@ vm::MemoryView SubscriptExpression::getMemoryView(vm::ExecutionContext *context)
     return context->getMemory()->getView(addr);
 }
 
+void SubscriptExpression::forEachChild(const ChildVisitor &visitor) const
+{
+    visitor(_ptrExpr.get());
+    visitor(_indexExpr.get());
+}
+
+bool SubscriptExpression::isEquivalent(const Expression *other) const
+{
+    auto subscript = dynamic_cast<const SubscriptExpression*>(other);
+    return subscript != nullptr
+        && _ptrExpr->isEquivalent(subscript->_ptrExpr.get())
+        && _indexExpr->isEquivalent(subscript->_indexExpr.get());
+}
+
+void SubscriptExpression::rewriteExpressions(const ExpressionRewriter &rewriter)
+{
+    rewriter(_ptrExpr);
+    rewriter(_indexExpr);
+}
+
 }
@@ -42,14 +42,34 @@ VariableReference
 class VariableReference: public Lvalue
 {
 public:
+    static constexpr uint32_t NO_REGISTER = UINT32_MAX;
+
     VariableReference(DeclarationContext *context, const std::string &varName);
     virtual ~VariableReference() = default;
 
     virtual TypeDecl getType() const override;
     virtual vm::MemoryView getMemoryView(vm::ExecutionContext *context) const override;
+    SymbolId getSymbol() const;
+
+    // See DeclarationContext::getLocalIndex()
+    uint32_t getLocalIndex() const;
+
+    /**
+     * Refer to the variable by its register in the function frame rather
+     * than by name, see RegisterAllocator.
+     */
+    void setRegister(uint32_t reg);
+    uint32_t getRegister() const;
+
+    // References to the same name are equivalent, whichever variable of
+    // that name is in scope when they are evaluated
+    virtual bool isEquivalent(const Expression *other) const override;
 
 private:
+    SymbolId _symbol;
     VarDeclaration _varDecl;
+    uint32_t _localIndex;
+    uint32_t _register;
 };
 
 
@@ -66,6 +86,9 @@ public:
 
     virtual TypeDecl getType() const override;
     virtual vm::MemoryView getMemoryView(vm::ExecutionContext *context) const override;
+    virtual void forEachChild(const ChildVisitor &visitor) const override;
+    virtual bool isEquivalent(const Expression *other) const override;
+    virtual void rewriteExpressions(const ExpressionRewriter &rewriter) override;
 
 private:
     Expression::Ptr _expr;
@@ -85,6 +108,9 @@ public:
 
     virtual TypeDecl getType() const override;
     virtual vm::MemoryView getMemoryView(vm::ExecutionContext *context) const override;
+    virtual void forEachChild(const ChildVisitor &visitor) const override;
+    virtual bool isEquivalent(const Expression *other) const override;
+    virtual void rewriteExpressions(const ExpressionRewriter &rewriter) override;
 
 private:
     Expression::Ptr _ptrExpr;
@@ -39,4 +39,25 @@ ExpressionValue MinusExpression::evaluate(vm::ExecutionContext *ctx) const
     }
 }
 
+bool MinusExpression::isConstant() const
+{
+    return _expr->isConstant();
+}
+
+void MinusExpression::forEachChild(const ChildVisitor &visitor) const
+{
+    visitor(_expr.get());
+}
+
+bool MinusExpression::isEquivalent(const Expression *other) const
+{
+    auto minus = dynamic_cast<const MinusExpression*>(other);
+    return minus != nullptr && _expr->isEquivalent(minus->_expr.get());
+}
+
+void MinusExpression::rewriteExpressions(const ExpressionRewriter &rewriter)
+{
+    rewriter(_expr);
+}
+
 }
@@ -0,0 +1,33 @@
+#include "NativeContext.h"
+#include "NativeParser.h"
+
+
+namespace cish::ast
+{
+
+NativeContext::NativeContext(const std::string &source, uint32_t numThreads):
+    _source(source),
+    _numThreads(numThreads)
+{
+    internal::NativeLexer lexer(_source);
+    _tokens = lexer.tokenize(&_errors);
+}
+
+bool NativeContext::hasErrors() const
+{
+    return _errors.size() != 0;
+}
+
+std::vector<CompilationError> NativeContext::getErrors() const
+{
+    return _errors;
+}
+
+Ast::Ptr NativeContext::buildAst(module::ModuleContext::Ptr moduleContext)
+{
+    internal::NativeParser parser(_source, _tokens, &_errors, std::move(moduleContext));
+    parser.setNumThreads(_numThreads);
+    return parser.parse();
+}
+
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Ast.h"
+#include "NativeLexer.h"
+#include "ParseContext.h"
+
+#include <string>
+
+
+namespace cish::ast
+{
+
+/**
+ * Parses the source with a hand written lexer and recursive descent
+ * parser, which builds the Ast directly without an intermediate parse
+ * tree. See NativeParser.
+ *
+ * The source is only tokenized up front, so hasErrors() reports lexical
+ * errors. Syntax errors are found while the Ast is built, and are thrown
+ * from buildAst() in the same format as AstBuilder throws the errors of
+ * the ANTLR parser. Parsing carries on after a syntax error, see
+ * NativeParser.
+ *
+ * Function bodies of large sources are parsed on up to 'numThreads'
+ * threads.
+ */
+class NativeContext: public ParseContext
+{
+public:
+    NativeContext(const std::string &source, uint32_t numThreads = 1);
+
+    bool hasErrors() const override;
+    std::vector<CompilationError> getErrors() const override;
+    Ast::Ptr buildAst(module::ModuleContext::Ptr moduleContext) override;
+
+private:
+    std::string _source;
+    std::vector<internal::Token> _tokens;
+    std::vector<CompilationError> _errors;
+    uint32_t _numThreads;
+};
+
+}
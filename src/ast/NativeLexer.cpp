@@ -0,0 +1,324 @@
+#include "NativeLexer.h"
+
+#include <string_view>
+#include <unordered_map>
+
+
+namespace cish::ast::internal
+{
+
+static const std::unordered_map<std::string_view, Token::Type> KEYWORDS = {
+    { "bool",       Token::BOOL },
+    { "char",       Token::CHAR_TYPE },
+    { "int",        Token::INT },
+    { "long",       Token::LONG },
+    { "short",      Token::SHORT },
+    { "float",      Token::FLOAT },
+    { "double",     Token::DOUBLE },
+    { "void",       Token::VOID },
+    { "const",      Token::CONST },
+    { "struct",     Token::STRUCT },
+    { "if",         Token::IF },
+    { "else",       Token::ELSE },
+    { "for",        Token::FOR },
+    { "while",      Token::WHILE },
+    { "do",         Token::DO },
+    { "switch",     Token::SWITCH },
+    { "case",       Token::CASE },
+    { "default",    Token::DEFAULT },
+    { "return",     Token::RETURN },
+    { "break",      Token::BREAK },
+    { "continue",   Token::CONTINUE },
+    { "sizeof",     Token::SIZEOF },
+    { "true",       Token::BOOLEAN },
+    { "false",      Token::BOOLEAN },
+    { "NULL",       Token::NULL_LITERAL },
+};
+
+static bool isIdentifierStart(char ch)
+{
+    return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || ch == '_';
+}
+
+static bool isDigit(char ch)
+{
+    return ch >= '0' && ch <= '9';
+}
+
+static bool isHexDigit(char ch)
+{
+    return isDigit(ch) || (ch >= 'a' && ch <= 'f') || (ch >= 'A' && ch <= 'F');
+}
+
+static bool isSysModuleChar(char ch)
+{
+    return isIdentifierStart(ch) || isDigit(ch) || ch == '/' || ch == '.' || ch == '-';
+}
+
+
+NativeLexer::NativeLexer(const std::string &source):
+    _source(source),
+    _pos(0),
+    _line(1),
+    _lineStart(0)
+{
+}
+
+std::vector<Token> NativeLexer::tokenize(std::vector<CompilationError> *errors)
+{
+    std::vector<Token> tokens;
+    tokens.reserve(_source.size() / 4);
+
+    while (true) {
+        skipWhitespaceAndComments();
+
+        Token token;
+        token.offset = (uint32_t)_pos;
+        token.line = _line;
+        token.column = (int)(_pos - _lineStart);
+
+        if (_pos >= _source.size()) {
+            token.type = Token::END;
+            token.length = 0;
+            tokens.push_back(token);
+            break;
+        }
+
+        if (!lexToken(&token)) {
+            // Like ANTLR, skip a single character and carry on
+            CompilationError err;
+            err.lineNumber = token.line;
+            err.charNumber = token.column;
+            err.message = "token recognition error at: '" + _source.substr(_pos, 1) + "'";
+            errors->push_back(err);
+            advance();
+            continue;
+        }
+
+        tokens.push_back(token);
+    }
+
+    return tokens;
+}
+
+char NativeLexer::peek(size_t ahead) const
+{
+    if (_pos + ahead >= _source.size()) {
+        return '\0';
+    }
+
+    return _source[_pos + ahead];
+}
+
+void NativeLexer::advance(size_t count)
+{
+    for (size_t i=0; i<count && _pos < _source.size(); i++) {
+        if (_source[_pos] == '\n') {
+            _line++;
+            _lineStart = _pos + 1;
+        }
+        _pos++;
+    }
+}
+
+void NativeLexer::skipWhitespaceAndComments()
+{
+    while (_pos < _source.size()) {
+        const char ch = peek();
+        if (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n' || ch == '\f') {
+            advance();
+        } else if (ch == '/' && peek(1) == '/') {
+            size_t end = _source.find_first_of("\r\n", _pos);
+            advance((end == std::string::npos ? _source.size() : end) - _pos);
+        } else if (ch == '/' && peek(1) == '*') {
+            // An unterminated comment is not a comment, but a division
+            size_t end = _source.find("*/", _pos + 2);
+            if (end == std::string::npos) {
+                break;
+            }
+            advance(end + 2 - _pos);
+        } else {
+            break;
+        }
+    }
+}
+
+bool NativeLexer::lexToken(Token *token)
+{
+    const size_t start = _pos;
+    const char ch = peek();
+
+    if (isIdentifierStart(ch)) {
+        size_t len = 1;
+        while (isIdentifierStart(peek(len)) || isDigit(peek(len))) {
+            len++;
+        }
+
+        auto keyword = KEYWORDS.find(std::string_view(_source.data() + start, len));
+        token->type = (keyword != KEYWORDS.end() ? keyword->second : Token::IDENTIFIER);
+        advance(len);
+    } else if (isDigit(ch) || (ch == '.' && isDigit(peek(1)))) {
+        size_t len = 0;
+        token->type = Token::INTEGER;
+
+        if (ch == '0' && peek(1) == 'x' && isHexDigit(peek(2))) {
+            len = 2;
+            while (isHexDigit(peek(len))) {
+                len++;
+            }
+        } else {
+            while (isDigit(peek(len))) {
+                len++;
+            }
+
+            if (peek(len) == '.') {
+                token->type = Token::FLOATING;
+                len++;
+                while (isDigit(peek(len))) {
+                    len++;
+                }
+                if (peek(len) == 'f' || peek(len) == 'F') {
+                    len++;
+                }
+            }
+        }
+
+        advance(len);
+    } else if (ch == '"' || ch == '\'') {
+        if (!lexQuoted(ch)) {
+            return false;
+        }
+        token->type = (ch == '"' ? Token::STRING : Token::CHAR);
+    } else if (ch == '#') {
+        if (_source.compare(_pos, 8, "#include") != 0) {
+            return false;
+        }
+        token->type = Token::INCLUDE;
+        advance(8);
+    } else if (const uint32_t moduleNameLength = matchSysModuleName()) {
+        token->type = Token::SYS_MODULE_NAME;
+        advance(moduleNameLength);
+    } else {
+        uint32_t len = 0;
+        token->type = lexOperator(&len);
+        if (len == 0) {
+            return false;
+        }
+        advance(len);
+    }
+
+    token->length = (uint32_t)(_pos - start);
+    return true;
+}
+
+bool NativeLexer::lexQuoted(char quote)
+{
+    size_t len = 1;
+    while (true) {
+        const char ch = peek(len);
+        if (ch == '\0' || ch == '\r' || ch == '\n') {
+            return false;
+        }
+
+        if (ch == '\\') {
+            const char escaped = peek(len + 1);
+            if (escaped == '\0' || escaped == '\r' || escaped == '\n') {
+                return false;
+            }
+            len += 2;
+        } else if (ch == quote) {
+            advance(len + 1);
+            return true;
+        } else {
+            len++;
+        }
+    }
+}
+
+uint32_t NativeLexer::matchSysModuleName() const
+{
+    // '<' followed by a name and '>' is always the longest match, so the
+    // ANTLR lexer reads e.g. 'a<b>c' as an identifier, a module name and
+    // another identifier. Do the same, so that both reject the same code.
+    if (peek() != '<' || !isSysModuleChar(peek(1))) {
+        return 0;
+    }
+
+    uint32_t len = 2;
+    while (isSysModuleChar(peek(len))) {
+        len++;
+    }
+
+    return peek(len) == '>' ? len + 1 : 0;
+}
+
+Token::Type NativeLexer::lexOperator(uint32_t *length) const
+{
+    const char ch = peek();
+    const char next = peek(1);
+    *length = 1;
+
+    switch (ch) {
+        case '(': return Token::OPAREN;
+        case ')': return Token::CPAREN;
+        case '{': return Token::OBRACE;
+        case '}': return Token::CBRACE;
+        case '[': return Token::OBRACKET;
+        case ']': return Token::CBRACKET;
+        case ';': return Token::SEMICOLON;
+        case ':': return Token::COLON;
+        case ',': return Token::COMMA;
+        case '.': return Token::DOT;
+        case '~': return Token::TILDE;
+        case '+':
+            if (next == '+') { *length = 2; return Token::INCREMENT; }
+            if (next == '=') { *length = 2; return Token::PLUS_ASSIGN; }
+            return Token::PLUS;
+        case '-':
+            if (next == '-') { *length = 2; return Token::DECREMENT; }
+            if (next == '=') { *length = 2; return Token::MINUS_ASSIGN; }
+            if (next == '>') { *length = 2; return Token::ARROW; }
+            return Token::MINUS;
+        case '*':
+            if (next == '=') { *length = 2; return Token::MULTIPLY_ASSIGN; }
+            return Token::ASTERISK;
+        case '/':
+            if (next == '=') { *length = 2; return Token::DIVIDE_ASSIGN; }
+            return Token::DIVIDE;
+        case '%':
+            if (next == '=') { *length = 2; return Token::MODULUS_ASSIGN; }
+            return Token::MODULUS;
+        case '!':
+            if (next == '=') { *length = 2; return Token::NEQUALS; }
+            return Token::NOT;
+        case '=':
+            if (next == '=') { *length = 2; return Token::EQUALS; }
+            return Token::ASSIGN;
+        case '&':
+            if (next == '&') { *length = 2; return Token::AND; }
+            if (next == '=') { *length = 2; return Token::AND_ASSIGN; }
+            return Token::AMPERSAND;
+        case '|':
+            if (next == '|') { *length = 2; return Token::OR; }
+            if (next == '=') { *length = 2; return Token::OR_ASSIGN; }
+            return Token::PIPE;
+        case '^':
+            if (next == '=') { *length = 2; return Token::XOR_ASSIGN; }
+            return Token::CARET;
+        case '<':
+            if (next == '<' && peek(2) == '=') { *length = 3; return Token::LSHIFT_ASSIGN; }
+            if (next == '<') { *length = 2; return Token::LSHIFT; }
+            if (next == '=') { *length = 2; return Token::LTE; }
+            return Token::LT;
+        case '>':
+            if (next == '>' && peek(2) == '=') { *length = 3; return Token::RSHIFT_ASSIGN; }
+            if (next == '>') { *length = 2; return Token::RSHIFT; }
+            if (next == '=') { *length = 2; return Token::GTE; }
+            return Token::GT;
+    }
+
+    *length = 0;
+    return Token::END;
+}
+
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "ParseContext.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+
+namespace cish::ast::internal
+{
+
+struct Token
+{
+    enum Type: uint8_t
+    {
+        END,
+
+        IDENTIFIER,
+        INTEGER,
+        FLOATING,
+        CHAR,
+        STRING,
+        BOOLEAN,
+        NULL_LITERAL,
+        SYS_MODULE_NAME,
+        INCLUDE,
+
+        BOOL,
+        CHAR_TYPE,
+        INT,
+        LONG,
+        SHORT,
+        FLOAT,
+        DOUBLE,
+        VOID,
+        CONST,
+        STRUCT,
+
+        IF,
+        ELSE,
+        FOR,
+        WHILE,
+        DO,
+        SWITCH,
+        CASE,
+        DEFAULT,
+        RETURN,
+        BREAK,
+        CONTINUE,
+        SIZEOF,
+
+        OPAREN,
+        CPAREN,
+        OBRACE,
+        CBRACE,
+        OBRACKET,
+        CBRACKET,
+        SEMICOLON,
+        COLON,
+        COMMA,
+        DOT,
+        ARROW,
+
+        PLUS,
+        MINUS,
+        ASTERISK,
+        DIVIDE,
+        MODULUS,
+        INCREMENT,
+        DECREMENT,
+        NOT,
+        TILDE,
+        AMPERSAND,
+        PIPE,
+        CARET,
+        AND,
+        OR,
+        LSHIFT,
+        RSHIFT,
+        LT,
+        GT,
+        LTE,
+        GTE,
+        EQUALS,
+        NEQUALS,
+
+        ASSIGN,
+        PLUS_ASSIGN,
+        MINUS_ASSIGN,
+        MULTIPLY_ASSIGN,
+        DIVIDE_ASSIGN,
+        MODULUS_ASSIGN,
+        LSHIFT_ASSIGN,
+        RSHIFT_ASSIGN,
+        AND_ASSIGN,
+        XOR_ASSIGN,
+        OR_ASSIGN,
+    };
+
+    Type type;
+    uint32_t offset;
+    uint32_t length;
+    int line;
+    int column;
+};
+
+
+/**
+ * Splits a source into the tokens of the CM grammar, see grammar/CM.g4.
+ * Ties are broken the same way as the ANTLR lexer: the longest match
+ * wins, and keywords win over identifiers of the same length.
+ *
+ * Characters which don't start any token are reported as errors and
+ * skipped, and the token list always ends with an END token.
+ */
+class NativeLexer
+{
+public:
+    NativeLexer(const std::string &source);
+
+    std::vector<Token> tokenize(std::vector<CompilationError> *errors);
+
+private:
+    const std::string &_source;
+    size_t _pos;
+    int _line;
+    size_t _lineStart;
+
+    char peek(size_t ahead = 0) const;
+    void advance(size_t count = 1);
+    void skipWhitespaceAndComments();
+    bool lexToken(Token *token);
+    bool lexQuoted(char quote);
+    uint32_t matchSysModuleName() const;
+    Token::Type lexOperator(uint32_t *length) const;
+};
+
+}
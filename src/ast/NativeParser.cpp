@@ -0,0 +1,1353 @@
+#include "NativeParser.h"
+
+#include "FunctionCallExpression.h"
+#include "LiteralExpression.h"
+#include "IncDecExpression.h"
+#include "AddrofExpression.h"
+#include "NegationExpression.h"
+#include "OnesComplementExpression.h"
+#include "StringLiteralExpression.h"
+#include "SizeofExpression.h"
+#include "TypeCastExpression.h"
+#include "ArithmeticAssignmentStatement.h"
+#include "MinusExpression.h"
+#include "StructAccessExpression.h"
+#include "StringEscape.h"
+
+#include "VariableAssignmentStatement.h"
+#include "VariableDeclarationStatement.h"
+#include "FunctionDeclarationStatement.h"
+#include "FunctionDefinition.h"
+#include "ReturnStatement.h"
+#include "BreakStatement.h"
+#include "IfStatement.h"
+#include "ForLoopStatement.h"
+#include "WhileStatement.h"
+#include "SwitchStatement.h"
+#include "ExpressionStatement.h"
+
+#include "StructLayout.h"
+#include "StructField.h"
+
+#include <atomic>
+#include <thread>
+
+
+namespace cish::ast::internal
+{
+
+// Starting threads takes longer than parsing small sources
+static const size_t MIN_PARALLEL_TOKENS = 16 * 1024;
+
+static const char* getTokenName(Token::Type type)
+{
+    switch (type) {
+        case Token::END:                return "<EOF>";
+        case Token::IDENTIFIER:         return "Identifier";
+        case Token::SYS_MODULE_NAME:    return "SysModuleName";
+        case Token::OPAREN:             return "'('";
+        case Token::CPAREN:             return "')'";
+        case Token::OBRACE:             return "'{'";
+        case Token::CBRACE:             return "'}'";
+        case Token::CBRACKET:           return "']'";
+        case Token::SEMICOLON:          return "';'";
+        case Token::COLON:              return "':'";
+        case Token::ASSIGN:             return "'='";
+        case Token::WHILE:              return "'while'";
+        default:                        return "?";
+    }
+}
+
+// Operator precedence, higher binds tighter, following the order of the
+// alternatives of 'expr' in the grammar. Zero if 'type' is no binary
+// operator.
+static int getBinaryPrecedence(Token::Type type, BinaryExpression::Operator *oper)
+{
+    switch (type) {
+        case Token::ASTERISK:   *oper = BinaryExpression::MULTIPLY; return 7;
+        case Token::DIVIDE:     *oper = BinaryExpression::DIVIDE; return 7;
+        case Token::MODULUS:    *oper = BinaryExpression::MODULO; return 7;
+        case Token::PLUS:       *oper = BinaryExpression::PLUS; return 6;
+        case Token::MINUS:      *oper = BinaryExpression::MINUS; return 6;
+        case Token::LSHIFT:     *oper = BinaryExpression::BITWISE_LSHIFT; return 5;
+        case Token::RSHIFT:     *oper = BinaryExpression::BITWISE_RSHIFT; return 5;
+        case Token::GTE:        *oper = BinaryExpression::GTE; return 4;
+        case Token::LTE:        *oper = BinaryExpression::LTE; return 4;
+        case Token::GT:         *oper = BinaryExpression::GT; return 4;
+        case Token::LT:         *oper = BinaryExpression::LT; return 4;
+        case Token::EQUALS:     *oper = BinaryExpression::EQ; return 3;
+        case Token::NEQUALS:    *oper = BinaryExpression::NE; return 3;
+        case Token::AMPERSAND:  *oper = BinaryExpression::BITWISE_AND; return 2;
+        case Token::CARET:      *oper = BinaryExpression::BITWISE_XOR; return 2;
+        case Token::PIPE:       *oper = BinaryExpression::BITWISE_OR; return 2;
+        case Token::AND:        *oper = BinaryExpression::LOGICAL_AND; return 1;
+        case Token::OR:         *oper = BinaryExpression::LOGICAL_OR; return 1;
+        default:                return 0;
+    }
+}
+
+static bool getArithmeticOperator(Token::Type type, BinaryExpression::Operator *oper)
+{
+    switch (type) {
+        case Token::PLUS_ASSIGN:        *oper = BinaryExpression::PLUS; return true;
+        case Token::MINUS_ASSIGN:       *oper = BinaryExpression::MINUS; return true;
+        case Token::MULTIPLY_ASSIGN:    *oper = BinaryExpression::MULTIPLY; return true;
+        case Token::DIVIDE_ASSIGN:      *oper = BinaryExpression::DIVIDE; return true;
+        case Token::MODULUS_ASSIGN:     *oper = BinaryExpression::MODULO; return true;
+        case Token::LSHIFT_ASSIGN:      *oper = BinaryExpression::BITWISE_LSHIFT; return true;
+        case Token::RSHIFT_ASSIGN:      *oper = BinaryExpression::BITWISE_RSHIFT; return true;
+        case Token::AND_ASSIGN:         *oper = BinaryExpression::BITWISE_AND; return true;
+        case Token::XOR_ASSIGN:         *oper = BinaryExpression::BITWISE_XOR; return true;
+        case Token::OR_ASSIGN:          *oper = BinaryExpression::BITWISE_OR; return true;
+        default:                        return false;
+    }
+}
+
+
+NativeParser::NativeParser(const std::string &source,
+                           const std::vector<Token> &tokens,
+                           std::vector<CompilationError> *errors,
+                           ModuleContext::Ptr moduleContext,
+                           const BuildCache *previousBuild):
+    _source(source),
+    _tokens(tokens),
+    _errors(errors),
+    _pos(0),
+    _moduleContext(std::move(moduleContext)),
+    _previousBuild(previousBuild),
+    _declarationsMatch(previousBuild != nullptr),
+    _numThreads(1),
+    _deferBodies(false),
+    _rootContext(nullptr),
+    _stringLiterals(nullptr)
+{
+    _stringTable = StringTable::create();
+    _dataSegment = std::make_unique<DataSegment>();
+    _arena = AstArena::create();
+
+    if (_previousBuild) {
+        _buildCache = std::make_unique<BuildCache>();
+        _buildCache->arena = _previousBuild->arena ? _previousBuild->arena : AstArena::create();
+        if (_previousBuild->stringTable) {
+            _stringTable = std::make_unique<StringTable>(*_previousBuild->stringTable);
+        }
+    }
+}
+
+NativeParser::NativeParser(const NativeParser &parent, AstArena::Ptr arena):
+    _source(parent._source),
+    _tokens(parent._tokens),
+    _errors(nullptr),
+    _pos(0),
+    _arena(std::move(arena)),
+    _declContext(parent._declContext),
+    _previousBuild(nullptr),
+    _declarationsMatch(false),
+    _numThreads(1),
+    _deferBodies(false),
+    _rootContext(&parent._declContext),
+    _stringLiterals(nullptr)
+{
+    _stringTable = StringTable::create();
+}
+
+void NativeParser::setNumThreads(uint32_t numThreads)
+{
+    _numThreads = std::max(1u, numThreads);
+}
+
+Ast::Ptr NativeParser::parse()
+{
+    Ast::Ptr ast = std::make_shared<Ast>();
+    ast->addArena(_arena);
+    if (_buildCache) {
+        ast->addArena(_buildCache->arena);
+    }
+
+    _deferBodies = _numThreads > 1 && !_buildCache && _tokens.size() >= MIN_PARALLEL_TOKENS;
+    const size_t numErrors = _errors->size();
+
+    while (!check(Token::END)) {
+        const RecoveryPoint point = getRecoveryPoint();
+        try {
+            parseRootItem(ast.get());
+        } catch (const Exception&) {
+            recover(point);
+        }
+    }
+
+    if (!_pendingBodies.empty() && (hasFailed(numErrors) || !parseDeferredBodies())) {
+        // The deferred bodies may contain errors before the ones found,
+        // so parse everything in order to report the same errors as always
+        _errors->erase(_errors->begin() + numErrors, _errors->end());
+        NativeParser sequential(_source, _tokens, _errors, std::move(_moduleContext));
+        return sequential.parse();
+    }
+
+    if (_errors->size() != numErrors) {
+        ParseContext::throwSyntaxErrors(*_errors);
+    }
+    if (_semanticError) {
+        std::rethrow_exception(_semanticError);
+    }
+
+    verifyAllFunctionsDefined(ast.get());
+
+    if (_buildCache) {
+        removeUnreferencedStrings();
+        _buildCache->stringTable = std::make_unique<StringTable>(*_stringTable);
+    }
+
+    _dataSegment->addStrings(_stringTable.get());
+    ast->setDataSegment(std::move(_dataSegment));
+    ast->setStringTable(std::move(_stringTable));
+    for (const AstArena::Ptr &arena: _bodyArenas) {
+        ast->addArena(arena);
+    }
+
+    return ast;
+}
+
+std::unique_ptr<BuildCache> NativeParser::takeBuildCache()
+{
+    return std::move(_buildCache);
+}
+
+
+/* TOKENS */
+
+
+const Token& NativeParser::peek(size_t ahead) const
+{
+    // The last token is always END
+    return _tokens[std::min(_pos + ahead, _tokens.size() - 1)];
+}
+
+bool NativeParser::check(Token::Type type) const
+{
+    return peek().type == type;
+}
+
+bool NativeParser::accept(Token::Type type)
+{
+    if (check(type)) {
+        _pos++;
+        return true;
+    }
+
+    return false;
+}
+
+const Token& NativeParser::expect(Token::Type type)
+{
+    if (!check(type)) {
+        syntaxError(std::string("mismatched input '") + getText(peek()) + "' expecting " + getTokenName(type));
+    }
+
+    return _tokens[_pos++];
+}
+
+std::string NativeParser::getText(const Token &token) const
+{
+    if (token.type == Token::END) {
+        return "<EOF>";
+    }
+
+    return _source.substr(token.offset, token.length);
+}
+
+void NativeParser::syntaxError(const std::string &message)
+{
+    CompilationError err;
+    err.lineNumber = peek().line;
+    err.charNumber = peek().column;
+    err.message = message;
+    _errors->push_back(err);
+
+    ParseContext::throwSyntaxErrors(*_errors);
+}
+
+NativeParser::RecoveryPoint NativeParser::getRecoveryPoint() const
+{
+    return RecoveryPoint { _pos, _declContext.getNesting() };
+}
+
+void NativeParser::recover(const RecoveryPoint &point)
+{
+    // Syntax errors are already in the error list
+    try {
+        throw;
+    } catch (const SyntaxErrorException&) {
+    } catch (const Exception&) {
+        if (!_semanticError) {
+            _semanticError = std::current_exception();
+        }
+    }
+
+    _declContext.restoreNesting(point.nesting);
+    _pos = findEndOfItem(point.firstToken);
+}
+
+size_t NativeParser::findEndOfItem(size_t firstToken) const
+{
+    // An item ends at a semicolon outside of any parentheses or braces,
+    // or at the brace closing the first block in it, and never extends
+    // past the end of the block it is in. Parentheses may be unbalanced
+    // by the error, braces rarely are.
+    int parens = 0;
+    int braces = 0;
+    size_t i = firstToken;
+
+    for (; _tokens[i].type != Token::END; i++) {
+        const Token::Type type = _tokens[i].type;
+        if (type == Token::OPAREN) {
+            parens++;
+        } else if (type == Token::CPAREN) {
+            parens = std::max(0, parens - 1);
+        } else if (type == Token::OBRACE) {
+            braces++;
+        } else if (type == Token::CBRACE) {
+            if (braces == 0) {
+                break;
+            }
+            if (--braces == 0 && _tokens[i + 1].type != Token::ELSE) {
+                // Struct declarations end with a semicolon after the brace
+                return _tokens[i + 1].type == Token::SEMICOLON ? i + 2 : i + 1;
+            }
+        } else if (type == Token::SEMICOLON && parens == 0 && braces == 0) {
+            return i + 1;
+        }
+    }
+
+    // Always make progress, unless the source has ended
+    return (i == firstToken && _tokens[i].type != Token::END) ? i + 1 : i;
+}
+
+bool NativeParser::hasFailed(size_t numErrors) const
+{
+    return _errors->size() != numErrors || _semanticError;
+}
+
+bool NativeParser::isTypeStart(size_t ahead) const
+{
+    switch (peek(ahead).type) {
+        case Token::CONST:
+        case Token::STRUCT:
+        case Token::BOOL:
+        case Token::CHAR_TYPE:
+        case Token::INT:
+        case Token::LONG:
+        case Token::SHORT:
+        case Token::FLOAT:
+        case Token::DOUBLE:
+        case Token::VOID:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool NativeParser::isAtomStart() const
+{
+    switch (peek().type) {
+        case Token::CHAR:
+        case Token::INTEGER:
+        case Token::FLOATING:
+        case Token::BOOLEAN:
+        case Token::NULL_LITERAL:
+        case Token::IDENTIFIER:
+        case Token::STRING:
+            return true;
+        default:
+            return false;
+    }
+}
+
+
+bool NativeParser::isOperandStart(size_t ahead) const
+{
+    switch (peek(ahead).type) {
+        case Token::CHAR:
+        case Token::INTEGER:
+        case Token::FLOATING:
+        case Token::BOOLEAN:
+        case Token::NULL_LITERAL:
+        case Token::IDENTIFIER:
+        case Token::STRING:
+        case Token::OPAREN:
+        case Token::INCREMENT:
+        case Token::DECREMENT:
+        case Token::MINUS:
+        case Token::NOT:
+        case Token::TILDE:
+        case Token::AMPERSAND:
+        case Token::SIZEOF:
+            return true;
+        default:
+            return false;
+    }
+}
+
+
+/* ROOT ITEMS */
+
+
+void NativeParser::parseRootItem(Ast *ast)
+{
+    const size_t start = _pos;
+
+    if (accept(Token::INCLUDE)) {
+        std::string moduleName = getText(expect(Token::SYS_MODULE_NAME));
+        moduleName = moduleName.substr(1, moduleName.length() - 2);
+        includeModule(ast, moduleName);
+        addDeclaration(start);
+        return;
+    }
+
+    if (check(Token::STRUCT) && peek(2).type == Token::OBRACE) {
+        if (!reuseStruct(ast, start)) {
+            StructLayout::Ptr structLayout = parseStructDeclaration();
+            ast->addStructLayout(structLayout);
+
+            if (_buildCache) {
+                BuildCache::Struct &cached = _buildCache->structs[structLayout->getName()];
+                cached.numDeclarations = _buildCache->declarations.size();
+                cached.source = getSource(start, _pos);
+                cached.layout = structLayout;
+            }
+        }
+        addDeclaration(start);
+        return;
+    }
+
+    if (!isTypeStart()) {
+        syntaxError("extraneous input '" + getText(peek()) + "'");
+    }
+
+    // Functions and variables both start with a type and a name
+    const TypeDecl type = parseTypeIdentifier();
+    const std::string name = getText(expect(Token::IDENTIFIER));
+
+    if (accept(Token::OPAREN)) {
+        FuncDeclaration funcDecl;
+        funcDecl.name = name;
+        funcDecl.params = parseIdentifierList();
+        funcDecl.returnType = type;
+        expect(Token::CPAREN);
+
+        if (accept(Token::SEMICOLON)) {
+            _funcDecls.push_back(funcDecl);
+            ast->addRootStatement(AstArena::create<FunctionDeclarationStatement>(_arena, &_declContext, funcDecl));
+            addDeclaration(start);
+            return;
+        }
+
+        // The signature is visible to the body, the body to nobody
+        addDeclaration(start);
+        if (_deferBodies && deferFunctionBody(ast, funcDecl)) {
+            return;
+        }
+
+        if (_buildCache) {
+            if (!reuseFunctionDefinition(ast, funcDecl)) {
+                cacheFunctionDefinition(ast, funcDecl);
+            }
+        } else {
+            ast->addFunctionDefinition(parseFunctionDefinition(funcDecl));
+        }
+        return;
+    }
+
+    _pos = start;
+    Statement::Ptr statement = parseVariableDeclaration();
+    expect(Token::SEMICOLON);
+
+    auto varDeclStmt = std::dynamic_pointer_cast<VariableDeclarationStatement>(statement);
+    varDeclStmt->allocateStatically(_dataSegment.get());
+    ast->addRootStatement(varDeclStmt);
+    addDeclaration(start);
+}
+
+bool NativeParser::reuseStruct(Ast *ast, size_t start)
+{
+    if (!_declarationsMatch) {
+        return false;
+    }
+
+    const std::string name = getText(peek(1));
+    const auto it = _previousBuild->structs.find(name);
+    if (it == _previousBuild->structs.end()) {
+        return false;
+    }
+
+    const BuildCache::Struct &cached = it->second;
+    const size_t close = findClosingBrace(start + 2);
+    if (close == 0 || _tokens[close + 1].type != Token::SEMICOLON) {
+        return false;
+    }
+
+    if (cached.numDeclarations != _buildCache->declarations.size() || cached.source != getSource(start, close + 2)) {
+        return false;
+    }
+
+    _declContext.declareStruct(cached.layout.get());
+    ast->addStructLayout(cached.layout);
+    _buildCache->structs[name] = cached;
+    _pos = close + 2;
+    return true;
+}
+
+bool NativeParser::reuseFunctionDefinition(Ast *ast, const FuncDeclaration &funcDecl)
+{
+    if (!_declarationsMatch || !check(Token::OBRACE)) {
+        return false;
+    }
+
+    const auto it = _previousBuild->functions.find(funcDecl.name);
+    if (it == _previousBuild->functions.end()) {
+        return false;
+    }
+
+    const BuildCache::Function &cached = it->second;
+    const size_t close = findClosingBrace(_pos);
+    if (close == 0) {
+        return false;
+    }
+
+    if (cached.numDeclarations != _buildCache->declarations.size() || cached.body != getSource(_pos, close + 1)) {
+        return false;
+    }
+
+    // Defining the function would have declared it
+    _declContext.declareFunction(funcDecl);
+    ast->addFunctionDefinition(cached.definition);
+    _referencedStrings.insert(_referencedStrings.end(), cached.strings.begin(), cached.strings.end());
+    _buildCache->functions[funcDecl.name] = cached;
+    _buildCache->numReusedFunctions++;
+    _pos = close + 1;
+    return true;
+}
+
+void NativeParser::addDeclaration(size_t startToken)
+{
+    if (!_buildCache) {
+        return;
+    }
+
+    std::vector<std::string> &declarations = _buildCache->declarations;
+    std::string declaration = getSource(startToken, _pos);
+
+    if (_declarationsMatch) {
+        const std::vector<std::string> &previous = _previousBuild->declarations;
+        _declarationsMatch = declarations.size() < previous.size()
+                          && previous[declarations.size()] == declaration;
+    }
+
+    declarations.push_back(std::move(declaration));
+}
+
+size_t NativeParser::findClosingBrace(size_t openToken) const
+{
+    // Zero if the braces are unbalanced
+    int depth = 0;
+    for (size_t i=openToken; i<_tokens.size(); i++) {
+        if (_tokens[i].type == Token::OBRACE) {
+            depth++;
+        } else if (_tokens[i].type == Token::CBRACE && --depth == 0) {
+            return i;
+        }
+    }
+
+    return 0;
+}
+
+std::string NativeParser::getSource(size_t firstToken, size_t endToken) const
+{
+    const Token &first = _tokens[firstToken];
+    const Token &last = _tokens[endToken - 1];
+    return _source.substr(first.offset, last.offset + last.length - first.offset);
+}
+
+StructLayout::Ptr NativeParser::parseStructDeclaration()
+{
+    expect(Token::STRUCT);
+    const std::string name = getText(expect(Token::IDENTIFIER));
+    expect(Token::OBRACE);
+
+    StructLayout *rawStruct = new StructLayout(name);
+    StructLayout::Ptr sharedStruct = StructLayout::Ptr(rawStruct);
+    _declContext.declareStruct(rawStruct);
+
+    std::vector<std::pair<TypeDecl,std::string>> fields;
+    while (!accept(Token::CBRACE)) {
+        const TypeDecl type = parseTypeIdentifier();
+        const std::string varName = getText(expect(Token::IDENTIFIER));
+        expect(Token::SEMICOLON);
+        fields.push_back(std::make_pair(type, varName));
+    }
+    expect(Token::SEMICOLON);
+
+    if (fields.empty()) {
+        Throw(EmptyStructException, "Struct '%s' has no declared fields", name.c_str());
+    }
+
+    for (const auto &field: fields) {
+        rawStruct->addField(new StructField(field.first, field.second));
+    }
+
+    rawStruct->finalize();
+
+    return sharedStruct;
+}
+
+vm::Callable::Ptr NativeParser::parseFunctionDefinition(const FuncDeclaration &funcDecl)
+{
+    expect(Token::OBRACE);
+
+    FunctionDefinition::Ptr funcDef = AstArena::create<FunctionDefinition>(_arena, &_declContext, funcDecl);
+    parseFunctionBody(funcDef, funcDecl);
+    return funcDef;
+}
+
+void NativeParser::cacheFunctionDefinition(Ast *ast, const FuncDeclaration &funcDecl)
+{
+    const AstArena::Ptr rootArena = _arena;
+    const size_t bodyStart = _pos;
+    const size_t firstByte = _buildCache->arena->getBytesAllocated();
+    const size_t firstString = _referencedStrings.size();
+
+    vm::Callable::Ptr funcDef;
+    _arena = _buildCache->arena;
+    try {
+        funcDef = parseFunctionDefinition(funcDecl);
+    } catch (...) {
+        _arena = rootArena;
+        throw;
+    }
+    _arena = rootArena;
+
+    ast->addFunctionDefinition(funcDef);
+
+    BuildCache::Function &cached = _buildCache->functions[funcDecl.name];
+    cached.numDeclarations = _buildCache->declarations.size();
+    cached.body = getSource(bodyStart, _pos);
+    cached.definition = funcDef;
+    cached.numBytes = _buildCache->arena->getBytesAllocated() - firstByte;
+    cached.strings.assign(_referencedStrings.begin() + firstString, _referencedStrings.end());
+    _buildCache->numBuiltFunctions++;
+}
+
+void NativeParser::removeUnreferencedStrings()
+{
+    const std::set<StringId> referenced(_referencedStrings.begin(), _referencedStrings.end());
+
+    std::vector<StringId> unreferenced;
+    for (const auto &pair: _stringTable->getMap()) {
+        if (!referenced.count(pair.first)) {
+            unreferenced.push_back(pair.first);
+        }
+    }
+
+    for (StringId id: unreferenced) {
+        _stringTable->remove(id);
+    }
+}
+
+void NativeParser::parseFunctionBody(FunctionDefinition::Ptr funcDef, const FuncDeclaration &funcDecl)
+{
+    _declContext.enterFunction(funcDef);
+    for (const VarDeclaration &varDecl: funcDecl.params) {
+        if (!varDecl.name.empty()) {
+            _declContext.declareVariable(varDecl.type, varDecl.name);
+        }
+    }
+
+    while (!accept(Token::CBRACE)) {
+        if (Statement::Ptr statement = parseStatementOrRecover()) {
+            funcDef->addStatement(statement);
+        }
+    }
+
+    _declContext.exitFunction();
+}
+
+bool NativeParser::deferFunctionBody(Ast *ast, const FuncDeclaration &funcDecl)
+{
+    const size_t close = check(Token::OBRACE) ? findClosingBrace(_pos) : 0;
+    if (close == 0) {
+        return false;
+    }
+
+    PendingBody body;
+    body.funcDef = AstArena::create<FunctionDefinition>(_arena, &_declContext, funcDecl);
+    body.funcDecl = funcDecl;
+    body.firstToken = _pos + 1;
+    body.numDeclarations = _declContext.getRootDeclarationCount();
+
+    ast->addFunctionDefinition(body.funcDef);
+    _pendingBodies.push_back(std::move(body));
+    _pos = close + 1;
+    return true;
+}
+
+bool NativeParser::parseDeferredBodies()
+{
+    std::atomic<size_t> nextBody(0);
+    auto parseBodies = [this,&nextBody](AstArena::Ptr arena) {
+        NativeParser parser(*this, std::move(arena));
+        for (size_t i = nextBody++; i < _pendingBodies.size(); i = nextBody++) {
+            parser.parseDeferredBody(&_pendingBodies[i]);
+        }
+    };
+
+    const size_t numThreads = std::min<size_t>(_numThreads, _pendingBodies.size());
+    for (size_t i=0; i<numThreads; i++) {
+        _bodyArenas.push_back(AstArena::create());
+    }
+
+    std::vector<std::thread> threads;
+    for (size_t i=1; i<numThreads; i++) {
+        threads.emplace_back(parseBodies, _bodyArenas[i]);
+    }
+
+    parseBodies(_bodyArenas[0]);
+    for (std::thread &thread: threads) {
+        thread.join();
+    }
+
+    // A failed body is parsed again in order with everything else, see
+    // parse()
+    for (const PendingBody &body: _pendingBodies) {
+        if (body.exception || !body.errors.empty()) {
+            return false;
+        }
+    }
+
+    // Merge in source order, so that the string ids don't depend on the
+    // scheduling
+    for (PendingBody &body: _pendingBodies) {
+        for (const auto &literal: body.stringLiterals) {
+            literal.first->setStringId(_stringTable->insert(literal.second));
+        }
+    }
+
+    _pendingBodies.clear();
+    return true;
+}
+
+void NativeParser::parseDeferredBody(PendingBody *body)
+{
+    _errors = &body->errors;
+    _stringLiterals = &body->stringLiterals;
+    _pos = body->firstToken;
+    _declContext.setVisibleRootDeclarations(body->numDeclarations);
+
+    try {
+        parseFunctionBody(body->funcDef, body->funcDecl);
+        body->exception = _semanticError;
+    } catch (...) {
+        body->exception = std::current_exception();
+
+        // The failed body left its scopes behind
+        _declContext = *_rootContext;
+    }
+
+    _semanticError = nullptr;
+}
+
+std::vector<VarDeclaration> NativeParser::parseIdentifierList()
+{
+    std::vector<VarDeclaration> identifierList;
+    if (check(Token::CPAREN)) {
+        return identifierList;
+    }
+
+    do {
+        identifierList.push_back(parseFunctionParameter());
+    } while (accept(Token::COMMA));
+
+    return identifierList;
+}
+
+VarDeclaration NativeParser::parseFunctionParameter()
+{
+    VarDeclaration decl;
+    decl.type = parseTypeIdentifier();
+    if (check(Token::IDENTIFIER)) {
+        decl.name = getText(expect(Token::IDENTIFIER));
+    }
+
+    return decl;
+}
+
+TypeDecl NativeParser::parseTypeIdentifier(bool stopBeforeOperand)
+{
+    std::vector<std::string> tokens;
+    if (check(Token::CONST)) {
+        tokens.push_back(getText(expect(Token::CONST)));
+    }
+
+    if (check(Token::STRUCT)) {
+        tokens.push_back(getText(expect(Token::STRUCT)));
+        tokens.push_back(getText(expect(Token::IDENTIFIER)));
+    } else if (isTypeStart() && !check(Token::CONST)) {
+        tokens.push_back(getText(peek()));
+        _pos++;
+    } else {
+        syntaxError("no viable alternative at input '" + getText(peek()) + "'");
+    }
+
+    while (check(Token::ASTERISK)) {
+        if (stopBeforeOperand && isOperandStart(1)) {
+            break;
+        }
+        tokens.push_back(getText(expect(Token::ASTERISK)));
+    }
+
+    return TypeDecl::getFromTokens(&_declContext, tokens);
+}
+
+
+/* STATEMENTS */
+
+
+Statement::Ptr NativeParser::parseStatement()
+{
+    switch (peek().type) {
+        case Token::SEMICOLON:
+            _pos++;
+            return AstArena::create<NoOpStatement>(_arena);
+        case Token::IF:
+            return parseIfStatement();
+        case Token::FOR:
+            return parseForStatement();
+        case Token::WHILE:
+            return parseWhileStatement();
+        case Token::DO:
+            return parseDoWhileStatement();
+        case Token::SWITCH:
+            return parseSwitchStatement();
+        case Token::RETURN:
+            return parseReturnStatement();
+        case Token::BREAK:
+            _pos++;
+            expect(Token::SEMICOLON);
+            return AstArena::create<BreakStatement>(_arena, &_declContext);
+        case Token::CONTINUE:
+            _pos++;
+            expect(Token::SEMICOLON);
+            return AstArena::create<ContinueStatement>(_arena, &_declContext);
+        default:
+            break;
+    }
+
+    Statement::Ptr statement;
+    if (isTypeStart()) {
+        statement = parseVariableDeclaration();
+    } else {
+        statement = parseAssignment(true, true);
+    }
+
+    expect(Token::SEMICOLON);
+    return statement;
+}
+
+Statement::Ptr NativeParser::parseStatementOrRecover()
+{
+    const RecoveryPoint point = getRecoveryPoint();
+    try {
+        return parseStatement();
+    } catch (const Exception&) {
+        recover(point);
+
+        // The enclosing blocks can't be closed any more, so leave it to
+        // the root item to recover
+        if (check(Token::END)) {
+            throw;
+        }
+
+        return nullptr;
+    }
+}
+
+std::vector<Statement::Ptr> NativeParser::parseBlockOrStatement()
+{
+    std::vector<Statement::Ptr> statements;
+
+    if (accept(Token::OBRACE)) {
+        while (!accept(Token::CBRACE)) {
+            if (Statement::Ptr statement = parseStatementOrRecover()) {
+                statements.push_back(statement);
+            }
+        }
+    } else {
+        statements.push_back(parseStatement());
+    }
+
+    return statements;
+}
+
+Statement::Ptr NativeParser::parseIfStatement()
+{
+    expect(Token::IF);
+    expect(Token::OPAREN);
+    Expression::Ptr expr = parseExpression();
+    expect(Token::CPAREN);
+
+    _declContext.pushVariableScope();
+    std::vector<Statement::Ptr> statements = parseBlockOrStatement();
+    const bool requiresScope = _declContext.currentScopeHasDeclarations();
+    _declContext.popVariableScope();
+
+    ElseStatement::Ptr elseStatement = nullptr;
+    if (check(Token::ELSE)) {
+        elseStatement = parseElseStatement();
+    }
+
+    IfStatement::Ptr ifStatement = AstArena::create<IfStatement>(_arena, expr, elseStatement);
+    for (const Statement::Ptr &statement: statements) {
+        ifStatement->addStatement(statement);
+    }
+
+    ifStatement->setRequiresScope(requiresScope);
+    return ifStatement;
+}
+
+ElseStatement::Ptr NativeParser::parseElseStatement()
+{
+    expect(Token::ELSE);
+
+    ElseStatement::Ptr elseStatement = AstArena::create<ElseStatement>(_arena);
+    _declContext.pushVariableScope();
+
+    for (const Statement::Ptr &statement: parseBlockOrStatement()) {
+        elseStatement->addStatement(statement);
+    }
+
+    elseStatement->setRequiresScope(_declContext.currentScopeHasDeclarations());
+    _declContext.popVariableScope();
+    return elseStatement;
+}
+
+Statement::Ptr NativeParser::parseForStatement()
+{
+    Statement::Ptr initializer = nullptr;
+    Expression::Ptr condition = nullptr;
+    Statement::Ptr iterator = nullptr;
+
+    expect(Token::FOR);
+    expect(Token::OPAREN);
+
+    _declContext.pushVariableScope();
+
+    if (!check(Token::SEMICOLON)) {
+        initializer = isTypeStart() ? parseVariableDeclaration() : parseAssignment(false, false);
+    }
+    expect(Token::SEMICOLON);
+
+    if (!check(Token::SEMICOLON)) {
+        condition = parseExpression();
+    }
+    expect(Token::SEMICOLON);
+
+    if (!check(Token::CPAREN)) {
+        iterator = parseAssignment(true, true);
+    }
+    expect(Token::CPAREN);
+
+    ForLoopStatement::Ptr forLoop = AstArena::create<ForLoopStatement>(_arena, initializer, condition, iterator);
+
+    _declContext.enterLoop();
+    for (const Statement::Ptr &statement: parseBlockOrStatement()) {
+        forLoop->addStatement(statement);
+    }
+    _declContext.exitLoop();
+
+    forLoop->setRequiresScope(_declContext.currentScopeHasDeclarations());
+    _declContext.popVariableScope();
+    return forLoop;
+}
+
+Statement::Ptr NativeParser::parseWhileStatement()
+{
+    expect(Token::WHILE);
+    expect(Token::OPAREN);
+    Expression::Ptr condition = parseExpression();
+    expect(Token::CPAREN);
+
+    _declContext.pushVariableScope();
+
+    WhileStatement::Ptr whileStatement = AstArena::create<WhileStatement>(_arena, condition);
+
+    _declContext.enterLoop();
+    for (const Statement::Ptr &statement: parseBlockOrStatement()) {
+        whileStatement->addStatement(statement);
+    }
+    _declContext.exitLoop();
+
+    whileStatement->setRequiresScope(_declContext.currentScopeHasDeclarations());
+    _declContext.popVariableScope();
+    return whileStatement;
+}
+
+Statement::Ptr NativeParser::parseDoWhileStatement()
+{
+    expect(Token::DO);
+    expect(Token::OBRACE);
+
+    // The condition follows the body, but is resolved in the enclosing
+    // scope all the same
+    _declContext.pushVariableScope();
+    _declContext.enterLoop();
+
+    std::vector<Statement::Ptr> statements;
+    while (!accept(Token::CBRACE)) {
+        if (Statement::Ptr statement = parseStatementOrRecover()) {
+            statements.push_back(statement);
+        }
+    }
+
+    _declContext.exitLoop();
+    const bool requiresScope = _declContext.currentScopeHasDeclarations();
+    _declContext.popVariableScope();
+
+    expect(Token::WHILE);
+    expect(Token::OPAREN);
+    Expression::Ptr condition = parseExpression();
+    expect(Token::CPAREN);
+    expect(Token::SEMICOLON);
+
+    DoWhileStatement::Ptr doWhileStatement = AstArena::create<DoWhileStatement>(_arena, condition);
+    for (const Statement::Ptr &statement: statements) {
+        doWhileStatement->addStatement(statement);
+    }
+
+    doWhileStatement->setRequiresScope(requiresScope);
+    return doWhileStatement;
+}
+
+Statement::Ptr NativeParser::parseSwitchStatement()
+{
+    expect(Token::SWITCH);
+    expect(Token::OPAREN);
+    Expression::Ptr expression = parseExpression();
+    expect(Token::CPAREN);
+    expect(Token::OBRACE);
+
+    _declContext.pushVariableScope();
+
+    SwitchStatement::Ptr switchStatement = AstArena::create<SwitchStatement>(_arena, expression);
+
+    _declContext.enterSwitch();
+    bool hasLabel = false;
+    while (!accept(Token::CBRACE)) {
+        if (accept(Token::CASE)) {
+            switchStatement->addCaseLabel(parseExpression());
+            expect(Token::COLON);
+            hasLabel = true;
+        } else if (accept(Token::DEFAULT)) {
+            expect(Token::COLON);
+            switchStatement->addDefaultLabel();
+            hasLabel = true;
+        } else if (!hasLabel) {
+            syntaxError("extraneous input '" + getText(peek()) + "' expecting {'case', 'default', '}'}");
+        } else if (Statement::Ptr statement = parseStatementOrRecover()) {
+            switchStatement->addStatement(statement);
+        }
+    }
+    _declContext.exitSwitch();
+
+    switchStatement->finalize();
+    switchStatement->setRequiresScope(_declContext.currentScopeHasDeclarations());
+    _declContext.popVariableScope();
+    return switchStatement;
+}
+
+Statement::Ptr NativeParser::parseReturnStatement()
+{
+    expect(Token::RETURN);
+
+    Expression::Ptr expression = nullptr;
+    if (!check(Token::SEMICOLON)) {
+        expression = parseExpression();
+    }
+    expect(Token::SEMICOLON);
+
+    return AstArena::create<ReturnStatement>(_arena, &_declContext, expression);
+}
+
+Statement::Ptr NativeParser::parseVariableDeclaration()
+{
+    const TypeDecl type = parseTypeIdentifier();
+    const std::string varName = getText(expect(Token::IDENTIFIER));
+
+    Expression::Ptr expression = nullptr;
+    if (accept(Token::ASSIGN)) {
+        expression = parseExpression();
+    }
+
+    return AstArena::create<VariableDeclarationStatement>(_arena, &_declContext, type, varName, expression);
+}
+
+Statement::Ptr NativeParser::parseAssignment(bool allowArithmetic, bool allowExpression)
+{
+    Expression::Ptr expression = parseExpression();
+
+    BinaryExpression::Operator oper;
+    if (accept(Token::ASSIGN)) {
+        Expression::Ptr rvalue = parseExpression();
+        return AstArena::create<VariableAssignmentStatement>(_arena, &_declContext, castToLvalue(expression), rvalue);
+    } else if (allowArithmetic && getArithmeticOperator(peek().type, &oper)) {
+        _pos++;
+        Expression::Ptr rvalue = parseExpression();
+        return AstArena::create<ArithmeticAssignmentStatement>(_arena, castToLvalue(expression), oper, rvalue);
+    } else if (!allowExpression) {
+        expect(Token::ASSIGN);
+    }
+
+    return AstArena::create<ExpressionStatement>(_arena, expression);
+}
+
+
+/* EXPRESSIONS */
+
+
+Expression::Ptr NativeParser::parseExpression(int minPrecedence, Expression::Ptr primary)
+{
+    Expression::Ptr left = primary ? parsePostfix(primary) : parseUnary();
+
+    BinaryExpression::Operator oper;
+    int precedence;
+    while ((precedence = getBinaryPrecedence(peek().type, &oper)) >= minPrecedence && precedence > 0) {
+        _pos++;
+        // All binary operators are left associative
+        Expression::Ptr right = parseExpression(precedence + 1);
+        left = AstArena::create<BinaryExpression>(_arena, oper, left, right);
+    }
+
+    return left;
+}
+
+Expression::Ptr NativeParser::parseUnary()
+{
+    switch (peek().type) {
+        case Token::INCREMENT:
+            _pos++;
+            return AstArena::create<IncDecExpression>(_arena, IncDecExpression::PREFIX_INCREMENT, castToLvalue(parseUnary()));
+        case Token::DECREMENT:
+            _pos++;
+            return AstArena::create<IncDecExpression>(_arena, IncDecExpression::PREFIX_DECREMENT, castToLvalue(parseUnary()));
+        case Token::MINUS:
+            _pos++;
+            return AstArena::create<MinusExpression>(_arena, parseUnary());
+        case Token::NOT:
+            _pos++;
+            return AstArena::create<NegationExpression>(_arena, parseUnary());
+        case Token::TILDE:
+            _pos++;
+            return AstArena::create<OnesComplementExpression>(_arena, parseUnary());
+        case Token::ASTERISK:
+            _pos++;
+            return AstArena::create<DereferenceExpression>(_arena, parseUnary());
+        case Token::AMPERSAND:
+            _pos++;
+            return AstArena::create<AddrofExpression>(_arena, castToLvalue(parseUnary()));
+        case Token::SIZEOF:
+            return parsePostfix(parseSizeof());
+        case Token::OPAREN:
+            if (isTypeStart(1)) {
+                _pos++;
+                TypeDecl type = parseTypeIdentifier();
+                expect(Token::CPAREN);
+                return AstArena::create<TypeCastExpression>(_arena, type, parseUnary());
+            }
+            break;
+        default:
+            break;
+    }
+
+    return parsePostfix(parseAtom());
+}
+
+Expression::Ptr NativeParser::parsePostfix(Expression::Ptr expr)
+{
+    while (true) {
+        if (check(Token::DOT) || check(Token::ARROW)) {
+            auto accessType = check(Token::DOT)
+                            ? StructAccessExpression::AccessType::OBJECT
+                            : StructAccessExpression::AccessType::POINTER;
+            _pos++;
+            const std::string identifier = getText(expect(Token::IDENTIFIER));
+            expr = AstArena::create<StructAccessExpression>(_arena, expr, identifier, accessType);
+        } else if (accept(Token::OBRACKET)) {
+            Expression::Ptr index = parseExpression();
+            expect(Token::CBRACKET);
+            expr = AstArena::create<SubscriptExpression>(_arena, expr, index);
+        } else if (accept(Token::INCREMENT)) {
+            expr = AstArena::create<IncDecExpression>(_arena, IncDecExpression::POSTFIX_INCREMENT, castToLvalue(expr));
+        } else if (accept(Token::DECREMENT)) {
+            expr = AstArena::create<IncDecExpression>(_arena, IncDecExpression::POSTFIX_DECREMENT, castToLvalue(expr));
+        } else {
+            return expr;
+        }
+    }
+}
+
+Expression::Ptr NativeParser::parseAtom()
+{
+    switch (peek().type) {
+        case Token::OPAREN: {
+            _pos++;
+            Expression::Ptr expr = parseExpression();
+            expect(Token::CPAREN);
+            return expr;
+        }
+        case Token::CHAR:
+        case Token::INTEGER:
+        case Token::FLOATING:
+        case Token::BOOLEAN:
+        case Token::NULL_LITERAL:
+            return AstArena::create<LiteralExpression>(_arena, getText(_tokens[_pos++]));
+        case Token::STRING:
+            return parseStringLiteral();
+        case Token::IDENTIFIER:
+            if (peek(1).type == Token::OPAREN) {
+                return parseFunctionCall();
+            }
+            return AstArena::create<VariableReference>(_arena, &_declContext, getText(_tokens[_pos++]));
+        default:
+            syntaxError("no viable alternative at input '" + getText(peek()) + "'");
+    }
+}
+
+Expression::Ptr NativeParser::parseSizeof()
+{
+    expect(Token::SIZEOF);
+
+    TypeDecl type;
+    Expression::Ptr expr = parseSizeofTerm(&type, false);
+    if (expr) {
+        return AstArena::create<SizeofExpression>(_arena, expr);
+    }
+
+    return AstArena::create<SizeofExpression>(_arena, type);
+}
+
+Expression::Ptr NativeParser::parseSizeofTerm(TypeDecl *type, bool parenthesized)
+{
+    // ANTLR prefers the earliest alternative of 'sizeofTerm' which still
+    // parses: a parenthesized term, a type, a single atom and finally a
+    // full expression. Inside parentheses, an atom must be followed by
+    // the closing parenthesis to be taken on its own.
+    if (accept(Token::OPAREN)) {
+        Expression::Ptr expr = parseSizeofTerm(type, true);
+        expect(Token::CPAREN);
+        return expr;
+    }
+
+    if (isTypeStart()) {
+        // In 'sizeof int * 2', the asterisk is a multiplication
+        *type = parseTypeIdentifier(!parenthesized);
+        return nullptr;
+    }
+
+    if (isAtomStart()) {
+        Expression::Ptr atom = parseAtom();
+        if (!parenthesized || check(Token::CPAREN)) {
+            return atom;
+        }
+        return parseExpression(1, atom);
+    }
+
+    return parseExpression();
+}
+
+Expression::Ptr NativeParser::parseFunctionCall()
+{
+    const std::string funcName = getText(expect(Token::IDENTIFIER));
+    expect(Token::OPAREN);
+
+    std::vector<Expression::Ptr> params;
+    if (!check(Token::CPAREN)) {
+        do {
+            params.push_back(parseExpression());
+        } while (accept(Token::COMMA));
+    }
+    expect(Token::CPAREN);
+
+    return AstArena::create<FunctionCallExpression>(_arena, &_declContext, funcName, params);
+}
+
+Expression::Ptr NativeParser::parseStringLiteral()
+{
+    const Token &token = expect(Token::STRING);
+    std::string str = _source.substr(token.offset + 1, token.length - 2);
+    str = ast::string::unescapeString(str);
+    const StringId stringId = _stringTable->insert(str);
+    auto literal = AstArena::create<StringLiteralExpression>(_arena, stringId);
+
+    if (_buildCache) {
+        _referencedStrings.push_back(stringId);
+    }
+
+    if (_stringLiterals) {
+        // Replaced by an id in the shared string table once merged
+        _stringLiterals->push_back(std::make_pair(literal, std::move(str)));
+    }
+
+    return literal;
+}
+
+Lvalue::Ptr NativeParser::castToLvalue(Expression::Ptr expr)
+{
+    Lvalue::Ptr lvalue = std::dynamic_pointer_cast<Lvalue>(expr);
+    if (lvalue == nullptr) {
+        Throw(AstConversionException, "Expected lvalue");
+    }
+
+    return lvalue;
+}
+
+
+/* MODULES */
+
+
+void NativeParser::verifyAllFunctionsDefined(Ast *ast)
+{
+    for (const FuncDeclaration& decl: _funcDecls) {
+        if (ast->getFunctionDefinition(decl.name) == nullptr) {
+            Throw(FunctionNotDefinedException, "Function '%s' was declared but never defined",
+                    decl.name.c_str());
+        }
+    }
+}
+
+void NativeParser::includeModule(Ast *ast, std::string moduleName)
+{
+    if (_includedModules.count(moduleName) == 1) {
+        return;
+    }
+
+    const module::Module::Ptr module = _moduleContext->getModule(moduleName);
+    if (!module) {
+        Throw(ModuleNotFoundException, "Could not include module '%s'", moduleName.c_str());
+    }
+
+    for (const auto& depName: module->getDependencies()) {
+        includeModule(ast, depName);
+    }
+
+    for (const auto &structLayout: module->getStructs()) {
+        ast->addStructLayout(structLayout);
+        _declContext.declareStruct(structLayout.get());
+    }
+
+    for (const auto &func: module->getFunctions()) {
+        _declContext.declareFunction(*func->getDeclaration());
+    }
+
+    ast->addModule(module);
+    _includedModules.insert(moduleName);
+}
+
+}
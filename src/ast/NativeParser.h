@@ -0,0 +1,242 @@
+#pragma once
+
+#include "NativeLexer.h"
+#include "ParseContext.h"
+#include "AstBuilder.h"
+
+#include "AstNodes.h"
+#include "Lvalue.h"
+
+#include "BinaryExpression.h"
+#include "DeclarationContext.h"
+#include "ElseStatement.h"
+#include "StringLiteralExpression.h"
+#include "Ast.h"
+
+#include "../module/ModuleContext.h"
+
+#include <exception>
+#include <map>
+#include <set>
+
+
+namespace cish::ast::internal
+{
+
+using module::ModuleContext;
+
+/**
+ * The parts of a previous build an incremental build can reuse, see
+ * IncrementalBuilder.
+ *
+ * A function body or struct only depends on the root items before it, so
+ * it is reused if its own source and the source of every declaration
+ * before it are unchanged. Function bodies are not declarations, their
+ * signatures are.
+ *
+ * The functions are built into an arena shared by every build, which also
+ * holds the functions later builds have replaced. The root items of a
+ * build are kept in the arena of its Ast.
+ */
+struct BuildCache
+{
+    struct Function
+    {
+        size_t numDeclarations;
+        std::string body;
+        vm::Callable::Ptr definition;
+
+        // The bytes of the arena taken by the definition, and the ids of
+        // its string literals
+        size_t numBytes;
+        std::vector<StringId> strings;
+    };
+
+    struct Struct
+    {
+        size_t numDeclarations;
+        std::string source;
+        StructLayout::Ptr layout;
+    };
+
+    // Declared first, as it must outlive the definitions
+    AstArena::Ptr arena;
+
+    std::vector<std::string> declarations;
+    std::map<std::string,Function> functions;
+    std::map<std::string,Struct> structs;
+
+    // Reused functions refer to their strings by id, so every build
+    // continues the string table of the previous one. Strings the build
+    // doesn't refer to are removed, and their ids are not handed out
+    // again.
+    StringTable::Ptr stringTable;
+
+    uint32_t numReusedFunctions = 0;
+    uint32_t numBuiltFunctions = 0;
+};
+
+/**
+ * Recursive descent parser for the language in grammar/CM.g4, building
+ * the Ast in a single pass over the tokens of NativeLexer.
+ *
+ * The nodes are created in the same order and from the same
+ * DeclarationContext state as the TreeConverter creates them from the
+ * ANTLR parse tree, so both produce the same Ast and report the same
+ * semantic errors. Where the grammar is ambiguous, the alternative ANTLR
+ * predicts is chosen.
+ *
+ * Every syntax error is added to the error list. After an error, the
+ * parser skips to the end of the statement or root item it was in and
+ * carries on, so that the errors after it are found as well. Once the
+ * source has been parsed, the errors are thrown as a
+ * SyntaxErrorException. Other errors are only thrown if the source has no
+ * syntax errors, as the ANTLR frontend only builds the Ast of sources
+ * without them.
+ */
+class NativeParser
+{
+public:
+    NativeParser(const std::string &source,
+                 const std::vector<Token> &tokens,
+                 std::vector<CompilationError> *errors,
+                 ModuleContext::Ptr moduleContext,
+                 const BuildCache *previousBuild = nullptr);
+
+    /**
+     * Parse function bodies on up to 'numThreads' threads. Bodies are
+     * only parsed in parallel when the source is large enough to pay for
+     * the threads, and never in incremental builds.
+     */
+    void setNumThreads(uint32_t numThreads);
+
+    Ast::Ptr parse();
+
+    /**
+     * The cache for the next incremental build. Only available after a
+     * successful parse() with a previous build.
+     */
+    std::unique_ptr<BuildCache> takeBuildCache();
+
+private:
+    // A function body deferred by the first pass over the root items
+    struct PendingBody
+    {
+        FunctionDefinition::Ptr funcDef;
+        FuncDeclaration funcDecl;
+        size_t firstToken;
+        uint32_t numDeclarations;
+
+        std::vector<std::pair<StringLiteralExpression::Ptr,std::string>> stringLiterals;
+        std::vector<CompilationError> errors;
+        std::exception_ptr exception;
+    };
+
+    // Recovery restarts after the statement or root item that failed
+    struct RecoveryPoint
+    {
+        size_t firstToken;
+        DeclarationContext::Nesting nesting;
+    };
+
+    const std::string &_source;
+    const std::vector<Token> &_tokens;
+    std::vector<CompilationError> *_errors;
+    size_t _pos;
+
+    // The arenas must outlive every node, so they are declared first.
+    // Deferred bodies are parsed into an arena per thread.
+    AstArena::Ptr _arena;
+    std::vector<AstArena::Ptr> _bodyArenas;
+
+    DeclarationContext _declContext;
+    StringTable::Ptr _stringTable;
+    DataSegment::Ptr _dataSegment;
+    std::vector<FuncDeclaration> _funcDecls;
+    ModuleContext::Ptr _moduleContext;
+    std::set<std::string> _includedModules;
+
+    const BuildCache *_previousBuild;
+    std::unique_ptr<BuildCache> _buildCache;
+    bool _declarationsMatch;
+
+    uint32_t _numThreads;
+    bool _deferBodies;
+    std::vector<PendingBody> _pendingBodies;
+
+    // The ids of the string literals in the Ast, kept in incremental
+    // builds only
+    std::vector<StringId> _referencedStrings;
+
+    // The first error that is not a syntax error
+    std::exception_ptr _semanticError;
+
+    // Set in the parsers of deferred bodies
+    const DeclarationContext *_rootContext;
+    std::vector<std::pair<StringLiteralExpression::Ptr,std::string>> *_stringLiterals;
+
+    NativeParser(const NativeParser &parent, AstArena::Ptr arena);
+
+    const Token& peek(size_t ahead = 0) const;
+    bool check(Token::Type type) const;
+    bool accept(Token::Type type);
+    const Token& expect(Token::Type type);
+    std::string getText(const Token &token) const;
+    [[noreturn]] void syntaxError(const std::string &message);
+    RecoveryPoint getRecoveryPoint() const;
+    void recover(const RecoveryPoint &point);
+    size_t findEndOfItem(size_t firstToken) const;
+    bool hasFailed(size_t numErrors) const;
+    bool isTypeStart(size_t ahead = 0) const;
+    bool isAtomStart() const;
+
+    // Whether the token can start an operand other than a dereference
+    bool isOperandStart(size_t ahead = 0) const;
+
+    void parseRootItem(Ast *ast);
+    bool reuseStruct(Ast *ast, size_t start);
+    bool reuseFunctionDefinition(Ast *ast, const FuncDeclaration &funcDecl);
+    void addDeclaration(size_t startToken);
+    size_t findClosingBrace(size_t openToken) const;
+    std::string getSource(size_t firstToken, size_t endToken) const;
+    StructLayout::Ptr parseStructDeclaration();
+    vm::Callable::Ptr parseFunctionDefinition(const FuncDeclaration &funcDecl);
+    void cacheFunctionDefinition(Ast *ast, const FuncDeclaration &funcDecl);
+    void removeUnreferencedStrings();
+    void parseFunctionBody(FunctionDefinition::Ptr funcDef, const FuncDeclaration &funcDecl);
+    bool deferFunctionBody(Ast *ast, const FuncDeclaration &funcDecl);
+    bool parseDeferredBodies();
+    void parseDeferredBody(PendingBody *body);
+    std::vector<VarDeclaration> parseIdentifierList();
+    VarDeclaration parseFunctionParameter();
+    TypeDecl parseTypeIdentifier(bool stopBeforeOperand = false);
+
+    Statement::Ptr parseStatement();
+    Statement::Ptr parseStatementOrRecover();
+    std::vector<Statement::Ptr> parseBlockOrStatement();
+    Statement::Ptr parseIfStatement();
+    ElseStatement::Ptr parseElseStatement();
+    Statement::Ptr parseForStatement();
+    Statement::Ptr parseWhileStatement();
+    Statement::Ptr parseDoWhileStatement();
+    Statement::Ptr parseSwitchStatement();
+    Statement::Ptr parseReturnStatement();
+    Statement::Ptr parseVariableDeclaration();
+    Statement::Ptr parseAssignment(bool allowArithmetic, bool allowExpression);
+
+    Expression::Ptr parseExpression(int minPrecedence = 1, Expression::Ptr primary = nullptr);
+    Expression::Ptr parseUnary();
+    Expression::Ptr parsePostfix(Expression::Ptr expr);
+    Expression::Ptr parseAtom();
+    Expression::Ptr parseSizeof();
+    Expression::Ptr parseSizeofTerm(TypeDecl *type, bool parenthesized);
+    Expression::Ptr parseFunctionCall();
+    Expression::Ptr parseStringLiteral();
+
+    Lvalue::Ptr castToLvalue(Expression::Ptr expr);
+
+    void verifyAllFunctionsDefined(Ast *ast);
+    void includeModule(Ast *ast, std::string moduleName);
+};
+
+}
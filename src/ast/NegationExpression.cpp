@@ -13,9 +13,30 @@ ExpressionValue NegationExpression::evaluate(vm::ExecutionContext *context) cons
     return !(toNegate.get<bool>());
 }
 
+bool NegationExpression::isConstant() const
+{
+    return _expression->isConstant();
+}
+
 TypeDecl NegationExpression::getType() const
 {
     return TypeDecl::BOOL;
 }
 
+void NegationExpression::forEachChild(const ChildVisitor &visitor) const
+{
+    visitor(_expression.get());
+}
+
+bool NegationExpression::isEquivalent(const Expression *other) const
+{
+    auto negation = dynamic_cast<const NegationExpression*>(other);
+    return negation != nullptr && _expression->isEquivalent(negation->_expression.get());
+}
+
+void NegationExpression::rewriteExpressions(const ExpressionRewriter &rewriter)
+{
+    rewriter(_expression);
+}
+
 }
\ No newline at end of file
@@ -12,6 +12,10 @@ public:
 
     ExpressionValue evaluate(vm::ExecutionContext *context) const override;
 	TypeDecl getType() const override;
+	bool isConstant() const override;
+    void forEachChild(const ChildVisitor &visitor) const override;
+    bool isEquivalent(const Expression *other) const override;
+    void rewriteExpressions(const ExpressionRewriter &rewriter) override;
 
 private:
     Expression::Ptr _expression;
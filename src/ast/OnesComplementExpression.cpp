@@ -19,6 +19,11 @@ ExpressionValue OnesComplementExpression::evaluate(vm::ExecutionContext *context
     return ExpressionValue(TypeDecl::INT, flipped);
 }
 
+bool OnesComplementExpression::isConstant() const
+{
+    return _expression->isConstant();
+}
+
 TypeDecl OnesComplementExpression::getType() const
 {
     /*
@@ -36,4 +41,20 @@ TypeDecl OnesComplementExpression::getType() const
     return TypeDecl::INT;
 }
 
+void OnesComplementExpression::forEachChild(const ChildVisitor &visitor) const
+{
+    visitor(_expression.get());
+}
+
+bool OnesComplementExpression::isEquivalent(const Expression *other) const
+{
+    auto complement = dynamic_cast<const OnesComplementExpression*>(other);
+    return complement != nullptr && _expression->isEquivalent(complement->_expression.get());
+}
+
+void OnesComplementExpression::rewriteExpressions(const ExpressionRewriter &rewriter)
+{
+    rewriter(_expression);
+}
+
 }
@@ -1,12 +1,64 @@
 #include "ParseContext.h"
 #include "AntlrContext.h"
+#include "NativeContext.h"
+
+#include <sstream>
 
 namespace cish::ast
 {
 
-ParseContext::Ptr ParseContext::parseSource(const std::string &source)
+// Covers the common constructs, so that the prediction cache has the
+// decisions for them by the time a real program is parsed.
+static const char *WARMUP_SOURCE =
+    "#include <stdio.h>\n"
+    "struct node { int value; struct node *next; };\n"
+    "int count = 0;\n"
+    "double scale(double d, float f) { return d * f / 2.0 - 1; }\n"
+    "int sum(struct node *head) {\n"
+    "    int total = 0;\n"
+    "    for (struct node *n = head; n != NULL; n = n->next) { total += n->value; }\n"
+    "    return total;\n"
+    "}\n"
+    "int main(int argc, char **argv) {\n"
+    "    struct node a; a.value = 1; a.next = NULL;\n"
+    "    int i = 0; long l = 2; char c = 'x'; bool b = true;\n"
+    "    while (i < 10 && !(i == 5 || i >= 7)) { i++; if (i % 2) { continue; } else { break; } }\n"
+    "    do { --i; } while (i > 0);\n"
+    "    switch (argc) { case 1: count = sizeof(int); break; default: count = -1; }\n"
+    "    int *p = &i; *p = (int)scale(1.5, 2.0) << 1 | (c & 0x0f) ^ ~l;\n"
+    "    printf(\"%d %s\\n\", sum(&a), argv[0]);\n"
+    "    return i;\n"
+    "}\n";
+
+
+ParseContext::Ptr ParseContext::parseSource(const std::string &source, Frontend frontend, uint32_t numThreads)
 {
+    if (frontend == Frontend::NATIVE) {
+        return std::make_shared<NativeContext>(source, numThreads);
+    }
+
     return std::make_shared<AntlrContext>(source);
 }
 
+void ParseContext::warmUp()
+{
+    parseSource(WARMUP_SOURCE);
+}
+
+void ParseContext::throwSyntaxErrors(const std::vector<CompilationError> &errors)
+{
+    std::stringstream ss;
+    ss << "There are syntax errors:";
+
+    for (auto err: errors) {
+        ss  << std::endl
+            << "Syntax error on line "
+            << err.lineNumber << ", near char "
+            << err.charNumber << ":" << err.message;
+    }
+
+    std::string errorStr = ss.str();
+    Throw(SyntaxErrorException, "%s", errorStr.c_str());
+}
+
 }
\ No newline at end of file
@@ -1,16 +1,20 @@
 #pragma once
 
+#include "../Exception.h"
+#include "../module/ModuleContext.h"
+
+#include <memory>
 #include <string>
 #include <vector>
 
-namespace antlr4::tree
-{
-class ParseTree;
-}
 
 namespace cish::ast
 {
 
+DECLARE_EXCEPTION(SyntaxErrorException);
+
+class Ast;
+
 struct CompilationError
 {
     std::string message;
@@ -27,11 +31,46 @@ class ParseContext
 public:
     typedef std::shared_ptr<ParseContext> Ptr;
 
-    static Ptr parseSource(const std::string &source);
+    enum class Frontend
+    {
+        // The ANTLR generated parser, see AntlrContext
+        ANTLR,
+
+        // The hand written parser, see NativeContext
+        NATIVE,
+    };
+
+    /**
+     * 'numThreads' is the number of threads the native frontend may
+     * build the Ast on, the ANTLR frontend always uses one.
+     */
+    static Ptr parseSource(const std::string &source,
+                           Frontend frontend = Frontend::ANTLR,
+                           uint32_t numThreads = 1);
+
+    /**
+     * The lexer and parser share their prediction caches between every
+     * source parsed by the process, and the first sources parsed spend
+     * most of their time filling them. Parse a representative program to
+     * get that out of the way, e.g. before forking off workers.
+     */
+    static void warmUp();
+
+    /**
+     * Throw a SyntaxErrorException listing every error.
+     */
+    [[noreturn]] static void throwSyntaxErrors(const std::vector<CompilationError> &errors);
+
+    virtual ~ParseContext() = default;
 
     virtual bool hasErrors() const = 0;
     virtual std::vector<CompilationError> getErrors() const = 0;
-    virtual antlr4::tree::ParseTree* getParseTree() const = 0;
+
+    /**
+     * Build the Ast of the parsed source. Must not be called if there
+     * are errors.
+     */
+    virtual std::shared_ptr<Ast> buildAst(module::ModuleContext::Ptr moduleContext) = 0;
 };
 
 }
@@ -0,0 +1,402 @@
+#include "RedundancyEliminator.h"
+#include "AddrofExpression.h"
+#include "ArithmeticAssignmentStatement.h"
+#include "CachedExpression.h"
+#include "ExpressionStatement.h"
+#include "ForLoopStatement.h"
+#include "FunctionCallExpression.h"
+#include "FunctionDefinition.h"
+#include "IfStatement.h"
+#include "IncDecExpression.h"
+#include "ReturnStatement.h"
+#include "StructAccessExpression.h"
+#include "SwitchStatement.h"
+#include "VariableAssignmentStatement.h"
+#include "VariableDeclarationStatement.h"
+#include "WhileStatement.h"
+
+#include <algorithm>
+
+
+namespace cish::ast
+{
+
+static bool isLoop(const Statement *statement)
+{
+    return dynamic_cast<const ForLoopStatement*>(statement) != nullptr
+        || dynamic_cast<const WhileStatement*>(statement) != nullptr;
+}
+
+// Statements whose own expressions are evaluated once before any of their
+// child statements
+static bool isBranch(const Statement *statement)
+{
+    return dynamic_cast<const IfStatement*>(statement) != nullptr
+        || dynamic_cast<const SwitchStatement*>(statement) != nullptr;
+}
+
+static bool isSimple(const Statement *statement)
+{
+    return dynamic_cast<const ExpressionStatement*>(statement) != nullptr
+        || dynamic_cast<const VariableAssignmentStatement*>(statement) != nullptr
+        || dynamic_cast<const ArithmeticAssignmentStatement*>(statement) != nullptr
+        || dynamic_cast<const VariableDeclarationStatement*>(statement) != nullptr
+        || dynamic_cast<const ReturnStatement*>(statement) != nullptr;
+}
+
+static bool isMemoryAccess(const AstNode *node)
+{
+    return dynamic_cast<const DereferenceExpression*>(node) != nullptr
+        || dynamic_cast<const SubscriptExpression*>(node) != nullptr
+        || dynamic_cast<const StructAccessExpression*>(node) != nullptr;
+}
+
+static bool containsAccessOrCall(const AstNode *node)
+{
+    if (isMemoryAccess(node) || dynamic_cast<const FunctionCallExpression*>(node)) {
+        return true;
+    }
+
+    bool found = false;
+    node->forEachChild([&](const AstNode *child) {
+        found = found || containsAccessOrCall(child);
+    });
+
+    return found;
+}
+
+static void collectNodes(const AstNode *node, std::set<const AstNode*> *nodes)
+{
+    nodes->insert(node);
+    node->forEachChild([nodes](const AstNode *child) { collectNodes(child, nodes); });
+}
+
+
+RedundancyEliminator::RedundancyEliminator(Ast *ast):
+    _ast(ast),
+    _nextSlot(0),
+    _hoistedExpressions(0),
+    _commonSubexpressions(0)
+{
+}
+
+void RedundancyEliminator::run()
+{
+    for (const Statement::Ptr &statement: _ast->getRootStatements()) {
+        if (auto varDecl = dynamic_cast<const VariableDeclarationStatement*>(statement.get())) {
+            _globals.insert(varDecl->getSymbol());
+        }
+    }
+
+    for (const vm::Callable::Ptr &callable: _ast->getFunctionDefinitions()) {
+        if (auto funcDef = dynamic_cast<const FunctionDefinition*>(callable.get())) {
+            optimizeFunction(funcDef);
+        }
+    }
+}
+
+uint32_t RedundancyEliminator::getHoistedExpressionCount() const
+{
+    return _hoistedExpressions;
+}
+
+uint32_t RedundancyEliminator::getCommonSubexpressionCount() const
+{
+    return _commonSubexpressions;
+}
+
+void RedundancyEliminator::optimizeFunction(const FunctionDefinition *funcDef)
+{
+    // Cache slots are numbered per function frame
+    _nextSlot = 0;
+    findRegisterVariables(funcDef);
+    optimizeStatements(funcDef);
+}
+
+void RedundancyEliminator::findRegisterVariables(const FunctionDefinition *funcDef)
+{
+    _registerVariables.clear();
+    std::set<SymbolId> exposed = _globals;
+
+    for (const VarDeclaration &param: funcDef->getDeclaration()->params) {
+        if (param.name.empty()) {
+            continue;
+        } else if (param.type == TypeDecl::STRUCT) {
+            exposed.insert(Symbol::intern(param.name));
+        } else {
+            _registerVariables.insert(Symbol::intern(param.name));
+        }
+    }
+
+    std::function<void(const AstNode*)> visit = [&](const AstNode *node) {
+        if (auto varDecl = dynamic_cast<const VariableDeclarationStatement*>(node)) {
+            if (varDecl->getDeclaredType() == TypeDecl::STRUCT) {
+                exposed.insert(varDecl->getSymbol());
+            } else {
+                _registerVariables.insert(varDecl->getSymbol());
+            }
+        } else if (auto addrof = dynamic_cast<const AddrofExpression*>(node)) {
+            if (auto ref = dynamic_cast<const VariableReference*>(addrof->getLvalue())) {
+                exposed.insert(ref->getSymbol());
+            }
+        }
+
+        node->forEachChild(visit);
+    };
+
+    funcDef->forEachChild(visit);
+
+    // Shadowing a global or another local whose address is taken makes
+    // the name ambiguous, so all variables of that name are memory
+    for (SymbolId symbol: exposed) {
+        _registerVariables.erase(symbol);
+    }
+}
+
+void RedundancyEliminator::optimizeStatements(const AstNode *node)
+{
+    node->forEachChild([this](const AstNode *child) {
+        auto statement = dynamic_cast<const Statement*>(child);
+        if (statement == nullptr) {
+            return;
+        }
+
+        // The nodes belong to the Ast being built, and are not shared
+        // with anything else yet
+        Statement *mutableStatement = const_cast<Statement*>(statement);
+
+        if (isLoop(statement)) {
+            hoistInvariants(mutableStatement);
+            optimizeStatements(statement);
+        } else if (isBranch(statement)) {
+            eliminateCommonSubexpressions(mutableStatement, true);
+            optimizeStatements(statement);
+        } else if (isSimple(statement)) {
+            eliminateCommonSubexpressions(mutableStatement, false);
+        } else {
+            optimizeStatements(statement);
+        }
+    });
+}
+
+void RedundancyEliminator::hoistInvariants(Statement *loop)
+{
+    // The initialization of a for-loop runs once before the loop, so the
+    // variables it assigns are still invariant
+    auto forLoop = dynamic_cast<const ForLoopStatement*>(loop);
+    const Statement *init = forLoop ? forLoop->getInitialization() : nullptr;
+
+    Effects loopEffects;
+    loop->forEachChild([&](const AstNode *child) {
+        if (child != init) {
+            collectEffects(child, &loopEffects);
+        }
+    });
+
+    const uint32_t firstSlot = _nextSlot;
+    std::vector<const Expression*> hoisted;
+
+    forEachRvalue(loop, [&](Expression::Ptr &expr) {
+        if (!isWorthCaching(expr.get())) {
+            return false;
+        }
+
+        Effects exprEffects;
+        collectEffects(expr.get(), &exprEffects);
+
+        if (exprEffects.hasSideEffects || (exprEffects.readsMemory && loopEffects.writesMemory)) {
+            return false;
+        }
+
+        for (SymbolId symbol: exprEffects.readVariables) {
+            if (loopEffects.writtenVariables.count(symbol) != 0) {
+                return false;
+            }
+        }
+
+        // Equivalent invariants share their slot
+        uint32_t slot = 0;
+        auto it = std::find_if(hoisted.begin(), hoisted.end(), [&](const Expression *other) {
+            return other->isEquivalent(expr.get());
+        });
+
+        if (it != hoisted.end()) {
+            slot = firstSlot + (it - hoisted.begin());
+        } else {
+            slot = _nextSlot++;
+            hoisted.push_back(expr.get());
+        }
+
+        expr = std::make_shared<CachedExpression>(expr, slot);
+        _hoistedExpressions++;
+        return true;
+    }, init);
+
+    if (_nextSlot != firstSlot) {
+        loop->setCacheSlots(firstSlot, _nextSlot - firstSlot);
+    }
+}
+
+void RedundancyEliminator::eliminateCommonSubexpressions(Statement *statement, bool onlyOwnExpressions)
+{
+    std::vector<Expression::Ptr*> candidates;
+    Effects effects;
+
+    const RvalueVisitor collect = [&](Expression::Ptr &expr) {
+        if (isWorthCaching(expr.get())) {
+            candidates.push_back(&expr);
+        }
+        return false;
+    };
+
+    // Only the expressions evaluated before the child statements of a
+    // branch are considered, as the children may change them
+    if (onlyOwnExpressions) {
+        statement->rewriteExpressions([&](Expression::Ptr &expr) {
+            collectEffects(expr.get(), &effects);
+            visitRvalue(expr, collect);
+        });
+    } else {
+        collectEffects(statement, &effects);
+        forEachRvalue(statement, collect);
+    }
+
+    // Values can't change in the middle of the statement, as long as it
+    // doesn't change anything until it stores its result
+    if (effects.hasSideEffects) {
+        return;
+    }
+
+    const uint32_t firstSlot = _nextSlot;
+    std::set<const AstNode*> cached;
+
+    // Candidates are in pre-order, so the largest common expressions are
+    // found first, and the expressions inside them are skipped
+    for (size_t i=0; i<candidates.size(); i++) {
+        const Expression *candidate = candidates[i]->get();
+        if (cached.count(candidate) != 0) {
+            continue;
+        }
+
+        std::vector<Expression::Ptr*> matches = { candidates[i] };
+        for (size_t j=i+1; j<candidates.size(); j++) {
+            const Expression *other = candidates[j]->get();
+            if (cached.count(other) == 0 && candidate->isEquivalent(other)) {
+                matches.push_back(candidates[j]);
+            }
+        }
+
+        if (matches.size() < 2) {
+            continue;
+        }
+
+        const uint32_t slot = _nextSlot++;
+        for (Expression::Ptr *match: matches) {
+            collectNodes(match->get(), &cached);
+            *match = std::make_shared<CachedExpression>(*match, slot);
+        }
+
+        _commonSubexpressions++;
+    }
+
+    if (_nextSlot != firstSlot) {
+        statement->setCacheSlots(firstSlot, _nextSlot - firstSlot);
+    }
+}
+
+void RedundancyEliminator::collectEffects(const AstNode *node, Effects *effects) const
+{
+    if (auto ref = dynamic_cast<const VariableReference*>(node)) {
+        effects->readVariables.insert(ref->getSymbol());
+        if (_registerVariables.count(ref->getSymbol()) == 0) {
+            effects->readsMemory = true;
+        }
+    } else if (isMemoryAccess(node)) {
+        effects->readsMemory = true;
+    } else if (auto call = dynamic_cast<const FunctionCallExpression*>(node)) {
+        const vm::Callable::Ptr callee = _ast->getFunctionDefinition(call->getFunctionSymbol());
+        const FuncDeclaration::Effects calleeEffects = callee ? callee->getDeclaration()->effects
+                                                              : FuncDeclaration::ANY;
+        effects->readsMemory |= calleeEffects >= FuncDeclaration::PURE;
+        effects->hasSideEffects |= calleeEffects >= FuncDeclaration::IO;
+        effects->writesMemory |= calleeEffects >= FuncDeclaration::ANY;
+    } else if (auto incDec = dynamic_cast<const IncDecExpression*>(node)) {
+        effects->hasSideEffects = true;
+        collectWrite(incDec->getLvalue(), effects);
+    } else if (auto assignment = dynamic_cast<const VariableAssignmentStatement*>(node)) {
+        collectWrite(assignment->getLvalue(), effects);
+    } else if (auto assignment = dynamic_cast<const ArithmeticAssignmentStatement*>(node)) {
+        collectWrite(assignment->getLvalue(), effects);
+    } else if (auto varDecl = dynamic_cast<const VariableDeclarationStatement*>(node)) {
+        // A declaration inside a loop is a new variable every iteration
+        effects->writtenVariables.insert(varDecl->getSymbol());
+        if (_registerVariables.count(varDecl->getSymbol()) == 0) {
+            effects->writesMemory = true;
+        }
+    }
+
+    node->forEachChild([this, effects](const AstNode *child) { collectEffects(child, effects); });
+}
+
+void RedundancyEliminator::collectWrite(const Lvalue *lvalue, Effects *effects) const
+{
+    auto ref = dynamic_cast<const VariableReference*>(lvalue);
+    if (ref == nullptr) {
+        effects->writesMemory = true;
+        return;
+    }
+
+    effects->writtenVariables.insert(ref->getSymbol());
+    if (_registerVariables.count(ref->getSymbol()) == 0) {
+        effects->writesMemory = true;
+    }
+}
+
+bool RedundancyEliminator::isWorthCaching(const Expression *expr) const
+{
+    if (dynamic_cast<const CachedExpression*>(expr) || expr->isConstant()) {
+        return false;
+    }
+
+    // Struct values are addresses of temporaries, which don't outlive the
+    // statement producing them
+    const TypeDecl type = expr->getType();
+    if (type == TypeDecl::STRUCT || type == TypeDecl::VOID) {
+        return false;
+    }
+
+    return containsAccessOrCall(expr);
+}
+
+void RedundancyEliminator::forEachRvalue(AstNode *node, const RvalueVisitor &visitor, const AstNode *exclude)
+{
+    std::vector<const AstNode*> rvalues;
+    node->rewriteExpressions([&](Expression::Ptr &expr) {
+        rvalues.push_back(expr.get());
+        visitRvalue(expr, visitor);
+    });
+
+    // Statements and lvalues are walked through, but never replaced
+    node->forEachChild([&](const AstNode *child) {
+        if (child == exclude || std::find(rvalues.begin(), rvalues.end(), child) != rvalues.end()) {
+            return;
+        }
+
+        if (dynamic_cast<const CachedExpression*>(child) == nullptr) {
+            forEachRvalue(const_cast<AstNode*>(child), visitor);
+        }
+    });
+}
+
+void RedundancyEliminator::visitRvalue(Expression::Ptr &expr, const RvalueVisitor &visitor)
+{
+    if (dynamic_cast<const CachedExpression*>(expr.get())) {
+        return;
+    }
+
+    if (!visitor(expr)) {
+        forEachRvalue(expr.get(), visitor);
+    }
+}
+
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "Ast.h"
+#include "Lvalue.h"
+
+#include <functional>
+#include <set>
+#include <vector>
+
+
+namespace cish::ast
+{
+
+/**
+ * Avoids evaluating the same expression again when its value can't have
+ * changed, by wrapping it in a CachedExpression:
+ *
+ *  - Expressions inside a loop whose inputs the loop never changes are
+ *    evaluated once per entry into the loop, such as 'strlen(s)' in the
+ *    condition of a loop which doesn't write any memory.
+ *  - Equivalent expressions within one statement are evaluated once, such
+ *    as the two 'a[i]' in 'x = a[i] * a[i]'.
+ *
+ * Only expressions reading memory or calling functions are cached.
+ *
+ * Whether a value can change is decided by a simple alias model. Locals
+ * whose address is never taken can only be changed by name. Everything
+ * else is memory, which any write through a pointer, assignment to a
+ * global or call to a function which may write memory can change, see
+ * FuncDeclaration::Effects.
+ */
+class RedundancyEliminator
+{
+public:
+    RedundancyEliminator(Ast *ast);
+
+    void run();
+
+    uint32_t getHoistedExpressionCount() const;
+    uint32_t getCommonSubexpressionCount() const;
+
+private:
+    /**
+     * What evaluating a part of a function may read and change.
+     */
+    struct Effects
+    {
+        std::set<SymbolId> readVariables;
+        std::set<SymbolId> writtenVariables;
+        bool readsMemory = false;
+        bool writesMemory = false;
+
+        // Whether evaluating an expression changes anything. Statements
+        // assigning or declaring a variable don't count by themselves.
+        bool hasSideEffects = false;
+    };
+
+    // Returns true if the expression was replaced
+    typedef std::function<bool(Expression::Ptr&)> RvalueVisitor;
+
+    Ast *_ast;
+    std::set<SymbolId> _globals;
+
+    // The locals of the current function which can only change by name
+    std::set<SymbolId> _registerVariables;
+    uint32_t _nextSlot;
+
+    uint32_t _hoistedExpressions;
+    uint32_t _commonSubexpressions;
+
+    void optimizeFunction(const FunctionDefinition *funcDef);
+    void findRegisterVariables(const FunctionDefinition *funcDef);
+    void optimizeStatements(const AstNode *node);
+    void hoistInvariants(Statement *loop);
+    void eliminateCommonSubexpressions(Statement *statement, bool onlyOwnExpressions);
+
+    void collectEffects(const AstNode *node, Effects *effects) const;
+    void collectWrite(const Lvalue *lvalue, Effects *effects) const;
+    bool isWorthCaching(const Expression *expr) const;
+
+    void forEachRvalue(AstNode *node, const RvalueVisitor &visitor, const AstNode *exclude = nullptr);
+    void visitRvalue(Expression::Ptr &expr, const RvalueVisitor &visitor);
+};
+
+}
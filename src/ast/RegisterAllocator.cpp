@@ -0,0 +1,131 @@
+#include "RegisterAllocator.h"
+#include "AddrofExpression.h"
+#include "DeclarationContext.h"
+#include "FunctionDefinition.h"
+#include "Lvalue.h"
+#include "VariableDeclarationStatement.h"
+
+
+namespace cish::ast
+{
+
+static void markLocal(std::vector<bool> *escapes, uint32_t localIndex, bool escaping)
+{
+    if (localIndex == DeclarationContext::NOT_LOCAL) {
+        return;
+    }
+
+    if (localIndex >= escapes->size()) {
+        escapes->resize(localIndex + 1, false);
+    }
+
+    if (escaping) {
+        (*escapes)[localIndex] = true;
+    }
+}
+
+
+RegisterAllocator::RegisterAllocator(Ast *ast):
+    _ast(ast),
+    _registerVariables(0),
+    _memoryVariables(0)
+{
+}
+
+void RegisterAllocator::run()
+{
+    for (const vm::Callable::Ptr &callable: _ast->getFunctionDefinitions()) {
+        if (auto funcDef = dynamic_cast<const FunctionDefinition*>(callable.get())) {
+            // The nodes belong to the Ast being built, and are not shared
+            // with anything else yet
+            allocateFunction(const_cast<FunctionDefinition*>(funcDef));
+        }
+    }
+}
+
+uint32_t RegisterAllocator::getRegisterVariableCount() const
+{
+    return _registerVariables;
+}
+
+uint32_t RegisterAllocator::getMemoryVariableCount() const
+{
+    return _memoryVariables;
+}
+
+void RegisterAllocator::allocateFunction(FunctionDefinition *funcDef)
+{
+    // The named parameters are the first locals of the function
+    const std::vector<VarDeclaration> &params = funcDef->getDeclaration()->params;
+    std::vector<uint32_t> paramLocals;
+    std::vector<bool> escapes;
+
+    for (const VarDeclaration &param: params) {
+        if (param.name.empty()) {
+            paramLocals.push_back(DeclarationContext::NOT_LOCAL);
+        } else {
+            paramLocals.push_back((uint32_t)escapes.size());
+            escapes.push_back(param.type == TypeDecl::STRUCT);
+        }
+    }
+
+    findEscapingLocals(funcDef, &escapes);
+
+    std::vector<uint32_t> registers(escapes.size(), VariableReference::NO_REGISTER);
+    uint32_t registerCount = 0;
+
+    for (size_t i=0; i<escapes.size(); i++) {
+        if (escapes[i]) {
+            _memoryVariables++;
+        } else {
+            registers[i] = registerCount++;
+            _registerVariables++;
+        }
+    }
+
+    std::vector<uint32_t> paramRegisters;
+    for (uint32_t local: paramLocals) {
+        paramRegisters.push_back(local != DeclarationContext::NOT_LOCAL
+                                 ? registers[local]
+                                 : VariableReference::NO_REGISTER);
+    }
+
+    assignRegisters(funcDef, registers);
+    funcDef->setRegisters(registerCount, paramRegisters);
+}
+
+void RegisterAllocator::findEscapingLocals(const AstNode *node, std::vector<bool> *escapes) const
+{
+    if (auto varDecl = dynamic_cast<const VariableDeclarationStatement*>(node)) {
+        markLocal(escapes, varDecl->getLocalIndex(), varDecl->getDeclaredType() == TypeDecl::STRUCT);
+    } else if (auto ref = dynamic_cast<const VariableReference*>(node)) {
+        markLocal(escapes, ref->getLocalIndex(), ref->getType() == TypeDecl::STRUCT);
+    } else if (auto addrof = dynamic_cast<const AddrofExpression*>(node)) {
+        if (auto ref = dynamic_cast<const VariableReference*>(addrof->getLvalue())) {
+            markLocal(escapes, ref->getLocalIndex(), true);
+        }
+    }
+
+    node->forEachChild([&](const AstNode *child) {
+        findEscapingLocals(child, escapes);
+    });
+}
+
+void RegisterAllocator::assignRegisters(const AstNode *node, const std::vector<uint32_t> &registers) const
+{
+    if (auto varDecl = dynamic_cast<const VariableDeclarationStatement*>(node)) {
+        if (varDecl->getLocalIndex() != DeclarationContext::NOT_LOCAL) {
+            const_cast<VariableDeclarationStatement*>(varDecl)->setRegister(registers[varDecl->getLocalIndex()]);
+        }
+    } else if (auto ref = dynamic_cast<const VariableReference*>(node)) {
+        if (ref->getLocalIndex() != DeclarationContext::NOT_LOCAL) {
+            const_cast<VariableReference*>(ref)->setRegister(registers[ref->getLocalIndex()]);
+        }
+    }
+
+    node->forEachChild([&](const AstNode *child) {
+        assignRegisters(child, registers);
+    });
+}
+
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "Ast.h"
+
+#include <vector>
+
+
+namespace cish::ast
+{
+
+class FunctionDefinition;
+
+/**
+ * Keeps the locals which never escape their function in registers of the
+ * function frame rather than in memory, see
+ * ExecutionContext::allocateRegisters(). A local escapes if its address
+ * is taken. Structs always live in memory, as they are passed around by
+ * their address.
+ *
+ * Accessing a register is a plain copy into or out of the frame, rather
+ * than a lookup of the variable by name and a checked access to Memory.
+ *
+ * Locals are told apart by their index in the function, so a local which
+ * shadows another, or a global, is allocated on its own.
+ */
+class RegisterAllocator
+{
+public:
+    RegisterAllocator(Ast *ast);
+
+    void run();
+
+    uint32_t getRegisterVariableCount() const;
+    uint32_t getMemoryVariableCount() const;
+
+private:
+    Ast *_ast;
+
+    uint32_t _registerVariables;
+    uint32_t _memoryVariables;
+
+    void allocateFunction(FunctionDefinition *funcDef);
+    void findEscapingLocals(const AstNode *node, std::vector<bool> *escapes) const;
+    void assignRegisters(const AstNode *node, const std::vector<uint32_t> &registers) const;
+};
+
+}
@@ -35,7 +35,12 @@ ReturnStatement::ReturnStatement(DeclarationContext *context, Expression::Ptr ex
     }
 }
 
-void ReturnStatement::virtualExecute(vm::ExecutionContext *context) const
+const Expression* ReturnStatement::getExpression() const
+{
+    return _expression.get();
+}
+
+Completion ReturnStatement::virtualExecute(vm::ExecutionContext *context) const
 {
     if (_expression) {
         ExpressionValue value = getReturnValue(context);
@@ -43,6 +48,8 @@ void ReturnStatement::virtualExecute(vm::ExecutionContext *context) const
     } else {
         context->returnCurrentFunction(TypeDecl::VOID);
     }
+
+    return Completion::RETURN;
 }
 
 ExpressionValue ReturnStatement::getReturnValue(vm::ExecutionContext *context) const
@@ -63,14 +70,32 @@ ExpressionValue ReturnStatement::getReturnValue(vm::ExecutionContext *context) c
     // the struct being returned is allocated on the stack and will be
     // freed shortly!
     const uint32_t sourceAddr = value.get<uint32_t>();
-    const uint32_t size = type.getSize();
-    vm::MemoryView sourceView = context->getMemory()->getView(sourceAddr);
-    const uint8_t *sourceBuf = sourceView.readBuf(size);
-
     vm::Variable *returnBuffer = context->getCurrentFunctionReturnBuffer();
-    returnBuffer->getAllocation()->writeBuf(sourceBuf, size);
+
+    // The return buffer may be the very variable being returned, such as
+    // '*p' when the call is assigned to what 'p' points to
+    if (sourceAddr != returnBuffer->getHeapAddress()) {
+        const uint32_t size = type.getSize();
+        vm::MemoryView sourceView = context->getMemory()->getView(sourceAddr);
+        const uint8_t *sourceBuf = sourceView.readBuf(size);
+        returnBuffer->getAllocation()->writeBuf(sourceBuf, size);
+    }
 
     return ExpressionValue(type, returnBuffer->getHeapAddress());
 }
 
+void ReturnStatement::forEachChild(const ChildVisitor &visitor) const
+{
+    if (_expression) {
+        visitor(_expression.get());
+    }
+}
+
+void ReturnStatement::rewriteExpressions(const ExpressionRewriter &rewriter)
+{
+    if (_expression) {
+        rewriter(_expression);
+    }
+}
+
 }
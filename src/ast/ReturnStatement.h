@@ -12,9 +12,12 @@ class ReturnStatement: public Statement
 {
 public:
     ReturnStatement(DeclarationContext *context, Expression::Ptr expr);
+    const Expression* getExpression() const;
+    virtual void forEachChild(const ChildVisitor &visitor) const override;
+    virtual void rewriteExpressions(const ExpressionRewriter &rewriter) override;
 
 protected:
-    virtual void virtualExecute(vm::ExecutionContext *context) const override;
+    virtual Completion virtualExecute(vm::ExecutionContext *context) const override;
 
 private:
     ExpressionValue getReturnValue(vm::ExecutionContext *context) const;
@@ -23,5 +23,10 @@ ExpressionValue SizeofExpression::evaluate(vm::ExecutionContext *context) const
     return ExpressionValue(TypeDecl::INT, _size);
 }
 
+bool SizeofExpression::isConstant() const
+{
+    return true;
+}
+
 }
 
@@ -13,6 +13,7 @@ public:
 
     TypeDecl getType() const override;
     ExpressionValue evaluate(vm::ExecutionContext*) const override;
+    bool isConstant() const override;
 
 private:
     uint32_t _size;
@@ -23,4 +23,20 @@ TypeDecl StringLiteralExpression::getType() const
     return _type;
 }
 
+bool StringLiteralExpression::isEquivalent(const Expression *other) const
+{
+    auto literal = dynamic_cast<const StringLiteralExpression*>(other);
+    return literal != nullptr && literal->_stringId == _stringId;
+}
+
+StringId StringLiteralExpression::getStringId() const
+{
+    return _stringId;
+}
+
+void StringLiteralExpression::setStringId(StringId stringId)
+{
+    _stringId = stringId;
+}
+
 }
\ No newline at end of file
@@ -9,10 +9,16 @@ namespace cish::ast
 class StringLiteralExpression: public Expression
 {
 public:
+    typedef std::shared_ptr<StringLiteralExpression> Ptr;
+
     StringLiteralExpression(StringId stringId);
 
     ExpressionValue evaluate(vm::ExecutionContext *context) const override;
     TypeDecl getType() const override;
+    bool isEquivalent(const Expression *other) const override;
+
+    StringId getStringId() const;
+    void setStringId(StringId stringId);
 
 private:
     StringId _stringId;
@@ -1,12 +1,9 @@
 #include "StringTable.h"
-#include "MurmurHash2.h"
 #include "../Exception.h"
 
 namespace cish::ast
 {
 
-static const uint32_t g_hseed = 0x8BADF00D;
-
 StringTable::Ptr StringTable::create()
 {
     return StringTable::Ptr(new StringTable());
@@ -20,23 +17,15 @@ StringTable::StringTable():
 
 StringId StringTable::insert(const std::string &str)
 {
-    const uint32_t hash = MurmurHash2(str, g_hseed);
-    if (_definedStrings.find(hash) == _definedStrings.end()) {
-        const StringId id = _nextStringId++;
-        _definedStrings.insert(hash);
-        _map[id] = str;
-        return id;
-    }
-
-    for (const auto& pair: _map) {
-        if (pair.second == str) {
-            return pair.first;
-        }
+    auto it = _ids.find(str);
+    if (it != _ids.end()) {
+        return it->second;
     }
 
-    Throw(Exception,
-        "Internal inconsistency - failed to find string with H=%d (%s) in lookup table",
-        hash, str.c_str());
+    const StringId id = _nextStringId++;
+    _ids[str] = id;
+    _map[id] = str;
+    return id;
 }
 
 std::string StringTable::resolve(StringId id) const
@@ -48,6 +37,15 @@ std::string StringTable::resolve(StringId id) const
     return _map.at(id);
 }
 
+void StringTable::remove(StringId id)
+{
+    auto it = _map.find(id);
+    if (it != _map.end()) {
+        _ids.erase(it->second);
+        _map.erase(it);
+    }
+}
+
 const std::map<StringId,std::string>& StringTable::getMap() const
 {
     return _map;
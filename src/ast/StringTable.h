@@ -3,7 +3,7 @@
 #include <stdint.h>
 #include <string>
 #include <map>
-#include <set>
+#include <unordered_map>
 #include <memory>
 
 namespace cish::ast
@@ -22,11 +22,14 @@ public:
     StringId insert(const std::string &str);
     std::string resolve(StringId id) const;
 
+    // The id of a removed string is not handed out again
+    void remove(StringId id);
+
     const std::map<StringId,std::string>& getMap() const;
 
 private:
     std::map<StringId,std::string> _map;
-    std::set<uint32_t> _definedStrings;
+    std::unordered_map<std::string,StringId> _ids;
 
     StringId _nextStringId;
 };
@@ -26,7 +26,8 @@ StructAccessExpression::StructAccessExpression(Expression::Ptr structExpr,
         Throw(InvalidTypeException, "Struct access can only be performed on struct or pointer-to-struct expressions");
     }
 
-    _field = _struct->getField(memberName);
+    _field = _struct->getField(Symbol::intern(memberName));
+    _offset = _field->getOffset();
 }
 
 TypeDecl StructAccessExpression::getType() const
@@ -38,10 +39,27 @@ vm::MemoryView StructAccessExpression::getMemoryView(vm::ExecutionContext *conte
 {
     ExpressionValue value = _expression->evaluate(context);
     const uint32_t base = value.get<uint32_t>();
-    const uint32_t offset = _struct->getField(_field->getName())->getOffset();
-    const uint32_t addr = (base + offset);
+    const uint32_t addr = (base + _offset);
 
     return context->getMemory()->getView(addr);
 }
 
+void StructAccessExpression::forEachChild(const ChildVisitor &visitor) const
+{
+    visitor(_expression.get());
+}
+
+bool StructAccessExpression::isEquivalent(const Expression *other) const
+{
+    auto access = dynamic_cast<const StructAccessExpression*>(other);
+    return access != nullptr
+        && access->_field == _field
+        && _expression->isEquivalent(access->_expression.get());
+}
+
+void StructAccessExpression::rewriteExpressions(const ExpressionRewriter &rewriter)
+{
+    rewriter(_expression);
+}
+
 }
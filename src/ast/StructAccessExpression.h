@@ -23,12 +23,16 @@ public:
 
     virtual TypeDecl getType() const override;
     virtual vm::MemoryView getMemoryView(vm::ExecutionContext *context) const override;
+    virtual void forEachChild(const ChildVisitor &visitor) const override;
+    virtual bool isEquivalent(const Expression *other) const override;
+    virtual void rewriteExpressions(const ExpressionRewriter &rewriter) override;
 
 private:
     Expression::Ptr _expression;
 
     const StructLayout *_struct;
     const StructField *_field;
+    uint32_t _offset;
 };
 
 }
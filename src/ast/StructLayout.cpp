@@ -48,11 +48,12 @@ void StructLayout::addField(StructField *field)
               _name.c_str());
     }
 
-    if (_fieldLookup.count(field->getName()) != 0) {
+    const SymbolId symbol = Symbol::intern(field->getName());
+    if (_fieldLookup.contains(symbol)) {
         Throw(FieldAlreadyDeclaredException, "Duplicate field with name '%s'",
                 field->getName().c_str());
     }
-    _fieldLookup[field->getName()] = index;
+    _fieldLookup[symbol] = index;
 }
 
 void StructLayout::finalize()
@@ -76,14 +77,31 @@ const std::string& StructLayout::getName() const
 
 const StructField* StructLayout::getField(const std::string &name) const
 {
-    if (_fieldLookup.count(name) != 0) {
-        return _fields.at(_fieldLookup.at(name));
+    const SymbolId symbol = Symbol::find(name);
+    if (symbol == 0) {
+        Throw(NoSuchFieldException, "No field '%s' in struct %s", name.c_str(), _name.c_str());
     }
 
-    Throw(NoSuchFieldException, "No field '%s' in struct %s", name.c_str(), _name.c_str());
+    return getField(symbol);
+}
+
+const StructField* StructLayout::getField(SymbolId symbol) const
+{
+    const uint32_t *index = _fieldLookup.find(symbol);
+    if (index != nullptr) {
+        return _fields[*index];
+    }
+
+    Throw(NoSuchFieldException, "No field '%s' in struct %s",
+          Symbol::getName(symbol).c_str(), _name.c_str());
     return nullptr;
 }
 
+const std::vector<StructField*>& StructLayout::getFields() const
+{
+    return _fields;
+}
+
 uint32_t StructLayout::getSize() const
 {
     return _size;
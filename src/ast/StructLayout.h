@@ -2,9 +2,9 @@
 
 #include <string>
 #include <vector>
-#include <map>
 #include <memory>
 
+#include "Symbol.h"
 #include "../Exception.h"
 
 
@@ -46,12 +46,14 @@ public:
     bool isFinalized() const;
     const std::string& getName() const;
     const StructField* getField(const std::string &name) const;
+    const StructField* getField(SymbolId symbol) const;
+    const std::vector<StructField*>& getFields() const;
     uint32_t getSize() const;
 
 private:
     const std::string _name;
     std::vector<StructField*> _fields;
-    std::map<const std::string, uint32_t> _fieldLookup;
+    SymbolMap<uint32_t> _fieldLookup;
     uint32_t _size;
     bool _finalized;
 };
@@ -12,6 +12,11 @@ namespace cish::ast
 SuperStatement
 ==============
 */
+SuperStatement::SuperStatement():
+    _requiresScope(true)
+{
+}
+
 const StatementList& SuperStatement::getStatements() const
 {
     return _statements;
@@ -22,18 +27,73 @@ void SuperStatement::addStatement(Statement::Ptr statement)
     _statements.push_back(statement);
 }
 
-void SuperStatement::virtualExecute(vm::ExecutionContext*) const
+bool SuperStatement::requiresScope() const
+{
+    return _requiresScope;
+}
+
+void SuperStatement::setRequiresScope(bool requiresScope)
+{
+    _requiresScope = requiresScope;
+}
+
+Completion SuperStatement::virtualExecute(vm::ExecutionContext*) const
 {
     Throw(Exception, "SuperStatement::execute should never be called"); 
 }
 
-void SuperStatement::executeChildStatements(vm::ExecutionContext *context) const
+Completion SuperStatement::executeChildStatements(vm::ExecutionContext *context, uint32_t firstStatement) const
 {
-    if (context->currentFunctionHasReturned())
-        return;
+    for (size_t i=firstStatement; i<_statements.size(); i++) {
+        const Completion completion = _statements[i]->execute(context);
+        if (completion != Completion::NORMAL) {
+            return completion;
+        }
+    }
 
-    for (const Statement::Ptr& statement: _statements) {
-        statement->execute(context);
+    return Completion::NORMAL;
+}
+
+Completion SuperStatement::resumeChildStatements(vm::ExecutionContext *context,
+                                                 const ResumePath &path,
+                                                 uint32_t level) const
+{
+    const uint32_t index = path[level];
+    if (index >= _statements.size()) {
+        Throw(InvalidStatementException, "Cannot resume at statement %u of %u",
+              index, (uint32_t)_statements.size());
+    }
+
+    Completion completion;
+    if (level + 1 < path.size()) {
+        completion = _statements[index]->resume(context, path, level + 1);
+    } else {
+        completion = _statements[index]->execute(context);
+    }
+
+    if (completion != Completion::NORMAL) {
+        return completion;
+    }
+
+    return executeChildStatements(context, index + 1);
+}
+
+bool SuperStatement::getResumeIndex(const Statement *child, uint32_t *index) const
+{
+    for (size_t i=0; i<_statements.size(); i++) {
+        if (_statements[i].get() == child) {
+            *index = (uint32_t)i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void SuperStatement::forEachChild(const ChildVisitor &visitor) const
+{
+    for (const auto &statement: _statements) {
+        visitor(statement.get());
     }
 }
 
@@ -15,16 +15,42 @@ class SuperStatement: public Statement
 public:
     typedef std::shared_ptr<SuperStatement> Ptr;
 
+    SuperStatement();
     virtual ~SuperStatement() = default;
 
     const StatementList& getStatements() const;
     void addStatement(Statement::Ptr statement);
 
-    virtual void virtualExecute(vm::ExecutionContext*) const override;
-    void executeChildStatements(vm::ExecutionContext*) const;
+    virtual Completion virtualExecute(vm::ExecutionContext*) const override;
+
+    /**
+     * Execute the child statements in order, starting at 'firstStatement'
+     * and stopping at the first one which completes abruptly. Its
+     * completion is returned, or NORMAL if all statements ran.
+     */
+    Completion executeChildStatements(vm::ExecutionContext*, uint32_t firstStatement = 0) const;
+
+    /**
+     * Resume the child at 'path[level]', and execute the statements
+     * following it like executeChildStatements().
+     */
+    Completion resumeChildStatements(vm::ExecutionContext*, const ResumePath &path, uint32_t level) const;
+
+    virtual bool getResumeIndex(const Statement *child, uint32_t *index) const override;
+
+    /**
+     * Blocks which declare no variables of their own don't need a scope
+     * at runtime. Defaults to true, the TreeConverter clears it for
+     * blocks without declarations.
+     */
+    bool requiresScope() const;
+    void setRequiresScope(bool requiresScope);
+
+    virtual void forEachChild(const ChildVisitor &visitor) const override;
 
 private:
     StatementList _statements;
+    bool _requiresScope;
 };
 
 }
@@ -0,0 +1,175 @@
+#include "SwitchStatement.h"
+
+#include "../vm/ExecutionContext.h"
+
+#include <algorithm>
+
+
+namespace cish::ast
+{
+
+// Switches with a handful of labels are searched, larger ones get a jump
+// table as long as at least a third of its slots would be used.
+static const int64_t JUMP_TABLE_MIN_CASES = 3;
+static const int64_t JUMP_TABLE_MAX_SLOTS_PER_CASE = 3;
+static const int64_t JUMP_TABLE_MAX_SIZE = 4096;
+
+static bool isSwitchableType(const TypeDecl &type)
+{
+    return type.isIntegral() && type != TypeDecl::POINTER;
+}
+
+
+SwitchStatement::SwitchStatement(Expression::Ptr expression):
+    _expression(expression),
+    _defaultIndex(-1),
+    _finalized(false),
+    _jumpTableBase(0)
+{
+    if (!isSwitchableType(expression->getType())) {
+        Throw(InvalidTypeException, "Switch expression of type '%s' is not an integer",
+              expression->getType().getName());
+    }
+}
+
+void SwitchStatement::addCaseLabel(Expression::Ptr value)
+{
+    if (!value->isConstant()) {
+        Throw(InvalidStatementException, "Case label is not a constant expression");
+    }
+    if (!isSwitchableType(value->getType())) {
+        Throw(InvalidTypeException, "Case label of type '%s' is not an integer",
+              value->getType().getName());
+    }
+
+    const int64_t caseValue = value->evaluate(nullptr).get<int64_t>();
+    for (const Case &existing: _cases) {
+        if (existing.value == caseValue) {
+            Throw(InvalidStatementException, "Duplicate case value %lld", (long long)caseValue);
+        }
+    }
+
+    _cases.push_back(Case { caseValue, (uint32_t)getStatements().size() });
+}
+
+void SwitchStatement::addDefaultLabel()
+{
+    if (_defaultIndex >= 0) {
+        Throw(InvalidStatementException, "Multiple default labels in one switch");
+    }
+
+    _defaultIndex = getStatements().size();
+}
+
+void SwitchStatement::finalize()
+{
+    std::sort(_cases.begin(), _cases.end(), [](const Case &a, const Case &b) {
+        return a.value < b.value;
+    });
+
+    _jumpTable.clear();
+
+    const int64_t numCases = _cases.size();
+    if (numCases >= JUMP_TABLE_MIN_CASES) {
+        // Labels may lie further apart than an int64_t can express, so the
+        // distance is taken as unsigned and bounded before the slot for the
+        // last label is added
+        const uint64_t span = (uint64_t)_cases.back().value - (uint64_t)_cases.front().value;
+        const int64_t range = span < (uint64_t)JUMP_TABLE_MAX_SIZE ? (int64_t)span + 1 : JUMP_TABLE_MAX_SIZE + 1;
+        if (range <= numCases * JUMP_TABLE_MAX_SLOTS_PER_CASE && range <= JUMP_TABLE_MAX_SIZE) {
+            _jumpTableBase = _cases.front().value;
+            _jumpTable.resize(range, getDefaultTarget());
+            for (const Case &c: _cases) {
+                _jumpTable[c.value - _jumpTableBase] = c.statementIndex;
+            }
+        }
+    }
+
+    _finalized = true;
+}
+
+bool SwitchStatement::usesJumpTable() const
+{
+    return !_jumpTable.empty();
+}
+
+Completion SwitchStatement::virtualExecute(vm::ExecutionContext *context) const
+{
+    if (!_finalized) {
+        Throw(Exception, "SwitchStatement executed before being finalized");
+    }
+
+    const int64_t value = _expression->evaluate(context).get<int64_t>();
+    const uint32_t target = findTarget(value);
+
+    if (requiresScope()) {
+        context->pushScope();
+    }
+
+    Completion completion = executeChildStatements(context, target);
+
+    if (requiresScope()) {
+        context->popScope();
+    }
+
+    // The switch is the target of any 'break' inside it, while 'continue'
+    // belongs to an enclosing loop
+    return completion == Completion::BREAK ? Completion::NORMAL : completion;
+}
+
+Completion SwitchStatement::virtualResume(vm::ExecutionContext *context, const ResumePath &path, uint32_t level) const
+{
+    const Completion completion = resumeChildStatements(context, path, level);
+
+    if (requiresScope()) {
+        context->popScope();
+    }
+
+    return completion == Completion::BREAK ? Completion::NORMAL : completion;
+}
+
+uint32_t SwitchStatement::getDefaultTarget() const
+{
+    // Without a default label, unmatched values skip the entire body
+    if (_defaultIndex < 0) {
+        return getStatements().size();
+    }
+
+    return _defaultIndex;
+}
+
+uint32_t SwitchStatement::findTarget(int64_t value) const
+{
+    if (!_jumpTable.empty()) {
+        // Values below the base wrap around to large slots
+        const uint64_t slot = (uint64_t)value - (uint64_t)_jumpTableBase;
+        if (slot >= _jumpTable.size()) {
+            return getDefaultTarget();
+        }
+        return _jumpTable[slot];
+    }
+
+    auto it = std::lower_bound(_cases.begin(), _cases.end(), value, [](const Case &c, int64_t v) {
+        return c.value < v;
+    });
+
+    if (it == _cases.end() || it->value != value) {
+        return getDefaultTarget();
+    }
+
+    return it->statementIndex;
+}
+
+void SwitchStatement::forEachChild(const ChildVisitor &visitor) const
+{
+    visitor(_expression.get());
+
+    SuperStatement::forEachChild(visitor);
+}
+
+void SwitchStatement::rewriteExpressions(const ExpressionRewriter &rewriter)
+{
+    rewriter(_expression);
+}
+
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "AstNodes.h"
+#include "SuperStatement.h"
+
+#include <vector>
+
+
+namespace cish::ast
+{
+
+/**
+ * The body of a switch is kept as one flat list of statements, and every
+ * case label is the index of the statement it precedes. Execution starts
+ * at the label matching the controlling expression and falls through the
+ * remaining statements until the end of the body or a 'break'.
+ *
+ * Once all labels are added, finalize() decides how to dispatch: dense
+ * labels are resolved through a jump table in O(1), sparse labels by a
+ * binary search over the sorted case values.
+ */
+class SwitchStatement: public SuperStatement
+{
+public:
+    typedef std::shared_ptr<SwitchStatement> Ptr;
+
+    SwitchStatement(Expression::Ptr expression);
+
+    // Labels refer to the next statement added to the switch
+    void addCaseLabel(Expression::Ptr value);
+    void addDefaultLabel();
+
+    void finalize();
+    bool usesJumpTable() const;
+    void forEachChild(const ChildVisitor &visitor) const override;
+    void rewriteExpressions(const ExpressionRewriter &rewriter) override;
+
+protected:
+    Completion virtualExecute(vm::ExecutionContext *context) const override;
+    Completion virtualResume(vm::ExecutionContext *context, const ResumePath &path, uint32_t level) const override;
+
+private:
+    struct Case
+    {
+        int64_t value;
+        uint32_t statementIndex;
+    };
+
+    Expression::Ptr _expression;
+    std::vector<Case> _cases;
+    int64_t _defaultIndex;
+    bool _finalized;
+
+    // Maps (value - _jumpTableBase) to a statement index. Values between
+    // the case labels map to the default target.
+    std::vector<uint32_t> _jumpTable;
+    int64_t _jumpTableBase;
+
+    uint32_t getDefaultTarget() const;
+    uint32_t findTarget(int64_t value) const;
+};
+
+}
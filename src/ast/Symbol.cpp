@@ -0,0 +1,75 @@
+#include "Symbol.h"
+#include "../Exception.h"
+
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+
+
+namespace cish::ast
+{
+
+struct SymbolTable
+{
+    std::shared_mutex mutex;
+
+    // The names are never moved, so the views into them stay valid
+    std::deque<std::string> names;
+    std::unordered_map<std::string_view, SymbolId> ids;
+};
+
+static SymbolTable& getSymbolTable()
+{
+    static SymbolTable table;
+    return table;
+}
+
+
+SymbolId Symbol::intern(const std::string &name)
+{
+    SymbolTable &table = getSymbolTable();
+
+    {
+        std::shared_lock<std::shared_mutex> lock(table.mutex);
+        auto it = table.ids.find(name);
+        if (it != table.ids.end()) {
+            return it->second;
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(table.mutex);
+    auto it = table.ids.find(name);
+    if (it != table.ids.end()) {
+        return it->second;
+    }
+
+    table.names.push_back(name);
+    const SymbolId symbol = (SymbolId)table.names.size();
+    table.ids[table.names.back()] = symbol;
+    return symbol;
+}
+
+SymbolId Symbol::find(const std::string &name)
+{
+    SymbolTable &table = getSymbolTable();
+    std::shared_lock<std::shared_mutex> lock(table.mutex);
+
+    auto it = table.ids.find(name);
+    return it != table.ids.end() ? it->second : 0;
+}
+
+const std::string& Symbol::getName(SymbolId symbol)
+{
+    SymbolTable &table = getSymbolTable();
+    std::shared_lock<std::shared_mutex> lock(table.mutex);
+
+    if (symbol == 0 || symbol > table.names.size()) {
+        Throw(Exception, "Invalid symbol: %u", symbol);
+    }
+
+    return table.names[symbol - 1];
+}
+
+}
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace cish::ast
+{
+
+/**
+ * Identifiers are interned once into a process wide table, and referred
+ * to by their SymbolId from then on. Two identifiers are equal if and
+ * only if their ids are equal. Zero is never the id of an identifier.
+ *
+ * Interning is thread safe, and ids are never reused.
+ */
+typedef uint32_t SymbolId;
+
+class Symbol
+{
+public:
+    static SymbolId intern(const std::string &name);
+
+    // Zero if 'name' has never been interned
+    static SymbolId find(const std::string &name);
+
+    static const std::string& getName(SymbolId symbol);
+};
+
+
+/**
+ * Open addressing hash map keyed by SymbolId. Entries can't be removed.
+ */
+template<typename T>
+class SymbolMap
+{
+public:
+    SymbolMap();
+
+    T* find(SymbolId symbol);
+    const T* find(SymbolId symbol) const;
+    bool contains(SymbolId symbol) const;
+
+    // Inserts a default constructed value if 'symbol' is not present
+    T& operator[](SymbolId symbol);
+
+    size_t size() const;
+    void clear();
+
+private:
+    struct Slot
+    {
+        SymbolId key;
+        T value;
+    };
+
+    std::vector<Slot> _slots;
+    size_t _size;
+
+    size_t findSlot(SymbolId symbol) const;
+    void grow();
+};
+
+
+template<typename T>
+SymbolMap<T>::SymbolMap():
+    _size(0)
+{
+}
+
+template<typename T>
+T* SymbolMap<T>::find(SymbolId symbol)
+{
+    if (_slots.empty() || symbol == 0) {
+        return nullptr;
+    }
+
+    Slot &slot = _slots[findSlot(symbol)];
+    return slot.key == symbol ? &slot.value : nullptr;
+}
+
+template<typename T>
+const T* SymbolMap<T>::find(SymbolId symbol) const
+{
+    if (_slots.empty() || symbol == 0) {
+        return nullptr;
+    }
+
+    const Slot &slot = _slots[findSlot(symbol)];
+    return slot.key == symbol ? &slot.value : nullptr;
+}
+
+template<typename T>
+bool SymbolMap<T>::contains(SymbolId symbol) const
+{
+    return find(symbol) != nullptr;
+}
+
+template<typename T>
+T& SymbolMap<T>::operator[](SymbolId symbol)
+{
+    // Keep the load factor at or below 1/2
+    if ((_size + 1) * 2 > _slots.size()) {
+        grow();
+    }
+
+    Slot &slot = _slots[findSlot(symbol)];
+    if (slot.key != symbol) {
+        slot.key = symbol;
+        _size++;
+    }
+
+    return slot.value;
+}
+
+template<typename T>
+size_t SymbolMap<T>::size() const
+{
+    return _size;
+}
+
+template<typename T>
+void SymbolMap<T>::clear()
+{
+    for (Slot &slot: _slots) {
+        slot = Slot();
+    }
+
+    _size = 0;
+}
+
+template<typename T>
+size_t SymbolMap<T>::findSlot(SymbolId symbol) const
+{
+    // Ids are handed out sequentially, so scramble them before masking
+    const size_t mask = _slots.size() - 1;
+    size_t index = (symbol * 0x9E3779B1u) & mask;
+
+    while (_slots[index].key != symbol && _slots[index].key != 0) {
+        index = (index + 1) & mask;
+    }
+
+    return index;
+}
+
+template<typename T>
+void SymbolMap<T>::grow()
+{
+    std::vector<Slot> slots(_slots.empty() ? 8 : _slots.size() * 2);
+    std::swap(slots, _slots);
+
+    for (Slot &slot: slots) {
+        if (slot.key != 0) {
+            Slot &target = _slots[findSlot(slot.key)];
+            target.key = slot.key;
+            target.value = std::move(slot.value);
+        }
+    }
+}
+
+}
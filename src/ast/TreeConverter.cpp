@@ -19,10 +19,12 @@
 #include "FunctionDeclarationStatement.h"
 #include "FunctionDefinition.h"
 #include "ReturnStatement.h"
+#include "BreakStatement.h"
 #include "IfStatement.h"
 #include "ElseStatement.h"
 #include "ForLoopStatement.h"
 #include "WhileStatement.h"
+#include "SwitchStatement.h"
 #include "ExpressionStatement.h"
 
 #include "StructLayout.h"
@@ -36,15 +38,21 @@ TreeConverter::TreeConverter(ModuleContext::Ptr moduleContext):
     _moduleContext(std::move(moduleContext))
 {
     _stringTable = StringTable::create();
+    _dataSegment = std::make_unique<DataSegment>();
+    _arena = AstArena::create();
 }
 
-Ast::Ptr TreeConverter::convertTree(const ParseContext *parseContext)
+Ast::Ptr TreeConverter::convertTree(const AntlrContext *antlrContext)
 {
-    antlr4::tree::ParseTree *tree = parseContext->getParseTree();
+    antlr4::tree::ParseTree *tree = antlrContext->getParseTree();
     Ast::Ptr ast = std::any_cast<Ast::Ptr>(visit(tree));
 
     verifyAllFunctionsDefined(ast.get());
+
+    _dataSegment->addStrings(_stringTable.get());
+    ast->setDataSegment(std::move(_dataSegment));
     ast->setStringTable(std::move(_stringTable));
+    ast->addArena(_arena);
 
     return ast;
 }
@@ -93,7 +101,11 @@ antlrcpp::Any TreeConverter::visitRootBlock(CMParser::RootBlockContext *ctx)
         if (varDecl != nullptr) {
             Result res = std::any_cast<Result>(visitVariableDeclaration(varDecl));
             assert(res.size() == 1);
-            ast->addRootStatement(castToStatement(res[0]));
+
+            auto varDeclStmt = std::dynamic_pointer_cast<VariableDeclarationStatement>(res[0]);
+            assert(varDeclStmt != nullptr);
+            varDeclStmt->allocateStatically(_dataSegment.get());
+            ast->addRootStatement(varDeclStmt);
         } else if (funcDef != nullptr) {
             Result res = std::any_cast<Result>(visitFunctionDefinition(funcDef));
             assert(res.size() == 1);
@@ -154,7 +166,7 @@ antlrcpp::Any TreeConverter::visitSTRUCT_ACCESS_EXPR(CMParser::STRUCT_ACCESS_EXP
 
     const std::string identifier = ctx->identifier()->getText();
 
-    return createResult(std::make_shared<StructAccessExpression>(expr, identifier, accessMethod));
+    return createResult(AstArena::create<StructAccessExpression>(_arena, expr, identifier, accessMethod));
 }
 
 antlrcpp::Any TreeConverter::visitPOSTFIX_INC_EXPR(CMParser::POSTFIX_INC_EXPRContext *ctx)
@@ -163,7 +175,7 @@ antlrcpp::Any TreeConverter::visitPOSTFIX_INC_EXPR(CMParser::POSTFIX_INC_EXPRCon
     Result res = std::any_cast<Result>(visitChildren(ctx));
     assert(res.size() == 1);
     Lvalue::Ptr lvalue = castToLvalue(res[0]);
-    return createResult(std::make_shared<IncDecExpression>(op, lvalue));
+    return createResult(AstArena::create<IncDecExpression>(_arena, op, lvalue));
 }
 
 antlrcpp::Any TreeConverter::visitPREFIX_INC_EXPR(CMParser::PREFIX_INC_EXPRContext *ctx)
@@ -172,7 +184,7 @@ antlrcpp::Any TreeConverter::visitPREFIX_INC_EXPR(CMParser::PREFIX_INC_EXPRConte
     Result res = std::any_cast<Result>(visitChildren(ctx));
     assert(res.size() == 1);
     Lvalue::Ptr lvalue = castToLvalue(res[0]);
-    return createResult(std::make_shared<IncDecExpression>(op, lvalue));
+    return createResult(AstArena::create<IncDecExpression>(_arena, op, lvalue));
 }
 
 antlrcpp::Any TreeConverter::visitPOSTFIX_DEC_EXPR(CMParser::POSTFIX_DEC_EXPRContext *ctx)
@@ -181,7 +193,7 @@ antlrcpp::Any TreeConverter::visitPOSTFIX_DEC_EXPR(CMParser::POSTFIX_DEC_EXPRCon
     auto res = std::any_cast<Result>(visitChildren(ctx));
     assert(res.size() == 1);
     Lvalue::Ptr lvalue = castToLvalue(res[0]);
-    return createResult(std::make_shared<IncDecExpression>(op, lvalue));
+    return createResult(AstArena::create<IncDecExpression>(_arena, op, lvalue));
 }
 
 antlrcpp::Any TreeConverter::visitPREFIX_DEC_EXPR(CMParser::PREFIX_DEC_EXPRContext *ctx)
@@ -190,7 +202,7 @@ antlrcpp::Any TreeConverter::visitPREFIX_DEC_EXPR(CMParser::PREFIX_DEC_EXPRConte
     auto res = std::any_cast<Result>(visitChildren(ctx));
     assert(res.size() == 1);
     Lvalue::Ptr lvalue = castToLvalue(res[0]);
-    return createResult(std::make_shared<IncDecExpression>(op, lvalue));
+    return createResult(AstArena::create<IncDecExpression>(_arena, op, lvalue));
 }
 
 antlrcpp::Any TreeConverter::visitTYPE_CAST_EXPR(CMParser::TYPE_CAST_EXPRContext *ctx)
@@ -201,7 +213,7 @@ antlrcpp::Any TreeConverter::visitTYPE_CAST_EXPR(CMParser::TYPE_CAST_EXPRContext
     assert(exprResult.size() == 1);
     Expression::Ptr expression = castToExpression(exprResult[0]);
 
-    auto castExpr = std::make_shared<TypeCastExpression>(type, expression);
+    auto castExpr = AstArena::create<TypeCastExpression>(_arena, type, expression);
     return createResult(castExpr);
 }
 
@@ -210,7 +222,7 @@ antlrcpp::Any TreeConverter::visitDEREF_EXPR(CMParser::DEREF_EXPRContext *ctx)
     Result result = std::any_cast<Result>(visitChildren(ctx));
     assert(result.size() == 1);
     Expression::Ptr expr = castToExpression(result[0]);
-    return createResult(std::make_shared<DereferenceExpression>(expr));
+    return createResult(AstArena::create<DereferenceExpression>(_arena, expr));
 }
 
 antlrcpp::Any TreeConverter::visitADDROF_EXPR(CMParser::ADDROF_EXPRContext *ctx)
@@ -218,7 +230,7 @@ antlrcpp::Any TreeConverter::visitADDROF_EXPR(CMParser::ADDROF_EXPRContext *ctx)
     Result result = std::any_cast<Result>(visitChildren(ctx));
     assert(result.size() == 1);
     Lvalue::Ptr lvalue = castToLvalue(result[0]);
-    return createResult(std::make_shared<AddrofExpression>(lvalue));
+    return createResult(AstArena::create<AddrofExpression>(_arena, lvalue));
 }
 
 antlrcpp::Any TreeConverter::visitSIZEOF_EXPR(CMParser::SIZEOF_EXPRContext *ctx)
@@ -228,9 +240,9 @@ antlrcpp::Any TreeConverter::visitSIZEOF_EXPR(CMParser::SIZEOF_EXPRContext *ctx)
     if (Result *result = std::any_cast<Result>(&evaluated)) {
         assert(result->size() == 1);
         Expression::Ptr expr = castToExpression((*result)[0]);
-        sizeofExpr = std::make_shared<SizeofExpression>(expr);
+        sizeofExpr = AstArena::create<SizeofExpression>(_arena, expr);
     } else if (TypeDecl *typeDecl = std::any_cast<TypeDecl>(&evaluated)) {
-        sizeofExpr = std::make_shared<SizeofExpression>(*typeDecl);
+        sizeofExpr = AstArena::create<SizeofExpression>(_arena, *typeDecl);
     } else {
         Throw(AstConversionException, "Unexpected type in sizeofTerm");
     }
@@ -259,7 +271,7 @@ antlrcpp::Any TreeConverter::visitMINUS_EXPR(CMParser::MINUS_EXPRContext *ctx)
     Result result = std::any_cast<Result>(visitChildren(ctx));
     assert(result.size() == 1);
     Expression::Ptr expr = castToExpression(result[0]);
-    return createResult(std::make_shared<MinusExpression>(expr));
+    return createResult(AstArena::create<MinusExpression>(_arena, expr));
 }
 
 antlrcpp::Any TreeConverter::visitNEGATION_EXPR(CMParser::NEGATION_EXPRContext *ctx)
@@ -267,7 +279,7 @@ antlrcpp::Any TreeConverter::visitNEGATION_EXPR(CMParser::NEGATION_EXPRContext *
     Result result = std::any_cast<Result>(visitChildren(ctx));
     assert(result.size() == 1);
     Expression::Ptr expr = castToExpression(result[0]);
-    return createResult(std::make_shared<NegationExpression>(expr));
+    return createResult(AstArena::create<NegationExpression>(_arena, expr));
 }
 
 antlrcpp::Any TreeConverter::visitSUBSCRIPT_EXPR(CMParser::SUBSCRIPT_EXPRContext *ctx)
@@ -278,7 +290,7 @@ antlrcpp::Any TreeConverter::visitSUBSCRIPT_EXPR(CMParser::SUBSCRIPT_EXPRContext
     Expression::Ptr ptrExpr = castToExpression(res[0]);
     Expression::Ptr idxExpr = castToExpression(res[1]);
 
-    auto subscript = std::make_shared<SubscriptExpression>(ptrExpr, idxExpr);
+    auto subscript = AstArena::create<SubscriptExpression>(_arena, ptrExpr, idxExpr);
     return createResult(subscript);
 }
 
@@ -287,7 +299,7 @@ antlrcpp::Any TreeConverter::visitONES_COMPLEMENT_EXPR(CMParser::ONES_COMPLEMENT
     Result result = std::any_cast<Result>(visitChildren(ctx));
     assert(result.size() == 1);
     Expression::Ptr expr = castToExpression(result[0]);
-    return createResult(std::make_shared<OnesComplementExpression>(expr));
+    return createResult(AstArena::create<OnesComplementExpression>(_arena, expr));
 }
 
 antlrcpp::Any TreeConverter::visitMULT_EXPR(CMParser::MULT_EXPRContext *ctx)
@@ -353,7 +365,7 @@ antlrcpp::Any TreeConverter::visitBITWISE_EXPR(CMParser::BITWISE_EXPRContext *ct
 antlrcpp::Any TreeConverter::visitLITERAL_EXPR(CMParser::LITERAL_EXPRContext *ctx)
 {
     const std::string literal = ctx->getText();
-    return createResult(std::make_shared<LiteralExpression>(literal));
+    return createResult(AstArena::create<LiteralExpression>(_arena, literal));
 }
 
 antlrcpp::Any TreeConverter::visitFUNC_CALL_EXPR(CMParser::FUNC_CALL_EXPRContext *ctx)
@@ -392,7 +404,7 @@ antlrcpp::Any TreeConverter::visitAND_EXPR(CMParser::AND_EXPRContext *ctx)
 antlrcpp::Any TreeConverter::visitVAR_REF_EXPR(CMParser::VAR_REF_EXPRContext *ctx)
 {
     const std::string varName = ctx->Identifier()->getText();
-    return createResult(std::make_shared<VariableReference>(&_declContext, varName));
+    return createResult(AstArena::create<VariableReference>(_arena, &_declContext, varName));
 }
 
 antlrcpp::Any TreeConverter::visitCOMPARE_EXPR(CMParser::COMPARE_EXPRContext *ctx)
@@ -425,10 +437,20 @@ antlrcpp::Any TreeConverter::visitReturnStatement(CMParser::ReturnStatementConte
         expression = manuallyVisitExpression(ctx->expression());
     }
 
-    ReturnStatement::Ptr statement = std::make_shared<ReturnStatement>(&_declContext, expression);
+    ReturnStatement::Ptr statement = AstArena::create<ReturnStatement>(_arena, &_declContext, expression);
     return createResult(statement);
 }
 
+antlrcpp::Any TreeConverter::visitBreakStatement(CMParser::BreakStatementContext *ctx)
+{
+    return createResult(AstArena::create<BreakStatement>(_arena, &_declContext));
+}
+
+antlrcpp::Any TreeConverter::visitContinueStatement(CMParser::ContinueStatementContext *ctx)
+{
+    return createResult(AstArena::create<ContinueStatement>(_arena, &_declContext));
+}
+
 antlrcpp::Any TreeConverter::visitIfStatement(CMParser::IfStatementContext *ctx)
 {
     ElseStatement::Ptr elseStatement = nullptr;
@@ -441,7 +463,7 @@ antlrcpp::Any TreeConverter::visitIfStatement(CMParser::IfStatementContext *ctx)
     }
 
     Expression::Ptr expr = manuallyVisitExpression(ctx->expression());
-    IfStatement::Ptr ifStatement = std::make_shared<IfStatement>(expr, elseStatement);
+    IfStatement::Ptr ifStatement = AstArena::create<IfStatement>(_arena, expr, elseStatement);
 
     _declContext.pushVariableScope();
 
@@ -450,13 +472,14 @@ antlrcpp::Any TreeConverter::visitIfStatement(CMParser::IfStatementContext *ctx)
         ifStatement->addStatement(statement);
     }
 
+    ifStatement->setRequiresScope(_declContext.currentScopeHasDeclarations());
     _declContext.popVariableScope();
     return createResult(std::dynamic_pointer_cast<AstNode>(ifStatement));
 }
 
 antlrcpp::Any TreeConverter::visitElseStatement(CMParser::ElseStatementContext *ctx)
 {
-    ElseStatement::Ptr elseStatement = std::make_shared<ElseStatement>();
+    ElseStatement::Ptr elseStatement = AstArena::create<ElseStatement>(_arena);
     _declContext.pushVariableScope();
 
     std::vector<Statement*> statements;
@@ -465,6 +488,7 @@ antlrcpp::Any TreeConverter::visitElseStatement(CMParser::ElseStatementContext *
         elseStatement->addStatement(statement);
     }
 
+    elseStatement->setRequiresScope(_declContext.currentScopeHasDeclarations());
     _declContext.popVariableScope();
     return createResult(elseStatement);
 }
@@ -484,14 +508,17 @@ antlrcpp::Any TreeConverter::visitForStatement(CMParser::ForStatementContext *ct
     if (ctx->forIterator())
         iterator = manuallyVisitForIterator(ctx->forIterator());
 
-    ForLoopStatement::Ptr forLoop = std::make_shared<ForLoopStatement>(initializer, condition, iterator);
+    ForLoopStatement::Ptr forLoop = AstArena::create<ForLoopStatement>(_arena, initializer, condition, iterator);
 
     std::vector<Statement*> statements;
+    _declContext.enterLoop();
     for (CMParser::StatementContext *stmtContext: ctx->statement()) {
         Statement::Ptr statement = manuallyVisitStatement(stmtContext);
         forLoop->addStatement(statement);
     }
+    _declContext.exitLoop();
 
+    forLoop->setRequiresScope(_declContext.currentScopeHasDeclarations());
     _declContext.popVariableScope();
     return createResult(forLoop);
 }
@@ -501,13 +528,16 @@ antlrcpp::Any TreeConverter::visitWhileStatement(CMParser::WhileStatementContext
     Expression::Ptr condition = manuallyVisitExpression(ctx->expression());
     _declContext.pushVariableScope();
 
-    WhileStatement::Ptr whileStatement = std::make_shared<WhileStatement>(condition);
+    WhileStatement::Ptr whileStatement = AstArena::create<WhileStatement>(_arena, condition);
 
+    _declContext.enterLoop();
     for (CMParser::StatementContext *stmtContext: ctx->statement()) {
         Statement::Ptr statement = manuallyVisitStatement(stmtContext);
         whileStatement->addStatement(statement);
     }
+    _declContext.exitLoop();
 
+    whileStatement->setRequiresScope(_declContext.currentScopeHasDeclarations());
     _declContext.popVariableScope();
     return createResult(whileStatement);
 }
@@ -517,21 +547,54 @@ antlrcpp::Any TreeConverter::visitDoWhileStatement(CMParser::DoWhileStatementCon
     Expression::Ptr condition = manuallyVisitExpression(ctx->expression());
     _declContext.pushVariableScope();
 
-    DoWhileStatement::Ptr doWhileStatement = std::make_shared<DoWhileStatement>(condition);
+    DoWhileStatement::Ptr doWhileStatement = AstArena::create<DoWhileStatement>(_arena, condition);
 
+    _declContext.enterLoop();
     for (CMParser::StatementContext *stmtContext: ctx->statement()) {
         Statement::Ptr statement = manuallyVisitStatement(stmtContext);
         doWhileStatement->addStatement(statement);
     }
+    _declContext.exitLoop();
 
+    doWhileStatement->setRequiresScope(_declContext.currentScopeHasDeclarations());
     _declContext.popVariableScope();
     return createResult(doWhileStatement);
 }
 
+antlrcpp::Any TreeConverter::visitSwitchStatement(CMParser::SwitchStatementContext *ctx)
+{
+    Expression::Ptr expression = manuallyVisitExpression(ctx->expression());
+    _declContext.pushVariableScope();
+
+    SwitchStatement::Ptr switchStatement = AstArena::create<SwitchStatement>(_arena, expression);
+
+    _declContext.enterSwitch();
+    for (CMParser::SwitchSectionContext *section: ctx->switchSection()) {
+        for (CMParser::SwitchLabelContext *label: section->switchLabel()) {
+            if (label->expression()) {
+                switchStatement->addCaseLabel(manuallyVisitExpression(label->expression()));
+            } else {
+                switchStatement->addDefaultLabel();
+            }
+        }
+
+        for (CMParser::StatementContext *stmtContext: section->statement()) {
+            Statement::Ptr statement = manuallyVisitStatement(stmtContext);
+            switchStatement->addStatement(statement);
+        }
+    }
+    _declContext.exitSwitch();
+
+    switchStatement->finalize();
+    switchStatement->setRequiresScope(_declContext.currentScopeHasDeclarations());
+    _declContext.popVariableScope();
+    return createResult(switchStatement);
+}
+
 antlrcpp::Any TreeConverter::visitExpressionStatement(CMParser::ExpressionStatementContext *ctx)
 {
     Expression::Ptr expression = manuallyVisitExpression(ctx->expression());
-    return createResult(std::make_shared<ExpressionStatement>(expression));
+    return createResult(AstArena::create<ExpressionStatement>(_arena, expression));
 }
 
 antlrcpp::Any TreeConverter::visitAssignment(CMParser::AssignmentContext *ctx)
@@ -544,7 +607,7 @@ antlrcpp::Any TreeConverter::visitAssignment(CMParser::AssignmentContext *ctx)
     Lvalue::Ptr lvalue = castToLvalue(res[0]);
     Expression::Ptr rvalue = castToExpression(res[1]);
 
-    auto varAssign = std::make_shared<VariableAssignmentStatement>(&_declContext, lvalue, rvalue);
+    auto varAssign = AstArena::create<VariableAssignmentStatement>(_arena, &_declContext, lvalue, rvalue);
     return createResult(varAssign);
 }
 
@@ -558,7 +621,7 @@ antlrcpp::Any TreeConverter::visitVariableDeclaration(CMParser::VariableDeclarat
         expression = manuallyVisitExpression(ctx->expression());
     }
 
-    auto varDecl = std::make_shared<VariableDeclarationStatement>(&_declContext, type, varName, expression);
+    auto varDecl = AstArena::create<VariableDeclarationStatement>(_arena, &_declContext, type, varName, expression);
 
     return createResult(varDecl);
 }
@@ -619,7 +682,7 @@ antlrcpp::Any TreeConverter::visitArithmeticAssignment(CMParser::ArithmeticAssig
         Throw(AstConversionException, "Unable to handle arith.ass. operator '%s'", op.c_str());
     BinaryExpression::Operator oper = opmap.at(op);
 
-    auto stmt = std::make_shared<ArithmeticAssignmentStatement>(lvalue, oper, rvalue);
+    auto stmt = AstArena::create<ArithmeticAssignmentStatement>(_arena, lvalue, oper, rvalue);
     return createResult(stmt);
 }
 
@@ -635,7 +698,7 @@ antlrcpp::Any TreeConverter::visitFunctionDeclaration(CMParser::FunctionDeclarat
 
     _funcDecls.push_back(funcDecl);
 
-    auto funcDeclStatement = std::make_shared<FunctionDeclarationStatement>(&_declContext, funcDecl);
+    auto funcDeclStatement = AstArena::create<FunctionDeclarationStatement>(_arena, &_declContext, funcDecl);
     return createResult(funcDeclStatement);
 }
 
@@ -652,7 +715,7 @@ antlrcpp::Any TreeConverter::visitFunctionDefinition(CMParser::FunctionDefinitio
     // Potentially dirty - we need to perform all the logic related to the DeclarationContext
     // and variable declaration in a very specific order, and this is the best - if somewhat
     // awkward - place to do that.
-    FunctionDefinition::Ptr funcDef = std::make_shared<FunctionDefinition>(&_declContext, funcDecl);
+    FunctionDefinition::Ptr funcDef = AstArena::create<FunctionDefinition>(_arena, &_declContext, funcDecl);
     _declContext.enterFunction(funcDef);
     for (const VarDeclaration &varDecl: params) {
         if (!varDecl.name.empty()) {
@@ -680,7 +743,7 @@ antlrcpp::Any TreeConverter::visitFunctionCall(CMParser::FunctionCallContext *ct
         params.push_back(expr);
     }
 
-    auto callExpr = std::make_shared<FunctionCallExpression>(&_declContext, funcName, params);
+    auto callExpr = AstArena::create<FunctionCallExpression>(_arena, &_declContext, funcName, params);
     return createResult(callExpr);
 }
 
@@ -746,7 +809,7 @@ TreeConverter::Result TreeConverter::buildBinaryExpression(BinaryExpression::Ope
     auto leftExpr = castToExpression(result[0]);
     auto rightExpr = castToExpression(result[1]);
 
-    auto binaryExpr = std::make_shared<BinaryExpression>(op, leftExpr, rightExpr);
+    auto binaryExpr = AstArena::create<BinaryExpression>(_arena, op, leftExpr, rightExpr);
     return createResult(binaryExpr);
 }
 
@@ -789,7 +852,7 @@ Expression::Ptr TreeConverter::manuallyVisitExpression(CMParser::ExpressionConte
 Statement::Ptr TreeConverter::manuallyVisitStatement(CMParser::StatementContext *ctx)
 {
     if (ctx->getText() == ";")
-        return std::make_shared<NoOpStatement>();
+        return AstArena::create<NoOpStatement>(_arena);
 
     antlrcpp::Any any = visitStatement(ctx);
     Result result = std::any_cast<Result>(any);
@@ -827,7 +890,7 @@ StringLiteralExpression::Ptr TreeConverter::manuallyVisitStringLiteral(CMParser:
     str = str.substr(1, str.length() - 2);
     str = ast::string::unescapeString(str);
     const StringId stringId = _stringTable->insert(str);
-    return std::make_shared<StringLiteralExpression>(stringId);
+    return AstArena::create<StringLiteralExpression>(_arena, stringId);
 }
 
 Statement::Ptr TreeConverter::manuallyVisitForInitializer(CMParser::ForInitializerContext *ctx)
@@ -858,7 +921,7 @@ Statement::Ptr TreeConverter::manuallyVisitForIterator(CMParser::ForIteratorCont
         return castToStatement(res[0]);
     } else if (ctx->expression()) {
         Expression::Ptr expr = manuallyVisitExpression(ctx->expression());
-        return std::make_shared<ExpressionStatement>(expr);
+        return AstArena::create<ExpressionStatement>(_arena, expr);
     } else {
         Throw(Exception, "Unsupported initialization in for-loop");
     }
@@ -3,7 +3,7 @@
 #include "antlr/CMBaseVisitor.h"
 #include "antlr/CMParser.h"
 #include "AntlrContext.h"
-#include "ParseContext.h"
+#include "AstBuilder.h"
 
 #include "AstNodes.h"
 #include "Lvalue.h"
@@ -22,11 +22,6 @@ namespace cish::ast
 using module::Module;
 using module::ModuleContext;
 
-DECLARE_EXCEPTION(AstNodeNotImplementedException);
-DECLARE_EXCEPTION(AstConversionException);
-DECLARE_EXCEPTION(FunctionNotDefinedException);
-DECLARE_EXCEPTION(ModuleNotFoundException);
-
 }
 
 namespace cish::ast::internal
@@ -38,7 +33,7 @@ class TreeConverter: public CMBaseVisitor
 
 public:
     TreeConverter(ModuleContext::Ptr moduleContext);
-    Ast::Ptr convertTree(const ParseContext *parseContext);
+    Ast::Ptr convertTree(const AntlrContext *antlrContext);
 
     virtual antlrcpp::Any visitChildren(antlr4::tree::ParseTree *node) override;
     virtual antlrcpp::Any visitRoot(CMParser::RootContext *ctx) override;
@@ -72,11 +67,14 @@ public:
     virtual antlrcpp::Any visitCOMPARE_EXPR(CMParser::COMPARE_EXPRContext *ctx) override;
     virtual antlrcpp::Any visitStatement(CMParser::StatementContext *ctx) override;
     virtual antlrcpp::Any visitReturnStatement(CMParser::ReturnStatementContext *ctx) override;
+    virtual antlrcpp::Any visitBreakStatement(CMParser::BreakStatementContext *ctx) override;
+    virtual antlrcpp::Any visitContinueStatement(CMParser::ContinueStatementContext *ctx) override;
     virtual antlrcpp::Any visitIfStatement(CMParser::IfStatementContext *ctx) override;
     virtual antlrcpp::Any visitElseStatement(CMParser::ElseStatementContext *ctx) override;
     virtual antlrcpp::Any visitForStatement(CMParser::ForStatementContext *ctx) override;
     virtual antlrcpp::Any visitWhileStatement(CMParser::WhileStatementContext *ctx) override;
     virtual antlrcpp::Any visitDoWhileStatement(CMParser::DoWhileStatementContext *ctx) override;
+    virtual antlrcpp::Any visitSwitchStatement(CMParser::SwitchStatementContext *ctx) override;
     virtual antlrcpp::Any visitExpressionStatement(CMParser::ExpressionStatementContext *ctx) override;
     virtual antlrcpp::Any visitAssignment(CMParser::AssignmentContext *ctx) override;
     virtual antlrcpp::Any visitVariableDeclaration(CMParser::VariableDeclarationContext *ctx) override;
@@ -93,8 +91,11 @@ public:
     virtual antlrcpp::Any visitTypeIdentifier(CMParser::TypeIdentifierContext *ctx) override;
 
 private:
+    // The arena must outlive every node, so it is declared first.
+    AstArena::Ptr _arena;
     DeclarationContext _declContext;
     StringTable::Ptr _stringTable;
+    DataSegment::Ptr _dataSegment;
     std::vector<FuncDeclaration> _funcDecls;
     ModuleContext::Ptr _moduleContext;
     std::set<std::string> _includedModules;
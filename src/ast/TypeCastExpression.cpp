@@ -60,4 +60,27 @@ ExpressionValue TypeCastExpression::evaluate(vm::ExecutionContext *ctx) const
     return casted;
 }
 
+bool TypeCastExpression::isConstant() const
+{
+    return _expression->isConstant();
+}
+
+void TypeCastExpression::forEachChild(const ChildVisitor &visitor) const
+{
+    visitor(_expression.get());
+}
+
+bool TypeCastExpression::isEquivalent(const Expression *other) const
+{
+    auto cast = dynamic_cast<const TypeCastExpression*>(other);
+    return cast != nullptr
+        && cast->_type == _type
+        && _expression->isEquivalent(cast->_expression.get());
+}
+
+void TypeCastExpression::rewriteExpressions(const ExpressionRewriter &rewriter)
+{
+    rewriter(_expression);
+}
+
 }
@@ -12,6 +12,10 @@ public:
 
     TypeDecl getType() const override;
     ExpressionValue evaluate(vm::ExecutionContext *ctx) const override;
+    bool isConstant() const override;
+    void forEachChild(const ChildVisitor &visitor) const override;
+    bool isEquivalent(const Expression *other) const override;
+    void rewriteExpressions(const ExpressionRewriter &rewriter) override;
 
 private:
     TypeDecl _type;
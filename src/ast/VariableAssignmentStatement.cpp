@@ -1,5 +1,6 @@
 #include "VariableAssignmentStatement.h"
 #include "DeclarationContext.h"
+#include "FunctionCallExpression.h"
 
 #include "../vm/Variable.h"
 #include "../vm/ExecutionContext.h"
@@ -30,11 +31,21 @@ VariableAssignmentStatement::VariableAssignmentStatement(
     if (constAwareness == ConstAwareness::STRICT && _lvalue->getType().isConst()) {
         Throw(InvalidOperationException, "Cannot assign to a constant variable");
     }
+
+    _returnSlotCall = findReturnSlotCall();
 }
 
 
 void VariableAssignmentStatement::executeAssignment(vm::ExecutionContext *context) const
 {
+    if (_returnSlotCall != nullptr) {
+        vm::MemoryView view = _lvalue->getMemoryView(context);
+        vm::Variable returnBuffer(_returnSlotCall->getType(),
+                                  context->getMemory()->createInteriorAllocation(view.getAddress()));
+        _returnSlotCall->evaluateInto(context, &returnBuffer);
+        return;
+    }
+
     ExpressionValue value = _expression->evaluate(context);
     vm::MemoryView view = _lvalue->getMemoryView(context);
 
@@ -74,9 +85,10 @@ void VariableAssignmentStatement::executeAssignment(vm::ExecutionContext *contex
     }
 }
 
-void VariableAssignmentStatement::virtualExecute(vm::ExecutionContext *context) const
+Completion VariableAssignmentStatement::virtualExecute(vm::ExecutionContext *context) const
 {
     executeAssignment(context);
+    return Completion::NORMAL;
 }
 
 void VariableAssignmentStatement::handleStructAssignment(vm::ExecutionContext *execContext, 
@@ -92,4 +104,33 @@ void VariableAssignmentStatement::handleStructAssignment(vm::ExecutionContext *e
     dest.writeBuf(sourceBuf, structSize);
 }
 
+const FunctionCallExpression* VariableAssignmentStatement::findReturnSlotCall() const
+{
+    // Nothing the call does can move a variable, and the callee only
+    // writes the return buffer once it is done reading anything else
+    if (_lvalue->getType() != TypeDecl::STRUCT || !dynamic_cast<const VariableReference*>(_lvalue.get())) {
+        return nullptr;
+    }
+
+    auto call = dynamic_cast<const FunctionCallExpression*>(_expression.get());
+    return call != nullptr && call->getType() == TypeDecl::STRUCT ? call : nullptr;
+}
+
+const Lvalue* VariableAssignmentStatement::getLvalue() const
+{
+    return _lvalue.get();
+}
+
+void VariableAssignmentStatement::forEachChild(const ChildVisitor &visitor) const
+{
+    visitor(_lvalue.get());
+    visitor(_expression.get());
+}
+
+void VariableAssignmentStatement::rewriteExpressions(const ExpressionRewriter &rewriter)
+{
+    rewriter(_expression);
+    _returnSlotCall = findReturnSlotCall();
+}
+
 }
@@ -12,6 +12,7 @@ namespace cish::ast
 {
 
 class DeclarationContext;
+class FunctionCallExpression;
 
 class VariableAssignmentStatement: public Statement
 {
@@ -34,14 +35,22 @@ public:
     virtual ~VariableAssignmentStatement() = default;
 
     void executeAssignment(vm::ExecutionContext *context) const;
+    const Lvalue* getLvalue() const;
+    virtual void forEachChild(const ChildVisitor &visitor) const override;
+    virtual void rewriteExpressions(const ExpressionRewriter &rewriter) override;
 
 protected:
-    virtual void virtualExecute(vm::ExecutionContext *context) const override;
+    virtual Completion virtualExecute(vm::ExecutionContext *context) const override;
 
 private:
     Lvalue::Ptr _lvalue;
     Expression::Ptr _expression;
 
+    // Set if the assigned value is a struct returned by a call, which
+    // can return it straight into the variable
+    const FunctionCallExpression *_returnSlotCall;
+
+    const FunctionCallExpression* findReturnSlotCall() const;
 
     void handleStructAssignment(vm::ExecutionContext *execContext, 
                                 vm::MemoryView &dest, 
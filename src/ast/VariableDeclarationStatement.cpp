@@ -1,6 +1,7 @@
 #include "VariableDeclarationStatement.h"
 #include "DeclarationContext.h"
 #include "VariableAssignmentStatement.h"
+#include "DataSegment.h"
 
 #include "../vm/ExecutionContext.h"
 #include "../vm/Variable.h"
@@ -15,9 +16,14 @@ VariableDeclarationStatement::VariableDeclarationStatement(
         Expression::Ptr value):
     _type(type),
     _varName(varName),
-    _assignment(nullptr)
+    _symbol(Symbol::intern(varName)),
+    _initialValue(value),
+    _assignment(nullptr),
+    _staticOffset(-1),
+    _register(VariableReference::NO_REGISTER)
 {
     context->declareVariable(type, _varName);
+    _localIndex = context->getLocalIndex(_symbol);
 
     if (value != nullptr) {
         Lvalue::Ptr varRef = Lvalue::Ptr(new VariableReference(context, varName));
@@ -31,16 +37,62 @@ const TypeDecl& VariableDeclarationStatement::getDeclaredType() const
     return _type;
 }
 
-void VariableDeclarationStatement::virtualExecute(vm::ExecutionContext *context) const
+SymbolId VariableDeclarationStatement::getSymbol() const
 {
-    vm::Allocation::Ptr alloc = context->getMemory()->allocate(_type.getSize());
-    vm::Variable *var = new vm::Variable(_type, std::move(alloc));
+    return _symbol;
+}
+
+uint32_t VariableDeclarationStatement::getLocalIndex() const
+{
+    return _localIndex;
+}
 
-    context->getScope()->addVariable(_varName, var);
+void VariableDeclarationStatement::setRegister(uint32_t reg)
+{
+    _register = reg;
+}
+
+bool VariableDeclarationStatement::allocateStatically(DataSegment *dataSegment)
+{
+    if (_initialValue == nullptr) {
+        _staticOffset = dataSegment->addObject(_type);
+    } else if (_initialValue->isConstant() && _type.getType() != TypeDecl::STRUCT) {
+        _staticOffset = dataSegment->addObject(_type, _initialValue->evaluate(nullptr));
+    }
+
+    return _staticOffset >= 0;
+}
+
+Completion VariableDeclarationStatement::virtualExecute(vm::ExecutionContext *context) const
+{
+    if (_staticOffset >= 0) {
+        vm::Allocation::Ptr alloc = context->getDataSegmentAllocation(_staticOffset);
+        context->getScope()->addVariable(_symbol, _type, std::move(alloc));
+        return Completion::NORMAL;
+    }
+
+    if (_register != VariableReference::NO_REGISTER) {
+        context->clearRegister(_register);
+    } else {
+        vm::Allocation::Ptr alloc = context->getMemory()->allocate(_type.getSize());
+        context->getScope()->addVariable(_symbol, _type, std::move(alloc));
+    }
 
     if (_assignment != nullptr) {
         ((const VariableAssignmentStatement*)_assignment.get())->executeAssignment(context);
     }
+    return Completion::NORMAL;
+}
+
+void VariableDeclarationStatement::forEachChild(const ChildVisitor &visitor) const
+{
+    // The assignment evaluates the initial value, unless it was placed
+    // in the data segment and is never evaluated at all
+    if (_assignment != nullptr) {
+        visitor(_assignment.get());
+    } else if (_initialValue != nullptr) {
+        visitor(_initialValue.get());
+    }
 }
 
 }
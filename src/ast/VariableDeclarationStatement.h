@@ -2,6 +2,7 @@
 
 #include "AstNodes.h"
 #include "VariableAssignmentStatement.h"
+#include "Symbol.h"
 
 
 namespace cish::vm
@@ -13,6 +14,7 @@ namespace cish::ast
 {
 
 class DeclarationContext;
+class DataSegment;
 class VariableAssignmentStatement;
 
 
@@ -27,14 +29,40 @@ public:
     virtual ~VariableDeclarationStatement() = default;
 
     const TypeDecl& getDeclaredType() const;
+    SymbolId getSymbol() const;
+
+    // See DeclarationContext::getLocalIndex()
+    uint32_t getLocalIndex() const;
+
+    /**
+     * Keep the variable in a register of the function frame instead of
+     * allocating it in memory, see RegisterAllocator. The references to
+     * the variable must be given the same register.
+     */
+    void setRegister(uint32_t reg);
+
+    /**
+     * Globals which are zero- or constant-initialized are given storage
+     * and their initial value in the data segment, so that declaring them
+     * neither allocates nor evaluates the initializer. Returns false if
+     * the initializer must be evaluated at runtime.
+     */
+    bool allocateStatically(DataSegment *dataSegment);
+
+    virtual void forEachChild(const ChildVisitor &visitor) const override;
 
 protected:
-    virtual void virtualExecute(vm::ExecutionContext *context) const override;
+    virtual Completion virtualExecute(vm::ExecutionContext *context) const override;
 
 private:
     const TypeDecl _type;
     const std::string _varName;
+    const SymbolId _symbol;
+    Expression::Ptr _initialValue;
     VariableAssignmentStatement::Ptr _assignment;
+    int64_t _staticOffset;
+    uint32_t _localIndex;
+    uint32_t _register;
 };
 
 }
@@ -16,18 +16,45 @@ WhileStatement::WhileStatement(Expression::Ptr condition):
 
 }
 
-void WhileStatement::virtualExecute(vm::ExecutionContext *context) const
+Completion WhileStatement::virtualExecute(vm::ExecutionContext *context) const
 {
-	context->pushScope();
+	if (requiresScope())
+		context->pushScope();
 
+	const Completion completion = runLoop(context);
+
+	if (requiresScope())
+		context->popScope();
+
+	return completion;
+}
+
+Completion WhileStatement::virtualResume(vm::ExecutionContext *context, const ResumePath &path, uint32_t level) const
+{
+	// Finish the iteration which was captured, then carry on as usual
+	Completion completion = resumeChildStatements(context, path, level);
+	if (completion != Completion::BREAK && completion != Completion::RETURN) {
+		synchronize(context);
+		completion = runLoop(context);
+	}
+
+	if (requiresScope())
+		context->popScope();
+
+	return completion == Completion::RETURN ? Completion::RETURN : Completion::NORMAL;
+}
+
+Completion WhileStatement::runLoop(vm::ExecutionContext *context) const
+{
+	Completion completion = Completion::NORMAL;
 	while (evaluateCondition(context)) {
-		executeChildStatements(context);
-		if (context->currentFunctionHasReturned())
+		completion = executeChildStatements(context);
+		if (completion == Completion::BREAK || completion == Completion::RETURN)
 			break;
         synchronize(context);
 	}
 
-	context->popScope();
+	return completion == Completion::RETURN ? Completion::RETURN : Completion::NORMAL;
 }
 
 bool WhileStatement::evaluateCondition(vm::ExecutionContext *context) const
@@ -45,18 +72,35 @@ DoWhileStatement
 DoWhileStatement::DoWhileStatement(Expression::Ptr condition)
 	: WhileStatement(condition) {}
 
-void DoWhileStatement::virtualExecute(vm::ExecutionContext *context) const
+Completion DoWhileStatement::virtualExecute(vm::ExecutionContext *context) const
 {
-	context->pushScope();
+	if (requiresScope())
+		context->pushScope();
 
+	Completion completion = Completion::NORMAL;
 	do {
-		executeChildStatements(context);
-		if (context->currentFunctionHasReturned())
+		completion = executeChildStatements(context);
+		if (completion == Completion::BREAK || completion == Completion::RETURN)
 			break;
         synchronize(context);
 	} while (evaluateCondition(context));
 
-	context->popScope();
+	if (requiresScope())
+		context->popScope();
+
+	return completion == Completion::RETURN ? Completion::RETURN : Completion::NORMAL;
+}
+
+void WhileStatement::forEachChild(const ChildVisitor &visitor) const
+{
+	visitor(_condition.get());
+
+	SuperStatement::forEachChild(visitor);
+}
+
+void WhileStatement::rewriteExpressions(const ExpressionRewriter &rewriter)
+{
+	rewriter(_condition);
 }
 
 }
@@ -12,11 +12,21 @@ class WhileStatement: public SuperStatement
 public:
 	WhileStatement(Expression::Ptr condition);
 	virtual ~WhileStatement() = default;
+	virtual void forEachChild(const ChildVisitor &visitor) const override;
+	virtual void rewriteExpressions(const ExpressionRewriter &rewriter) override;
 
 protected:
-	virtual void virtualExecute(vm::ExecutionContext *context) const override;
+	virtual Completion virtualExecute(vm::ExecutionContext *context) const override;
+	virtual Completion virtualResume(vm::ExecutionContext *context, const ResumePath &path, uint32_t level) const override;
 	bool evaluateCondition(vm::ExecutionContext *context) const;
 
+	/**
+	 * Iterate for as long as the condition holds. Also used to continue
+	 * resumed do-while loops, as they are equivalent after the first
+	 * iteration. Returns either RETURN or NORMAL.
+	 */
+	Completion runLoop(vm::ExecutionContext *context) const;
+
 private:
 	Expression::Ptr _condition;
 };
@@ -28,7 +38,7 @@ public:
 	DoWhileStatement(Expression::Ptr condition);
 
 protected:
-	virtual void virtualExecute(vm::ExecutionContext *context) const override;
+	virtual Completion virtualExecute(vm::ExecutionContext *context) const override;
 };
 
 }
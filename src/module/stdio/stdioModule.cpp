@@ -11,15 +11,13 @@ namespace cish::module::stdio
 using ast::TypeDecl;
 
 Module::Ptr buildModule() {
-                      FopenContext::Ptr fopenContext = FopenContext::Ptr(new FopenContext());
-
                       Module::Ptr module = Module::create("stdio.h");
                       module->addFunction(Function::Ptr(new impl::Puts()));
                       module->addFunction(Function::Ptr(new impl::Printf()));
-                      module->addFunction(Function::Ptr(new impl::Fopen(fopenContext)));
-                      module->addFunction(Function::Ptr(new impl::Fclose(fopenContext)));
-                      module->addFunction(Function::Ptr(new impl::Fgetc(fopenContext)));
-                      module->addFunction(Function::Ptr(new impl::Fgets(fopenContext)));
+                      module->addFunction(Function::Ptr(new impl::Fopen()));
+                      module->addFunction(Function::Ptr(new impl::Fclose()));
+                      module->addFunction(Function::Ptr(new impl::Fgetc()));
+                      module->addFunction(Function::Ptr(new impl::Fgets()));
                       return module;
                       }
 
@@ -49,7 +47,9 @@ ast::FuncDeclaration Puts::getSignature()
                 TypeDecl::getPointer(TypeDecl::getConst(TypeDecl::CHAR)),
                 "ptr"
             }
-        }
+        },
+        false,
+        FuncDeclaration::IO
     );
 }
 
@@ -88,7 +88,8 @@ ast::FuncDeclaration Printf::getSignature()
                 "s"
             }
         },
-        true
+        true,
+        FuncDeclaration::IO
     );
 }
 
@@ -215,9 +216,8 @@ ast::FuncDeclaration Fopen::getSignature()
     );
 }
 
-Fopen::Fopen(FopenContext::Ptr fopenContext):
-    Function(getSignature()),
-    _fopenContext(fopenContext)
+Fopen::Fopen():
+    Function(getSignature())
 {
 
 }
@@ -236,7 +236,7 @@ ast::ExpressionValue Fopen::execute(vm::ExecutionContext *context, FuncParams pa
     std::vector<char> mode;
     utils::readString(view, mode);
 
-    int32_t handle = _fopenContext->fopen(path.data(), mode.data());
+    int32_t handle = context->getFopenContext()->fopen(path.data(), mode.data());
 
     TypeDecl returnType = TypeDecl::getPointer(TypeDecl::INT);
 
@@ -267,16 +267,15 @@ ast::FuncDeclaration Fclose::getSignature()
     );
 }
 
-Fclose::Fclose(FopenContext::Ptr fopenContext):
-    Function(getSignature()),
-    _fopenContext(fopenContext)
+Fclose::Fclose():
+    Function(getSignature())
 {
 }
 
 ast::ExpressionValue Fclose::execute(vm::ExecutionContext *context, FuncParams params, vm::Variable*) const
 {
     const int32_t handle = params[0].get<int32_t>();
-    const int result = _fopenContext->fclose(handle);
+    const int result = context->getFopenContext()->fclose(handle);
     return ast::ExpressionValue(TypeDecl::INT, result);
 }
 
@@ -300,16 +299,15 @@ ast::FuncDeclaration Fgetc::getSignature()
     );
 }
 
-Fgetc::Fgetc(FopenContext::Ptr fopenContext):
-    Function(getSignature()),
-    _fopenContext(fopenContext)
+Fgetc::Fgetc():
+    Function(getSignature())
 {
 }
 
 ast::ExpressionValue Fgetc::execute(vm::ExecutionContext *context, FuncParams params, vm::Variable*) const
 {
     const int32_t handle = params[0].get<int32_t>();
-    const int result = _fopenContext->fgetc(handle);
+    const int result = context->getFopenContext()->fgetc(handle);
     return ast::ExpressionValue(TypeDecl::INT, result);
 }
 
@@ -341,9 +339,8 @@ ast::FuncDeclaration Fgets::getSignature()
     );
 }
 
-Fgets::Fgets(FopenContext::Ptr fopenContext):
-    Function(getSignature()),
-    _fopenContext(fopenContext)
+Fgets::Fgets():
+    Function(getSignature())
 {
 }
 
@@ -354,7 +351,7 @@ ast::ExpressionValue Fgets::execute(vm::ExecutionContext *context, FuncParams pa
     const int32_t fileHandle = params[2].get<int32_t>();
 
     std::string result;
-    if (!_fopenContext->fgets(&result, strSize, fileHandle)) {
+    if (!context->getFopenContext()->fgets(&result, strSize, fileHandle)) {
         return ast::ExpressionValue(TypeDecl::getPointer(TypeDecl::CHAR), 0);
     }
 
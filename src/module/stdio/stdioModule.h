@@ -1,6 +1,5 @@
 #pragma once
 
-#include "FopenContext.h"
 
 #include "../Module.h"
 #include "../Function.h"
@@ -51,14 +50,11 @@ class Fopen: public Function
 public:
     static ast::FuncDeclaration getSignature();
 
-    Fopen(FopenContext::Ptr fopenContext);
+    Fopen();
 
     ast::ExpressionValue execute(vm::ExecutionContext *context,
                                  FuncParams params,
                                  vm::Variable*) const override;
-
-private:
-    FopenContext::Ptr _fopenContext;
 };
 
 class Fclose: public Function
@@ -66,14 +62,11 @@ class Fclose: public Function
 public:
     static ast::FuncDeclaration getSignature();
 
-    Fclose(FopenContext::Ptr fopenContext);
+    Fclose();
 
     ast::ExpressionValue execute(vm::ExecutionContext *context,
                                  FuncParams params,
                                  vm::Variable*) const override;
-
-private:
-    FopenContext::Ptr _fopenContext;
 };
 
 class Fgetc: public Function
@@ -81,14 +74,11 @@ class Fgetc: public Function
 public:
     static ast::FuncDeclaration getSignature();
 
-    Fgetc(FopenContext::Ptr fopenContext);
+    Fgetc();
 
     ast::ExpressionValue execute(vm::ExecutionContext *context,
                                  FuncParams params,
                                  vm::Variable*) const override;
-
-private:
-    FopenContext::Ptr _fopenContext;
 };
 
 class Fgets: public Function
@@ -96,14 +86,11 @@ class Fgets: public Function
 public:
     static ast::FuncDeclaration getSignature();
 
-    Fgets(FopenContext::Ptr fopenContext);
+    Fgets();
 
     ast::ExpressionValue execute(vm::ExecutionContext *context,
                                  FuncParams params,
                                  vm::Variable*) const override;
-
-private:
-    FopenContext::Ptr _fopenContext;
 };
 
 }
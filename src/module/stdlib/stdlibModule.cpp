@@ -4,6 +4,7 @@
 #include "../../ast/Type.h"
 #include "../../vm/Allocation.h"
 #include "../../vm/ExecutionContext.h"
+#include "../../vm/MallocContext.h"
 #include "../../vm/Memory.h"
 
 
@@ -11,16 +12,14 @@ namespace cish::module::stdlib
 {
 
 Module::Ptr buildModule() {
-                      MallocContext::Ptr mallocContext = MallocContext::Ptr(new MallocContext());
-
                       Module::Ptr module = Module::create("stdlib.h");
                       module->addFunction(Function::Ptr(new impl::Atof()));
                       module->addFunction(Function::Ptr(new impl::Atoi()));
                       module->addFunction(Function::Ptr(new impl::Atol()));
                       module->addFunction(Function::Ptr(new impl::Rand()));
                       module->addFunction(Function::Ptr(new impl::Srand()));
-                      module->addFunction(Function::Ptr(new impl::Malloc(mallocContext)));
-                      module->addFunction(Function::Ptr(new impl::Free(mallocContext)));
+                      module->addFunction(Function::Ptr(new impl::Malloc()));
+                      module->addFunction(Function::Ptr(new impl::Free()));
 
                       return module;
                       }
@@ -56,6 +55,8 @@ ast::FuncDeclaration Atof::getSignature()
         }
     );
 
+    decl.effects = FuncDeclaration::PURE;
+
     return decl;
 }
 
@@ -95,6 +96,8 @@ ast::FuncDeclaration Atoi::getSignature()
         }
     );
 
+    decl.effects = FuncDeclaration::PURE;
+
     return decl;
 }
 
@@ -134,6 +137,8 @@ ast::FuncDeclaration Atol::getSignature()
         }
     );
 
+    decl.effects = FuncDeclaration::PURE;
+
     return decl;
 }
 
@@ -171,7 +176,7 @@ ast::ExpressionValue Rand::execute(vm::ExecutionContext *context,
                                    FuncParams params,
                                    vm::Variable*) const
 {
-    return ExpressionValue(TypeDecl::INT, (int)rand());
+    return ExpressionValue(TypeDecl::INT, context->getRandContext()->next());
 }
 
 
@@ -195,7 +200,7 @@ ast::ExpressionValue Srand::execute(vm::ExecutionContext *context,
                                     FuncParams params,
                                     vm::Variable*) const
 {
-    srand(params[0].get<int>());
+    context->getRandContext()->seed(params[0].get<uint32_t>());
     return ExpressionValue(TypeDecl::VOID);
 }
 
@@ -214,26 +219,17 @@ ast::FuncDeclaration Malloc::getSignature()
     );
 }
 
-Malloc::Malloc(MallocContext::Ptr mallocContext):
-    Function(getSignature()),
-    _mallocContext(mallocContext)
+Malloc::Malloc():
+    Function(getSignature())
 {}
 
 ast::ExpressionValue Malloc::execute(vm::ExecutionContext *context,
                                      FuncParams params,
                                      vm::Variable*) const
 {
-    try {
-        const uint32_t size = params[0].get<uint32_t>();
-        Allocation::Ptr alloc = context->getMemory()->allocate(size);
-
-        const uint32_t addr = alloc->getAddress();
-        _mallocContext->onAllocation(std::move(alloc));
-
-        return ExpressionValue(TypeDecl::getPointer(TypeDecl::VOID), addr);
-    } catch (const vm::AllocationFailedException &e) {
-        return ExpressionValue(TypeDecl::getPointer(TypeDecl::VOID), 0);
-    }
+    const uint32_t size = params[0].get<uint32_t>();
+    const uint32_t addr = context->getMallocContext()->allocate(size, context->getCurrentFunctionName());
+    return ExpressionValue(TypeDecl::getPointer(TypeDecl::VOID), addr);
 }
 
 
@@ -251,9 +247,8 @@ ast::FuncDeclaration Free::getSignature()
     );
 }
 
-Free::Free(MallocContext::Ptr mallocContext):
-    Function(getSignature()),
-    _mallocContext(mallocContext)
+Free::Free():
+    Function(getSignature())
 {}
 
 ast::ExpressionValue Free::execute(vm::ExecutionContext *context,
@@ -261,7 +256,7 @@ ast::ExpressionValue Free::execute(vm::ExecutionContext *context,
                                      vm::Variable*) const
 {
     const uint32_t addr = params[0].get<uint32_t>();
-    if (!_mallocContext->attemptDeallocation(addr)) {
+    if (!context->getMallocContext()->attemptDeallocation(addr)) {
         Throw(StdlibException,
             "buffer %x was not allocated with malloc or has already been freed",
             addr);
@@ -1,7 +1,5 @@
 #pragma once
 
-#include "MallocContext.h"
-
 #include "../Module.h"
 #include "../Function.h"
 #include "../../ast/FuncDeclaration.h"
@@ -76,12 +74,10 @@ class Malloc: public Function
 public:
     static ast::FuncDeclaration getSignature();
 
-    Malloc(MallocContext::Ptr mallocContext);
+    Malloc();
     ast::ExpressionValue execute(vm::ExecutionContext *context,
                                  FuncParams params,
                                  vm::Variable*) const override;
-private:
-    MallocContext::Ptr _mallocContext;
 };
 
 class Free: public Function
@@ -89,12 +85,10 @@ class Free: public Function
 public:
     static ast::FuncDeclaration getSignature();
 
-    Free(MallocContext::Ptr mallocContext);
+    Free();
     ast::ExpressionValue execute(vm::ExecutionContext *context,
                                  FuncParams params,
                                  vm::Variable*) const override;
-private:
-    MallocContext::Ptr _mallocContext;
 };
 
 }
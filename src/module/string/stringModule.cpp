@@ -53,7 +53,9 @@ ast::FuncDeclaration Memchr::getSignature()
                 TypeDecl::INT,
                 "n"
             }
-        }
+        },
+        false,
+        FuncDeclaration::PURE
     );
 }
 
@@ -104,7 +106,9 @@ ast::FuncDeclaration Memcmp::getSignature()
                 TypeDecl::INT,
                 "n"
             }
-        }
+        },
+        false,
+        FuncDeclaration::PURE
     );
 }
 
@@ -363,7 +367,9 @@ ast::FuncDeclaration Strchr::getSignature()
                 TypeDecl::INT,
                 "character"
             }
-        }
+        },
+        false,
+        FuncDeclaration::PURE
     );
 }
 
@@ -416,7 +422,9 @@ ast::FuncDeclaration Strstr::getSignature()
                 TypeDecl::getPointer(TypeDecl::getConst(TypeDecl::CHAR)),
                 "needle"
             }
-        }
+        },
+        false,
+        FuncDeclaration::PURE
     );
 }
 
@@ -465,7 +473,9 @@ ast::FuncDeclaration Strcmp::getSignature()
                 TypeDecl::getPointer(TypeDecl::getConst(TypeDecl::CHAR)),
                 "str2"
             }
-        }
+        },
+        false,
+        FuncDeclaration::PURE
     );
 }
 
@@ -519,7 +529,9 @@ ast::FuncDeclaration Strncmp::getSignature()
                 TypeDecl::INT,
                 "n"
             }
-        }
+        },
+        false,
+        FuncDeclaration::PURE
     );
 }
 
@@ -673,7 +685,9 @@ ast::FuncDeclaration Strlen::getSignature()
                 TypeDecl::getPointer(TypeDecl::getConst(TypeDecl::CHAR)),
                 "str"
             }
-        }
+        },
+        false,
+        FuncDeclaration::PURE
     );
 }
 
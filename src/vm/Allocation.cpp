@@ -67,9 +67,9 @@ Allocation::Allocation(MemoryAccess *memAccess, uint32_t offset):
 {
 }
 
-Allocation::~Allocation()
+void Allocation::Deleter::operator()(Allocation *allocation) const
 {
-    _memoryAccess->onDeallocation(this);
+    allocation->_memoryAccess->onDeallocation(allocation);
 }
 
 }
@@ -19,6 +19,11 @@ class MemoryAccess
 public:
     virtual ~MemoryAccess() = default;
 
+    /**
+     * Called when an Allocation::Ptr releases its Allocation. The
+     * MemoryAccess owns the Allocation object itself, and is responsible
+     * for destroying it.
+     */
     virtual void onDeallocation(Allocation *allocation) = 0;
     virtual const uint8_t* read(uint32_t address, uint32_t len) = 0;
     virtual void write(const uint8_t *buffer, uint32_t address, uint32_t len) = 0;
@@ -80,16 +85,23 @@ void MemoryView::write(T value, uint32_t offset)
 ==================
 Allocation
 
-An allocated (i.e., owned & safe) chunk of memory.
+An allocated (i.e., owned & safe) chunk of memory. The
+Allocation object is owned by the MemoryAccess which created
+it, and is handed back to it when the Ptr is released.
 ==================
 */
 class Allocation: public MemoryView
 {
 public:
-    typedef std::unique_ptr<Allocation> Ptr;
+    struct Deleter
+    {
+        void operator()(Allocation *allocation) const;
+    };
+
+    typedef std::unique_ptr<Allocation, Deleter> Ptr;
 
     Allocation(MemoryAccess *memAccess, uint32_t addr);
-    ~Allocation();
+    ~Allocation() = default;
 };
 
 }
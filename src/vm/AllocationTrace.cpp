@@ -0,0 +1,89 @@
+#include "AllocationTrace.h"
+#include "ExecutionContext.h"
+
+
+namespace cish::vm
+{
+
+static const char TRACE_MAGIC[8] = { 'C', 'I', 'S', 'H', 'T', 'R', 'C', '1' };
+static const size_t TRACE_BUFFER_SIZE = 1 << 16;
+
+
+AllocationTrace::AllocationTrace(const std::string &path, const ExecutionContext *context):
+    _context(context)
+{
+    _file = fopen(path.c_str(), "wb");
+    if (!_file) {
+        Throw(AllocationTraceException, "Unable to open allocation trace '%s'", path.c_str());
+    }
+
+    setvbuf(_file, nullptr, _IOFBF, TRACE_BUFFER_SIZE);
+    fwrite(TRACE_MAGIC, 1, sizeof(TRACE_MAGIC), _file);
+}
+
+AllocationTrace::~AllocationTrace()
+{
+    fclose(_file);
+}
+
+void AllocationTrace::flush()
+{
+    fflush(_file);
+}
+
+void AllocationTrace::onAllocate(uint32_t address, uint32_t size)
+{
+    writeRecord('A', address, size);
+}
+
+void AllocationTrace::onFree(uint32_t address, uint32_t size)
+{
+    writeRecord('D', address, size);
+}
+
+
+uint32_t AllocationTrace::getCallSiteId()
+{
+    const std::string *name = _context->getCurrentFunctionName();
+    if (name == nullptr) {
+        return 0;
+    }
+
+    auto it = _functionIds.find(name);
+    if (it != _functionIds.end()) {
+        return it->second;
+    }
+
+    const uint32_t id = (uint32_t)_functionIds.size() + 1;
+    _functionIds[name] = id;
+
+    fputc('F', _file);
+    writeU32(id);
+    writeU32((uint32_t)name->length());
+    fwrite(name->data(), 1, name->length(), _file);
+
+    return id;
+}
+
+void AllocationTrace::writeRecord(char tag, uint32_t address, uint32_t size)
+{
+    const uint32_t callSite = getCallSiteId();
+
+    fputc(tag, _file);
+    writeU32(address);
+    writeU32(size);
+    writeU32(callSite);
+}
+
+void AllocationTrace::writeU32(uint32_t value)
+{
+    const uint8_t bytes[4] = {
+        (uint8_t)(value),
+        (uint8_t)(value >> 8),
+        (uint8_t)(value >> 16),
+        (uint8_t)(value >> 24),
+    };
+    fwrite(bytes, 1, sizeof(bytes), _file);
+}
+
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "MemoryStats.h"
+#include "../Exception.h"
+
+#include <stdio.h>
+#include <string>
+#include <unordered_map>
+
+
+namespace cish::vm
+{
+
+DECLARE_EXCEPTION(AllocationTraceException);
+
+class ExecutionContext;
+
+/**
+ * Writes every allocation and deallocation to a binary log, tagged with
+ * the function executing at the time.
+ *
+ * All integers are little endian. The file starts with the 8 byte magic
+ * "CISHTRC1", followed by a stream of records, each starting with a one
+ * byte tag:
+ *
+ *   'F' u32 functionId, u32 length, char[length] name
+ *       Defines a function name. Emitted the first time a function
+ *       is seen. Function id 0 is the global scope.
+ *
+ *   'A' u32 address, u32 size, u32 functionId
+ *       An allocation of 'size' bytes at 'address'.
+ *
+ *   'D' u32 address, u32 size, u32 functionId
+ *       Deallocation of the allocation at 'address'.
+ */
+class AllocationTrace: public AllocationObserver
+{
+public:
+    AllocationTrace(const std::string &path, const ExecutionContext *context);
+    ~AllocationTrace();
+
+    AllocationTrace(const AllocationTrace&) = delete;
+    AllocationTrace& operator=(const AllocationTrace&) = delete;
+
+    void flush();
+
+    /* AllocationObserver */
+    void onAllocate(uint32_t address, uint32_t size) override;
+    void onFree(uint32_t address, uint32_t size) override;
+
+private:
+    FILE *_file;
+    const ExecutionContext *_context;
+    std::unordered_map<const std::string*, uint32_t> _functionIds;
+
+    uint32_t getCallSiteId();
+    void writeRecord(char tag, uint32_t address, uint32_t size);
+    void writeU32(uint32_t value);
+};
+
+}
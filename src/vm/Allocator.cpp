@@ -1,5 +1,7 @@
 #include "Allocator.h"
 
+#include <algorithm>
+
 
 namespace cish::vm::internal
 {
@@ -37,32 +39,82 @@ namespace cish::vm
 {
 
 Allocator::Allocator(uint32_t size):
-    _size(size)
+    _size(size),
+    _freeSize(size),
+    _largestFreeHint(size)
 {
     Block block = { 0, _size };
     _blocks.push_back(block);
 }
 
+Allocator::Allocator(uint32_t size, const std::list<Block> &freeBlocks):
+    _blocks(freeBlocks),
+    _size(size),
+    _freeSize(0),
+    _largestFreeHint(0)
+{
+    uint32_t end = 0;
+    for (const Block &block: _blocks) {
+        if (block.offset < end || block.length > _size - block.offset) {
+            Throw(InvalidDeallocationException, "Invalid free block [%u, +%u)", block.offset, block.length);
+        }
+
+        end = block.offset + block.length;
+        _freeSize += block.length;
+        _largestFreeHint = std::max(_largestFreeHint, block.length);
+    }
+}
+
 uint32_t Allocator::allocate(uint32_t size)
 {
+    uint32_t offset;
+    if (!tryAllocate(size, &offset)) {
+        Throw(AllocationFailedException, "Failed to allocate %d units", size);
+    }
+
+    return offset;
+}
+
+bool Allocator::tryAllocate(uint32_t size, uint32_t *offset)
+{
+    if (size > _freeSize || size > _largestFreeHint) {
+        return false;
+    }
+
+    uint32_t largest = 0;
 	for (auto it = _blocks.begin(); it != _blocks.end(); it++) {
         if (it->length >= size) {
-            uint32_t addr = it->offset;
+            *offset = it->offset;
             it->offset += size;
             it->length -= size;
+            _freeSize -= size;
 
             if (it->length == 0) {
                 _blocks.erase(it);
             }
 
-            return addr;
+            return true;
         }
+
+        largest = std::max(largest, it->length);
 	}
 
-    Throw(AllocationFailedException, "Failed to allocate %d units", size);
+    // We've seen every block, so the hint can be made exact
+    _largestFreeHint = largest;
+    return false;
+}
+
+Allocator::Block Allocator::deallocate(uint32_t offset, uint32_t size)
+{
+    const Block block = mergeFreeBlock(offset, size);
+
+    _freeSize += size;
+    _largestFreeHint = std::max(_largestFreeHint, block.length);
+
+    return block;
 }
 
-void Allocator::deallocate(uint32_t offset, uint32_t size)
+Allocator::Block Allocator::mergeFreeBlock(uint32_t offset, uint32_t size)
 {
     // lowerBoundOffset returns the position that would come *AFTER* a block at 'offset'.
     auto upper = internal::lowerBoundOffset(_blocks.begin(), _blocks.end(), offset);
@@ -76,23 +128,32 @@ void Allocator::deallocate(uint32_t offset, uint32_t size)
             lower->length += upper->length;
             _blocks.erase(upper);
         }
+
+        return *lower;
     } else if (upper != _blocks.end() && offset + size == upper->offset) {
         upper->offset -= size;
         upper->length += size;
+        return *upper;
     } else {
         Block block = { offset, size };
         _blocks.insert(upper, block);
+        return block;
     }
 }
 
 uint32_t Allocator::getFreeSize() const
 {
-    uint32_t sum = 0;
+    return _freeSize;
+}
+
+uint32_t Allocator::getLargestFreeBlock() const
+{
+    uint32_t largest = 0;
     for (const auto &block: _blocks) {
-        sum += block.length;
+        largest = std::max(largest, block.length);
     }
 
-    return sum;
+    return largest;
 }
 
 const std::list<Allocator::Block>& Allocator::getBlocksByOffset() const
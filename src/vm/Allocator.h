@@ -22,18 +22,53 @@ public:
 
     Allocator(uint32_t size);
 
+    /**
+     * Restore an allocator of 'size' units with the given free blocks,
+     * as returned by getBlocksByOffset().
+     */
+    Allocator(uint32_t size, const std::list<Block> &freeBlocks);
+
 	uint32_t allocate(uint32_t size);
-    void deallocate(uint32_t offset, uint32_t size);
+
+    /**
+     * Non-throwing variant of allocate(). Returns false if no free block
+     * is large enough. Allocations which are larger than the largest
+     * free block seen so far fail without scanning the free list.
+     */
+    bool tryAllocate(uint32_t size, uint32_t *offset);
+
+    /**
+     * Returns the free block which the deallocated range ended up in,
+     * after it has been coalesced with any adjacent free blocks.
+     */
+    Block deallocate(uint32_t offset, uint32_t size);
 
     uint32_t getFreeSize() const;
 
-    // !! Should only be used for test purposes !! //
+    /**
+     * Exact size of the largest free block. This walks the free list,
+     * and is intended for diagnostics only.
+     */
+    uint32_t getLargestFreeBlock() const;
+
+    /**
+     * The free blocks in ascending order. Exposed for tests and for
+     * writing checkpoints only.
+     */
     const std::list<Block>& getBlocksByOffset() const;
 
 private:
     std::list<Block> _blocks;
 
     uint32_t _size;
+    uint32_t _freeSize;
+
+    // Upper bound on the largest free block. It is raised whenever a
+    // free creates a larger block, and lowered to the exact value when
+    // a scan of the free list fails.
+    uint32_t _largestFreeHint;
+
+    Block mergeFreeBlock(uint32_t offset, uint32_t size);
 };
 
 }
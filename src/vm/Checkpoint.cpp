@@ -0,0 +1,643 @@
+#include "Checkpoint.h"
+#include "../ast/LiteralExpression.h"
+#include "../ast/MurmurHash2.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <list>
+#include <typeinfo>
+#include <vector>
+
+
+namespace cish::vm
+{
+
+static const char CHECKPOINT_MAGIC[8] = { 'C', 'I', 'S', 'H', 'C', 'K', 'P', '3' };
+static const uint8_t KIND_FULL = 'F';
+static const uint8_t KIND_INCREMENTAL = 'I';
+static const size_t RECORD_HEADER_SIZE = sizeof(CHECKPOINT_MAGIC) + 1 + 8;
+static const size_t RECORD_TRAILER_SIZE = 4;
+
+
+static uint32_t hashNode(const ast::AstNode *node, uint32_t hash)
+{
+    const char *nodeType = typeid(*node).name();
+    hash = ast::MurmurHash2(nodeType, (int)strlen(nodeType), hash);
+
+    if (auto literal = dynamic_cast<const ast::LiteralExpression*>(node)) {
+        const ast::ExpressionValue value = literal->evaluate(nullptr);
+        const uint8_t type = (uint8_t)value.getIntrinsicType().getType();
+        const int64_t ival = value.get<int64_t>();
+        const double fval = value.get<double>();
+        hash = ast::MurmurHash2(&type, sizeof(type), hash);
+        hash = ast::MurmurHash2(&ival, sizeof(ival), hash);
+        hash = ast::MurmurHash2(&fval, sizeof(fval), hash);
+    }
+
+    uint32_t numChildren = 0;
+    node->forEachChild([&](const ast::AstNode *child) {
+        hash = hashNode(child, hash);
+        numChildren++;
+    });
+
+    return ast::MurmurHash2(&numChildren, sizeof(numChildren), hash);
+}
+
+/**
+ * Identifies the program a checkpoint was taken from. Resume paths are
+ * indices into the statements of the program, so resuming a different
+ * program must be refused. Besides the data segment and the names of the
+ * functions, the shape of every statement and expression is hashed, so
+ * editing a function body is caught even when no name or string changes.
+ */
+static uint32_t getProgramFingerprint(const ast::Ast *ast)
+{
+    uint32_t hash = 0;
+
+    const ast::DataSegment *dataSegment = ast->getDataSegment();
+    if (dataSegment) {
+        hash = ast::MurmurHash2(dataSegment->getData(), dataSegment->getSize(), hash);
+    }
+
+    for (const ast::Statement::Ptr &statement: ast->getRootStatements()) {
+        hash = hashNode(statement.get(), hash);
+    }
+
+    for (const Callable::Ptr &func: ast->getFunctionDefinitions()) {
+        hash = ast::MurmurHash2(func->getDeclaration()->name, hash);
+
+        if (auto funcDef = dynamic_cast<const ast::FunctionDefinition*>(func.get())) {
+            hash = hashNode(funcDef, hash);
+        }
+    }
+
+    return hash;
+}
+
+
+/*
+==============
+Encoding
+==============
+*/
+class RecordWriter
+{
+public:
+    void u8(uint8_t value)
+    {
+        _buffer.push_back(value);
+    }
+
+    void u32(uint32_t value)
+    {
+        for (int i=0; i<4; i++) {
+            _buffer.push_back((uint8_t)(value >> (i * 8)));
+        }
+    }
+
+    void u64(uint64_t value)
+    {
+        for (int i=0; i<8; i++) {
+            _buffer.push_back((uint8_t)(value >> (i * 8)));
+        }
+    }
+
+    void bytes(const void *data, size_t len)
+    {
+        const uint8_t *ptr = (const uint8_t*)data;
+        _buffer.insert(_buffer.end(), ptr, ptr + len);
+    }
+
+    void string(const std::string &str)
+    {
+        u32((uint32_t)str.size());
+        bytes(str.data(), str.size());
+    }
+
+    void type(const ast::TypeDecl &type)
+    {
+        u8((uint8_t)type.getType());
+        u8(type.isConst() ? 1 : 0);
+
+        if (type == ast::TypeDecl::POINTER) {
+            this->type(*type.getReferencedType());
+        } else if (type == ast::TypeDecl::STRUCT) {
+            string(type.getStructLayout()->getName());
+        }
+    }
+
+    void variables(const std::vector<ExecutionContext::Snapshot::NamedVariable> &vars)
+    {
+        u32((uint32_t)vars.size());
+        for (const auto &var: vars) {
+            string(var.name);
+            type(var.type);
+            u32(var.address);
+        }
+    }
+
+    const std::vector<uint8_t>& getBuffer() const
+    {
+        return _buffer;
+    }
+
+private:
+    std::vector<uint8_t> _buffer;
+};
+
+
+class RecordReader
+{
+public:
+    RecordReader(const uint8_t *data, size_t len, ast::Ast::Ptr ast):
+        _data(data),
+        _len(len),
+        _pos(0),
+        _ast(ast)
+    {
+    }
+
+    uint8_t u8()
+    {
+        return *take(1);
+    }
+
+    uint32_t u32()
+    {
+        const uint8_t *ptr = take(4);
+        uint32_t value = 0;
+        for (int i=0; i<4; i++) {
+            value |= (uint32_t)ptr[i] << (i * 8);
+        }
+        return value;
+    }
+
+    uint64_t u64()
+    {
+        const uint8_t *ptr = take(8);
+        uint64_t value = 0;
+        for (int i=0; i<8; i++) {
+            value |= (uint64_t)ptr[i] << (i * 8);
+        }
+        return value;
+    }
+
+    const uint8_t* bytes(size_t len)
+    {
+        return take(len);
+    }
+
+    std::string string()
+    {
+        const uint32_t len = u32();
+        const uint8_t *ptr = take(len);
+        return std::string((const char*)ptr, len);
+    }
+
+    ast::TypeDecl type()
+    {
+        const uint8_t typeValue = u8();
+        const bool isConst = u8() != 0;
+
+        ast::TypeDecl result;
+        if (typeValue == ast::TypeDecl::POINTER) {
+            result = ast::TypeDecl::getPointer(type());
+        } else if (typeValue == ast::TypeDecl::STRUCT) {
+            const std::string name = string();
+            const ast::StructLayout *layout = _ast->getStructLayout(name);
+            if (!layout) {
+                Throw(CheckpointException, "Checkpoint refers to unknown struct '%s'", name.c_str());
+            }
+            result = ast::TypeDecl::getStruct(layout);
+        } else if (typeValue < ast::TypeDecl::POINTER) {
+            result = ast::TypeDecl((ast::TypeDecl::Type)typeValue);
+        } else {
+            Throw(CheckpointException, "Checkpoint contains invalid type %u", typeValue);
+        }
+
+        result.setConst(isConst);
+        return result;
+    }
+
+    std::vector<ExecutionContext::Snapshot::NamedVariable> variables()
+    {
+        std::vector<ExecutionContext::Snapshot::NamedVariable> vars(u32());
+        for (auto &var: vars) {
+            var.name = string();
+            var.type = type();
+            var.address = u32();
+        }
+        return vars;
+    }
+
+    // Function names are resolved to the name owned by the definition,
+    // as the VM identifies functions by the address of their name.
+    const std::string* functionName()
+    {
+        const std::string name = string();
+        if (name.empty()) {
+            return nullptr;
+        }
+
+        const Callable::Ptr func = _ast->getFunctionDefinition(name);
+        if (!func) {
+            Throw(CheckpointException, "Checkpoint refers to unknown function '%s'", name.c_str());
+        }
+        return &func->getDeclaration()->name;
+    }
+
+private:
+    const uint8_t *_data;
+    size_t _len;
+    size_t _pos;
+    ast::Ast::Ptr _ast;
+
+    const uint8_t* take(size_t len)
+    {
+        if (len > _len - _pos) {
+            Throw(CheckpointException, "Checkpoint record is truncated");
+        }
+
+        const uint8_t *ptr = _data + _pos;
+        _pos += len;
+        return ptr;
+    }
+};
+
+
+static void writeFile(FILE *file, const std::vector<uint8_t> &record, const std::string &path)
+{
+    const bool ok = fwrite(record.data(), 1, record.size(), file) == record.size()
+                 && fflush(file) == 0
+                 && fsync(fileno(file)) == 0;
+
+    if (fclose(file) != 0 || !ok) {
+        Throw(CheckpointException, "Failed to write checkpoint '%s'", path.c_str());
+    }
+}
+
+
+/*
+==============
+CheckpointWriter
+==============
+*/
+CheckpointWriter::CheckpointWriter(const std::string &path, const ast::Ast *ast, uint32_t fullInterval):
+    _path(path),
+    _fingerprint(getProgramFingerprint(ast)),
+    _fullInterval(fullInterval),
+    _checkpointCount(0),
+    _needsFullCheckpoint(true)
+{
+}
+
+void CheckpointWriter::write(Memory *memory, const ExecutionContext *context)
+{
+    // Fails if the context is not at a resumable point, so do it first
+    const ExecutionContext::Snapshot contextSnapshot = context->createSnapshot();
+
+    const bool full = _needsFullCheckpoint || (_fullInterval != 0 && _checkpointCount % _fullInterval == 0);
+    _needsFullCheckpoint = true;
+
+    RecordWriter payload;
+    payload.u32(_fingerprint);
+
+    // Allocator state
+    const Memory::Snapshot::Ptr memorySnapshot = memory->createSnapshot(false);
+    payload.u32(memorySnapshot->heapSize);
+    payload.u32(memorySnapshot->minAllocSize);
+
+    const std::list<Allocator::Block> &freeBlocks = memorySnapshot->allocator.getBlocksByOffset();
+    payload.u32((uint32_t)freeBlocks.size());
+    for (const Allocator::Block &block: freeBlocks) {
+        payload.u32(block.offset);
+        payload.u32(block.length);
+    }
+
+    // Only the allocation starts are stored, the table is mostly zeros
+    // and the allocation map follows from it
+    const std::vector<uint32_t> &allocationUnits = memorySnapshot->allocationUnits;
+    payload.u32((uint32_t)allocationUnits.size());
+    payload.u32((uint32_t)(allocationUnits.size() - std::count(allocationUnits.begin(), allocationUnits.end(), 0)));
+    for (uint32_t unit=0; unit<allocationUnits.size(); unit++) {
+        if (allocationUnits[unit] != 0) {
+            payload.u32(unit);
+            payload.u32(allocationUnits[unit]);
+        }
+    }
+
+    payload.u32((uint32_t)sizeof(MemoryStats));
+    payload.bytes(&memorySnapshot->stats, sizeof(MemoryStats));
+
+    // Heap pages. The committed runs decide which pages exist after the
+    // record is applied, the page data what they contain.
+    std::vector<std::pair<uint64_t,uint64_t>> committedRuns;
+    memory->forEachCommittedRun([&](uint64_t offset, const uint8_t*, uint64_t len) {
+        committedRuns.push_back({ offset, len });
+    });
+
+    payload.u32((uint32_t)committedRuns.size());
+    for (const auto &run: committedRuns) {
+        payload.u64(run.first);
+        payload.u64(run.second);
+    }
+
+    RecordWriter pages;
+    uint32_t numPageRuns = 0;
+    const Memory::PageVisitor writePages = [&](uint64_t offset, const uint8_t *data, uint64_t len) {
+        pages.u64(offset);
+        pages.u64(len);
+        pages.bytes(data, len);
+        numPageRuns++;
+    };
+
+    if (full) {
+        memory->forEachCommittedRun(writePages);
+        memory->setDirtyTrackingEnabled(true);
+    } else {
+        memory->collectDirtyPages(writePages);
+    }
+
+    payload.u32(numPageRuns);
+    payload.bytes(pages.getBuffer().data(), pages.getBuffer().size());
+
+    // Execution state
+    payload.u32(contextSnapshot.dataSegmentAddress);
+    payload.u32(contextSnapshot.ephemeralArenaAddress);
+    payload.variables(contextSnapshot.globals);
+
+    payload.u32((uint32_t)contextSnapshot.mallocBlocks.size());
+    for (const auto &block: contextSnapshot.mallocBlocks) {
+        payload.u32(block.address);
+        payload.u32(block.size);
+        payload.string(block.callSite ? *block.callSite : "");
+    }
+
+    payload.u32((uint32_t)contextSnapshot.files.size());
+    for (const auto &file: contextSnapshot.files) {
+        payload.u32((uint32_t)file.handle);
+        payload.string(file.path);
+        payload.string(file.mode);
+        payload.u64((uint64_t)file.offset);
+    }
+    payload.u32((uint32_t)contextSnapshot.nextFileHandle);
+
+    for (uint32_t word: contextSnapshot.randState.table) {
+        payload.u32(word);
+    }
+    payload.u32(contextSnapshot.randState.front);
+    payload.u32(contextSnapshot.randState.rear);
+
+    payload.string(contextSnapshot.functionName ? *contextSnapshot.functionName : "");
+    payload.u32((uint32_t)contextSnapshot.frameScopes.size());
+    for (const auto &scope: contextSnapshot.frameScopes) {
+        payload.variables(scope);
+    }
+
+    payload.u32((uint32_t)contextSnapshot.registers.size());
+    for (uint64_t value: contextSnapshot.registers) {
+        payload.u64(value);
+    }
+
+    payload.u32((uint32_t)contextSnapshot.resumePath.size());
+    for (uint32_t index: contextSnapshot.resumePath) {
+        payload.u32(index);
+    }
+
+    RecordWriter record;
+    record.bytes(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+    record.u8(full ? KIND_FULL : KIND_INCREMENTAL);
+    record.u64(payload.getBuffer().size());
+    record.bytes(payload.getBuffer().data(), payload.getBuffer().size());
+    record.u32(ast::MurmurHash2(payload.getBuffer().data(), (int)payload.getBuffer().size(), 0));
+
+    if (full) {
+        // Replace the file atomically, so that a crash leaves either the
+        // old or the new checkpoint behind
+        const std::string tmpPath = _path + ".tmp";
+        FILE *file = fopen(tmpPath.c_str(), "wb");
+        if (!file) {
+            Throw(CheckpointException, "Unable to open checkpoint '%s'", tmpPath.c_str());
+        }
+
+        writeFile(file, record.getBuffer(), tmpPath);
+
+        if (rename(tmpPath.c_str(), _path.c_str()) != 0) {
+            Throw(CheckpointException, "Unable to replace checkpoint '%s'", _path.c_str());
+        }
+    } else {
+        FILE *file = fopen(_path.c_str(), "ab");
+        if (!file) {
+            Throw(CheckpointException, "Unable to open checkpoint '%s'", _path.c_str());
+        }
+
+        writeFile(file, record.getBuffer(), _path);
+    }
+
+    _needsFullCheckpoint = false;
+    _checkpointCount++;
+}
+
+uint32_t CheckpointWriter::getCheckpointCount() const
+{
+    return _checkpointCount;
+}
+
+void CheckpointWriter::removeCheckpoint(const std::string &path)
+{
+    unlink(path.c_str());
+    unlink((path + ".tmp").c_str());
+}
+
+
+/*
+==============
+CheckpointReader
+==============
+*/
+CheckpointReader::CheckpointReader(const std::string &path, ast::Ast::Ptr ast)
+{
+    FILE *file = fopen(path.c_str(), "rb");
+    if (!file) {
+        Throw(CheckpointException, "Unable to open checkpoint '%s'", path.c_str());
+    }
+
+    std::vector<uint8_t> contents;
+    uint8_t chunk[1 << 16];
+    size_t len;
+    while ((len = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        contents.insert(contents.end(), chunk, chunk + len);
+    }
+    fclose(file);
+
+    const uint32_t fingerprint = getProgramFingerprint(ast.get());
+
+    std::shared_ptr<HeapImage> heap;
+    std::shared_ptr<Memory::Snapshot> memory;
+    std::vector<std::pair<uint64_t,uint64_t>> committedRuns;
+    uint32_t numRecords = 0;
+
+    size_t pos = 0;
+    while (contents.size() - pos >= RECORD_HEADER_SIZE + RECORD_TRAILER_SIZE) {
+        const uint8_t *header = contents.data() + pos;
+        if (memcmp(header, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC)) != 0) {
+            break;
+        }
+
+        RecordReader headerReader(header + sizeof(CHECKPOINT_MAGIC), RECORD_HEADER_SIZE - sizeof(CHECKPOINT_MAGIC), ast);
+        const uint8_t kind = headerReader.u8();
+        const uint64_t payloadLen = headerReader.u64();
+        if (payloadLen > contents.size() - pos - RECORD_HEADER_SIZE - RECORD_TRAILER_SIZE) {
+            break;
+        }
+
+        const uint8_t *payloadData = header + RECORD_HEADER_SIZE;
+        RecordReader trailer(payloadData + payloadLen, RECORD_TRAILER_SIZE, ast);
+        if (trailer.u32() != ast::MurmurHash2(payloadData, (int)payloadLen, 0)) {
+            break;
+        }
+
+        if (numRecords == 0 && kind != KIND_FULL) {
+            Throw(CheckpointException, "Checkpoint '%s' does not start with a full checkpoint", path.c_str());
+        }
+
+        RecordReader payload(payloadData, payloadLen, ast);
+        if (payload.u32() != fingerprint) {
+            Throw(CheckpointException, "Checkpoint '%s' was written by a different program", path.c_str());
+        }
+
+        const uint32_t heapSize = payload.u32();
+        const uint32_t minAllocSize = payload.u32();
+        if (minAllocSize == 0) {
+            Throw(CheckpointException, "Checkpoint '%s' is corrupt", path.c_str());
+        }
+
+        std::list<Allocator::Block> freeBlocks(payload.u32());
+        for (Allocator::Block &block: freeBlocks) {
+            block.offset = payload.u32();
+            block.length = payload.u32();
+        }
+
+        std::vector<uint32_t> allocationUnits(payload.u32());
+        std::vector<uint8_t> allocationMap((allocationUnits.size() + 7) / 8);
+        const uint32_t numAllocations = payload.u32();
+        for (uint32_t i=0; i<numAllocations; i++) {
+            const uint32_t unit = payload.u32();
+            const uint32_t units = payload.u32();
+            if (unit >= allocationUnits.size() || units > allocationUnits.size() - unit) {
+                Throw(CheckpointException, "Checkpoint '%s' is corrupt", path.c_str());
+            }
+
+            allocationUnits[unit] = units;
+            for (uint32_t u=unit; u<unit + units; u++) {
+                allocationMap[u / 8] |= (1 << (u % 8));
+            }
+        }
+
+        MemoryStats stats;
+        if (payload.u32() != sizeof(MemoryStats)) {
+            Throw(CheckpointException, "Checkpoint '%s' was written by an incompatible version", path.c_str());
+        }
+        memcpy(&stats, payload.bytes(sizeof(MemoryStats)), sizeof(MemoryStats));
+
+        if (!heap || kind == KIND_FULL) {
+            heap = std::make_shared<HeapImage>(heapSize);
+        }
+
+        memory = std::make_shared<Memory::Snapshot>(Memory::Snapshot {
+            heapSize,
+            minAllocSize,
+            nullptr,
+            Allocator(heapSize / minAllocSize, freeBlocks),
+            std::move(allocationMap),
+            std::move(allocationUnits),
+            stats,
+        });
+
+        committedRuns.resize(payload.u32());
+        for (auto &run: committedRuns) {
+            run.first = payload.u64();
+            run.second = payload.u64();
+        }
+
+        const uint32_t numPageRuns = payload.u32();
+        for (uint32_t i=0; i<numPageRuns; i++) {
+            const uint64_t offset = payload.u64();
+            const uint64_t len = payload.u64();
+            heap->write(offset, payload.bytes(len), len);
+        }
+
+        ExecutionContext::Snapshot &context = _context;
+        context.dataSegment = ast->getDataSegment();
+        context.dataSegmentAddress = payload.u32();
+        context.ephemeralArenaAddress = payload.u32();
+        context.globals = payload.variables();
+
+        context.mallocBlocks.resize(payload.u32());
+        for (auto &block: context.mallocBlocks) {
+            block.address = payload.u32();
+            block.size = payload.u32();
+            block.callSite = payload.functionName();
+        }
+
+        context.files.resize(payload.u32());
+        for (auto &file: context.files) {
+            file.handle = (int32_t)payload.u32();
+            file.path = payload.string();
+            file.mode = payload.string();
+            file.offset = (int64_t)payload.u64();
+        }
+        context.nextFileHandle = (int32_t)payload.u32();
+
+        for (uint32_t &word: context.randState.table) {
+            word = payload.u32();
+        }
+        context.randState.front = payload.u32() % RandContext::DEGREE;
+        context.randState.rear = payload.u32() % RandContext::DEGREE;
+
+        context.functionName = payload.functionName();
+        context.frameScopes.resize(payload.u32());
+        for (auto &scope: context.frameScopes) {
+            scope = payload.variables();
+        }
+
+        context.registers.resize(payload.u32());
+        for (uint64_t &value: context.registers) {
+            value = payload.u64();
+        }
+
+        context.resumePath.resize(payload.u32());
+        for (uint32_t &index: context.resumePath) {
+            index = payload.u32();
+        }
+
+        pos += RECORD_HEADER_SIZE + payloadLen + RECORD_TRAILER_SIZE;
+        numRecords++;
+    }
+
+    if (numRecords == 0) {
+        Throw(CheckpointException, "Checkpoint '%s' contains no valid checkpoint", path.c_str());
+    }
+
+    for (const auto &run: committedRuns) {
+        heap->commit(run.first, run.second);
+    }
+
+    memory->heap = heap;
+    _memory = memory;
+}
+
+Memory::Snapshot::Ptr CheckpointReader::getMemorySnapshot() const
+{
+    return _memory;
+}
+
+const ExecutionContext::Snapshot& CheckpointReader::getContextSnapshot() const
+{
+    return _context;
+}
+
+}
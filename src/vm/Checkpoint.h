@@ -0,0 +1,95 @@
+#pragma once
+
+#include "Memory.h"
+#include "ExecutionContext.h"
+#include "../ast/Ast.h"
+#include "../Exception.h"
+
+#include <stdint.h>
+#include <string>
+
+
+namespace cish::vm
+{
+
+DECLARE_EXCEPTION(CheckpointException);
+
+/**
+ * Writes the state of a running program to a file, so that it can be
+ * resumed by another process running the same program.
+ *
+ * A checkpoint file is a sequence of records. The first record is a full
+ * checkpoint holding every committed heap page, every following record is
+ * incremental and only holds the pages written to since the record before
+ * it. Every 'fullInterval' checkpoints, the file is replaced by a single
+ * full record again to bound its size.
+ *
+ * All integers are little endian. Every record is laid out as:
+ *
+ *   char[8] "CISHCKP3"
+ *   u8      kind, 'F' for full and 'I' for incremental
+ *   u64     payload length
+ *   u8[]    payload
+ *   u32     MurmurHash2 of the payload
+ *
+ * The payload holds a fingerprint of the program, the allocator state,
+ * the committed page runs, the page data and the ExecutionContext
+ * snapshot. A record that was torn by a crash while writing fails its
+ * checksum, and the file is read as if it ended before it.
+ */
+class CheckpointWriter
+{
+public:
+    static const uint32_t DEFAULT_FULL_INTERVAL = 16;
+
+    CheckpointWriter(const std::string &path, const ast::Ast *ast,
+                     uint32_t fullInterval = DEFAULT_FULL_INTERVAL);
+
+    CheckpointWriter(const CheckpointWriter&) = delete;
+    CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+    /**
+     * Write a checkpoint of 'memory' and 'context' and flush it to disk.
+     * The context must be at a point where it can be snapshotted, see
+     * ExecutionContext::createSnapshot(). Dirty page tracking is enabled
+     * on the memory by the first checkpoint.
+     */
+    void write(Memory *memory, const ExecutionContext *context);
+
+    uint32_t getCheckpointCount() const;
+
+    /**
+     * Remove the checkpoint at 'path', along with the full record that
+     * was being written next to it if the writer was interrupted.
+     */
+    static void removeCheckpoint(const std::string &path);
+
+private:
+    std::string _path;
+    uint32_t _fingerprint;
+    uint32_t _fullInterval;
+    uint32_t _checkpointCount;
+
+    // Set until a full record has been written, and whenever writing a
+    // record fails, as the dirty pages collected for it are lost.
+    bool _needsFullCheckpoint;
+};
+
+
+/**
+ * Reads the most recent checkpoint in a file written by CheckpointWriter.
+ */
+class CheckpointReader
+{
+public:
+    CheckpointReader(const std::string &path, ast::Ast::Ptr ast);
+
+    Memory::Snapshot::Ptr getMemorySnapshot() const;
+    const ExecutionContext::Snapshot& getContextSnapshot() const;
+
+private:
+    Memory::Snapshot::Ptr _memory;
+    ExecutionContext::Snapshot _context;
+};
+
+}
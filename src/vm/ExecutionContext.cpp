@@ -3,6 +3,9 @@
 #include "../ast/FunctionDefinition.h"
 #include "../ast/AstNodes.h"
 
+#include <algorithm>
+#include <cstring>
+
 
 namespace cish::vm
 {
@@ -10,158 +13,456 @@ namespace cish::vm
 // If this ever occurs, something fucky is definitely going on
 const int MAX_STACK_FRAMES = 4096;
 
+// Automatic leak collection runs once this many bytes have been malloc'ed
+// since the last collection, or as many bytes as survived it if that is
+// more. This keeps the amortized cost linear in the amount allocated.
+const uint64_t MIN_LEAK_COLLECTION_THRESHOLD = 1 << 20;
+
+// The arena of ephemeral variables is this large, but never takes more
+// than a sixteenth of the heap
+const uint32_t EPHEMERAL_ARENA_SIZE = 4096;
+const uint32_t EPHEMERAL_ALIGNMENT = 8;
+
 ExecutionContext::ExecutionContext(Memory *memory):
+    _frameDepth(0),
+    _registerAccess(this),
+    _ephemeralFrameDepth(0),
+    _ephemeralArenaSize(0),
+    _ephemeralArenaTop(0),
     _memory(memory),
+    _dataSegment(nullptr),
+    _mallocContext(memory),
+    _leakCollectionEnabled(false),
+    _leakCollectionThreshold(MIN_LEAK_COLLECTION_THRESHOLD),
     _customStdout(nullptr),
     _defaultStdout(new StdoutStream())
 {
-    _globalScope = new Scope();
+    _globalScope = _scopePool.create(&_variablePool);
 }
 
 ExecutionContext::~ExecutionContext()
 {
-    for (FunctionFrame &functionFrame: _frameStack) {
-        for (Scope *scope: functionFrame.scopes) {
-            delete scope;
+    for (const EphemeralVariable &ephemeral: _ephemeralVariables) {
+        _variablePool.destroy(ephemeral.var);
+    }
+
+    for (uint32_t i=0; i<_frameDepth; i++) {
+        for (Scope *scope: _frameStack[i].scopes) {
+            _scopePool.destroy(scope);
         }
     }
 
-    delete _globalScope;
+    for (Scope *scope: _freeScopes) {
+        _scopePool.destroy(scope);
+    }
+
+    _scopePool.destroy(_globalScope);
     delete _defaultStdout;
 }
 
-void ExecutionContext::copyStringTable(const ast::StringTable *stringTable)
+static std::vector<ExecutionContext::Snapshot::NamedVariable> captureScope(const Scope *scope)
 {
-    auto map = stringTable->getMap();
-    for (const auto& pair: map) {
-        const uint32_t allocLen = pair.second.length() + 1;
-        Allocation::Ptr alloc = _memory->allocate(allocLen);
-        alloc->writeBuf(pair.second.data(), allocLen);
-        _stringMap[pair.first] = std::move(alloc);
+    std::vector<ExecutionContext::Snapshot::NamedVariable> variables;
+    scope->forEachNamedVariable([&](const std::string &name, const Variable *var) {
+        variables.push_back({ name, var->getType(), var->getHeapAddress() });
+    });
+
+    return variables;
+}
+
+ExecutionContext::Snapshot ExecutionContext::createSnapshot() const
+{
+    const uint32_t arenaAddress = _ephemeralArena ? _ephemeralArena->getAddress() : 0;
+    Snapshot snapshot { _dataSegment, getDataSegmentAddress(), arenaAddress, captureScope(_globalScope), {},
+                        _fopenContext.getOpenFiles(), _fopenContext.getNextHandle(), _randContext.getState(),
+                        nullptr, {}, {}, {} };
+
+    if (_frameDepth != 0) {
+        if (!getResumePath(&snapshot.resumePath)) {
+            Throw(Exception, "Cannot snapshot an ExecutionContext which is not at a resumable point");
+        }
+
+        snapshot.functionName = currentFrame().functionName;
+        for (const Scope *scope: currentFrame().scopes) {
+            snapshot.frameScopes.push_back(captureScope(scope));
+        }
+        snapshot.registers = currentFrame().registers;
     }
+
+    for (const auto &pair: _mallocContext.getBlocks()) {
+        snapshot.mallocBlocks.push_back({ pair.first, pair.second.size, pair.second.callSite });
+    }
+
+    return snapshot;
+}
+
+void ExecutionContext::restoreSnapshot(const Snapshot &snapshot)
+{
+    if (_dataSegment || _frameDepth != 0) {
+        Throw(Exception, "Cannot restore a snapshot into an initialized ExecutionContext");
+    }
+
+    _dataSegment = snapshot.dataSegment;
+    if (snapshot.dataSegmentAddress != 0) {
+        _dataSegmentAllocation = _memory->adoptAllocation(snapshot.dataSegmentAddress);
+    }
+
+    if (snapshot.ephemeralArenaAddress != 0) {
+        _ephemeralArena = _memory->adoptAllocation(snapshot.ephemeralArenaAddress);
+        _ephemeralArenaSize = _memory->getAllocationSize(snapshot.ephemeralArenaAddress);
+    }
+
+    const uint32_t dataSegmentEnd = snapshot.dataSegmentAddress + getDataSegmentSize();
+    auto restoreVariables = [&](Scope *scope, const std::vector<Snapshot::NamedVariable> &variables) {
+        for (const Snapshot::NamedVariable &var: variables) {
+            // Globals in the data segment are only views into its allocation
+            Allocation::Ptr alloc;
+            if (var.address >= snapshot.dataSegmentAddress && var.address < dataSegmentEnd) {
+                alloc = _memory->createInteriorAllocation(var.address);
+            } else {
+                alloc = _memory->adoptAllocation(var.address);
+            }
+
+            scope->addVariable(var.name, var.type, std::move(alloc));
+        }
+    };
+
+    restoreVariables(_globalScope, snapshot.globals);
+
+    if (!snapshot.frameScopes.empty()) {
+        pushFunctionFrame(snapshot.functionName);
+        for (size_t i=0; i<snapshot.frameScopes.size(); i++) {
+            if (i != 0) {
+                pushScope();
+            }
+            restoreVariables(getScope(), snapshot.frameScopes[i]);
+        }
+        currentFrame().registers = snapshot.registers;
+    }
+
+    for (const Snapshot::MallocBlock &block: snapshot.mallocBlocks) {
+        _mallocContext.adoptBlock(block.address, block.size, block.callSite);
+    }
+
+    _fopenContext.restoreOpenFiles(snapshot.files, snapshot.nextFileHandle);
+    _randContext.restoreState(snapshot.randState);
+}
+
+void ExecutionContext::installDataSegment(const ast::DataSegment *dataSegment)
+{
+    if (_dataSegment) {
+        Throw(Exception, "A data segment has already been installed");
+    }
+
+    _dataSegment = dataSegment;
+    if (dataSegment->getSize() == 0) {
+        return;
+    }
+
+    _dataSegmentAllocation = _memory->allocate(dataSegment->getSize());
+    _dataSegmentAllocation->writeBuf(dataSegment->getData(), dataSegment->getSize());
 }
 
 MemoryView ExecutionContext::resolveString(ast::StringId stringId) const
 {
-    if (_stringMap.count(stringId) == 0) {
+    if (!_dataSegment || !_dataSegment->hasString(stringId)) {
         return _memory->getView(0);
     }
 
-    const uint32_t addr = _stringMap.at(stringId)->getAddress();
-    return _memory->getView(addr);
+    return _memory->getView(getDataSegmentAddress() + _dataSegment->getStringOffset(stringId));
+}
+
+Allocation::Ptr ExecutionContext::getDataSegmentAllocation(uint32_t offset) const
+{
+    if (!_dataSegmentAllocation) {
+        Throw(Exception, "No data segment installed");
+    }
+
+    return _memory->createInteriorAllocation(getDataSegmentAddress() + offset);
+}
+
+uint32_t ExecutionContext::getDataSegmentAddress() const
+{
+    return _dataSegmentAllocation ? _dataSegmentAllocation->getAddress() : 0;
+}
+
+uint32_t ExecutionContext::getDataSegmentSize() const
+{
+    return _dataSegment ? _dataSegment->getSize() : 0;
 }
 
 
 void ExecutionContext::pushScope()
 {
-    if (_frameStack.empty()) {
+    if (_frameDepth == 0) {
         Throw(Exception, "Cannot push a scope without a function frame");
     }
 
-    Scope *scope = new Scope(getScope());
-    _frameStack.back().scopes.push_back(scope);
+    Scope *scope = acquireScope(getScope());
+    currentFrame().scopes.push_back(scope);
+}
+
+void ExecutionContext::pushInlineScope()
+{
+    if (_frameDepth == 0) {
+        Throw(Exception, "Cannot push a scope without a function frame");
+    }
+
+    Scope *scope = acquireScope(_globalScope);
+    currentFrame().scopes.push_back(scope);
 }
 
 void ExecutionContext::popScope()
 {
-    if (_frameStack.empty()) {
+    if (_frameDepth == 0) {
         Throw(Exception, "Cannot push a scope without a function frame");
     }
 
-    if (_frameStack.back().scopes.size() == 1) {
+    FunctionFrame &frame = currentFrame();
+    if (frame.scopes.size() == 1) {
         Throw(StackUnderflowException, "Cannot pop the root scope");
     }
 
-    delete _frameStack.back().scopes.back();
-    _frameStack.back().scopes.pop_back();
+    releaseScope(frame.scopes.back());
+    frame.scopes.pop_back();
 }
 
-void ExecutionContext::pushFunctionFrame()
+void ExecutionContext::pushFunctionFrame(const std::string *functionName)
 {
-    if (_frameStack.size() > MAX_STACK_FRAMES) {
+    if (_frameDepth > MAX_STACK_FRAMES) {
         Throw(StackOverflowException, "Call stack exceeded maximum limit of %d", MAX_STACK_FRAMES);
     }
 
-    Scope *scope = new Scope(_globalScope);
-    _frameStack.push_back(FunctionFrame { {scope}, false, ast::ExpressionValue(0), nullptr });
+    if (_frameDepth == _frameStack.size()) {
+        _frameStack.push_back(FunctionFrame { {}, false, ast::ExpressionValue(0), nullptr, nullptr, {}, {}, 0 });
+    }
+
+    FunctionFrame &frame = _frameStack[_frameDepth++];
+    frame.scopes.push_back(acquireScope(_globalScope));
+    frame.hasReturned = false;
+    frame.returnValue = ast::ExpressionValue(0);
+    frame.returnBuffer = nullptr;
+    frame.functionName = functionName;
+    frame.registers.clear();
+    frame.registerBase = 0;
 }
 
 void ExecutionContext::popFunctionFrame()
 {
-    if (_frameStack.empty()) {
+    if (_frameDepth == 0) {
         Throw(StackUnderflowException, "No function frame to pop");
     }
 
-    if (_frameStack.back().scopes.size() != 1) {
+    FunctionFrame &frame = currentFrame();
+    if (frame.scopes.size() != 1) {
         Throw(Exception, "Illegal operation - cannot pop function frame without popping all scopes first");
     }
 
-    delete _frameStack.back().scopes[0];
-    _frameStack.pop_back();
+    releaseScope(frame.scopes[0]);
+    frame.scopes.clear();
+    frame.returnValue = ast::ExpressionValue(0);
+    _frameDepth--;
 }
 
 void ExecutionContext::setFunctionReturnBuffer(vm::Variable *buffer)
 {
-    if (_frameStack.empty())
+    if (_frameDepth == 0)
         Throw(Exception, "No function frame");
-    if (_frameStack.back().returnBuffer != nullptr)
+    if (currentFrame().returnBuffer != nullptr)
         Throw(Exception, "Current frame already has a return buffer");
-    _frameStack.back().returnBuffer = buffer;
+    currentFrame().returnBuffer = buffer;
 }
 
 void ExecutionContext::returnCurrentFunction(ast::ExpressionValue retval)
 {
-    if (_frameStack.empty())
+    if (_frameDepth == 0)
         Throw(Exception, "Cannot return from outside a function");
-    if (_frameStack.back().hasReturned)
+    if (currentFrame().hasReturned)
         Throw(Exception, "Current function has already returned");
 
-    _frameStack.back().hasReturned = true;
-    _frameStack.back().returnValue = retval;
+    currentFrame().hasReturned = true;
+    currentFrame().returnValue = retval;
 }
 
 bool ExecutionContext::currentFunctionHasReturned() const
 {
-    // Keep in mind that this method will get called by ALL statements, including
-    // those in the global scope - as such, we need to inform them gently that
-    // the current function - albeit undefined - has NOT returned.
-    if (_frameStack.empty())
+    // Statements propagate returns through their completion value, this is
+    // only kept for inspection. Outside of a function nothing has returned.
+    if (_frameDepth == 0)
         return false;
 
-    return _frameStack.back().hasReturned;
+    return currentFrame().hasReturned;
 }
 
 ast::ExpressionValue ExecutionContext::getCurrentFunctionReturnValue() const
 {
-    if (_frameStack.empty())
+    if (_frameDepth == 0)
         Throw(Exception, "No return value available");
 
-    return _frameStack.back().returnValue;
+    return currentFrame().returnValue;
 }
 
 vm::Variable* ExecutionContext::getCurrentFunctionReturnBuffer() const
 {
-    if (_frameStack.empty())
+    if (_frameDepth == 0)
         Throw(Exception, "No function frames on stack");
-    if (_frameStack.back().returnBuffer == nullptr)
+    if (currentFrame().returnBuffer == nullptr)
         Throw(Exception, "No return buffer defined for current function");
 
-    return _frameStack.back().returnBuffer;
+    return currentFrame().returnBuffer;
 }
 
 const ast::Statement* ExecutionContext::getCurrentStatement() const
 {
     if (_statementStack.empty())
         return nullptr;
-    return _statementStack.top();
+    return _statementStack.back();
+}
+
+size_t ExecutionContext::getStatementDepth() const
+{
+    return _statementStack.size();
+}
+
+const std::string* ExecutionContext::getCurrentFunctionName() const
+{
+    if (_frameDepth == 0)
+        return nullptr;
+    return currentFrame().functionName;
+}
+
+void ExecutionContext::pushEphemeralFrame()
+{
+    _ephemeralFrameDepth++;
+}
+
+void ExecutionContext::popEphemeralFrame()
+{
+    if (_ephemeralFrameDepth == 0) {
+        Throw(StackUnderflowException, "No ephemeral frame to pop");
+    }
+
+    while (!_ephemeralVariables.empty() && _ephemeralVariables.back().frame == _ephemeralFrameDepth) {
+        _ephemeralArenaTop = _ephemeralVariables.back().arenaTop;
+        _variablePool.destroy(_ephemeralVariables.back().var);
+        _ephemeralVariables.pop_back();
+    }
+
+    _ephemeralFrameDepth--;
+}
+
+Variable* ExecutionContext::allocateEphemeral(ast::TypeDecl type)
+{
+    if (_ephemeralFrameDepth == 0) {
+        Throw(Exception, "Cannot allocate an ephemeral variable outside of a statement");
+    }
+
+    const uint32_t arenaTop = _ephemeralArenaTop;
+    Variable *var = _variablePool.create(type, allocateTemporary(type.getSize()));
+    _ephemeralVariables.push_back(EphemeralVariable { _ephemeralFrameDepth, var, arenaTop });
+    return var;
+}
+
+void ExecutionContext::invalidateCachedValues(uint32_t first, uint32_t count)
+{
+    if (_frameDepth == 0)
+        Throw(Exception, "Cannot cache values outside of a function");
+
+    std::vector<CachedValue> &values = currentFrame().cachedValues;
+    if (values.size() < first + count) {
+        values.resize(first + count);
+    }
+
+    for (uint32_t i=first; i<first+count; i++) {
+        values[i].valid = false;
+    }
+}
+
+const ast::ExpressionValue* ExecutionContext::getCachedValue(uint32_t slot) const
+{
+    if (_frameDepth == 0)
+        return nullptr;
+
+    const std::vector<CachedValue> &values = currentFrame().cachedValues;
+    if (slot >= values.size() || !values[slot].valid)
+        return nullptr;
+
+    return &values[slot].value;
+}
+
+void ExecutionContext::setCachedValue(uint32_t slot, const ast::ExpressionValue &value)
+{
+    if (_frameDepth == 0)
+        Throw(Exception, "Cannot cache values outside of a function");
+
+    std::vector<CachedValue> &values = currentFrame().cachedValues;
+    if (slot >= values.size())
+        Throw(Exception, "Cache slot %u has not been invalidated by its owner", slot);
+
+    values[slot].valid = true;
+    values[slot].value = value;
+}
+
+void ExecutionContext::allocateRegisters(uint32_t count)
+{
+    if (_frameDepth == 0)
+        Throw(Exception, "Cannot allocate registers outside of a function");
+
+    FunctionFrame &frame = currentFrame();
+    frame.registers.assign(count, 0);
+    frame.registerBase = 0;
+}
+
+uint32_t ExecutionContext::pushRegisterWindow(uint32_t count)
+{
+    if (_frameDepth == 0)
+        Throw(Exception, "Cannot allocate registers outside of a function");
+
+    FunctionFrame &frame = currentFrame();
+    const uint32_t previousBase = frame.registerBase;
+    frame.registerBase = (uint32_t)frame.registers.size();
+    frame.registers.resize(frame.registers.size() + count, 0);
+    return previousBase;
+}
+
+void ExecutionContext::popRegisterWindow(uint32_t previousBase)
+{
+    if (_frameDepth == 0)
+        Throw(Exception, "No register window to pop");
+
+    FunctionFrame &frame = currentFrame();
+    if (previousBase > frame.registerBase)
+        Throw(StackUnderflowException, "No register window to pop");
+
+    frame.registers.resize(frame.registerBase);
+    frame.registerBase = previousBase;
+}
+
+void ExecutionContext::clearRegister(uint32_t reg)
+{
+    getRegisterView(reg).write<uint64_t>(0);
+}
+
+MemoryView ExecutionContext::getRegisterView(uint32_t reg)
+{
+    return MemoryView(&_registerAccess, reg * sizeof(uint64_t));
+}
+
+void ExecutionContext::forEachRegister(const std::function<void(uint64_t)> &visitor) const
+{
+    for (uint32_t i=0; i<_frameDepth; i++) {
+        for (uint64_t value: _frameStack[i].registers) {
+            visitor(value);
+        }
+    }
 }
 
 Scope* ExecutionContext::getScope() const
 {
-    if (_frameStack.empty())
+    if (_frameDepth == 0)
         return _globalScope;
 
-    return _frameStack.back().scopes.back();
+    return currentFrame().scopes.back();
 }
 
 Memory* ExecutionContext::getMemory() const
@@ -169,23 +470,90 @@ Memory* ExecutionContext::getMemory() const
     return _memory;
 }
 
+MallocContext* ExecutionContext::getMallocContext()
+{
+    return &_mallocContext;
+}
+
+FopenContext* ExecutionContext::getFopenContext()
+{
+    return &_fopenContext;
+}
+
+RandContext* ExecutionContext::getRandContext()
+{
+    return &_randContext;
+}
+
+uint32_t ExecutionContext::getCallDepth() const
+{
+    return _frameDepth;
+}
+
+bool ExecutionContext::getResumePath(ast::ResumePath *path) const
+{
+    if (_frameDepth != 1 || _statementStack.size() < 2) {
+        return false;
+    }
+
+    // The bottom of the stack is the function itself
+    path->clear();
+    for (size_t i=1; i<_statementStack.size(); i++) {
+        uint32_t index;
+        if (!_statementStack[i - 1]->getResumeIndex(_statementStack[i], &index)) {
+            return false;
+        }
+        path->push_back(index);
+    }
+
+    return true;
+}
+
+void ExecutionContext::forEachVariable(const std::function<void(const Variable*)> &visitor) const
+{
+    _globalScope->forEachVariable(visitor);
+
+    for (uint32_t i=0; i<_frameDepth; i++) {
+        for (const Scope *scope: _frameStack[i].scopes) {
+            scope->forEachVariable(visitor);
+        }
+    }
+
+    for (const EphemeralVariable &ephemeral: _ephemeralVariables) {
+        visitor(ephemeral.var);
+    }
+}
+
+void ExecutionContext::setLeakCollectionEnabled(bool enabled)
+{
+    _leakCollectionEnabled = enabled;
+}
+
+const LeakReport& ExecutionContext::getLastCollectionReport() const
+{
+    return _lastCollectionReport;
+}
+
 void ExecutionContext::onStatementEnter(const ast::Statement *statement)
 {
     if (!statement)
         return;
-    if (!_statementStack.empty() && _statementStack.top() == statement)
+
+    collectLeaksIfDue();
+
+    if (!_statementStack.empty() && _statementStack.back() == statement)
         return;
 
-    _statementStack.push(statement);
+    _statementStack.push_back(statement);
 }
 
 void ExecutionContext::onStatementExit(const ast::Statement *statement)
 {
     if (_statementStack.empty())
         Throw(Exception, "Statement-stack is empty");
-    if (_statementStack.top() != statement)
+    if (_statementStack.back() != statement)
         Throw(Exception, "Last statement is not the exited one");
-    _statementStack.pop();
+    _statementStack.pop_back();
 }
 
 const Callable::Ptr ExecutionContext::getFunctionDefinition(const std::string &funcName) const
@@ -195,6 +563,105 @@ const Callable::Ptr ExecutionContext::getFunctionDefinition(const std::string &f
     return nullptr;
 }
 
+const Callable::Ptr ExecutionContext::getFunctionDefinition(ast::SymbolId symbol) const
+{
+    return getFunctionDefinition(ast::Symbol::getName(symbol));
+}
+
+ExecutionContext::FunctionFrame& ExecutionContext::currentFrame()
+{
+    return _frameStack[_frameDepth - 1];
+}
+
+const ExecutionContext::FunctionFrame& ExecutionContext::currentFrame() const
+{
+    return _frameStack[_frameDepth - 1];
+}
+
+Scope* ExecutionContext::acquireScope(const Scope *parent)
+{
+    if (_freeScopes.empty()) {
+        return _scopePool.create(&_variablePool, parent);
+    }
+
+    Scope *scope = _freeScopes.back();
+    _freeScopes.pop_back();
+    scope->reset(parent);
+    return scope;
+}
+
+Allocation::Ptr ExecutionContext::allocateTemporary(uint32_t size)
+{
+    if (!_ephemeralArena) {
+        _ephemeralArenaSize = std::min(EPHEMERAL_ARENA_SIZE, _memory->getTotalSize() / 16);
+        _ephemeralArena = _memory->tryAllocate(_ephemeralArenaSize);
+    }
+
+    const uint32_t alignedSize = (size + EPHEMERAL_ALIGNMENT - 1) & ~(EPHEMERAL_ALIGNMENT - 1);
+    if (!_ephemeralArena || alignedSize > _ephemeralArenaSize - _ephemeralArenaTop) {
+        return _memory->allocate(size);
+    }
+
+    Allocation::Ptr alloc = _memory->createInteriorAllocation(_ephemeralArena->getAddress() + _ephemeralArenaTop);
+    _ephemeralArenaTop += alignedSize;
+    return alloc;
+}
+
+void ExecutionContext::collectLeaksIfDue()
+{
+    if (!_leakCollectionEnabled || !LeakDetector::isSafePoint(this))
+        return;
+    if (_mallocContext.getBytesAllocatedSinceReset() < _leakCollectionThreshold)
+        return;
+
+    _lastCollectionReport = LeakDetector(this).run(true);
+    _mallocContext.resetAllocationCounter();
+    _leakCollectionThreshold = std::max(MIN_LEAK_COLLECTION_THRESHOLD, _mallocContext.getAllocatedBytes());
+}
+
+void ExecutionContext::releaseScope(Scope *scope)
+{
+    // Variables are released immediately, but the scope itself is
+    // kept around for the next block or call
+    scope->reset(nullptr);
+    _freeScopes.push_back(scope);
+}
+
+
+
+ExecutionContext::RegisterAccess::RegisterAccess(ExecutionContext *context):
+    _context(context)
+{
+}
+
+void ExecutionContext::RegisterAccess::onDeallocation(Allocation *allocation)
+{
+    Throw(Exception, "Registers are never allocated");
+}
+
+const uint8_t* ExecutionContext::RegisterAccess::read(uint32_t address, uint32_t len)
+{
+    return resolve(address, len);
+}
+
+void ExecutionContext::RegisterAccess::write(const uint8_t *buffer, uint32_t address, uint32_t len)
+{
+    memcpy(resolve(address, len), buffer, len);
+}
+
+uint8_t* ExecutionContext::RegisterAccess::resolve(uint32_t address, uint32_t len) const
+{
+    if (_context->_frameDepth == 0)
+        Throw(InvalidAccessException, "No registers outside of a function");
+
+    FunctionFrame &frame = _context->currentFrame();
+    const uint64_t windowSize = (frame.registers.size() - frame.registerBase) * sizeof(uint64_t);
+    if ((uint64_t)address + len > windowSize)
+        Throw(InvalidAccessException, "Register access at %u of length %u is out of bounds", address, len);
+
+    return (uint8_t*)&frame.registers[frame.registerBase] + address;
+}
+
 void ExecutionContext::setStdout(IStream *stream)
 {
     _customStdout = stream;
@@ -5,15 +5,21 @@
 #include "ExecutionThread.h"
 #include "Callable.h"
 #include "IStream.h"
+#include "ObjectPool.h"
+#include "MallocContext.h"
+#include "FopenContext.h"
+#include "RandContext.h"
+#include "LeakDetector.h"
 
 #include "../Exception.h"
 
+#include "../ast/AstNodes.h"
 #include "../ast/ExpressionValue.h"
 #include "../ast/StringTable.h"
+#include "../ast/DataSegment.h"
 
 #include <vector>
 #include <iostream>
-#include <stack>
 
 
 namespace cish::ast
@@ -32,15 +38,69 @@ DECLARE_EXCEPTION(NoEntryPointException);
 class ExecutionContext
 {
 public:
+    /**
+     * Everything needed to recreate the context on top of a restored
+     * Memory: the data segment, the variables, the malloc'ed blocks, the
+     * open files and the rand() sequence. The heap itself is captured by
+     * Memory.
+     */
+    struct Snapshot
+    {
+        struct NamedVariable
+        {
+            std::string name;
+            ast::TypeDecl type;
+            uint32_t address;
+        };
+
+        struct MallocBlock
+        {
+            uint32_t address;
+            uint32_t size;
+            const std::string *callSite;
+        };
+
+        const ast::DataSegment *dataSegment;
+        uint32_t dataSegmentAddress;
+        uint32_t ephemeralArenaAddress;
+        std::vector<NamedVariable> globals;
+        std::vector<MallocBlock> mallocBlocks;
+        std::vector<FopenContext::OpenFile> files;
+        int32_t nextFileHandle;
+        RandContext::State randState;
+
+        // Only set when captured inside the entry function: its name, the
+        // variables of each of its scopes, outermost first, its registers
+        // and the statement to resume at.
+        const std::string *functionName;
+        std::vector<std::vector<NamedVariable>> frameScopes;
+        std::vector<uint64_t> registers;
+        ast::ResumePath resumePath;
+    };
+
     ExecutionContext(Memory *memory);
     virtual ~ExecutionContext();
 
     /**
-     * Copies all strings from the StringTable into the Memory-memoryspace
-     * and makes the strings resolvable. This method must be called exactly
-     * once.
+     * Capture the state of the context. This is only possible outside
+     * of any function, or at a resumable point in the entry function,
+     * see getResumePath().
      */
-    void copyStringTable(const ast::StringTable *stringTable);
+    Snapshot createSnapshot() const;
+
+    /**
+     * Re-create the state captured in 'snapshot' in a fresh context,
+     * whose Memory has been restored from the heap snapshot taken at the
+     * same time. The data segment must outlive the ExecutionContext.
+     */
+    void restoreSnapshot(const Snapshot &snapshot);
+
+    /**
+     * Copies the data segment into the Memory-memoryspace and makes its
+     * strings resolvable. The segment must outlive the ExecutionContext,
+     * and this method must be called exactly once.
+     */
+    void installDataSegment(const ast::DataSegment *dataSegment);
 
     /**
      * Resolve a StringId into its first allocated memory address. If the
@@ -48,10 +108,27 @@ public:
      */
     MemoryView resolveString(ast::StringId stringId) const;
 
+    /**
+     * An Allocation of the object at 'offset' in the installed data
+     * segment. Releasing it does not free any memory.
+     */
+    Allocation::Ptr getDataSegmentAllocation(uint32_t offset) const;
+
+    uint32_t getDataSegmentAddress() const;
+    uint32_t getDataSegmentSize() const;
+
     void pushScope();
     void popScope();
 
-    void pushFunctionFrame();
+    /**
+     * Push a scope onto the current function frame whose parent is the
+     * global scope rather than the current scope, so that the caller's
+     * locals are not visible from it. Used for the parameters of inlined
+     * calls, and popped with popScope().
+     */
+    void pushInlineScope();
+
+    void pushFunctionFrame(const std::string *functionName = nullptr);
     void popFunctionFrame();
     void setFunctionReturnBuffer(vm::Variable *buffer);
     void returnCurrentFunction(ast::ExpressionValue retval);
@@ -59,36 +136,185 @@ public:
     ast::ExpressionValue getCurrentFunctionReturnValue() const;
     vm::Variable* getCurrentFunctionReturnBuffer() const;
     const ast::Statement* getCurrentStatement() const;
+    size_t getStatementDepth() const;
+
+    /**
+     * The name of the function currently executing, or null when in the
+     * global scope or the frame was pushed without a name.
+     */
+    const std::string* getCurrentFunctionName() const;
+
+    /**
+     * Ephemeral variables hold temporaries such as struct return values.
+     * They belong to the innermost executing statement, and are released
+     * when it pops its ephemeral frame. They are bumped out of an arena
+     * which is allocated once and reused by every statement, and only
+     * fall back to allocating from Memory when the arena is full.
+     */
+    void pushEphemeralFrame();
+    void popEphemeralFrame();
+    Variable* allocateEphemeral(ast::TypeDecl type);
+
+    /**
+     * Values of expressions which are known not to change for a while,
+     * such as loop invariants, see CachedExpression. The slots belong to
+     * the current function frame and are numbered per function. A value
+     * stays cached until the statement owning its slot invalidates it.
+     */
+    void invalidateCachedValues(uint32_t first, uint32_t count);
+    const ast::ExpressionValue* getCachedValue(uint32_t slot) const;
+    void setCachedValue(uint32_t slot, const ast::ExpressionValue &value);
+
+    /**
+     * Registers hold the locals whose address is never taken, see
+     * RegisterAllocator. They are native slots of the current function
+     * frame, and are accessed through a view which bypasses Memory
+     * entirely. Inlined calls get a window of registers of their own
+     * above the caller's, which is popped by restoring the base returned
+     * when it was pushed.
+     */
+    void allocateRegisters(uint32_t count);
+    uint32_t pushRegisterWindow(uint32_t count);
+    void popRegisterWindow(uint32_t previousBase);
+    void clearRegister(uint32_t reg);
+    MemoryView getRegisterView(uint32_t reg);
+
+    /**
+     * Visit the value of every register of every live function frame.
+     */
+    void forEachRegister(const std::function<void(uint64_t)> &visitor) const;
 
     Scope* getScope() const;
     Memory* getMemory() const;
+    MallocContext* getMallocContext();
+    FopenContext* getFopenContext();
+    RandContext* getRandContext();
+
+    /**
+     * The number of function frames currently on the stack.
+     */
+    uint32_t getCallDepth() const;
+
+    /**
+     * Whether execution can be captured here and resumed later, and if
+     * so, where. This requires that only one function is executing, and
+     * that the statement just entered was reached through blocks alone,
+     * so that no expression is partially evaluated.
+     */
+    bool getResumePath(ast::ResumePath *path) const;
+
+    /**
+     * Visit every variable in the global scope, in every scope of every
+     * live function frame and every live ephemeral variable.
+     */
+    void forEachVariable(const std::function<void(const Variable*)> &visitor) const;
+
+    /**
+     * Periodically scan for and reclaim unreachable malloc() blocks.
+     * Collection only happens at points where no expression evaluation
+     * is in progress, see LeakDetector.
+     */
+    void setLeakCollectionEnabled(bool enabled);
+    const LeakReport& getLastCollectionReport() const;
 
     virtual void onStatementEnter(const ast::Statement *statement);
     virtual void onStatementExit(const ast::Statement *statement);
     virtual const Callable::Ptr getFunctionDefinition(const std::string &funcName) const;
+    virtual const Callable::Ptr getFunctionDefinition(ast::SymbolId symbol) const;
 
     void setStdout(IStream *stream);
     IStream* getStdout();
 
 private:
+    /**
+     * MemoryAccess of the registers in the current window. The address
+     * of a register is its offset from the start of the window.
+     */
+    class RegisterAccess: public MemoryAccess
+    {
+    public:
+        RegisterAccess(ExecutionContext *context);
+
+        void onDeallocation(Allocation *allocation) override;
+        const uint8_t* read(uint32_t address, uint32_t len) override;
+        void write(const uint8_t *buffer, uint32_t address, uint32_t len) override;
+
+    private:
+        ExecutionContext *_context;
+
+        uint8_t* resolve(uint32_t address, uint32_t len) const;
+    };
+
+    struct CachedValue
+    {
+        bool valid = false;
+        ast::ExpressionValue value = ast::ExpressionValue(0);
+    };
+
     struct FunctionFrame
     {
         std::vector<Scope*> scopes;
         bool hasReturned;
         ast::ExpressionValue returnValue;
         Variable *returnBuffer;
+        const std::string *functionName;
+        std::vector<CachedValue> cachedValues;
+        std::vector<uint64_t> registers;
+        uint32_t registerBase;
     };
 
+    // The pools must outlive every scope and variable, so they are
+    // declared first.
+    Scope::VariablePool _variablePool;
+    ObjectPool<Scope> _scopePool;
+    std::vector<Scope*> _freeScopes;
+
     Scope *_globalScope;
+
+    // Frames are reused by depth rather than popped, so their scope
+    // vectors keep their capacity between calls. Only the first
+    // _frameDepth frames are live.
     std::vector<FunctionFrame> _frameStack;
+    uint32_t _frameDepth;
+
+    std::vector<const ast::Statement*> _statementStack;
+    RegisterAccess _registerAccess;
+
+    struct EphemeralVariable
+    {
+        uint32_t frame;
+        Variable *var;
 
-    std::stack<const ast::Statement*> _statementStack;
+        // The top of the arena before the variable was allocated
+        uint32_t arenaTop;
+    };
+
+    std::vector<EphemeralVariable> _ephemeralVariables;
+    uint32_t _ephemeralFrameDepth;
+    Allocation::Ptr _ephemeralArena;
+    uint32_t _ephemeralArenaSize;
+    uint32_t _ephemeralArenaTop;
 
     Memory *_memory;
-    std::map<ast::StringId, Allocation::Ptr> _stringMap;
+    const ast::DataSegment *_dataSegment;
+    Allocation::Ptr _dataSegmentAllocation;
+    MallocContext _mallocContext;
+    FopenContext _fopenContext;
+    RandContext _randContext;
+
+    bool _leakCollectionEnabled;
+    uint64_t _leakCollectionThreshold;
+    LeakReport _lastCollectionReport;
 
     IStream *_customStdout;
     IStream *_defaultStdout;
+
+    FunctionFrame& currentFrame();
+    const FunctionFrame& currentFrame() const;
+    Scope* acquireScope(const Scope *parent);
+    Allocation::Ptr allocateTemporary(uint32_t size);
+    void collectLeaksIfDue();
+    void releaseScope(Scope *scope);
 };
 
 }
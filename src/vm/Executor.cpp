@@ -1,17 +1,30 @@
 #include "Executor.h"
+#include "Checkpoint.h"
 
+#include "../ast/FunctionDefinition.h"
 #include "../ast/SuperStatement.h"
 #include "../Exception.h"
 
 namespace cish::vm
 {
 
+// Reading the clock on every statement would be measurable, so the
+// checkpoint interval is only checked this often.
+static const uint32_t CLOCK_CHECK_INTERVAL = 1024;
+
+
 Executor::Executor(Memory *memory, ast::Ast::Ptr ast):
     ExecutionContext(memory),
     _ast(ast),
     _exitStatus(-1),
     _cliArgs({}),
-    _hasTerminated(false)
+    _hasTerminated(false),
+    _initialized(false),
+    _resuming(false),
+    _checkpointWriter(nullptr),
+    _checkpointInterval(0),
+    _statementsSinceClockCheck(0),
+    _checkpointRequested(false)
 {
 
 }
@@ -28,9 +41,70 @@ void Executor::setCliArgs(const std::vector<ast::ExpressionValue> &args)
     _cliArgs = args;
 }
 
+void Executor::initialize()
+{
+    if (_initialized) {
+        Throw(Exception, "The executor has already been initialized");
+    }
+
+    _initialized = true;
+    if (_ast->getDataSegment()) {
+        installDataSegment(_ast->getDataSegment());
+    }
+
+    // Execute global statements
+    for (const ast::Statement::Ptr &statement: _ast->getRootStatements()) {
+        statement->execute(this);
+    }
+}
+
+void Executor::initialize(const ExecutionContext::Snapshot &snapshot)
+{
+    if (_initialized) {
+        Throw(Exception, "The executor has already been initialized");
+    }
+
+    _initialized = true;
+    restoreSnapshot(snapshot);
+
+    if (!snapshot.frameScopes.empty()) {
+        if (*snapshot.functionName != "main") {
+            Throw(Exception, "Cannot resume execution in '%s'", snapshot.functionName->c_str());
+        }
+
+        _resuming = true;
+        _resumePath = snapshot.resumePath;
+    }
+}
+
+bool Executor::isResuming() const
+{
+    return _resuming;
+}
+
+void Executor::setCheckpointWriter(CheckpointWriter *writer, std::chrono::milliseconds interval)
+{
+    _checkpointWriter = writer;
+    _checkpointInterval = interval;
+    _lastCheckpoint = std::chrono::steady_clock::now();
+}
+
+void Executor::requestCheckpoint()
+{
+    _checkpointRequested = true;
+}
+
 void Executor::onStatementEnter(const ast::Statement *statement)
 {
+    // Loops synchronize on every iteration without entering a new
+    // statement, and those are not points execution can resume at.
+    const size_t depth = getStatementDepth();
     ExecutionContext::onStatementEnter(statement);
+
+    if (_checkpointWriter && getStatementDepth() > depth) {
+        checkpointIfDue();
+    }
+
     await();
 }
 
@@ -39,6 +113,11 @@ const Callable::Ptr Executor::getFunctionDefinition(const std::string &funcName)
     return _ast->getFunctionDefinition(funcName);
 }
 
+const Callable::Ptr Executor::getFunctionDefinition(ast::SymbolId symbol) const
+{
+    return _ast->getFunctionDefinition(symbol);
+}
+
 ast::ExpressionValue Executor::getExitStatus() const
 {
     if (!_hasTerminated) {
@@ -51,20 +130,48 @@ ast::ExpressionValue Executor::getExitStatus() const
 void Executor::execute()
 {
     await();
-    copyStringTable(_ast->getStringTable());
 
     const Callable::Ptr main = _ast->getFunctionDefinition("main");
     if (!main) {
         Throw(NoEntryPointException, "Entrypoint 'main' not found");
     }
 
-    // Execute global statements
-    for (ast::Statement::Ptr statement: _ast->getRootStatements()) {
-        statement->execute(this);
+    if (!_initialized) {
+        initialize();
+    }
+
+    if (_resuming) {
+        auto mainDefinition = std::dynamic_pointer_cast<const ast::FunctionDefinition>(main);
+        if (!mainDefinition) {
+            Throw(Exception, "Cannot resume execution in a native 'main'");
+        }
+
+        _exitStatus = mainDefinition->resume(this, _resumePath);
+    } else {
+        _exitStatus = main->execute(this, _cliArgs, nullptr);
     }
 
-    _exitStatus = main->execute(this, _cliArgs, nullptr);
     _hasTerminated = true;
 }
 
+void Executor::checkpointIfDue()
+{
+    bool due = _checkpointRequested.load(std::memory_order_relaxed);
+
+    if (!due && ++_statementsSinceClockCheck >= CLOCK_CHECK_INTERVAL) {
+        _statementsSinceClockCheck = 0;
+        due = std::chrono::steady_clock::now() - _lastCheckpoint >= _checkpointInterval;
+    }
+
+    ast::ResumePath path;
+    if (!due || !getResumePath(&path)) {
+        return;
+    }
+
+    _checkpointWriter->write(getMemory(), this);
+    _checkpointRequested = false;
+    _lastCheckpoint = std::chrono::steady_clock::now();
+    _statementsSinceClockCheck = 0;
+}
+
 }
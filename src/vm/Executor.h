@@ -3,6 +3,8 @@
 #include "ExecutionContext.h"
 #include "../ast/Ast.h"
 
+#include <atomic>
+#include <chrono>
 #include <vector>
 #include <string>
 
@@ -10,6 +12,7 @@ namespace cish::vm
 {
 
 class Memory;
+class CheckpointWriter;
 
 class Executor: public ExecutionContext, public ExecutionThread
 {
@@ -19,9 +22,39 @@ public:
 
     void setCliArgs(const std::vector<ast::ExpressionValue> &args);
 
+    /**
+     * Install the data segment and execute the global statements on the
+     * calling thread, so that the state before main can be captured.
+     * When the executor is started, only main is called.
+     */
+    void initialize();
+
+    /**
+     * Same as initialize(), but the state is restored from 'snapshot'
+     * rather than by executing the global statements. If the snapshot was
+     * taken inside main, execution resumes where it was taken.
+     */
+    void initialize(const ExecutionContext::Snapshot &snapshot);
+    bool isResuming() const;
+
+    /**
+     * Write a checkpoint every 'interval' while main is executing. The
+     * checkpoint is taken when entering the next statement at which the
+     * execution can be resumed. The Executor does not take ownership of
+     * the writer.
+     */
+    void setCheckpointWriter(CheckpointWriter *writer, std::chrono::milliseconds interval);
+
+    /**
+     * Take a checkpoint at the next opportunity, regardless of the
+     * interval. Safe to call from any thread.
+     */
+    void requestCheckpoint();
+
     // From ExecutionContext
     virtual void onStatementEnter(const ast::Statement *statement) override;
     virtual const Callable::Ptr getFunctionDefinition(const std::string &funcName) const override;
+    virtual const Callable::Ptr getFunctionDefinition(ast::SymbolId symbol) const override;
 
     ast::ExpressionValue getExitStatus() const;
 
@@ -31,11 +64,22 @@ protected:
 
 private:
     std::vector<ast::ExpressionValue> prepareMainArguments(const Callable::Ptr main) const;
+    void checkpointIfDue();
 
     ast::Ast::Ptr _ast;
     ast::ExpressionValue _exitStatus;
     std::vector<ast::ExpressionValue> _cliArgs;
     bool _hasTerminated;
+    bool _initialized;
+
+    bool _resuming;
+    ast::ResumePath _resumePath;
+
+    CheckpointWriter *_checkpointWriter;
+    std::chrono::milliseconds _checkpointInterval;
+    std::chrono::steady_clock::time_point _lastCheckpoint;
+    uint32_t _statementsSinceClockCheck;
+    std::atomic<bool> _checkpointRequested;
 };
 
 }
@@ -0,0 +1,121 @@
+#include "FopenContext.h"
+
+namespace cish::vm
+{
+
+FopenContext::FopenContext():
+    _counter(0x4533345)
+{
+
+}
+
+FopenContext::~FopenContext()
+{
+    for (const auto &pair: _files) {
+        ::fclose(pair.second.file);
+    }
+}
+
+int32_t FopenContext::fopen(const char *path, const char *mode)
+{
+    FILE *file = ::fopen(path, mode);
+    if (!file) {
+        return 0;
+    }
+
+    const int32_t handle = _counter++;
+    _files[handle] = File { file, path, mode };
+    return handle;
+}
+
+int FopenContext::fclose(int32_t handle)
+{
+    if (_files.count(handle) == 0) {
+        return EOF;
+    }
+
+    FILE *file = _files[handle].file;
+    const int res = ::fclose(file);
+    _files.erase(handle);
+
+    return res;
+}
+
+int FopenContext::fgetc(int32_t handle)
+{
+    if (_files.count(handle) == 0) {
+        return EOF;
+    }
+
+    FILE *file = _files[handle].file;
+    return ::fgetc(file);
+}
+
+bool FopenContext::fgets(std::string *result, int32_t size, uint32_t handle)
+{
+    if (_files.count(handle) == 0) {
+        return false;
+    }
+
+    FILE *file = _files[handle].file;
+
+    std::vector<char> buffer;
+    buffer.resize(size);
+
+    if (::fgets(buffer.data(), size, file) == NULL) {
+        return false;
+    }
+
+    *result = std::string(buffer.data());
+    return true;
+}
+
+std::vector<FopenContext::OpenFile> FopenContext::getOpenFiles() const
+{
+    std::vector<OpenFile> files;
+    for (const auto &pair: _files) {
+        const File &file = pair.second;
+        files.push_back(OpenFile { pair.first, file.path, file.mode, (int64_t)ftello(file.file) });
+    }
+
+    return files;
+}
+
+int32_t FopenContext::getNextHandle() const
+{
+    return _counter;
+}
+
+void FopenContext::restoreOpenFiles(const std::vector<OpenFile> &files, int32_t nextHandle)
+{
+    if (!_files.empty()) {
+        Throw(FopenContextException, "Cannot restore files into a context with open files");
+    }
+
+    for (const OpenFile &openFile: files) {
+        // Opening for writing again would truncate the file
+        std::string mode = openFile.mode;
+        if (mode[0] == 'w') {
+            mode[0] = 'r';
+            if (mode.find('+') == std::string::npos) {
+                mode += '+';
+            }
+        }
+
+        FILE *file = ::fopen(openFile.path.c_str(), mode.c_str());
+        if (!file) {
+            Throw(FopenContextException, "Failed to re-open file '%s'", openFile.path.c_str());
+        }
+
+        if (fseeko(file, (off_t)openFile.offset, SEEK_SET) != 0) {
+            ::fclose(file);
+            Throw(FopenContextException, "Failed to seek in re-opened file '%s'", openFile.path.c_str());
+        }
+
+        _files[openFile.handle] = File { file, openFile.path, openFile.mode };
+    }
+
+    _counter = nextHandle;
+}
+
+}
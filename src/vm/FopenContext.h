@@ -0,0 +1,68 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "../Exception.h"
+
+namespace cish::vm
+{
+
+DECLARE_EXCEPTION(FopenContextException);
+
+/**
+ * The files opened through fopen(). Like the MallocContext, every VM has
+ * its own FopenContext, and the files are closed when the VM is destroyed.
+ */
+class FopenContext
+{
+public:
+    /**
+     * An open file as it is captured in snapshots. Files are re-opened
+     * by path when restored, and positioned at the captured offset.
+     */
+    struct OpenFile
+    {
+        int32_t handle;
+        std::string path;
+        std::string mode;
+        int64_t offset;
+    };
+
+    FopenContext();
+    ~FopenContext();
+
+    FopenContext(const FopenContext&) = delete;
+    FopenContext& operator=(const FopenContext&) = delete;
+
+    int32_t fopen(const char *path, const  char *mode);
+    int fgetc(int32_t handle);
+    bool fgets(std::string *result, int32_t size, uint32_t handle);
+
+    int fclose(int32_t handle);
+
+    std::vector<OpenFile> getOpenFiles() const;
+    int32_t getNextHandle() const;
+
+    /**
+     * Re-open the captured files. Files which were opened for writing
+     * are not truncated again. Must be called on an empty context.
+     */
+    void restoreOpenFiles(const std::vector<OpenFile> &files, int32_t nextHandle);
+
+private:
+    struct File
+    {
+        FILE *file;
+        std::string path;
+        std::string mode;
+    };
+
+    int32_t _counter;
+    std::map<int32_t, File> _files;
+};
+
+}
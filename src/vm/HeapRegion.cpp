@@ -0,0 +1,344 @@
+#include "HeapRegion.h"
+
+#include <algorithm>
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#ifndef MAP_NORESERVE
+    #define MAP_NORESERVE 0
+#endif
+
+
+namespace cish::vm
+{
+
+static bool isBitSet(const std::vector<uint64_t> &bitmap, uint64_t bit)
+{
+    return bitmap[bit / 64] & (1ull << (bit % 64));
+}
+
+// The file only exists to give the pages of a HeapImage something to be
+// mapped from, so it is never visible in the file system.
+static int createAnonymousFile(uint64_t size)
+{
+#ifdef __linux__
+    int fd = memfd_create("cish-heap-image", MFD_CLOEXEC);
+#else
+    char path[] = "/tmp/cish-heap-image-XXXXXX";
+    int fd = mkstemp(path);
+    if (fd >= 0) {
+        unlink(path);
+    }
+#endif
+
+    if (fd < 0) {
+        Throw(MemoryReservationException, "Failed to create a file for the heap image");
+    }
+
+    if (ftruncate(fd, (off_t)size) != 0) {
+        close(fd);
+        Throw(MemoryReservationException, "Failed to reserve %llu bytes for the heap image",
+              (unsigned long long)size);
+    }
+
+    return fd;
+}
+
+
+static uint64_t roundUpToPages(uint64_t size)
+{
+    const uint64_t pageSize = HeapRegion::getPageSize();
+    return std::max<uint64_t>(1, (size + pageSize - 1) / pageSize) * pageSize;
+}
+
+
+/*
+==============
+HeapImage
+==============
+*/
+HeapImage::HeapImage(uint64_t size):
+    _fd(createAnonymousFile(roundUpToPages(size))),
+    _size(roundUpToPages(size)),
+    _committedPages(0),
+    _commitMap((_size / HeapRegion::getPageSize() + 63) / 64, 0)
+{
+}
+
+HeapImage::~HeapImage()
+{
+    close(_fd);
+}
+
+uint64_t HeapImage::getSize() const
+{
+    return _size;
+}
+
+uint64_t HeapImage::getCommittedSize() const
+{
+    return _committedPages * HeapRegion::getPageSize();
+}
+
+void HeapImage::write(uint64_t offset, const uint8_t *data, uint64_t len)
+{
+    if (offset + len > _size) {
+        Throw(MemoryReservationException, "Write of %llu bytes at offset %llu exceeds the heap image",
+              (unsigned long long)len, (unsigned long long)offset);
+    }
+
+    while (len > 0) {
+        const ssize_t written = pwrite(_fd, data, len, (off_t)offset);
+        if (written <= 0) {
+            Throw(MemoryReservationException, "Failed to write the heap image");
+        }
+
+        data += written;
+        offset += written;
+        len -= written;
+    }
+}
+
+void HeapImage::commit(uint64_t offset, uint64_t len)
+{
+    const uint64_t pageSize = HeapRegion::getPageSize();
+    const uint64_t numPages = _size / pageSize;
+    const uint64_t endPage = std::min(numPages, (offset + len + pageSize - 1) / pageSize);
+    for (uint64_t page = offset / pageSize; page < endPage; page++) {
+        if (!isBitSet(_commitMap, page)) {
+            _commitMap[page / 64] |= (1ull << (page % 64));
+            _committedPages++;
+        }
+    }
+}
+
+
+/*
+==============
+HeapRegion
+==============
+*/
+uint32_t HeapRegion::getPageSize()
+{
+    static const uint32_t pageSize = (uint32_t)sysconf(_SC_PAGESIZE);
+    return pageSize;
+}
+
+
+HeapRegion::HeapRegion(uint64_t size):
+    _base(nullptr),
+    _size(0),
+    _numPages(0),
+    _committedPages(0)
+{
+    const uint64_t pageSize = getPageSize();
+    _numPages = std::max<uint64_t>(1, (size + pageSize - 1) / pageSize);
+    _size = _numPages * pageSize;
+
+    reserve();
+}
+
+HeapRegion::HeapRegion(const HeapImage &image):
+    _base(nullptr),
+    _size(image._size),
+    _numPages(image._size / getPageSize()),
+    _committedPages(0)
+{
+    reserve();
+
+    const uint64_t pageSize = getPageSize();
+    uint64_t page = 0;
+    while (page < _numPages) {
+        if (!isBitSet(image._commitMap, page)) {
+            page++;
+            continue;
+        }
+
+        const uint64_t runStart = page;
+        while (page < _numPages && isBitSet(image._commitMap, page)) {
+            setPageCommitted(page, true);
+            page++;
+        }
+
+        const uint64_t offset = runStart * pageSize;
+        const uint64_t len = (page - runStart) * pageSize;
+        void *res = mmap(_base + offset, len, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_FIXED, image._fd, (off_t)offset);
+        if (res == MAP_FAILED) {
+            munmap(_base, _size);
+            Throw(MemoryReservationException, "Failed to map %llu bytes of the heap image",
+                  (unsigned long long)len);
+        }
+
+        _committedPages += page - runStart;
+    }
+}
+
+HeapRegion::~HeapRegion()
+{
+    if (_base) {
+        munmap(_base, _size);
+    }
+}
+
+
+uint8_t* HeapRegion::data() const
+{
+    return _base;
+}
+
+uint64_t HeapRegion::getReservedSize() const
+{
+    return _size;
+}
+
+uint64_t HeapRegion::getCommittedSize() const
+{
+    return _committedPages * getPageSize();
+}
+
+void HeapRegion::commit(uint64_t offset, uint64_t len)
+{
+    if (len == 0) {
+        return;
+    }
+
+    const uint64_t pageSize = getPageSize();
+    const uint64_t firstPage = offset / pageSize;
+    const uint64_t endPage = std::min(_numPages, (offset + len + pageSize - 1) / pageSize);
+
+    // Commit consecutive runs of uncommitted pages with a single call each
+    uint64_t page = firstPage;
+    while (page < endPage) {
+        if (isPageCommitted(page)) {
+            page++;
+            continue;
+        }
+
+        const uint64_t runStart = page;
+        while (page < endPage && !isPageCommitted(page)) {
+            page++;
+        }
+
+        protectPages(runStart, page - runStart, true);
+    }
+}
+
+void HeapRegion::decommit(uint64_t offset, uint64_t len)
+{
+    const uint64_t pageSize = getPageSize();
+    const uint64_t firstPage = (offset + pageSize - 1) / pageSize;
+    const uint64_t endPage = std::min(_numPages, (offset + len) / pageSize);
+
+    uint64_t page = firstPage;
+    while (page < endPage) {
+        if (!isPageCommitted(page)) {
+            page++;
+            continue;
+        }
+
+        const uint64_t runStart = page;
+        while (page < endPage && isPageCommitted(page)) {
+            page++;
+        }
+
+        protectPages(runStart, page - runStart, false);
+    }
+}
+
+HeapImage::Ptr HeapRegion::createImage() const
+{
+    std::shared_ptr<HeapImage> image(new HeapImage(_size));
+    image->_commitMap = _commitMap;
+    image->_committedPages = _committedPages;
+
+    forEachCommittedRun([&](uint64_t offset, uint64_t len) {
+        image->write(offset, _base + offset, len);
+    });
+
+    return image;
+}
+
+void HeapRegion::forEachCommittedRun(const RunVisitor &visitor) const
+{
+    const uint64_t pageSize = getPageSize();
+    uint64_t page = 0;
+    while (page < _numPages) {
+        if (!isPageCommitted(page)) {
+            page++;
+            continue;
+        }
+
+        const uint64_t runStart = page;
+        while (page < _numPages && isPageCommitted(page)) {
+            page++;
+        }
+
+        visitor(runStart * pageSize, (page - runStart) * pageSize);
+    }
+}
+
+
+void HeapRegion::reserve()
+{
+    void *addr = mmap(nullptr, _size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (addr == MAP_FAILED) {
+        Throw(MemoryReservationException, "Failed to reserve %llu bytes of address space",
+              (unsigned long long)_size);
+    }
+
+    _base = (uint8_t*)addr;
+    _commitMap.resize((_numPages + 63) / 64, 0);
+}
+
+bool HeapRegion::isPageCommitted(uint64_t page) const
+{
+    return isBitSet(_commitMap, page);
+}
+
+void HeapRegion::setPageCommitted(uint64_t page, bool committed)
+{
+    if (committed) {
+        _commitMap[page / 64] |= (1ull << (page % 64));
+    } else {
+        _commitMap[page / 64] &= ~(1ull << (page % 64));
+    }
+}
+
+void HeapRegion::protectPages(uint64_t firstPage, uint64_t numPages, bool commit)
+{
+    const uint64_t pageSize = getPageSize();
+    uint8_t *addr = _base + firstPage * pageSize;
+    const uint64_t len = numPages * pageSize;
+
+    if (commit) {
+        if (mprotect(addr, len, PROT_READ | PROT_WRITE) != 0) {
+            Throw(MemoryReservationException, "Failed to commit %llu bytes of memory",
+                  (unsigned long long)len);
+        }
+    } else {
+        // Mapping fresh anonymous memory on top of the range is the most
+        // portable way to actually hand the pages back to the OS.
+        void *res = mmap(addr, len, PROT_NONE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED, -1, 0);
+        if (res == MAP_FAILED) {
+            Throw(MemoryReservationException, "Failed to decommit %llu bytes of memory",
+                  (unsigned long long)len);
+        }
+    }
+
+    for (uint64_t i=0; i<numPages; i++) {
+        setPageCommitted(firstPage + i, commit);
+    }
+
+    if (commit) {
+        _committedPages += numPages;
+    } else {
+        _committedPages -= numPages;
+    }
+}
+
+}
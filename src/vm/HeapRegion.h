@@ -0,0 +1,131 @@
+#pragma once
+
+#include <stdint.h>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "../Exception.h"
+
+
+namespace cish::vm
+{
+
+DECLARE_EXCEPTION(MemoryReservationException);
+
+/**
+ * An immutable copy of the committed pages of a HeapRegion. The pages
+ * are kept in an anonymous file rather than in host memory, so that
+ * regions created from the image can map them copy-on-write: a page is
+ * shared by every region until one of them writes to it.
+ */
+class HeapImage
+{
+public:
+    typedef std::shared_ptr<const HeapImage> Ptr;
+
+    /**
+     * An image of 'size' bytes with no committed pages, to be filled with
+     * write() and commit(). Used when the pages are read back from a
+     * checkpoint rather than copied from a live region.
+     */
+    HeapImage(uint64_t size);
+    ~HeapImage();
+
+    HeapImage(const HeapImage&) = delete;
+    HeapImage& operator=(const HeapImage&) = delete;
+
+    uint64_t getSize() const;
+    uint64_t getCommittedSize() const;
+
+    /**
+     * Copy 'len' bytes to 'offset' in the image. The commit state of the
+     * pages is not affected, only committed pages are mapped by regions.
+     */
+    void write(uint64_t offset, const uint8_t *data, uint64_t len);
+
+    /**
+     * Mark every page overlapping [offset, offset+len) as committed.
+     * Pages which were never written read as zero.
+     */
+    void commit(uint64_t offset, uint64_t len);
+
+private:
+    friend class HeapRegion;
+
+    int _fd;
+    uint64_t _size;
+    uint64_t _committedPages;
+    std::vector<uint64_t> _commitMap;
+};
+
+
+/**
+ * A contiguous range of virtual memory which is reserved up front, but
+ * only backed by physical pages once they are explicitly committed.
+ *
+ * Reserving costs address space only, so a HeapRegion of several
+ * gigabytes is cheap as long as only a small part of it is committed.
+ * Decommitted pages are returned to the operating system and will read
+ * as zero once they are committed again.
+ */
+class HeapRegion
+{
+public:
+    typedef std::function<void(uint64_t offset, uint64_t len)> RunVisitor;
+
+    static uint32_t getPageSize();
+
+    HeapRegion(uint64_t size);
+
+    /**
+     * Create a region with the size and contents of 'image'. The pages
+     * committed in the image are mapped copy-on-write, so creating the
+     * region costs the same regardless of how much memory it contains.
+     */
+    HeapRegion(const HeapImage &image);
+    ~HeapRegion();
+
+    HeapRegion(const HeapRegion&) = delete;
+    HeapRegion& operator=(const HeapRegion&) = delete;
+
+    uint8_t* data() const;
+    uint64_t getReservedSize() const;
+    uint64_t getCommittedSize() const;
+
+    /**
+     * Ensure that every page overlapping [offset, offset+len) is backed
+     * by physical memory. Already committed pages are left untouched.
+     */
+    void commit(uint64_t offset, uint64_t len);
+
+    /**
+     * Return every page which lies *entirely* within [offset, offset+len)
+     * to the operating system. Partially covered pages stay committed.
+     */
+    void decommit(uint64_t offset, uint64_t len);
+
+    /**
+     * Copy the committed pages into a new HeapImage.
+     */
+    HeapImage::Ptr createImage() const;
+
+    /**
+     * Visit every maximal run of committed pages in ascending order.
+     */
+    void forEachCommittedRun(const RunVisitor &visitor) const;
+
+private:
+    uint8_t *_base;
+    uint64_t _size;
+    uint64_t _numPages;
+    uint64_t _committedPages;
+    std::vector<uint64_t> _commitMap;
+
+    void reserve();
+    bool isPageCommitted(uint64_t page) const;
+    void setPageCommitted(uint64_t page, bool committed);
+    void protectPages(uint64_t firstPage, uint64_t numPages, bool commit);
+};
+
+}
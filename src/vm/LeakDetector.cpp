@@ -0,0 +1,139 @@
+#include "LeakDetector.h"
+#include "ExecutionContext.h"
+#include "MallocContext.h"
+#include "Memory.h"
+
+#include <algorithm>
+#include <map>
+#include <unordered_set>
+
+
+namespace cish::vm
+{
+
+std::vector<LeakReport::CallSiteSummary> LeakReport::getCallSiteSummary() const
+{
+    std::map<const std::string*, CallSiteSummary> byCallSite;
+    for (const Leak &leak: leaks) {
+        auto it = byCallSite.find(leak.callSite);
+        if (it == byCallSite.end()) {
+            const std::string name = leak.callSite ? *leak.callSite : "<global>";
+            it = byCallSite.insert({leak.callSite, CallSiteSummary { name, 0, 0 }}).first;
+        }
+
+        it->second.count++;
+        it->second.bytes += leak.size;
+    }
+
+    std::vector<CallSiteSummary> result;
+    for (const auto &pair: byCallSite) {
+        result.push_back(pair.second);
+    }
+
+    std::sort(result.begin(), result.end(), [](const CallSiteSummary &a, const CallSiteSummary &b) {
+        return a.bytes > b.bytes;
+    });
+
+    return result;
+}
+
+
+LeakDetector::LeakDetector(ExecutionContext *context):
+    _context(context)
+{
+}
+
+bool LeakDetector::isSafePoint(const ExecutionContext *context)
+{
+    return context->getCallDepth() <= 1;
+}
+
+LeakReport LeakDetector::run(bool reclaim)
+{
+    MallocContext *mallocContext = _context->getMallocContext();
+    Memory *memory = _context->getMemory();
+    const auto &blocks = mallocContext->getBlocks();
+
+    LeakReport report;
+    if (blocks.empty()) {
+        return report;
+    }
+
+    const uint32_t lowest = blocks.begin()->first;
+    const uint32_t highest = blocks.rbegin()->first + blocks.rbegin()->second.size;
+
+    std::unordered_set<uint32_t> marked;
+    std::vector<uint32_t> worklist;
+
+    auto mark = [&](uint32_t value) {
+        if (value < lowest || value > highest) {
+            return;
+        }
+
+        auto it = blocks.upper_bound(value);
+        if (it == blocks.begin()) {
+            return;
+        }
+        it--;
+
+        if (value <= it->first + it->second.size && marked.insert(it->first).second) {
+            worklist.push_back(it->first);
+        }
+    };
+
+    auto scan = [&](uint32_t address, uint32_t len) {
+        if (len < sizeof(uint32_t)) {
+            return;
+        }
+
+        const uint8_t *buf = memory->getView(address).readBuf(len);
+
+        for (uint32_t i=0; i + sizeof(uint32_t) <= len; i++) {
+            uint32_t value;
+            memcpy(&value, buf + i, sizeof(value));
+            mark(value);
+        }
+    };
+
+    // Globals living in the data segment are covered by scanning it whole
+    scan(_context->getDataSegmentAddress(), _context->getDataSegmentSize());
+
+    _context->forEachVariable([&](const Variable *var) {
+        // Ephemeral variables may be interior to the ephemeral arena
+        const uint32_t address = var->getHeapAddress();
+        const uint32_t size = memory->getAllocationSize(address);
+        scan(address, size != 0 ? size : var->getType().getSize());
+    });
+
+    // Pointers are stored in the low bytes of a register
+    _context->forEachRegister([&](uint64_t value) {
+        mark((uint32_t)value);
+    });
+
+    while (!worklist.empty()) {
+        const uint32_t address = worklist.back();
+        worklist.pop_back();
+        scan(address, blocks.at(address).size);
+    }
+
+    for (const auto &pair: blocks) {
+        if (marked.count(pair.first)) {
+            report.reachableBlocks++;
+            report.reachableBytes += pair.second.size;
+        } else {
+            report.leaks.push_back(LeakReport::Leak { pair.first, pair.second.size, pair.second.callSite });
+            report.leakedBytes += pair.second.size;
+        }
+    }
+
+    if (reclaim && isSafePoint(_context)) {
+        for (const LeakReport::Leak &leak: report.leaks) {
+            mallocContext->attemptDeallocation(leak.address);
+        }
+        report.reclaimed = true;
+    }
+
+    return report;
+}
+
+}
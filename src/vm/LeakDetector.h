@@ -0,0 +1,79 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+
+namespace cish::vm
+{
+
+class ExecutionContext;
+
+struct LeakReport
+{
+    struct Leak
+    {
+        uint32_t address;
+        uint32_t size;
+
+        // The function which called malloc, or null for the global scope
+        const std::string *callSite;
+    };
+
+    struct CallSiteSummary
+    {
+        std::string callSite;
+        uint32_t count;
+        uint64_t bytes;
+    };
+
+    std::vector<Leak> leaks;
+    uint64_t leakedBytes = 0;
+
+    uint32_t reachableBlocks = 0;
+    uint64_t reachableBytes = 0;
+
+    // Whether the leaked blocks were freed
+    bool reclaimed = false;
+
+    /**
+     * The leaks grouped by call site, largest total first.
+     */
+    std::vector<CallSiteSummary> getCallSiteSummary() const;
+};
+
+
+/**
+ * Conservative mark & sweep over the blocks allocated with malloc().
+ *
+ * Every variable in the global scope and in the live function frames is
+ * a root. Roots and reachable blocks are scanned at every byte offset for
+ * values pointing into (or one past the end of) a malloc'ed block, and
+ * blocks not reached this way are reported as leaked.
+ *
+ * Values held by the host while an expression is being evaluated are not
+ * visible to the scanner. Leaks are therefore only reclaimed at safe
+ * points, when no function other than main() is executing and no
+ * expression evaluation can be in progress. Because any integer that
+ * looks like a pointer keeps a block alive, blocks can't be moved, so
+ * the heap is never compacted.
+ */
+class LeakDetector
+{
+public:
+    LeakDetector(ExecutionContext *context);
+
+    static bool isSafePoint(const ExecutionContext *context);
+
+    /**
+     * Scan for unreachable blocks. If 'reclaim' is set and the context is
+     * at a safe point, the unreachable blocks are freed as well.
+     */
+    LeakReport run(bool reclaim);
+
+private:
+    ExecutionContext *_context;
+};
+
+}
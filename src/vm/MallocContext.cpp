@@ -0,0 +1,74 @@
+#include "MallocContext.h"
+#include "Memory.h"
+
+namespace cish::vm
+{
+
+MallocContext::MallocContext(Memory *memory):
+    _memory(memory),
+    _allocatedBytes(0),
+    _bytesSinceReset(0)
+{
+}
+
+uint32_t MallocContext::allocate(uint32_t size, const std::string *callSite)
+{
+    Allocation::Ptr alloc = _memory->tryAllocate(size);
+    if (!alloc) {
+        return 0;
+    }
+
+    const uint32_t addr = alloc->getAddress();
+    if (_blocks.count(addr) != 0) {
+        Throw(MallocContextException, "address %x already allocated", addr);
+    }
+
+    _blocks[addr] = Block { std::move(alloc), size, callSite };
+    _allocatedBytes += size;
+    _bytesSinceReset += size;
+    return addr;
+}
+
+void MallocContext::adoptBlock(uint32_t addr, uint32_t size, const std::string *callSite)
+{
+    if (_blocks.count(addr) != 0) {
+        Throw(MallocContextException, "address %x already allocated", addr);
+    }
+
+    _blocks[addr] = Block { _memory->adoptAllocation(addr), size, callSite };
+    _allocatedBytes += size;
+}
+
+bool MallocContext::attemptDeallocation(uint32_t addr)
+{
+    auto it = _blocks.find(addr);
+    if (it == _blocks.end()) {
+        return false;
+    }
+
+    _allocatedBytes -= it->second.size;
+    _blocks.erase(it);
+    return true;
+}
+
+const std::map<uint32_t, MallocContext::Block>& MallocContext::getBlocks() const
+{
+    return _blocks;
+}
+
+uint64_t MallocContext::getAllocatedBytes() const
+{
+    return _allocatedBytes;
+}
+
+uint64_t MallocContext::getBytesAllocatedSinceReset() const
+{
+    return _bytesSinceReset;
+}
+
+void MallocContext::resetAllocationCounter()
+{
+    _bytesSinceReset = 0;
+}
+
+}
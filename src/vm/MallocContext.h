@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Allocation.h"
+#include "../Exception.h"
+
+#include <map>
+#include <string>
+
+namespace cish::vm
+{
+
+DECLARE_EXCEPTION(MallocContextException);
+
+class Memory;
+
+/**
+ * Bookkeeping for the memory handed out through malloc(). Every VM has
+ * its own MallocContext, which owns the allocations until they are freed
+ * by the program, reclaimed by the LeakDetector or the VM is destroyed.
+ */
+class MallocContext
+{
+public:
+    struct Block
+    {
+        Allocation::Ptr allocation;
+        uint32_t size;
+
+        // The function which called malloc, or null for the global scope
+        const std::string *callSite;
+    };
+
+    MallocContext(Memory *memory);
+
+    /**
+     * Returns the address of the new block, or 0 if the allocation failed.
+     */
+    uint32_t allocate(uint32_t size, const std::string *callSite);
+    bool attemptDeallocation(uint32_t addr);
+
+    /**
+     * Take over a block which was malloc'ed before the Memory was
+     * restored from a snapshot, see Memory::adoptAllocation().
+     */
+    void adoptBlock(uint32_t addr, uint32_t size, const std::string *callSite);
+
+    const std::map<uint32_t, Block>& getBlocks() const;
+    uint64_t getAllocatedBytes() const;
+
+    /**
+     * The number of bytes allocated since the last call to
+     * resetAllocationCounter().
+     */
+    uint64_t getBytesAllocatedSinceReset() const;
+    void resetAllocationCounter();
+
+private:
+    Memory *_memory;
+    std::map<uint32_t, Block> _blocks;
+    uint64_t _allocatedBytes;
+    uint64_t _bytesSinceReset;
+};
+
+}
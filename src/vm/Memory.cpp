@@ -2,40 +2,160 @@
 
 #include "../Exception.h"
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <cstring>
+
+#include <sys/mman.h>
+
+#ifndef MAP_NORESERVE
+    #define MAP_NORESERVE 0
+#endif
 
 
 namespace cish::vm
 {
 
 static const uint32_t FIRST_USABLE_ADDRESS = 0x00400000;
+static const uint64_t MAX_HEAP_SIZE = 0x100000000ull - FIRST_USABLE_ADDRESS;
+
+// Free blocks smaller than this are kept committed, so that programs
+// which repeatedly allocate and free small buffers don't end up calling
+// into the kernel on every free.
+static const uint64_t DECOMMIT_THRESHOLD = 256 * 1024;
+
+/**
+ * Adds the lifetime of the timer to 'target', if 'enabled' is set.
+ */
+class ScopedTimer
+{
+public:
+    ScopedTimer(bool enabled, uint64_t &target):
+        _enabled(enabled),
+        _target(target)
+    {
+        if (_enabled) {
+            _start = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~ScopedTimer()
+    {
+        if (_enabled) {
+            auto elapsed = std::chrono::steady_clock::now() - _start;
+            _target += std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+        }
+    }
+
+private:
+    bool _enabled;
+    uint64_t &_target;
+    std::chrono::steady_clock::time_point _start;
+};
+
+static uint32_t validateHeapSize(uint32_t heapSize)
+{
+    if ((uint64_t)heapSize > MAX_HEAP_SIZE) {
+        Throw(MemoryReservationException, "Heap size of %u bytes exceeds the maximum of %llu bytes",
+              heapSize, (unsigned long long)MAX_HEAP_SIZE);
+    }
+
+    return heapSize;
+}
+
+// Anonymous mappings are zero-filled and only backed by physical memory
+// once written to, so bookkeeping tables sized after the heap limit only
+// cost memory for the parts of the heap actually in use.
+static void* mapLazyTable(uint64_t size)
+{
+    void *table = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (table == MAP_FAILED) {
+        Throw(MemoryReservationException, "Failed to reserve %llu bytes of bookkeeping memory",
+              (unsigned long long)size);
+    }
+
+    return table;
+}
 
 uint32_t Memory::firstUsableMemoryAddress()
 {
     return FIRST_USABLE_ADDRESS;
 }
 
+uint32_t Memory::maxHeapSize()
+{
+    return (uint32_t)MAX_HEAP_SIZE;
+}
+
 
 Memory::Memory(uint32_t heapSize, uint32_t minAllocSize):
-    _heapSize(heapSize),
+    _heapSize(validateHeapSize(heapSize)),
     _allocationSize(minAllocSize),
     _numAllocationUnits(heapSize / minAllocSize),
-    _allocator(_numAllocationUnits)
+    _heap(heapSize),
+    _allocationMap(nullptr),
+    _allocationMapSize(_numAllocationUnits / 8 + 1),
+    _allocationUnits(nullptr),
+    _allocationUnitsSize(((uint64_t)_numAllocationUnits + 1) * sizeof(uint32_t)),
+    _unitHighWater(0),
+    _allocator(_numAllocationUnits),
+    _interiorAccess(this),
+    _timingEnabled(false),
+    _observer(nullptr),
+    _dirtyTracking(false)
 {
-    assert(_heapSize >= 0);
-    assert(_allocationSize >= 0);
+    assert(_allocationSize > 0);
+    mapTables();
+}
 
-    _heap = new uint8_t[_heapSize];
+Memory::Memory(const Snapshot &snapshot):
+    _heapSize(snapshot.heapSize),
+    _allocationSize(snapshot.minAllocSize),
+    _numAllocationUnits(snapshot.heapSize / snapshot.minAllocSize),
+    _heap(*snapshot.heap),
+    _allocationMap(nullptr),
+    _allocationMapSize(_numAllocationUnits / 8 + 1),
+    _allocationUnits(nullptr),
+    _allocationUnitsSize(((uint64_t)_numAllocationUnits + 1) * sizeof(uint32_t)),
+    _unitHighWater((uint32_t)snapshot.allocationUnits.size()),
+    _allocator(snapshot.allocator),
+    _interiorAccess(this),
+    _stats(snapshot.stats),
+    _timingEnabled(false),
+    _observer(nullptr),
+    _dirtyTracking(false)
+{
+    mapTables();
 
-    const uint32_t allocMapSize = _heapSize / (_allocationSize * 8) + 1;
-    _allocationMap = new uint8_t[allocMapSize];
-    memset(_allocationMap, 0, allocMapSize);
+    // Only the used prefix of the tables is copied, the rest of the
+    // lazily mapped tables are zero already.
+    memcpy(_allocationMap, snapshot.allocationMap.data(), snapshot.allocationMap.size());
+    memcpy(_allocationUnits, snapshot.allocationUnits.data(),
+           snapshot.allocationUnits.size() * sizeof(uint32_t));
 }
 
 Memory::~Memory()
 {
-    delete[] _heap;
-    delete[] _allocationMap;
+    munmap(_allocationMap, _allocationMapSize);
+    munmap(_allocationUnits, _allocationUnitsSize);
+}
+
+
+Memory::Snapshot::Ptr Memory::createSnapshot(bool includeHeap) const
+{
+    const uint32_t mapBytes = (_unitHighWater + 7) / 8;
+
+    return std::make_shared<Snapshot>(Snapshot {
+        _heapSize,
+        _allocationSize,
+        includeHeap ? _heap.createImage() : nullptr,
+        _allocator,
+        std::vector<uint8_t>(_allocationMap, _allocationMap + mapBytes),
+        std::vector<uint32_t>(_allocationUnits, _allocationUnits + _unitHighWater),
+        _stats,
+    });
 }
 
 
@@ -49,19 +169,75 @@ uint32_t Memory::getFreeSize() const
     return _allocator.getFreeSize() * _allocationSize;
 }
 
+uint64_t Memory::getCommittedSize() const
+{
+    return _heap.getCommittedSize();
+}
+
+MemoryStats Memory::getStats() const
+{
+    MemoryStats stats = _stats;
+
+    stats.totalFreeBytes = (uint64_t)_allocator.getFreeSize() * _allocationSize;
+    stats.largestFreeBlock = (uint64_t)_allocator.getLargestFreeBlock() * _allocationSize;
+    stats.reservedBytes = _heap.getReservedSize();
+    stats.committedBytes = _heap.getCommittedSize();
+
+    return stats;
+}
+
+void Memory::setTimingEnabled(bool enabled)
+{
+    _timingEnabled = enabled;
+}
+
+void Memory::setAllocationObserver(AllocationObserver *observer)
+{
+    _observer = observer;
+}
+
 Allocation::Ptr Memory::allocate(uint32_t size)
 {
-    const uint32_t allocationUnits = byteCountToUnitCount(size);
-    const uint32_t unitIndex = _allocator.allocate(allocationUnits);
-    markAsAllocated(unitIndex, allocationUnits);
+    Allocation::Ptr alloc = tryAllocate(size);
+    if (!alloc) {
+        Throw(AllocationFailedException, "Failed to allocate %u bytes", size);
+    }
+
+    return alloc;
+}
+
+Allocation::Ptr Memory::tryAllocate(uint32_t size)
+{
+    ScopedTimer timer(_timingEnabled, _stats.allocateNanos);
+
+    // Zero-sized allocations still get a unique address
+    const uint32_t allocationUnits = std::max(1u, byteCountToUnitCount(size));
+
+    uint32_t unitIndex;
+    if (!allocateUnits(allocationUnits, &unitIndex)) {
+        _stats.failedAllocationCount++;
+        return nullptr;
+    }
 
     const uint32_t byteOffset = unitIndex * _allocationSize;
     const uint32_t byteSize = allocationUnits * _allocationSize;
 
+    markAsAllocated(unitIndex, allocationUnits);
+    _allocationUnits[unitIndex] = allocationUnits;
+    _unitHighWater = std::max(_unitHighWater, unitIndex + allocationUnits);
+
+    _stats.allocationCount++;
+    _stats.allocationsBySizeClass[MemoryStats::getSizeClass(byteSize)]++;
+    _stats.liveBytes += byteSize;
+    _stats.peakBytes = std::max(_stats.peakBytes, _stats.liveBytes);
+
+    const uint32_t address = FIRST_USABLE_ADDRESS + byteOffset;
+    if (_observer) {
+        _observer->onAllocate(address, byteSize);
+    }
+
     MemoryAccess *memAccess = this;
-    Allocation::Ptr alloc = std::make_unique<Allocation>(memAccess, FIRST_USABLE_ADDRESS + byteOffset);
-    _allocLen[alloc.get()] = byteSize;
-    return alloc;
+    return Allocation::Ptr(_allocationPool.create(memAccess, address));
 }
 
 MemoryView Memory::getView(uint32_t address) noexcept
@@ -69,6 +245,96 @@ MemoryView Memory::getView(uint32_t address) noexcept
     return MemoryView(this, address);
 }
 
+uint32_t Memory::getAllocationSize(uint32_t address) const
+{
+    if (address < FIRST_USABLE_ADDRESS) {
+        return 0;
+    }
+
+    const uint32_t byteOffset = address - FIRST_USABLE_ADDRESS;
+    const uint32_t unit = byteOffsetToUnit(byteOffset);
+    if (unit >= _numAllocationUnits || unit * _allocationSize != byteOffset) {
+        return 0;
+    }
+
+    return _allocationUnits[unit] * _allocationSize;
+}
+
+Allocation::Ptr Memory::createInteriorAllocation(uint32_t address)
+{
+    checkAccess(address, 1);
+
+    MemoryAccess *memAccess = &_interiorAccess;
+    return Allocation::Ptr(_allocationPool.create(memAccess, address));
+}
+
+Allocation::Ptr Memory::adoptAllocation(uint32_t address)
+{
+    if (getAllocationSize(address) == 0) {
+        Throw(InvalidAccessException, "No allocation starts at address 0x%x", address);
+    }
+
+    MemoryAccess *memAccess = this;
+    return Allocation::Ptr(_allocationPool.create(memAccess, address));
+}
+
+void Memory::setDirtyTrackingEnabled(bool enabled)
+{
+    _dirtyTracking = enabled;
+    _dirtyPages.assign(enabled ? (_heap.getReservedSize() / HeapRegion::getPageSize() + 63) / 64 : 0, 0);
+}
+
+void Memory::collectDirtyPages(const PageVisitor &visitor)
+{
+    if (!_dirtyTracking) {
+        Throw(Exception, "Dirty page tracking is not enabled");
+    }
+
+    const uint64_t pageSize = HeapRegion::getPageSize();
+
+    // Only committed pages can hold data, whatever was written to pages
+    // which have since been decommitted is gone.
+    _heap.forEachCommittedRun([&](uint64_t runOffset, uint64_t runLen) {
+        const uint64_t endPage = (runOffset + runLen) / pageSize;
+        uint64_t page = runOffset / pageSize;
+        while (page < endPage) {
+            if (!isPageDirty(page)) {
+                page++;
+                continue;
+            }
+
+            const uint64_t dirtyStart = page;
+            while (page < endPage && isPageDirty(page)) {
+                page++;
+            }
+
+            const uint64_t offset = dirtyStart * pageSize;
+            visitor(offset, _heap.data() + offset, (page - dirtyStart) * pageSize);
+        }
+    });
+
+    std::fill(_dirtyPages.begin(), _dirtyPages.end(), 0);
+}
+
+void Memory::forEachCommittedRun(const PageVisitor &visitor) const
+{
+    _heap.forEachCommittedRun([&](uint64_t offset, uint64_t len) {
+        visitor(offset, _heap.data() + offset, len);
+    });
+}
+
+void Memory::mapTables()
+{
+    _allocationMap = (uint8_t*)mapLazyTable(_allocationMapSize);
+
+    try {
+        _allocationUnits = (uint32_t*)mapLazyTable(_allocationUnitsSize);
+    } catch (...) {
+        munmap(_allocationMap, _allocationMapSize);
+        throw;
+    }
+}
+
 void Memory::markAsAllocated(uint32_t startUnit, uint32_t numUnits)
 {
     for (int i = startUnit; i<startUnit + numUnits; i++) {
@@ -111,31 +377,91 @@ uint32_t Memory::byteCountToUnitCount(uint32_t byteCount) const
     }
 
     return units;
+}
+
+bool Memory::allocateUnits(uint32_t numUnits, uint32_t *unitIndex)
+{
+    if (!_allocator.tryAllocate(numUnits, unitIndex)) {
+        return false;
+    }
+
+    try {
+        _heap.commit((uint64_t)*unitIndex * _allocationSize, (uint64_t)numUnits * _allocationSize);
+    } catch (const MemoryReservationException&) {
+        // The OS refused to back the memory, which is rare enough to
+        // not warrant a non-throwing path through HeapRegion.
+        _allocator.deallocate(*unitIndex, numUnits);
+        return false;
+    }
+
+    // Recommitted pages are zeroed, which counts as a write
+    markDirty((uint64_t)*unitIndex * _allocationSize, (uint64_t)numUnits * _allocationSize);
+    return true;
+}
+
+void Memory::releaseFreeBlock(const Allocator::Block &block)
+{
+    const uint64_t byteOffset = (uint64_t)block.offset * _allocationSize;
+    const uint64_t byteLength = (uint64_t)block.length * _allocationSize;
+
+    if (byteLength >= DECOMMIT_THRESHOLD) {
+        _heap.decommit(byteOffset, byteLength);
+    }
+}
+
+void Memory::markDirty(uint64_t byteOffset, uint64_t len)
+{
+    if (!_dirtyTracking || len == 0) {
+        return;
+    }
+
+    const uint64_t pageSize = HeapRegion::getPageSize();
+    const uint64_t endPage = (byteOffset + len + pageSize - 1) / pageSize;
+    for (uint64_t page = byteOffset / pageSize; page < endPage; page++) {
+        _dirtyPages[page / 64] |= (1ull << (page % 64));
+    }
+}
 
+bool Memory::isPageDirty(uint64_t page) const
+{
+    return _dirtyPages[page / 64] & (1ull << (page % 64));
 }
 
 
 /* MemoryAccess */
 void Memory::onDeallocation(Allocation *allocation)
 {
-    if (!_allocLen.count(allocation)) {
-        Throw(InvalidFreeException, "unable to free allocation");
-    }
+    ScopedTimer timer(_timingEnabled, _stats.freeNanos);
 
     const uint32_t byteOffset = allocation->getAddress() - FIRST_USABLE_ADDRESS;
     const uint32_t startUnit = byteOffsetToUnit(byteOffset);
 
-    const uint32_t allocatedBytes = _allocLen[allocation];
-    const uint32_t numUnits = byteCountToUnitCount(allocatedBytes);
+    if (startUnit >= _numAllocationUnits || _allocationUnits[startUnit] == 0) {
+        Throw(InvalidFreeException, "unable to free allocation");
+    }
+
+    const uint32_t numUnits = _allocationUnits[startUnit];
+    const uint32_t byteSize = numUnits * _allocationSize;
+    _allocationUnits[startUnit] = 0;
+
+    if (_observer) {
+        _observer->onFree(allocation->getAddress(), byteSize);
+    }
 
-    _allocator.deallocate(startUnit, numUnits);
+    _allocationPool.destroy(allocation);
+    _stats.freeCount++;
+    _stats.liveBytes -= byteSize;
+
+    const Allocator::Block freeBlock = _allocator.deallocate(startUnit, numUnits);
     markAsFree(startUnit, numUnits);
-    _allocLen.erase(allocation);
+
+    releaseFreeBlock(freeBlock);
 }
 
-const uint8_t* Memory::read(uint32_t address, uint32_t len)
+void Memory::checkAccess(uint32_t address, uint32_t len) const
 {
-    if (address < FIRST_USABLE_ADDRESS || address + len > FIRST_USABLE_ADDRESS + _heapSize) {
+    const uint64_t end = (uint64_t)address + len;
+    if (address < FIRST_USABLE_ADDRESS || end > (uint64_t)FIRST_USABLE_ADDRESS + _heapSize) {
         Throw(InvalidAccessException, "cannot access address 0x%x", address);
     }
 
@@ -143,32 +469,53 @@ const uint8_t* Memory::read(uint32_t address, uint32_t len)
     const uint32_t firstUnit = byteOffsetToUnit(byteOffset);
     const uint32_t numUnits = byteCountToUnitCount(len);
 
-    for (int i=0; i<numUnits; i++) {
+    for (uint32_t i=0; i<numUnits; i++) {
         if (!isUnitAllocated(firstUnit + i)) {
             Throw(InvalidAccessException, "cannot access address 0x%x", address);
         }
     }
+}
+
+const uint8_t* Memory::read(uint32_t address, uint32_t len)
+{
+    checkAccess(address, len);
 
-    return _heap + byteOffset;
+    const uint32_t byteOffset = address - FIRST_USABLE_ADDRESS;
+
+    return _heap.data() + byteOffset;
 }
 
 void Memory::write(const uint8_t *buffer, uint32_t address, uint32_t len)
 {
-    if (address < FIRST_USABLE_ADDRESS || address + len > FIRST_USABLE_ADDRESS + _heapSize) {
-        Throw(InvalidAccessException, "cannot access address 0x%x", address);
-    }
+    checkAccess(address, len);
 
     const uint32_t byteOffset = address - FIRST_USABLE_ADDRESS;
-    const uint32_t firstUnit = byteOffsetToUnit(byteOffset);
-    const uint32_t numUnits = byteCountToUnitCount(len);
 
-    for (int i=0; i<numUnits; i++) {
-        if (!isUnitAllocated(firstUnit + i)) {
-            Throw(InvalidAccessException, "cannot access address 0x%x", address);
-        }
-    }
+    memcpy(_heap.data() + byteOffset, buffer, len);
+    markDirty(byteOffset, len);
+}
+
 
-    memcpy(_heap + byteOffset, buffer, len);
+
+/* InteriorAccess */
+Memory::InteriorAccess::InteriorAccess(Memory *memory):
+    _memory(memory)
+{
+}
+
+void Memory::InteriorAccess::onDeallocation(Allocation *allocation)
+{
+    _memory->_allocationPool.destroy(allocation);
+}
+
+const uint8_t* Memory::InteriorAccess::read(uint32_t address, uint32_t len)
+{
+    return _memory->read(address, len);
+}
+
+void Memory::InteriorAccess::write(const uint8_t *buffer, uint32_t address, uint32_t len)
+{
+    _memory->write(buffer, address, len);
 }
 
 }
@@ -2,12 +2,16 @@
 
 #include "Allocation.h"
 #include "Allocator.h"
+#include "HeapRegion.h"
+#include "ObjectPool.h"
+#include "MemoryStats.h"
 #include "../Exception.h"
 
 #include <stdint.h>
+#include <functional>
+#include <memory>
 #include <stdexcept>
 #include <vector>
-#include <map>
 
 namespace cish::vm
 {
@@ -19,14 +23,92 @@ DECLARE_EXCEPTION(InvalidAccessException);
 class Memory : private MemoryAccess
 {
 public:
+    /**
+     * The heap and allocator state of a Memory at one point in time. Any
+     * number of Memory instances can be restored from a snapshot, and
+     * they share the heap pages until they write to them. The Allocation
+     * objects are not captured, see adoptAllocation().
+     */
+    struct Snapshot
+    {
+        typedef std::shared_ptr<const Snapshot> Ptr;
+
+        uint32_t heapSize;
+        uint32_t minAllocSize;
+
+        // Null if the snapshot was created without the heap pages
+        HeapImage::Ptr heap;
+        Allocator allocator;
+
+        // The bookkeeping tables, up to the last unit ever allocated
+        std::vector<uint8_t> allocationMap;
+        std::vector<uint32_t> allocationUnits;
+
+        MemoryStats stats;
+    };
+
+    /**
+     * Receives runs of whole heap pages. 'offset' is relative to the start
+     * of the heap, not a VM address.
+     */
+    typedef std::function<void(uint64_t offset, const uint8_t *data, uint64_t len)> PageVisitor;
+
     static uint32_t firstUsableMemoryAddress();
 
+    /**
+     * The largest heap the VM address space can hold.
+     */
+    static uint32_t maxHeapSize();
+
+    /**
+     * 'heapSize' is the upper limit of the heap. The address space is
+     * reserved immediately, but physical memory is only committed as
+     * allocations are made, and returned when large regions are freed.
+     */
     Memory(uint32_t heapSize, uint32_t minAllocSize);
+
+    /**
+     * Restore the state captured in 'snapshot'. Every allocation which
+     * was live when the snapshot was taken is live in the new Memory.
+     */
+    Memory(const Snapshot &snapshot);
     virtual ~Memory();
 
+    /**
+     * Copying the heap pages is by far the most expensive part of a
+     * snapshot, so it can be left out when the pages are captured by
+     * other means, see collectDirtyPages().
+     */
+    Snapshot::Ptr createSnapshot(bool includeHeap = true) const;
+
     uint32_t getTotalSize() const;
     uint32_t getFreeSize() const;
 
+    /**
+     * The number of bytes of the heap currently backed by physical
+     * memory. Always a multiple of the system page size.
+     */
+    uint64_t getCommittedSize() const;
+
+    /**
+     * Collect the current allocator statistics. Counters are maintained
+     * continuously, while the fragmentation figures are computed on
+     * demand.
+     */
+    MemoryStats getStats() const;
+
+    /**
+     * Measure the time spent allocating and freeing memory. Disabled by
+     * default, as it reads the clock twice for every operation.
+     */
+    void setTimingEnabled(bool enabled);
+
+    /**
+     * The observer is notified of every allocation and deallocation.
+     * Memory does not take ownership of the observer.
+     */
+    void setAllocationObserver(AllocationObserver *observer);
+
     /**
      * If an allocation can be made, this method guarantees a
      * safe view into memory. The memory will remain safely
@@ -34,6 +116,12 @@ public:
      */
     Allocation::Ptr allocate(uint32_t size);
 
+    /**
+     * Same as allocate(), but returns null instead of throwing
+     * when the allocation cannot be made.
+     */
+    Allocation::Ptr tryAllocate(uint32_t size);
+
     /**
      * Provides a potentially unsafe view into the memory. No
      * checks are performed to ensure that 'address' is a valid
@@ -43,20 +131,102 @@ public:
      */
     MemoryView getView(uint32_t address) noexcept;
 
+    /**
+     * The number of bytes reserved for the allocation starting at
+     * 'address', or 0 if no allocation starts there.
+     */
+    uint32_t getAllocationSize(uint32_t address) const;
+
+    /**
+     * Create an Allocation referring to 'address' within an existing
+     * allocation, such as a single variable in the data segment.
+     * Releasing it frees no memory, so the enclosing allocation must
+     * outlive it.
+     */
+    Allocation::Ptr createInteriorAllocation(uint32_t address);
+
+    /**
+     * Take ownership of the allocation starting at 'address', which was
+     * restored from a snapshot. Releasing it frees the memory as usual,
+     * so every restored allocation must be adopted at most once.
+     */
+    Allocation::Ptr adoptAllocation(uint32_t address);
+
+    /**
+     * Keep track of which heap pages are written to. Enabling the tracking
+     * marks every page as clean.
+     */
+    void setDirtyTrackingEnabled(bool enabled);
+
+    /**
+     * Visit the committed pages written to since tracking was enabled or
+     * since the last call, and mark them clean. Adjacent dirty pages are
+     * visited as one run.
+     */
+    void collectDirtyPages(const PageVisitor &visitor);
+
+    /**
+     * Visit every run of committed heap pages.
+     */
+    void forEachCommittedRun(const PageVisitor &visitor) const;
+
 private:
+    /**
+     * MemoryAccess of interior allocations. Accesses are forwarded to
+     * the Memory, releasing only recycles the Allocation object.
+     */
+    class InteriorAccess: public MemoryAccess
+    {
+    public:
+        InteriorAccess(Memory *memory);
+
+        void onDeallocation(Allocation *allocation) override;
+        const uint8_t* read(uint32_t address, uint32_t len) override;
+        void write(const uint8_t *buffer, uint32_t address, uint32_t len) override;
+
+    private:
+        Memory *_memory;
+    };
+
     const uint32_t _heapSize;
     const uint32_t _allocationSize;
     const uint32_t _numAllocationUnits;
-    uint8_t *_heap;
+    HeapRegion _heap;
     uint8_t *_allocationMap;
-    std::map<Allocation*,uint32_t> _allocLen;
+    uint64_t _allocationMapSize;
+
+    // The length in units of every live allocation, indexed by its
+    // first unit. Zero for units which don't start an allocation.
+    uint32_t *_allocationUnits;
+    uint64_t _allocationUnitsSize;
+
+    // One past the highest unit ever allocated, beyond which both
+    // tables are still all zero.
+    uint32_t _unitHighWater;
+
     Allocator _allocator;
+    ObjectPool<Allocation> _allocationPool;
+    InteriorAccess _interiorAccess;
+
+    MemoryStats _stats;
+    bool _timingEnabled;
+    AllocationObserver *_observer;
+
+    // One bit per heap page, only maintained while tracking is enabled
+    bool _dirtyTracking;
+    std::vector<uint64_t> _dirtyPages;
 
+    void mapTables();
     void markAsAllocated(uint32_t offset, uint32_t len);
     void markAsFree(uint32_t offset, uint32_t len);
     bool isUnitAllocated(uint32_t unitIndex) const;
     uint32_t byteOffsetToUnit(uint32_t byteOffset) const;
     uint32_t byteCountToUnitCount(uint32_t byteCount) const;
+    bool allocateUnits(uint32_t numUnits, uint32_t *unitIndex);
+    void releaseFreeBlock(const Allocator::Block &block);
+    void markDirty(uint64_t byteOffset, uint64_t len);
+    bool isPageDirty(uint64_t page) const;
+    void checkAccess(uint32_t address, uint32_t len) const;
 
     /* MemoryAccess */
     void onDeallocation(Allocation *allocation) override;
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <stdint.h>
+
+
+namespace cish::vm
+{
+
+/**
+ * A snapshot of the allocator state of a Memory instance. All byte counts
+ * refer to heap bytes actually consumed, i.e. rounded up to whole
+ * allocation units.
+ */
+struct MemoryStats
+{
+    /**
+     * Allocations are bucketed by powers of two, starting at 8 bytes.
+     * Size class N counts allocations of at most (8 << N) bytes, the last
+     * class counts everything larger.
+     */
+    static const uint32_t NUM_SIZE_CLASSES = 16;
+
+    static uint32_t getSizeClass(uint32_t size)
+    {
+        uint32_t sizeClass = 0;
+        uint64_t limit = 8;
+        while (sizeClass < NUM_SIZE_CLASSES - 1 && size > limit) {
+            limit <<= 1;
+            sizeClass++;
+        }
+        return sizeClass;
+    }
+
+    // Memory currently handed out, and the most that has ever been
+    uint64_t liveBytes = 0;
+    uint64_t peakBytes = 0;
+
+    uint64_t allocationCount = 0;
+    uint64_t freeCount = 0;
+    uint64_t failedAllocationCount = 0;
+    uint64_t allocationsBySizeClass[NUM_SIZE_CLASSES] = {};
+
+    // Fragmentation of the free space. When the largest free block is
+    // much smaller than the total free size, large allocations may fail
+    // even though plenty of memory is available.
+    uint64_t totalFreeBytes = 0;
+    uint64_t largestFreeBlock = 0;
+
+    uint64_t reservedBytes = 0;
+    uint64_t committedBytes = 0;
+
+    // Time spent in allocate and free. Only measured when timing has
+    // been enabled on the Memory, as reading the clock is not free.
+    uint64_t allocateNanos = 0;
+    uint64_t freeNanos = 0;
+
+    /**
+     * 0.0 when all free memory is one contiguous block, approaching 1.0
+     * as the free memory is split into ever smaller blocks.
+     */
+    double getFragmentation() const
+    {
+        if (totalFreeBytes == 0) {
+            return 0.0;
+        }
+        return 1.0 - (double)largestFreeBlock / (double)totalFreeBytes;
+    }
+};
+
+
+/**
+ * Receives a callback for every allocation and deallocation made
+ * through a Memory instance.
+ */
+class AllocationObserver
+{
+public:
+    virtual ~AllocationObserver() = default;
+
+    virtual void onAllocate(uint32_t address, uint32_t size) = 0;
+    virtual void onFree(uint32_t address, uint32_t size) = 0;
+};
+
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+
+namespace cish::vm
+{
+
+/**
+ * Slab allocator for the host-side bookkeeping objects of a single VM.
+ *
+ * Objects are carved out of fixed-size slabs and recycled through an
+ * intrusive free list, so once a pool has grown to the working set of
+ * the program, create() and destroy() never touch the host allocator.
+ * Slabs are only released when the pool itself is destroyed.
+ *
+ * The pool is not thread safe, and every object must be destroyed
+ * before the pool is.
+ */
+template<typename T, uint32_t SlabSize = 128>
+class ObjectPool
+{
+public:
+    ObjectPool();
+    ~ObjectPool() = default;
+
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    template<typename... Args>
+    T* create(Args&&... args);
+    void destroy(T *object);
+
+    uint32_t getLiveCount() const;
+    uint32_t getCapacity() const;
+
+private:
+    union Slot
+    {
+        Slot *next;
+        alignas(T) uint8_t storage[sizeof(T)];
+    };
+
+    std::vector<std::unique_ptr<Slot[]>> _slabs;
+    Slot *_freeList;
+    uint32_t _liveCount;
+
+    void addSlab();
+};
+
+
+template<typename T, uint32_t SlabSize>
+ObjectPool<T,SlabSize>::ObjectPool():
+    _freeList(nullptr),
+    _liveCount(0)
+{
+}
+
+template<typename T, uint32_t SlabSize>
+template<typename... Args>
+T* ObjectPool<T,SlabSize>::create(Args&&... args)
+{
+    if (_freeList == nullptr) {
+        addSlab();
+    }
+
+    Slot *slot = _freeList;
+    _freeList = slot->next;
+
+    T *object;
+    try {
+        object = new (slot->storage) T(std::forward<Args>(args)...);
+    } catch (...) {
+        slot->next = _freeList;
+        _freeList = slot;
+        throw;
+    }
+
+    _liveCount++;
+    return object;
+}
+
+template<typename T, uint32_t SlabSize>
+void ObjectPool<T,SlabSize>::destroy(T *object)
+{
+    if (object == nullptr) {
+        return;
+    }
+
+    object->~T();
+
+    Slot *slot = reinterpret_cast<Slot*>(object);
+    slot->next = _freeList;
+    _freeList = slot;
+    _liveCount--;
+}
+
+template<typename T, uint32_t SlabSize>
+uint32_t ObjectPool<T,SlabSize>::getLiveCount() const
+{
+    return _liveCount;
+}
+
+template<typename T, uint32_t SlabSize>
+uint32_t ObjectPool<T,SlabSize>::getCapacity() const
+{
+    return (uint32_t)_slabs.size() * SlabSize;
+}
+
+template<typename T, uint32_t SlabSize>
+void ObjectPool<T,SlabSize>::addSlab()
+{
+    std::unique_ptr<Slot[]> slab(new Slot[SlabSize]);
+
+    for (uint32_t i=0; i<SlabSize; i++) {
+        slab[i].next = (i + 1 < SlabSize) ? &slab[i + 1] : _freeList;
+    }
+
+    _freeList = &slab[0];
+    _slabs.push_back(std::move(slab));
+}
+
+}
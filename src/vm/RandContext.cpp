@@ -0,0 +1,63 @@
+#include "RandContext.h"
+
+
+namespace cish::vm
+{
+
+RandContext::RandContext()
+{
+    seed(1);
+}
+
+void RandContext::seed(uint32_t seed)
+{
+    // A zero seed would leave the table all zeroes
+    if (seed == 0) {
+        seed = 1;
+    }
+
+    // Fill the table with the Park-Miller "minimal standard" generator,
+    // computed with Schrage's method to avoid overflow
+    int32_t word = (int32_t)seed;
+    _state.table[0] = seed;
+    for (uint32_t i=1; i<DEGREE; i++) {
+        const int64_t hi = word / 127773;
+        const int64_t lo = word % 127773;
+        word = (int32_t)(16807 * lo - 2836 * hi);
+        if (word < 0) {
+            word += MAX_VALUE;
+        }
+        _state.table[i] = (uint32_t)word;
+    }
+
+    _state.front = SEPARATION;
+    _state.rear = 0;
+
+    // The first values are poorly mixed
+    for (uint32_t i=0; i<DEGREE*10; i++) {
+        next();
+    }
+}
+
+int32_t RandContext::next()
+{
+    _state.table[_state.front] += _state.table[_state.rear];
+    const int32_t result = (int32_t)(_state.table[_state.front] >> 1);
+
+    _state.front = (_state.front + 1) % DEGREE;
+    _state.rear = (_state.rear + 1) % DEGREE;
+
+    return result;
+}
+
+const RandContext::State& RandContext::getState() const
+{
+    return _state;
+}
+
+void RandContext::restoreState(const State &state)
+{
+    _state = state;
+}
+
+}
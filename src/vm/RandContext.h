@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stdint.h>
+
+
+namespace cish::vm
+{
+
+/**
+ * The sequence of rand() and srand(). Like the MallocContext, every VM has
+ * its own RandContext, so VMs running on other threads can neither reseed
+ * nor consume the sequence of this one.
+ *
+ * The generator is the additive feedback generator of glibc's random(),
+ * so a program prints the same numbers as it would when compiled natively
+ * on glibc.
+ */
+class RandContext
+{
+public:
+    static const uint32_t DEGREE = 31;
+    static const uint32_t SEPARATION = 3;
+    static const int32_t MAX_VALUE = 2147483647;
+
+    /**
+     * The generator as it is captured in snapshots.
+     */
+    struct State
+    {
+        uint32_t table[DEGREE];
+        uint32_t front;
+        uint32_t rear;
+    };
+
+    /**
+     * Seeded with 1, like rand() is before srand() has been called.
+     */
+    RandContext();
+
+    void seed(uint32_t seed);
+    int32_t next();
+
+    const State& getState() const;
+    void restoreState(const State &state);
+
+private:
+    State _state;
+};
+
+}
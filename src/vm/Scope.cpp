@@ -4,36 +4,115 @@
 namespace cish::vm
 {
 
-Scope::Scope(): Scope(nullptr) { }
-
-Scope::Scope(const Scope *parent): _parent(parent) { }
+Scope::Scope(VariablePool *variablePool, const Scope *parent):
+    _variablePool(variablePool),
+    _parent(parent)
+{
+}
 
 Scope::~Scope()
 {
-    for (const std::pair<std::string, Variable*> &pair: _vars) {
-        delete pair.second;
-    }
+    clear();
 }
 
 
-void Scope::addVariable(const std::string &name, Variable *var)
+void Scope::reset(const Scope *parent)
 {
-    // Delete existing variable if one exists
-    if (_vars.count(name) != 0) {
-        delete _vars[name];
+    clear();
+    _parent = parent;
+}
+
+Variable* Scope::addVariable(ast::SymbolId symbol, ast::TypeDecl type, Allocation::Ptr allocation)
+{
+    Variable *var = _variablePool->create(type, std::move(allocation));
+
+    // Replace the existing variable if one exists
+    if (Entry *entry = findEntry(symbol)) {
+        _variablePool->destroy(entry->var);
+        entry->var = var;
+        return var;
+    }
+
+    _vars.push_back(Entry { symbol, var });
+
+    if (_vars.size() == INDEX_THRESHOLD) {
+        for (uint32_t i=0; i<_vars.size(); i++) {
+            _index[_vars[i].symbol] = i;
+        }
+    } else if (_vars.size() > INDEX_THRESHOLD) {
+        _index[symbol] = (uint32_t)_vars.size() - 1;
     }
 
-    _vars[name] = var;
+    return var;
+}
+
+Variable* Scope::getVariable(ast::SymbolId symbol) const
+{
+    for (const Scope *scope = this; scope; scope = scope->_parent) {
+        if (const Entry *entry = scope->findEntry(symbol)) {
+            return entry->var;
+        }
+    }
+
+    return nullptr;
+}
+
+Variable* Scope::addVariable(const std::string &name, ast::TypeDecl type, Allocation::Ptr allocation)
+{
+    return addVariable(ast::Symbol::intern(name), type, std::move(allocation));
 }
 
 Variable* Scope::getVariable(const std::string &name) const
 {
-    if (_vars.count(name) != 0) {
-        return _vars.at(name);
+    const ast::SymbolId symbol = ast::Symbol::find(name);
+    return symbol != 0 ? getVariable(symbol) : nullptr;
+}
+
+void Scope::forEachVariable(const std::function<void(const Variable*)> &visitor) const
+{
+    for (const Entry &entry: _vars) {
+        visitor(entry.var);
+    }
+}
+
+void Scope::forEachNamedVariable(const std::function<void(const std::string&, const Variable*)> &visitor) const
+{
+    for (const Entry &entry: _vars) {
+        visitor(ast::Symbol::getName(entry.symbol), entry.var);
+    }
+}
+
+
+void Scope::clear()
+{
+    // Destroy in reverse order of declaration, like C would
+    for (auto it = _vars.rbegin(); it != _vars.rend(); it++) {
+        _variablePool->destroy(it->var);
+    }
+
+    _vars.clear();
+
+    if (_index.size() != 0) {
+        _index.clear();
+    }
+}
+
+Scope::Entry* Scope::findEntry(ast::SymbolId symbol)
+{
+    return const_cast<Entry*>(static_cast<const Scope*>(this)->findEntry(symbol));
+}
+
+const Scope::Entry* Scope::findEntry(ast::SymbolId symbol) const
+{
+    if (_vars.size() >= INDEX_THRESHOLD) {
+        const uint32_t *index = _index.find(symbol);
+        return index ? &_vars[*index] : nullptr;
     }
 
-    if (_parent) {
-        return _parent->getVariable(name);
+    for (const Entry &entry: _vars) {
+        if (entry.symbol == symbol) {
+            return &entry;
+        }
     }
 
     return nullptr;
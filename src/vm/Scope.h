@@ -1,9 +1,12 @@
 #pragma once
 
-#include <map>
+#include <functional>
 #include <string>
+#include <vector>
 
 #include "Variable.h"
+#include "ObjectPool.h"
+#include "../ast/Symbol.h"
 
 
 namespace cish::vm
@@ -12,16 +15,59 @@ namespace cish::vm
 class Scope
 {
 public:
-    Scope();
-    Scope(const Scope *parent);
+    typedef ObjectPool<Variable> VariablePool;
+
+    /**
+     * Variables added to the scope are created in 'variablePool', and
+     * returned to it when the scope is cleared or destroyed.
+     */
+    Scope(VariablePool *variablePool, const Scope *parent = nullptr);
     ~Scope();
 
-    void addVariable(const std::string &name, Variable *var);
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+    /**
+     * Destroy all variables and attach the scope to a new parent. The
+     * storage of the scope is retained, so recycled scopes don't need
+     * to allocate anything.
+     */
+    void reset(const Scope *parent);
+
+    Variable* addVariable(ast::SymbolId symbol, ast::TypeDecl type, Allocation::Ptr allocation);
+    Variable* getVariable(ast::SymbolId symbol) const;
+
+    Variable* addVariable(const std::string &name, ast::TypeDecl type, Allocation::Ptr allocation);
     Variable* getVariable(const std::string &name) const;
 
+    /**
+     * Visit the variables declared directly in this scope. Parent
+     * scopes are not visited.
+     */
+    void forEachVariable(const std::function<void(const Variable*)> &visitor) const;
+    void forEachNamedVariable(const std::function<void(const std::string&, const Variable*)> &visitor) const;
+
 private:
+    struct Entry
+    {
+        ast::SymbolId symbol;
+        Variable *var;
+    };
+
+    VariablePool *_variablePool;
     const Scope *_parent;
-    std::map<std::string, Variable*> _vars;
+
+    // Scopes rarely hold more than a handful of variables, so a flat
+    // vector beats any kind of map. Scopes holding many, like the global
+    // scope of a large program, are indexed as well.
+    static constexpr size_t INDEX_THRESHOLD = 16;
+    std::vector<Entry> _vars;
+    ast::SymbolMap<uint32_t> _index;
+
+    Entry* findEntry(ast::SymbolId symbol);
+    const Entry* findEntry(ast::SymbolId symbol) const;
+
+    void clear();
 };
 
 }
@@ -1,6 +1,8 @@
 #include "VirtualMachine.h"
 #include "Executor.h"
 #include "Memory.h"
+#include "AllocationTrace.h"
+#include "Checkpoint.h"
 #include "../Exception.h"
 
 using cish::ast::Ast;
@@ -10,13 +12,55 @@ namespace cish::vm
 
 DECLARE_EXCEPTION(CommandLineArgumentException)
 
+VmSnapshot::Ptr VirtualMachine::createSnapshot(const VmOptions &opts, Ast::Ptr ast)
+{
+    Memory memory(opts.heapSize, opts.minAllocSize);
+    Executor executor(&memory, ast);
+    executor.initialize();
+
+    return std::make_shared<VmSnapshot>(VmSnapshot {
+        ast,
+        memory.createSnapshot(),
+        executor.createSnapshot(),
+    });
+}
+
+VmSnapshot::Ptr VirtualMachine::loadCheckpoint(const std::string &path, Ast::Ptr ast)
+{
+    CheckpointReader reader(path, ast);
+
+    return std::make_shared<VmSnapshot>(VmSnapshot {
+        ast,
+        reader.getMemorySnapshot(),
+        reader.getContextSnapshot(),
+    });
+}
+
+void VirtualMachine::removeCheckpoint(const std::string &path)
+{
+    CheckpointWriter::removeCheckpoint(path);
+}
+
 VirtualMachine::VirtualMachine(const VmOptions &opts, Ast::Ptr ast):
     _memory(new Memory(opts.heapSize, opts.minAllocSize)),
     _executor(new Executor(_memory, ast)),
+    _allocationTrace(nullptr),
+    _checkpointWriter(nullptr),
     _started(false)
 {
-    auto args = prepareCliArguments(opts.args);
-    _executor->setCliArgs(args);
+    configure(opts, ast.get());
+}
+
+VirtualMachine::VirtualMachine(const VmOptions &opts, VmSnapshot::Ptr snapshot):
+    _memory(new Memory(*snapshot->memory)),
+    _executor(new Executor(_memory, snapshot->ast)),
+    _allocationTrace(nullptr),
+    _checkpointWriter(nullptr),
+    _started(false),
+    _snapshot(snapshot)
+{
+    _executor->initialize(snapshot->context);
+    configure(opts, snapshot->ast.get());
 }
 
 VirtualMachine::~VirtualMachine()
@@ -25,6 +69,12 @@ VirtualMachine::~VirtualMachine()
     _argvBuffer = nullptr;
 
     _executor->terminate();
+
+    // Whatever is released during teardown is not interesting to trace
+    _memory->setAllocationObserver(nullptr);
+    delete _allocationTrace;
+    delete _checkpointWriter;
+
     delete _executor;
     delete _memory;
 }
@@ -91,11 +141,47 @@ std::shared_ptr<Exception> VirtualMachine::getRuntimeError() const
     return _executor->getRuntimeError();
 }
 
+MemoryStats VirtualMachine::getMemoryStats() const
+{
+    return _memory->getStats();
+}
+
+LeakReport VirtualMachine::detectLeaks(bool reclaim)
+{
+    return LeakDetector(_executor).run(reclaim);
+}
+
+void VirtualMachine::requestCheckpoint()
+{
+    _executor->requestCheckpoint();
+}
+
 void VirtualMachine::terminate()
 {
     _executor->terminate();
 }
 
+void VirtualMachine::configure(const VmOptions &opts, const Ast *ast)
+{
+    _memory->setTimingEnabled(opts.timeAllocations);
+    _executor->setLeakCollectionEnabled(opts.collectLeaks);
+
+    if (!opts.allocationTraceFile.empty()) {
+        _allocationTrace = new AllocationTrace(opts.allocationTraceFile, _executor);
+        _memory->setAllocationObserver(_allocationTrace);
+    }
+
+    if (!opts.checkpointFile.empty()) {
+        _checkpointWriter = new CheckpointWriter(opts.checkpointFile, ast);
+        _executor->setCheckpointWriter(_checkpointWriter, std::chrono::seconds(opts.checkpointInterval));
+    }
+
+    if (!_executor->isResuming()) {
+        auto args = prepareCliArguments(opts.args);
+        _executor->setCliArgs(args);
+    }
+}
+
 std::vector<ast::ExpressionValue> VirtualMachine::prepareCliArguments(std::vector<std::string> args)
 {
     const Callable::Ptr main = _executor->getFunctionDefinition("main");
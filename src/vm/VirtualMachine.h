@@ -1,24 +1,33 @@
 #pragma once
 
 #include <stdint.h>
+#include "MemoryStats.h"
+#include "Memory.h"
+#include "ExecutionContext.h"
+#include "LeakDetector.h"
 #include "../ast/Ast.h"
 #include "../Exception.h"
 
 namespace cish::vm
 {
 
-class Memory;
 class Executor;
+class AllocationTrace;
+class CheckpointWriter;
 
 DECLARE_EXCEPTION(VmException);
 
 struct VmOptions
 {
     VmOptions() {
-        heapSize = 1 << 10;
+        heapSize = 1 << 28;
         minAllocSize = 4;
+        timeAllocations = false;
+        collectLeaks = false;
+        checkpointInterval = 60;
     }
-    // The total size of the memory in bytes
+    // The upper limit of the memory in bytes. The memory is reserved up
+    // front, but only committed as the program actually allocates it.
     uint32_t heapSize;
 
     // The smallest supported allocation unit, in bytes. Any allocation
@@ -26,14 +35,83 @@ struct VmOptions
     // of 'minAllocSize' bytes.
     uint32_t minAllocSize;
 
+    // Measure the time spent in allocate and free, see MemoryStats
+    bool timeAllocations;
+
+    // When set, every allocation and deallocation is logged to this
+    // file. See AllocationTrace for the format.
+    std::string allocationTraceFile;
+
+    // Periodically free malloc'ed blocks which are no longer reachable
+    // by the program. See LeakDetector.
+    bool collectLeaks;
+
+    // When set, the state of the program is written to this file every
+    // 'checkpointInterval' seconds while main is executing, so that it
+    // can be resumed with VirtualMachine::loadCheckpoint().
+    std::string checkpointFile;
+    uint32_t checkpointInterval;
+
     std::vector<std::string> args;
 };
 
 
+/**
+ * The state of a program after its global statements have executed,
+ * right before main is called, or at a statement inside main when read
+ * from a checkpoint. See VirtualMachine::createSnapshot() and
+ * VirtualMachine::loadCheckpoint().
+ */
+struct VmSnapshot
+{
+    typedef std::shared_ptr<const VmSnapshot> Ptr;
+
+    ast::Ast::Ptr ast;
+    Memory::Snapshot::Ptr memory;
+    ExecutionContext::Snapshot context;
+};
+
+
 class VirtualMachine
 {
 public:
+    /**
+     * Execute the global statements of 'ast' on the calling thread, and
+     * capture the state right before main would be called. Only the heap
+     * options are used.
+     *
+     * Files opened during initialization are re-opened by every VM forked
+     * off the snapshot, each with its own file position.
+     */
+    static VmSnapshot::Ptr createSnapshot(const VmOptions &opts, ast::Ast::Ptr ast);
+
+    /**
+     * Read the latest checkpoint from a file written by a VM running
+     * 'ast' with VmOptions::checkpointFile set. A VM created from the
+     * snapshot continues at the statement the checkpoint was taken at.
+     */
+    static VmSnapshot::Ptr loadCheckpoint(const std::string &path, ast::Ast::Ptr ast);
+
+    /**
+     * Remove a checkpoint file once the program it was taken of has
+     * finished, so that it is not resumed by a later run.
+     */
+    static void removeCheckpoint(const std::string &path);
+
     VirtualMachine(const VmOptions &opts, ast::Ast::Ptr ast);
+
+    /**
+     * Fork a VM off 'snapshot'. It starts executing at main, with the
+     * heap pages of the snapshot mapped copy-on-write, so pages are only
+     * copied once the VM writes to them. The heap options are taken from
+     * the snapshot, everything else from 'opts'.
+     *
+     * Any number of VMs may be forked off one snapshot and run in
+     * parallel. When the snapshot was loaded from a checkpoint, the
+     * command line arguments in 'opts' are ignored, as main has already
+     * received them.
+     */
+    VirtualMachine(const VmOptions &opts, VmSnapshot::Ptr snapshot);
     ~VirtualMachine();
 
     ExecutionContext* getExecutionContext() const;
@@ -55,6 +133,28 @@ public:
     int getExitCode() const;
     std::shared_ptr<Exception> getRuntimeError() const;
 
+    /**
+     * The counters are updated by the executing thread without any
+     * synchronization, so the numbers are only exact while the VM is
+     * paused or after it has terminated.
+     */
+    MemoryStats getMemoryStats() const;
+
+    /**
+     * Find malloc'ed blocks which can no longer be reached by the program.
+     * Must only be called while the VM is paused or after it has
+     * terminated. Leaks are only reclaimed if the VM is paused at a safe
+     * point, see LeakDetector.
+     */
+    LeakReport detectLeaks(bool reclaim = false);
+
+    /**
+     * Write a checkpoint as soon as the program reaches a statement it
+     * can be resumed at. Has no effect unless VmOptions::checkpointFile
+     * is set. Safe to call while the VM is running.
+     */
+    void requestCheckpoint();
+
     /**
      * Termniate the VM. This method will not return until the
      * associated background thread is joined, and will not have
@@ -65,12 +165,18 @@ public:
 private:
     Memory *_memory;
     Executor *_executor;
+    AllocationTrace *_allocationTrace;
+    CheckpointWriter *_checkpointWriter;
     bool _started;
 
     // We need to hold a reference to the allocated CLI parameters.
     Allocation::Ptr _argvBuffer;
     std::vector<Allocation::Ptr> _argvElements;
 
+    // Keeps the program of a forked VM alive
+    VmSnapshot::Ptr _snapshot;
+
+    void configure(const VmOptions &opts, const ast::Ast *ast);
     std::vector<ast::ExpressionValue> prepareCliArguments(std::vector<std::string> args);
 };
 
@@ -18,7 +18,7 @@ TEST(AddrofExpressionTest, verifyReturnValue)
     ExecutionContext ec(&memory);
 
     dc.declareVariable(TypeDecl::INT, "i");
-    ec.getScope()->addVariable("i", new Variable(TypeDecl::INT, memory.allocate(4)));
+    ec.getScope()->addVariable("i", TypeDecl::INT, memory.allocate(4));
 
     VariableReference::Ptr varRef = std::make_shared<VariableReference>(&dc, "i");
     
@@ -38,7 +38,7 @@ TEST(AddrofExpressionTest, addorfOfPointerEqualsPointerToPointer)
 
     TypeDecl type = TypeDecl::getPointer(TypeDecl::INT);
     dc.declareVariable(type, "ptr");
-    ec.getScope()->addVariable("ptr", new Variable(type, memory.allocate(4)));
+    ec.getScope()->addVariable("ptr", type, memory.allocate(4));
 
     VariableReference::Ptr varRef = std::make_shared<VariableReference>(&dc, "ptr");
 
@@ -19,3 +19,19 @@ TEST(AntlrContextTest, invalidSyntaxThrowsException)
         ASSERT_THROW(context.getParseTree(), SyntaxErrorException);
     }
 }
+
+TEST(AntlrContextTest, validSyntaxIsParsedWithoutFullContext)
+{
+    AntlrContext context("int main() { int a = 5; return a * 2; }");
+    ASSERT_FALSE(context.hasErrors());
+    ASSERT_FALSE(context.usedFullContext());
+    ASSERT_NE(nullptr, context.getParseTree());
+}
+
+TEST(AntlrContextTest, syntaxErrorsAreReportedByFullContextParse)
+{
+    AntlrContext context("int main() { int a = ; }");
+    ASSERT_TRUE(context.usedFullContext());
+    ASSERT_TRUE(context.hasErrors());
+    ASSERT_EQ(1, context.getErrors()[0].lineNumber);
+}
@@ -29,8 +29,7 @@ void create(LHS initialValue,
     dc.declareVariable(leftType, "var");
 
     Allocation::Ptr alloc = memory.allocate(leftType.getSize());
-    Variable *var = new Variable(leftType, std::move(alloc));
-    ec.getScope()->addVariable("var", var);
+    Variable *var = ec.getScope()->addVariable("var", leftType, std::move(alloc));
 
     // -- 
 
@@ -56,8 +55,7 @@ LHS exec(LHS initialValue,
     dc.declareVariable(leftType, "var");
 
     Allocation::Ptr alloc = memory.allocate(leftType.getSize());
-    Variable *var = new Variable(leftType, std::move(alloc));
-    ec.getScope()->addVariable("var", var);
+    Variable *var = ec.getScope()->addVariable("var", leftType, std::move(alloc));
 
     // -- 
 
@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+
+#include "ast/AstArena.h"
+#include "ast/LiteralExpression.h"
+#include "ast/AstNodes.h"
+#include "ast/IncrementalBuilder.h"
+#include "vm/VirtualMachine.h"
+#include "module/ModuleContext.h"
+#include "../TestHelpers.h"
+
+using namespace cish::ast;
+using namespace cish::vm;
+using namespace cish::module;
+
+
+TEST(AstArenaTest, allocationsAreAligned)
+{
+    AstArena arena;
+
+    for (size_t alignment: {1, 2, 4, 8, 16, 64}) {
+        arena.allocate(1, 1);
+        void *ptr = arena.allocate(24, alignment);
+        ASSERT_EQ(0, (uintptr_t)ptr % alignment);
+    }
+}
+
+TEST(AstArenaTest, consecutiveAllocationsAreAdjacent)
+{
+    AstArena arena;
+
+    uint8_t *a = (uint8_t*)arena.allocate(32, 8);
+    uint8_t *b = (uint8_t*)arena.allocate(32, 8);
+    ASSERT_EQ(a + 32, b);
+    ASSERT_EQ(64, arena.getBytesAllocated());
+}
+
+TEST(AstArenaTest, largeAllocationsDoNotDiscardTheCurrentChunk)
+{
+    AstArena arena;
+
+    uint8_t *a = (uint8_t*)arena.allocate(16, 8);
+    uint8_t *large = (uint8_t*)arena.allocate(1024 * 1024, 8);
+    uint8_t *b = (uint8_t*)arena.allocate(16, 8);
+
+    ASSERT_NE(nullptr, large);
+    ASSERT_EQ(a + 16, b);
+    large[1024 * 1024 - 1] = 0;
+}
+
+TEST(AstArenaTest, nodesOnlyPointToTheArena)
+{
+    AstArena::Ptr arena = AstArena::create();
+    Expression::Ptr expr = AstArena::create<LiteralExpression>(arena, 15);
+
+    ASSERT_EQ(sizeof(void*), sizeof(ArenaAllocator<LiteralExpression>));
+    ASSERT_EQ(1, arena.use_count());
+    ASSERT_EQ(15, expr->evaluate(nullptr).get<int>());
+}
+
+TEST(AstArenaTest, astOwnsTheArenasOfReusedFunctions)
+{
+    IncrementalBuilder builder(&ModuleContext::create);
+    Ast::Ptr first = builder.buildAst("int f() { return 2; } int main() { return f(); }");
+    Ast::Ptr second = builder.buildAst("int f() { return 2; } int main() { return f() + 1; }");
+
+    ASSERT_EQ(2, second->getArenas().size());
+    ASSERT_NE(first->getArena(), second->getArena());
+    ASSERT_EQ(first->getArenas()[1], second->getArenas()[1]);
+
+    first = nullptr;
+    VmOptions opts;
+    opts.heapSize = 512;
+    opts.minAllocSize = 4;
+    VirtualMachine vm(opts, second);
+    vm.startSync();
+    while (vm.isRunning()) {
+        vm.executeNextStatement();
+    }
+    ASSERT_EQ(3, vm.getExitCode());
+}
+
+TEST(AstArenaTest, parsedAstHasArena)
+{
+    Ast::Ptr ast = createAst("int a = 1; int main() { int b = a + 2; return b; }");
+
+    ASSERT_NE(nullptr, ast->getArena());
+    ASSERT_LT(0, ast->getArena()->getBytesAllocated());
+    ASSERT_LE(ast->getArena()->getBytesAllocated(), ast->getArena()->getBytesReserved());
+}
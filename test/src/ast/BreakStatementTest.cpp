@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+
+#include "ast/BreakStatement.h"
+#include "ast/WhileStatement.h"
+#include "ast/ReturnStatement.h"
+#include "ast/LiteralExpression.h"
+#include "ast/DeclarationContext.h"
+
+#include "vm/Memory.h"
+#include "vm/ExecutionContext.h"
+
+
+using namespace cish::vm;
+using namespace cish::ast;
+
+
+TEST(BreakStatementTest, breakAndContinueRequireLoop)
+{
+    DeclarationContext dc;
+    ASSERT_THROW(BreakStatement stmt(&dc), InvalidStatementException);
+    ASSERT_THROW(ContinueStatement stmt(&dc), InvalidStatementException);
+
+    dc.enterLoop();
+    ASSERT_NO_THROW(BreakStatement stmt(&dc));
+    ASSERT_NO_THROW(ContinueStatement stmt(&dc));
+    dc.exitLoop();
+
+    ASSERT_THROW(dc.exitLoop(), InvalidDeclarationScope);
+}
+
+TEST(BreakStatementTest, breakTerminatesLoop)
+{
+    Memory memory(100, 1);
+    ExecutionContext ec(&memory);
+    DeclarationContext dc;
+    ec.pushFunctionFrame();
+
+    dc.enterLoop();
+    auto cond = std::make_shared<LiteralExpression>(ExpressionValue(TypeDecl::BOOL, true));
+    WhileStatement loop(cond);
+    loop.addStatement(std::make_shared<BreakStatement>(&dc));
+    dc.exitLoop();
+
+    // The loop consumes the break, so the caller sees a normal completion
+    ASSERT_EQ(Completion::NORMAL, loop.execute(&ec));
+}
+
+TEST(BreakStatementTest, blocksStopAtFirstAbruptCompletion)
+{
+    Memory memory(100, 1);
+    ExecutionContext ec(&memory);
+    DeclarationContext dc;
+    ec.pushFunctionFrame();
+
+    dc.enterLoop();
+    SuperStatement super;
+    super.addStatement(std::make_shared<ContinueStatement>(&dc));
+    super.addStatement(std::make_shared<BreakStatement>(&dc));
+    dc.exitLoop();
+
+    ASSERT_EQ(Completion::CONTINUE, super.executeChildStatements(&ec));
+}
@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+
+#include "ast/DataSegment.h"
+#include "ast/AstNodes.h"
+
+#include <cstring>
+
+
+using namespace cish::ast;
+
+
+TEST(DataSegmentTest, stringsAreNulTerminated)
+{
+    StringTable table;
+    const StringId abc = table.insert("abc");
+    const StringId hello = table.insert("hello");
+
+    DataSegment segment;
+    segment.addStrings(&table);
+
+    ASSERT_EQ(10, segment.getSize());
+    ASSERT_STREQ("abc", (const char*)segment.getData() + segment.getStringOffset(abc));
+    ASSERT_STREQ("hello", (const char*)segment.getData() + segment.getStringOffset(hello));
+}
+
+TEST(DataSegmentTest, unknownStringsAreNotResolvable)
+{
+    DataSegment segment;
+    ASSERT_FALSE(segment.hasString(1));
+    ASSERT_ANY_THROW(segment.getStringOffset(1));
+}
+
+TEST(DataSegmentTest, objectsAreAlignedAndInitialized)
+{
+    DataSegment segment;
+
+    const uint32_t c = segment.addObject(TypeDecl::CHAR, ExpressionValue(TypeDecl::CHAR, 'x'));
+    const uint32_t i = segment.addObject(TypeDecl::INT, ExpressionValue(TypeDecl::INT, -5));
+    const uint32_t d = segment.addObject(TypeDecl::DOUBLE, ExpressionValue(TypeDecl::INT, 3));
+    const uint32_t z = segment.addObject(TypeDecl::LONG);
+
+    ASSERT_EQ(0, c);
+    ASSERT_EQ(4, i);
+    ASSERT_EQ(8, d);
+    ASSERT_EQ(16, z);
+    ASSERT_EQ(24, segment.getSize());
+
+    int32_t ival;
+    double dval;
+    int64_t lval;
+    memcpy(&ival, segment.getData() + i, sizeof(ival));
+    memcpy(&dval, segment.getData() + d, sizeof(dval));
+    memcpy(&lval, segment.getData() + z, sizeof(lval));
+
+    ASSERT_EQ('x', segment.getData()[c]);
+    ASSERT_EQ(-5, ival);
+    ASSERT_EQ(3.0, dval);
+    ASSERT_EQ(0, lval);
+}
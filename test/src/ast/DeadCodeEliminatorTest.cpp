@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+
+#include "ast/DeadCodeEliminator.h"
+#include "module/ModuleContext.h"
+#include "module/string/stringModule.h"
+#include "../TestHelpers.h"
+
+using namespace cish::ast;
+using namespace cish::module;
+
+
+static size_t countStrings(Ast::Ptr ast)
+{
+    return ast->getStringTable()->getMap().size();
+}
+
+TEST(DeadCodeEliminatorTest, unreachableFunctionsAreRemoved)
+{
+    Ast::Ptr ast = createAst(
+        "int leaf(int n) { return n + 1; }\n"
+        "int used(int n) { return leaf(n) * 2; }\n"
+        "int unused(int n) { return used(n); }\n"
+        "int alsoUnused() { return unused(1); }\n"
+        "int main() { return used(3); }\n"
+    );
+
+    ASSERT_NE(nullptr, ast->getFunctionDefinition("main"));
+    ASSERT_NE(nullptr, ast->getFunctionDefinition("used"));
+    ASSERT_NE(nullptr, ast->getFunctionDefinition("leaf"));
+    ASSERT_EQ(nullptr, ast->getFunctionDefinition("unused"));
+    ASSERT_EQ(nullptr, ast->getFunctionDefinition("alsoUnused"));
+    ASSERT_EQ(nullptr, ast->getFunctionDefinition(Symbol::intern("unused")));
+    ASSERT_EQ(3, ast->getFunctionDefinitions().size());
+}
+
+TEST(DeadCodeEliminatorTest, unusedModuleFunctionsAreRemoved)
+{
+    ModuleContext::Ptr moduleContext = ModuleContext::create();
+    moduleContext->addModule(string::buildModule());
+
+    Ast::Ptr ast = createAst(std::move(moduleContext),
+        "#include <string.h>\n"
+        "int main() { return strlen(\"abc\"); }\n"
+    );
+
+    ASSERT_NE(nullptr, ast->getFunctionDefinition("strlen"));
+    ASSERT_EQ(nullptr, ast->getFunctionDefinition("strcpy"));
+    ASSERT_EQ(2, ast->getFunctionDefinitions().size());
+}
+
+TEST(DeadCodeEliminatorTest, stringsOfRemovedFunctionsAreRemoved)
+{
+    const std::string source =
+        "const char *global = \"global\";\n"
+        "char unused() { const char *a = \"shared\"; const char *b = \"only unused\"; return a[0] + b[0]; }\n"
+        "int main() { const char *s = \"shared\"; return s[1] - global[0]; }\n";
+
+    Ast::Ptr ast = createAst(source);
+
+    ASSERT_EQ(2, countStrings(ast));
+    ASSERT_EQ(sizeof("global") + sizeof("shared"), ast->getDataSegment()->getSize());
+    assertExitCode(source, 'h' - 'g');
+}
+
+TEST(DeadCodeEliminatorTest, unusedStructsAreRemoved)
+{
+    Ast::Ptr ast = createAst(
+        "struct inner { int n; };\n"
+        "struct outer { struct inner *inner; };\n"
+        "struct unused { int n; };\n"
+        "struct onlyInUnused { int n; };\n"
+        "int unused() { struct onlyInUnused s; s.n = 1; return s.n; }\n"
+        "int main() { struct outer o; return sizeof(struct unused); }\n"
+    );
+
+    ASSERT_NE(nullptr, ast->getStructLayout("outer"));
+    ASSERT_NE(nullptr, ast->getStructLayout("inner"));
+    ASSERT_EQ(nullptr, ast->getStructLayout("unused"));
+    ASSERT_EQ(nullptr, ast->getStructLayout("onlyInUnused"));
+}
+
+TEST(DeadCodeEliminatorTest, astWithoutMainIsLeftAlone)
+{
+    Ast::Ptr ast = createAst(
+        "struct point { int x; };\n"
+        "int f() { const char *s = \"str\"; return s[0]; }\n"
+        "int g() { return 2; }\n"
+    );
+
+    ASSERT_EQ(2, ast->getFunctionDefinitions().size());
+    ASSERT_NE(nullptr, ast->getStructLayout("point"));
+    ASSERT_EQ(1, countStrings(ast));
+}
+
+TEST(DeadCodeEliminatorTest, removedCountsAreReported)
+{
+    ParseContext::Ptr parseContext = ParseContext::parseSource(
+        "struct unused { int n; };\n"
+        "int unused() { const char *s = \"str\"; return s[0]; }\n"
+        "int main() { return 0; }\n"
+    );
+
+    Ast::Ptr ast = parseContext->buildAst(ModuleContext::create());
+
+    DeadCodeEliminator eliminator(ast.get());
+    eliminator.run();
+
+    ASSERT_EQ(1, eliminator.getRemovedFunctionCount());
+    ASSERT_EQ(1, eliminator.getRemovedStructCount());
+    ASSERT_EQ(1, eliminator.getRemovedStringCount());
+    ASSERT_EQ(0, ast->getDataSegment()->getSize());
+}
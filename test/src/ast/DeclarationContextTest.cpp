@@ -211,3 +211,46 @@ TEST(DeclarationContextTest, functionRootVariablesAreNotGloballyDeclared)
     ASSERT_EQ(nullptr, context.getVariableDeclaration("var"));
 }
 
+
+TEST(DeclarationContextTest, currentScopeHasDeclarationsOnlyConsidersInnermostScope)
+{
+    DeclarationContext context;
+    auto func = std::make_shared<FunctionDefinition>(&context, FuncDeclaration(TypeDecl::INT, "foo"));
+    context.enterFunction(func);
+
+    context.declareVariable(TypeDecl::INT, "outer");
+    ASSERT_TRUE(context.currentScopeHasDeclarations());
+
+    context.pushVariableScope();
+    ASSERT_FALSE(context.currentScopeHasDeclarations());
+
+    context.declareVariable(TypeDecl::INT, "inner");
+    ASSERT_TRUE(context.currentScopeHasDeclarations());
+
+    context.popVariableScope();
+    context.exitFunction();
+}
+
+TEST(DeclarationContextTest, laterRootDeclarationsCanBeHidden)
+{
+    DeclarationContext context;
+    context.declareVariable(TypeDecl::INT, "first");
+    auto func = std::make_shared<FunctionDefinition>(&context, FuncDeclaration(TypeDecl::INT, "foo"));
+
+    const uint32_t count = context.getRootDeclarationCount();
+    ASSERT_EQ(2, count);
+
+    context.declareVariable(TypeDecl::INT, "second");
+    context.declareFunction(FuncDeclaration(TypeDecl::INT, "bar"));
+    context.setVisibleRootDeclarations(count);
+
+    ASSERT_NE(nullptr, context.getVariableDeclaration("first"));
+    ASSERT_NE(nullptr, context.getFunctionDeclaration("foo"));
+    ASSERT_EQ(nullptr, context.getVariableDeclaration("second"));
+    ASSERT_EQ(nullptr, context.getFunctionDeclaration("bar"));
+
+    context.enterFunction(func);
+    context.declareVariable(TypeDecl::INT, "local");
+    ASSERT_NE(nullptr, context.getVariableDeclaration("local"));
+    context.exitFunction();
+}
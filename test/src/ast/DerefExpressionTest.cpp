@@ -23,9 +23,8 @@ TEST(DereferenceExpressionTest, simpleDereference)
     TypeDecl type = TypeDecl::getPointer(TypeDecl::INT);
     dc.declareVariable(type, "ptr");
 
-    Variable *var = new Variable(type, memory.allocate(4));
+    Variable *var = ec.getScope()->addVariable("ptr", type, memory.allocate(4));
     var->getAllocation()->write<int>(15);
-    ec.getScope()->addVariable("ptr", var);
 
     ExpressionValue exprVal(type, var->getAllocation()->getAddress());
     auto literal = std::make_shared<LiteralExpression>(exprVal);
@@ -47,9 +46,8 @@ TEST(DereferenceExpressionTest, testWithIncrementalOperand)
     Variable *rawVal = new Variable(TypeDecl::INT, memory.allocate(4));
     rawVal->getAllocation()->write<int>(15);
 
-    Variable *ptrVar = new Variable(type, memory.allocate(4));
+    Variable *ptrVar = ec.getScope()->addVariable("ptr", type, memory.allocate(4));
     ptrVar->getAllocation()->write<int>(rawVal->getAllocation()->getAddress());
-    ec.getScope()->addVariable("ptr", ptrVar);
 
     auto lvalue = std::make_shared<VariableReference>(&dc, "ptr");
     auto inc = std::make_shared<IncDecExpression>(IncDecExpression::POSTFIX_INCREMENT, lvalue);
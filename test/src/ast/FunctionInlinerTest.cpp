@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+
+#include "ast/FunctionInliner.h"
+#include "module/ModuleContext.h"
+#include "../TestHelpers.h"
+
+using namespace cish::ast;
+using namespace cish::module;
+
+
+static uint32_t countInlinedCalls(const std::string &source)
+{
+    ParseContext::Ptr parseContext = ParseContext::parseSource(source);
+    Ast::Ptr ast = parseContext->buildAst(ModuleContext::create());
+
+    FunctionInliner inliner(ast.get());
+    inliner.run();
+    return inliner.getInlinedCallCount();
+}
+
+TEST(FunctionInlinerTest, leafHelpersAreInlined)
+{
+    const std::string source =
+        "int isMatch(int n) { return n % 3 == 0 || n % 5 == 0; }\n"
+        "int main() {\n"
+        "    int sum = 0;\n"
+        "    for (int i=3; i<20; i++) {\n"
+        "        if (isMatch(i)) sum = sum + i;\n"
+        "    }\n"
+        "    return sum + isMatch(1);\n"
+        "}\n";
+
+    ASSERT_EQ(2, countInlinedCalls(source));
+    assertExitCode(source, 78);
+}
+
+TEST(FunctionInlinerTest, functionsWhichCallAreNotInlined)
+{
+    ASSERT_EQ(1, countInlinedCalls(
+        "int leaf(int n) { return n + 1; }\n"
+        "int caller(int n) { return leaf(n) * 2; }\n"
+        "int forever(int n) { return forever(n + 1); }\n"
+        "int main() { return caller(3) + forever(0); }\n"
+    ));
+}
+
+TEST(FunctionInlinerTest, largeOrStatementBodiesAreNotInlined)
+{
+    ASSERT_EQ(0, countInlinedCalls(
+        "int big(int a, int b) { return a*b + a*b + a*b + a*b + a*b + a*b + a*b + a*b; }\n"
+        "int body(int n) { int m = n; return m; }\n"
+        "int main() { return big(1, 2) + body(3); }\n"
+    ));
+}
+
+TEST(FunctionInlinerTest, structsByValueAreNotInlined)
+{
+    ASSERT_EQ(1, countInlinedCalls(
+        "struct point { int x; int y; };\n"
+        "int byValue(struct point p) { return p.x; }\n"
+        "int byPointer(struct point *p) { return p->x; }\n"
+        "int main() { struct point p; p.x = 1; return byValue(p) + byPointer(&p); }\n"
+    ));
+}
+
+TEST(FunctionInlinerTest, parametersAreFreshLocals)
+{
+    assertExitCode(
+        "int inc(int n) { return ++n; }\n"
+        "int main() { int a = 1; int b = inc(a); return a * 10 + b; }\n",
+        12
+    );
+}
+
+TEST(FunctionInlinerTest, callerLocalsAreNotVisible)
+{
+    assertExitCode(
+        "int k = 10;\n"
+        "int addK(int n) { return n + k; }\n"
+        "int main() { int k = 1; int n = 5; return addK(2) + k; }\n",
+        13
+    );
+}
+
+TEST(FunctionInlinerTest, argumentsAreEvaluatedInTheCallersScope)
+{
+    assertExitCode(
+        "int twice(int n) { return n * 2; }\n"
+        "int main() { int n = 4; return twice(n + 1); }\n",
+        10
+    );
+}
+
+TEST(FunctionInlinerTest, globalInitializersCallTheFunction)
+{
+    assertExitCode(
+        "char first(const char *s) { return s[0]; }\n"
+        "char c = first(\"abc\");\n"
+        "int main() { return c - first(\"`\"); }\n",
+        1
+    );
+}
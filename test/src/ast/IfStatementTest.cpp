@@ -3,6 +3,11 @@
 #include "ast/IfStatement.h"
 #include "ast/LiteralExpression.h"
 #include "ast/ExpressionValue.h"
+#include "ast/VariableDeclarationStatement.h"
+#include "ast/DeclarationContext.h"
+
+#include "vm/Memory.h"
+#include "vm/ExecutionContext.h"
 
 
 using namespace cish::vm;
@@ -15,3 +20,25 @@ TEST(IfStatementTest, expressionMustBeConvertibleToBool)
     auto expr = std::make_shared<LiteralExpression>(value);
     ASSERT_THROW(IfStatement stmt(expr, nullptr), InvalidCastException);
 }
+
+TEST(IfStatementTest, scopeIsOnlyPushedWhenRequired)
+{
+    Memory memory(100, 1);
+    ExecutionContext ec(&memory);
+    DeclarationContext dc;
+    ec.pushFunctionFrame();
+
+    auto cond = std::make_shared<LiteralExpression>(ExpressionValue(TypeDecl::BOOL, true));
+    auto decl = std::make_shared<VariableDeclarationStatement>(&dc, TypeDecl::INT, "var", nullptr);
+
+    IfStatement scoped(cond, nullptr);
+    scoped.addStatement(decl);
+    scoped.execute(&ec);
+    ASSERT_EQ(nullptr, ec.getScope()->getVariable("var"));
+
+    IfStatement unscoped(cond, nullptr);
+    unscoped.addStatement(decl);
+    unscoped.setRequiresScope(false);
+    unscoped.execute(&ec);
+    ASSERT_NE(nullptr, ec.getScope()->getVariable("var"));
+}
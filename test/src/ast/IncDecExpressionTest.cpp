@@ -47,11 +47,10 @@ TEST(IncDecExpressionTest, verifyOperationsOnPointers)
 			DeclarationContext dc;
 			ExecutionContext ec(&memory);
 
-			Variable *var = new Variable(type, memory.allocate(type.getSize()));
+			Variable *var = ec.getScope()->addVariable("i", type, memory.allocate(type.getSize()));
 			var->getAllocation()->write<int>(10);
 
 			dc.declareVariable(type, "i");
-			ec.getScope()->addVariable("i", var);
 
             auto lvalue = std::make_shared<VariableReference>(&dc, "i");
 			IncDecExpression expr(pair.first, lvalue);
@@ -90,11 +89,10 @@ TEST(IncDecExpressionTest, verifyOperationsOnPrimitives)
 			DeclarationContext dc;
 			ExecutionContext ec(&memory);
 
-			Variable *var = new Variable(type, memory.allocate(type.getSize()));
+			Variable *var = ec.getScope()->addVariable("i", type, memory.allocate(type.getSize()));
 			var->getAllocation()->write<uint8_t>(10);
 
 			dc.declareVariable(type, "i");
-			ec.getScope()->addVariable("i", var);
 
             auto lvalue = std::make_shared<VariableReference>(&dc, "i");
 			IncDecExpression expr(pair.first, lvalue);
@@ -111,11 +109,10 @@ TEST(IncDecExpressionTest, charOverflow)
     DeclarationContext dc;
     ExecutionContext ec(&memory);
 
-    Variable *var = new Variable(TypeDecl::CHAR, memory.allocate(1));
+    Variable *var = ec.getScope()->addVariable("i", TypeDecl::CHAR, memory.allocate(1));
     var->getAllocation()->write<uint8_t>(127);
 
     dc.declareVariable(TypeDecl::CHAR, "i");
-    ec.getScope()->addVariable("i", var);
 
     auto lvalue = std::make_shared<VariableReference>(&dc, "i");
     IncDecExpression expr(IncDecExpression::POSTFIX_INCREMENT, lvalue);
@@ -131,11 +128,10 @@ TEST(IncDecExpressionTest, charUnderflow)
     DeclarationContext dc;
     ExecutionContext ec(&memory);
 
-    Variable *var = new Variable(TypeDecl::CHAR, memory.allocate(1));
+    Variable *var = ec.getScope()->addVariable("i", TypeDecl::CHAR, memory.allocate(1));
     var->getAllocation()->write<char>(-128);
 
     dc.declareVariable(TypeDecl::CHAR, "i");
-    ec.getScope()->addVariable("i", var);
 
     auto lvalue = std::make_shared<VariableReference>(&dc, "i");
     IncDecExpression expr(IncDecExpression::POSTFIX_DECREMENT, lvalue);
@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+
+#include "ast/IncrementalBuilder.h"
+#include "vm/VirtualMachine.h"
+#include "module/ModuleContext.h"
+
+using namespace cish::vm;
+using namespace cish::ast;
+using namespace cish::module;
+
+
+static int runAst(Ast::Ptr ast)
+{
+    VmOptions opts;
+    opts.heapSize = 512;
+    opts.minAllocSize = 4;
+
+    VirtualMachine vm(opts, ast);
+    vm.startSync();
+    while (vm.isRunning()) {
+        vm.executeNextStatement();
+    }
+
+    return vm.getExitCode();
+}
+
+static const std::string PROGRAM =
+    "struct point { int x; int y; };\n"
+    "int scale = 2;\n"
+    "int sum(struct point *p) { return p->x + p->y; }\n"
+    "char second(const char *s) { return s[1]; }\n"
+    "int main() {\n"
+    "    struct point p; p.x = 3; p.y = 4;\n"
+    "    return sum(&p) * scale + (second(\"abc\") == 'b');\n"
+    "}\n";
+
+
+TEST(IncrementalBuilderTest, firstBuildBuildsEverything)
+{
+    IncrementalBuilder builder(&ModuleContext::create);
+    Ast::Ptr ast = builder.buildAst(PROGRAM);
+
+    ASSERT_EQ(3, builder.getBuiltFunctionCount());
+    ASSERT_EQ(0, builder.getReusedFunctionCount());
+    ASSERT_EQ(15, runAst(ast));
+}
+
+TEST(IncrementalBuilderTest, unchangedFunctionsAreReused)
+{
+    IncrementalBuilder builder(&ModuleContext::create);
+    Ast::Ptr first = builder.buildAst(PROGRAM);
+    Ast::Ptr second = builder.buildAst(PROGRAM);
+
+    ASSERT_EQ(0, builder.getBuiltFunctionCount());
+    ASSERT_EQ(3, builder.getReusedFunctionCount());
+    ASSERT_EQ(first->getFunctionDefinition("sum"), second->getFunctionDefinition("sum"));
+    ASSERT_EQ(first->getStructLayout("point"), second->getStructLayout("point"));
+
+    first = nullptr;
+    ASSERT_EQ(15, runAst(second));
+}
+
+TEST(IncrementalBuilderTest, changedFunctionIsRebuilt)
+{
+    IncrementalBuilder builder(&ModuleContext::create);
+    Ast::Ptr first = builder.buildAst(PROGRAM);
+
+    std::string source = PROGRAM;
+    source.replace(source.find("p->x + p->y"), 11, "p->x - p->y");
+    Ast::Ptr second = builder.buildAst(source);
+
+    ASSERT_EQ(1, builder.getBuiltFunctionCount());
+    ASSERT_EQ(2, builder.getReusedFunctionCount());
+    ASSERT_NE(first->getFunctionDefinition("sum"), second->getFunctionDefinition("sum"));
+    ASSERT_EQ(first->getFunctionDefinition("second"), second->getFunctionDefinition("second"));
+    ASSERT_EQ(-1, runAst(second));
+}
+
+TEST(IncrementalBuilderTest, changedDeclarationRebuildsFollowingFunctions)
+{
+    IncrementalBuilder builder(&ModuleContext::create);
+    builder.buildAst(PROGRAM);
+
+    std::string source = PROGRAM;
+    source.replace(source.find("int scale = 2;"), 14, "int scale = 3;");
+    Ast::Ptr ast = builder.buildAst(source);
+
+    ASSERT_EQ(3, builder.getBuiltFunctionCount());
+    ASSERT_EQ(0, builder.getReusedFunctionCount());
+    ASSERT_EQ(22, runAst(ast));
+}
+
+TEST(IncrementalBuilderTest, newStringsDoNotMoveReusedStrings)
+{
+    IncrementalBuilder builder(&ModuleContext::create);
+    builder.buildAst(PROGRAM);
+
+    std::string source = PROGRAM;
+    source.insert(source.find("(second("), "(second(\"xyz\") == 'y') + ");
+    Ast::Ptr ast = builder.buildAst(source);
+
+    ASSERT_EQ(1, builder.getBuiltFunctionCount());
+    ASSERT_EQ(16, runAst(ast));
+}
+
+TEST(IncrementalBuilderTest, failedBuildKeepsPreviousBuild)
+{
+    IncrementalBuilder builder(&ModuleContext::create);
+    builder.buildAst(PROGRAM);
+
+    ASSERT_THROW(builder.buildAst("int main() { return 0; "), SyntaxErrorException);
+    ASSERT_THROW(builder.buildAst("int main() { return undeclared; }"), cish::Exception);
+
+    Ast::Ptr ast = builder.buildAst(PROGRAM);
+    ASSERT_EQ(3, builder.getReusedFunctionCount());
+    ASSERT_EQ(15, runAst(ast));
+}
+
+TEST(IncrementalBuilderTest, memoryIsBoundedOverManyEdits)
+{
+    IncrementalBuilder builder(&ModuleContext::create);
+    builder.buildAst(PROGRAM);
+    const size_t firstArenaBytes = builder.getCachedArenaBytes();
+    const size_t firstStringCount = builder.getCachedStringCount();
+
+    for (int i=0; i<1000; i++) {
+        std::string source = PROGRAM;
+        source.replace(source.find("\"abc\""), 5, "\"x" + std::to_string(i) + "\"");
+        Ast::Ptr ast = builder.buildAst(source);
+
+        ASSERT_LE(builder.getCachedArenaBytes(), 3 * firstArenaBytes);
+        ASSERT_EQ(firstStringCount, builder.getCachedStringCount());
+        ASSERT_EQ(2, ast->getArenas().size());
+        if (i % 100 == 0) {
+            ASSERT_EQ(14, runAst(ast));
+        }
+    }
+}
@@ -0,0 +1,192 @@
+#include <gtest/gtest.h>
+
+#include "ast/NativeContext.h"
+#include "ast/AstBuilder.h"
+#include "ast/VariableDeclarationStatement.h"
+#include "ast/FunctionDefinition.h"
+#include "module/ModuleContext.h"
+
+using namespace cish::ast;
+using namespace cish::module;
+
+
+static Ast::Ptr buildNativeAst(const std::string &source)
+{
+    ParseContext::Ptr parseContext = ParseContext::parseSource(source, ParseContext::Frontend::NATIVE);
+    AstBuilder builder(parseContext, ModuleContext::create());
+    return builder.buildAst();
+}
+
+TEST(NativeContextTest, invalidSyntaxThrowsException)
+{
+    std::vector<std::string> invalidSyntax = {
+        "int a = ;",
+        "int b",
+        "hei mamma",
+        "int a (= 5);",
+        "int main() { return 0; ",
+        "int main() { if (1 { } return 0; }",
+    };
+
+    for (auto source : invalidSyntax) {
+        NativeContext context(source);
+        ASSERT_FALSE(context.hasErrors());
+        ASSERT_THROW(context.buildAst(ModuleContext::create()), SyntaxErrorException);
+        ASSERT_EQ(1, context.getErrors().size());
+    }
+}
+
+TEST(NativeContextTest, syntaxErrorHasLineAndChar)
+{
+    NativeContext context("int main()\n{\n    int a = ;\n}");
+
+    try {
+        context.buildAst(ModuleContext::create());
+        FAIL() << "Expected SyntaxErrorException";
+    } catch (SyntaxErrorException &e) {
+        // Expected
+    }
+
+    auto errors = context.getErrors();
+    ASSERT_EQ(1, errors.size());
+    ASSERT_EQ(3, errors[0].lineNumber);
+    ASSERT_EQ(12, errors[0].charNumber);
+    ASSERT_NE(std::string::npos, errors[0].message.find("';'"));
+}
+
+TEST(NativeContextTest, everySyntaxErrorIsReported)
+{
+    NativeContext context(
+        "int a = ;\n"
+        "int main() {\n"
+        "    int b = 1;\n"
+        "    if (b { b = 2; }\n"
+        "    for (int i=0; i<3; i++) { b += ; }\n"
+        "    return b;\n"
+        "}\n"
+        "int c = 3;\n");
+
+    ASSERT_THROW(context.buildAst(ModuleContext::create()), SyntaxErrorException);
+
+    auto errors = context.getErrors();
+    ASSERT_EQ(3, errors.size());
+    ASSERT_EQ(1, errors[0].lineNumber);
+    ASSERT_EQ(4, errors[1].lineNumber);
+    ASSERT_EQ(5, errors[2].lineNumber);
+}
+
+TEST(NativeContextTest, syntaxErrorsAreReportedBeforeSemanticErrors)
+{
+    NativeContext context(
+        "int main() {\n"
+        "    return undeclared;\n"
+        "}\n"
+        "int f() { int x = ; }\n");
+
+    ASSERT_THROW(context.buildAst(ModuleContext::create()), SyntaxErrorException);
+    ASSERT_EQ(1, context.getErrors().size());
+    ASSERT_EQ(4, context.getErrors()[0].lineNumber);
+}
+
+TEST(NativeContextTest, unknownCharactersAreLexicalErrors)
+{
+    NativeContext context("int a = 5 @ 3;\nint b = $;");
+    ASSERT_TRUE(context.hasErrors());
+
+    auto errors = context.getErrors();
+    ASSERT_EQ(2, errors.size());
+    ASSERT_EQ(1, errors[0].lineNumber);
+    ASSERT_EQ(10, errors[0].charNumber);
+    ASSERT_EQ(2, errors[1].lineNumber);
+    ASSERT_EQ(8, errors[1].charNumber);
+
+    AstBuilder builder(std::make_shared<NativeContext>("int a = 5 @ 3;"), ModuleContext::create());
+    ASSERT_THROW(builder.buildAst(), SyntaxErrorException);
+}
+
+TEST(NativeContextTest, commentsAreSkipped)
+{
+    Ast::Ptr ast = buildNativeAst(
+        "// int x = 1;\n"
+        "int a = 15; /* int y = 2; */\n"
+        "/* multi\n line */ int b = a;\n"
+    );
+
+    auto statements = ast->getRootStatements();
+    ASSERT_EQ(2, statements.size());
+    ASSERT_NE(nullptr, dynamic_cast<const VariableDeclarationStatement*>(statements[0].get()));
+    ASSERT_NE(nullptr, dynamic_cast<const VariableDeclarationStatement*>(statements[1].get()));
+}
+
+TEST(NativeContextTest, functionsAreDefined)
+{
+    Ast::Ptr ast = buildNativeAst(
+        "int square(int n);\n"
+        "int main() { return square(4); }\n"
+        "int square(int n) { return n * n; }\n"
+    );
+
+    ASSERT_NE(nullptr, ast->getFunctionDefinition("main"));
+    ASSERT_NE(nullptr, ast->getFunctionDefinition("square"));
+}
+
+TEST(NativeContextTest, semanticErrorsAreThrown)
+{
+    ASSERT_THROW(buildNativeAst("int main() { return undeclared; }"), cish::Exception);
+    ASSERT_THROW(buildNativeAst("int foo(); int main() { return foo(); }"), FunctionNotDefinedException);
+}
+
+static std::string generateProgram(int numFunctions)
+{
+    std::string source = "int counter = 0;\n";
+    for (int i=0; i<numFunctions; i++) {
+        const std::string n = std::to_string(i);
+        source += "int f" + n + "(int a) {\n"
+                  "    const char *s = \"str" + std::to_string(i % 7) + "\";\n"
+                  "    int sum = 0;\n"
+                  "    for (int i = 0; i < a; i++) { if (i % 2 == 0) { sum += i * " + n + "; } else { sum -= s[0]; } }\n"
+                  "    counter++;\n"
+                  "    return sum;\n"
+                  "}\n";
+    }
+    return source;
+}
+
+TEST(NativeContextTest, parallelBuildMatchesSequentialBuild)
+{
+    const std::string source = generateProgram(500);
+
+    NativeContext sequential(source, 1);
+    NativeContext parallel(source, 4);
+
+    Ast::Ptr expected = sequential.buildAst(ModuleContext::create());
+    Ast::Ptr ast = parallel.buildAst(ModuleContext::create());
+
+    ASSERT_EQ(expected->getFunctionDefinitions().size(), ast->getFunctionDefinitions().size());
+    ASSERT_EQ(expected->getStringTable()->getMap(), ast->getStringTable()->getMap());
+
+    auto funcDef = std::dynamic_pointer_cast<FunctionDefinition>(ast->getFunctionDefinition("f499"));
+    ASSERT_NE(nullptr, funcDef);
+    ASSERT_EQ(5, funcDef->getStatements().size());
+}
+
+TEST(NativeContextTest, parallelBuildReportsSameErrors)
+{
+    std::string source = generateProgram(500);
+    source.replace(source.find("int f10("), 0, "int broken() { int x = ; }\n");
+    source.replace(source.find("int f400("), 0, "int alsoBroken() { return missing; }\n");
+
+    NativeContext context(source, 4);
+    ASSERT_THROW(context.buildAst(ModuleContext::create()), SyntaxErrorException);
+    ASSERT_EQ(1, context.getErrors().size());
+}
+
+TEST(NativeContextTest, parallelBuildHidesLaterDeclarations)
+{
+    std::string source = generateProgram(500);
+    source += "int late = 1;\n";
+    source.replace(source.find("int f10("), 0, "int early() { return late; }\n");
+
+    NativeContext context(source, 4);
+    ASSERT_THROW(context.buildAst(ModuleContext::create()), cish::Exception);
+}
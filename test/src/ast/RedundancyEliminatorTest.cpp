@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+
+#include "ast/RedundancyEliminator.h"
+#include "module/ModuleContext.h"
+#include "module/stdlib/stdlibModule.h"
+#include "module/string/stringModule.h"
+#include "../TestHelpers.h"
+
+using namespace cish::ast;
+using namespace cish::module;
+
+
+static ModuleContext::Ptr createModuleContext()
+{
+    ModuleContext::Ptr moduleContext = ModuleContext::create();
+    moduleContext->addModule(stdlib::buildModule());
+    moduleContext->addModule(string::buildModule());
+    return moduleContext;
+}
+
+static std::shared_ptr<RedundancyEliminator> eliminate(const std::string &source)
+{
+    ParseContext::Ptr parseContext = ParseContext::parseSource(source);
+    Ast::Ptr ast = parseContext->buildAst(createModuleContext());
+
+    auto eliminator = std::make_shared<RedundancyEliminator>(ast.get());
+    eliminator->run();
+    return eliminator;
+}
+
+static void assertResult(const std::string &source, int expectedExitCode)
+{
+    assertExitCode(createModuleContext(), source, expectedExitCode);
+}
+
+TEST(RedundancyEliminatorTest, pureCallsInLoopConditionsAreHoisted)
+{
+    const std::string source =
+        "#include <string.h>\n"
+        "int main() {\n"
+        "    const char *s = \"a cat sat\";\n"
+        "    int spaces = 0;\n"
+        "    for (int i=0; i<strlen(s); i++) {\n"
+        "        if (s[i] == ' ') spaces++;\n"
+        "    }\n"
+        "    return spaces;\n"
+        "}\n";
+
+    ASSERT_EQ(1, eliminate(source)->getHoistedExpressionCount());
+    assertResult(source, 2);
+}
+
+TEST(RedundancyEliminatorTest, memoryWritesPreventHoistingReads)
+{
+    const std::string source =
+        "#include <stdlib.h>\n"
+        "#include <string.h>\n"
+        "int main() {\n"
+        "    char *s = malloc(7);\n"
+        "    strcpy(s, \"abcdef\");\n"
+        "    int i = 0;\n"
+        "    while (i < strlen(s)) {\n"
+        "        if (s[i] == 'c') s[i] = 0;\n"
+        "        i++;\n"
+        "    }\n"
+        "    return i;\n"
+        "}\n";
+
+    ASSERT_EQ(0, eliminate(source)->getHoistedExpressionCount());
+    assertResult(source, 3);
+}
+
+TEST(RedundancyEliminatorTest, callsToProgramFunctionsPreventHoistingReads)
+{
+    const std::string source =
+        "struct counter { int n; };\n"
+        "void bump(struct counter *c) { c->n = c->n + 1; }\n"
+        "int main() {\n"
+        "    struct counter c; c.n = 0;\n"
+        "    struct counter *p = &c;\n"
+        "    int seen = 0;\n"
+        "    for (int i=0; i<3; i++) { bump(p); seen = seen + p->n; }\n"
+        "    return seen;\n"
+        "}\n";
+
+    ASSERT_EQ(0, eliminate(source)->getHoistedExpressionCount());
+    assertResult(source, 6);
+}
+
+TEST(RedundancyEliminatorTest, assignedVariablesAreNotInvariant)
+{
+    const std::string source =
+        "struct node { int value; struct node *next; };\n"
+        "int main() {\n"
+        "    struct node a; struct node b;\n"
+        "    a.value = 1; a.next = &b; b.value = 2; b.next = 0;\n"
+        "    struct node *p = &a;\n"
+        "    int sum = 0;\n"
+        "    while (p) { sum = sum + p->value; p = p->next; }\n"
+        "    return sum;\n"
+        "}\n";
+
+    ASSERT_EQ(0, eliminate(source)->getHoistedExpressionCount());
+    assertResult(source, 3);
+}
+
+TEST(RedundancyEliminatorTest, invariantsAreReevaluatedOnEveryLoopEntry)
+{
+    const std::string source =
+        "#include <string.h>\n"
+        "int main() {\n"
+        "    const char *s = \"ab\";\n"
+        "    int total = 0;\n"
+        "    for (int k=0; k<2; k++) {\n"
+        "        for (int i=0; i<strlen(s); i++) total++;\n"
+        "        s = \"hello\";\n"
+        "    }\n"
+        "    return total;\n"
+        "}\n";
+
+    ASSERT_EQ(1, eliminate(source)->getHoistedExpressionCount());
+    assertResult(source, 7);
+}
+
+TEST(RedundancyEliminatorTest, commonSubexpressionsAreEvaluatedOnce)
+{
+    const std::string source =
+        "struct point { int x; int y; };\n"
+        "int main() {\n"
+        "    struct point pt; pt.x = 3; pt.y = 4;\n"
+        "    struct point *p = &pt;\n"
+        "    int d = p->x * p->x + p->y * p->y;\n"
+        "    if (p->x == 3 && p->x != p->y) d = d + 1;\n"
+        "    return d;\n"
+        "}\n";
+
+    ASSERT_EQ(3, eliminate(source)->getCommonSubexpressionCount());
+    assertResult(source, 26);
+}
+
+TEST(RedundancyEliminatorTest, sideEffectsPreventCommonSubexpressions)
+{
+    const std::string source =
+        "int next(int *i) { *i = *i + 1; return 0; }\n"
+        "int main() {\n"
+        "    int i = 0;\n"
+        "    int *p = &i;\n"
+        "    int n = *p + next(p) + *p;\n"
+        "    return n;\n"
+        "}\n";
+
+    ASSERT_EQ(0, eliminate(source)->getCommonSubexpressionCount());
+    assertResult(source, 1);
+}
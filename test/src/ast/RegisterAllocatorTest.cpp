@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+
+#include "ast/RegisterAllocator.h"
+#include "module/ModuleContext.h"
+#include "../TestHelpers.h"
+
+using namespace cish::ast;
+using namespace cish::module;
+
+
+static void assertRegisterVariables(const std::string &source, uint32_t registers, uint32_t memory)
+{
+    ParseContext::Ptr parseContext = ParseContext::parseSource(source);
+    Ast::Ptr ast = parseContext->buildAst(ModuleContext::create());
+
+    RegisterAllocator allocator(ast.get());
+    allocator.run();
+    ASSERT_EQ(registers, allocator.getRegisterVariableCount());
+    ASSERT_EQ(memory, allocator.getMemoryVariableCount());
+}
+
+TEST(RegisterAllocatorTest, scalarLocalsAreKeptInRegisters)
+{
+    const std::string source =
+        "int sum(int n) {\n"
+        "    long total = 0;\n"
+        "    for (int i=0; i<n; i++) total += i;\n"
+        "    return total;\n"
+        "}\n"
+        "int main() { return sum(10); }\n";
+
+    assertRegisterVariables(source, 3, 0);
+    assertExitCode(source, 45);
+}
+
+TEST(RegisterAllocatorTest, localsWhoseAddressIsTakenStayInMemory)
+{
+    const std::string source =
+        "void set(int *p) { *p = 7; }\n"
+        "int main() {\n"
+        "    int a = 1;\n"
+        "    int b = 2;\n"
+        "    set(&a);\n"
+        "    return a + b;\n"
+        "}\n";
+
+    assertRegisterVariables(source, 2, 1);
+    assertExitCode(source, 9);
+}
+
+TEST(RegisterAllocatorTest, structsStayInMemory)
+{
+    const std::string source =
+        "struct point { int x; int y; };\n"
+        "int area(struct point p) { int n = p.x * p.y; return n; }\n"
+        "int main() {\n"
+        "    struct point p;\n"
+        "    p.x = 3;\n"
+        "    p.y = 4;\n"
+        "    return area(p);\n"
+        "}\n";
+
+    assertRegisterVariables(source, 1, 2);
+    assertExitCode(source, 12);
+}
+
+TEST(RegisterAllocatorTest, shadowingLocalsHaveRegistersOfTheirOwn)
+{
+    const std::string source =
+        "int x = 100;\n"
+        "int global() { return x; }\n"
+        "int main() {\n"
+        "    int x = 1;\n"
+        "    int total = 0;\n"
+        "    for (int i=0; i<3; i++) { int x = i * 10; total += x; }\n"
+        "    for (int i=0; i<2; i++) { char x = 'a'; total += x - 'a'; }\n"
+        "    if (total > 0) { int total = 5; x += total; }\n"
+        "    return x + total + global();\n"
+        "}\n";
+
+    assertRegisterVariables(source, 7, 0);
+    assertExitCode(source, 136);
+}
+
+TEST(RegisterAllocatorTest, recursiveCallsHaveRegistersOfTheirOwn)
+{
+    assertExitCode(
+        "int fib(int n) {\n"
+        "    if (n < 2) return n;\n"
+        "    int a = fib(n - 1);\n"
+        "    int b = fib(n - 2);\n"
+        "    return a + b;\n"
+        "}\n"
+        "int main() { return fib(10); }\n",
+        55);
+}
+
+TEST(RegisterAllocatorTest, inlinedCallsHaveRegistersOfTheirOwn)
+{
+    assertExitCode(
+        "int combine(int a, int b) { return a * 10 + b; }\n"
+        "int main() {\n"
+        "    int a = 1;\n"
+        "    int b = 2;\n"
+        "    return combine(b, combine(a, b)) + a;\n"
+        "}\n",
+        33);
+}
@@ -60,4 +60,20 @@ TEST(StringTableTest, identicalStringsAreGivenTheSameId)
 
     ASSERT_EQ(key1, key2);
     ASSERT_NE(key1, key3);
+}
+
+TEST(StringTableTest, manyDuplicatesResolveToTheFirstId)
+{
+    StringTable table;
+    std::vector<StringId> ids;
+
+    for (int i=0; i<10000; i++) {
+        ids.push_back(table.insert("string " + std::to_string(i)));
+    }
+
+    for (int i=0; i<10000; i++) {
+        ASSERT_EQ(ids[i], table.insert("string " + std::to_string(i)));
+    }
+
+    ASSERT_EQ(10000, table.getMap().size());
 }
\ No newline at end of file
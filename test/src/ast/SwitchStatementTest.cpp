@@ -0,0 +1,167 @@
+#include <gtest/gtest.h>
+
+#include "ast/SwitchStatement.h"
+#include "ast/BreakStatement.h"
+#include "ast/LiteralExpression.h"
+#include "ast/BinaryExpression.h"
+#include "ast/VariableDeclarationStatement.h"
+#include "ast/DeclarationContext.h"
+
+#include "vm/Memory.h"
+#include "vm/ExecutionContext.h"
+
+#include <algorithm>
+
+
+using namespace cish::vm;
+using namespace cish::ast;
+
+
+static Expression::Ptr intLiteral(int value)
+{
+    return std::make_shared<LiteralExpression>(ExpressionValue(TypeDecl::INT, value));
+}
+
+static Expression::Ptr longLiteral(int64_t value)
+{
+    return std::make_shared<LiteralExpression>(ExpressionValue(TypeDecl::LONG, value));
+}
+
+static SwitchStatement::Ptr createSwitch(int value, const std::vector<int> &cases)
+{
+    auto switchStatement = std::make_shared<SwitchStatement>(intLiteral(value));
+    for (int c: cases) {
+        switchStatement->addCaseLabel(intLiteral(c));
+    }
+    switchStatement->finalize();
+    return switchStatement;
+}
+
+
+TEST(SwitchStatementTest, expressionMustBeInteger)
+{
+    auto floatLiteral = std::make_shared<LiteralExpression>(ExpressionValue(TypeDecl::FLOAT, 1.f));
+    ASSERT_THROW(SwitchStatement stmt(floatLiteral), InvalidTypeException);
+
+    SwitchStatement stmt(intLiteral(1));
+    ASSERT_THROW(stmt.addCaseLabel(floatLiteral), InvalidTypeException);
+}
+
+TEST(SwitchStatementTest, caseLabelsMustBeUniqueConstants)
+{
+    Memory memory(100, 1);
+    ExecutionContext ec(&memory);
+
+    SwitchStatement stmt(intLiteral(1));
+    stmt.addCaseLabel(intLiteral(1));
+    ASSERT_THROW(stmt.addCaseLabel(intLiteral(1)), InvalidStatementException);
+
+    auto sum = std::make_shared<BinaryExpression>(BinaryExpression::PLUS, intLiteral(1), intLiteral(2));
+    ASSERT_NO_THROW(stmt.addCaseLabel(sum));
+    ASSERT_THROW(stmt.addCaseLabel(sum), InvalidStatementException);
+
+    stmt.addDefaultLabel();
+    ASSERT_THROW(stmt.addDefaultLabel(), InvalidStatementException);
+}
+
+TEST(SwitchStatementTest, denseCasesUseJumpTable)
+{
+    ASSERT_TRUE(createSwitch(0, {1, 2, 3, 4, 5})->usesJumpTable());
+    ASSERT_TRUE(createSwitch(0, {-2, 0, 2, 4})->usesJumpTable());
+
+    ASSERT_FALSE(createSwitch(0, {1, 2})->usesJumpTable());
+    ASSERT_FALSE(createSwitch(0, {1, 100, 10000})->usesJumpTable());
+}
+
+TEST(SwitchStatementTest, labelsAtTheEndsOfTheRangeAreDispatched)
+{
+    const std::vector<std::vector<int64_t>> labelSets = {
+        // Too far apart to even compute the size of a table
+        { INT64_MIN, 0, INT64_MAX },
+        // A table whose base is far away from the values outside of it
+        { INT64_MAX - 3, INT64_MAX - 2, INT64_MAX - 1, INT64_MAX },
+        { INT64_MIN, INT64_MIN + 1, INT64_MIN + 2, INT64_MIN + 3 },
+    };
+    const int64_t values[] = { INT64_MIN, INT64_MIN + 2, -1, 0, 1, INT64_MAX - 1, INT64_MAX };
+
+    for (const std::vector<int64_t> &labels: labelSets) {
+        for (int64_t value: values) {
+            Memory memory(100, 1);
+            ExecutionContext ec(&memory);
+            DeclarationContext dc;
+            ec.pushFunctionFrame();
+
+            //  switch (value) {
+            //      case labels[0]: char matched; break;
+            //      ...
+            //      default: char unmatched;
+            //  }
+            auto stmt = std::make_shared<SwitchStatement>(longLiteral(value));
+            stmt->setRequiresScope(false);
+            for (int64_t label: labels) {
+                stmt->addCaseLabel(longLiteral(label));
+                if (label == value) {
+                    stmt->addStatement(std::make_shared<VariableDeclarationStatement>(&dc, TypeDecl::CHAR, "matched", nullptr));
+                }
+                dc.enterSwitch();
+                stmt->addStatement(std::make_shared<BreakStatement>(&dc));
+                dc.exitSwitch();
+            }
+            stmt->addDefaultLabel();
+            stmt->addStatement(std::make_shared<VariableDeclarationStatement>(&dc, TypeDecl::CHAR, "unmatched", nullptr));
+            stmt->finalize();
+
+            ASSERT_EQ(labels.size() == 4, stmt->usesJumpTable());
+            ASSERT_EQ(Completion::NORMAL, stmt->execute(&ec));
+
+            const bool isLabel = std::find(labels.begin(), labels.end(), value) != labels.end();
+            ASSERT_EQ(isLabel, ec.getScope()->getVariable("matched") != nullptr);
+            ASSERT_EQ(!isLabel, ec.getScope()->getVariable("unmatched") != nullptr);
+        }
+    }
+}
+
+TEST(SwitchStatementTest, executionStartsAtMatchingLabelAndFallsThrough)
+{
+    for (int useJumpTable=0; useJumpTable<2; useJumpTable++) {
+        for (int value=0; value<6; value++) {
+            Memory memory(100, 1);
+            ExecutionContext ec(&memory);
+            DeclarationContext dc;
+            ec.pushFunctionFrame();
+
+            // The sparse variant gets labels that are too far apart for a table
+            const int scale = useJumpTable ? 1 : 1000;
+
+            //  switch (value) {
+            //      case 1: int a;
+            //      case 2: int b; break;
+            //      default: int c;
+            //      case 4: int d;
+            //  }
+            auto stmt = std::make_shared<SwitchStatement>(intLiteral(value * scale));
+            stmt->setRequiresScope(false);
+            stmt->addCaseLabel(intLiteral(1 * scale));
+            stmt->addStatement(std::make_shared<VariableDeclarationStatement>(&dc, TypeDecl::CHAR, "a", nullptr));
+            stmt->addCaseLabel(intLiteral(2 * scale));
+            stmt->addStatement(std::make_shared<VariableDeclarationStatement>(&dc, TypeDecl::CHAR, "b", nullptr));
+            dc.enterSwitch();
+            stmt->addStatement(std::make_shared<BreakStatement>(&dc));
+            dc.exitSwitch();
+            stmt->addDefaultLabel();
+            stmt->addStatement(std::make_shared<VariableDeclarationStatement>(&dc, TypeDecl::CHAR, "c", nullptr));
+            stmt->addCaseLabel(intLiteral(4 * scale));
+            stmt->addStatement(std::make_shared<VariableDeclarationStatement>(&dc, TypeDecl::CHAR, "d", nullptr));
+            stmt->finalize();
+
+            ASSERT_EQ(useJumpTable, stmt->usesJumpTable());
+            ASSERT_EQ(Completion::NORMAL, stmt->execute(&ec));
+
+            Scope *scope = ec.getScope();
+            ASSERT_EQ(value == 1, scope->getVariable("a") != nullptr);
+            ASSERT_EQ(value == 1 || value == 2, scope->getVariable("b") != nullptr);
+            ASSERT_EQ(value != 1 && value != 2 && value != 4, scope->getVariable("c") != nullptr);
+            ASSERT_EQ(value != 1 && value != 2, scope->getVariable("d") != nullptr);
+        }
+    }
+}
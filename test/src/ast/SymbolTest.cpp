@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+
+#include "ast/Symbol.h"
+
+using namespace cish::ast;
+
+
+TEST(SymbolTest, equalNamesShareSymbol)
+{
+    const SymbolId a = Symbol::intern("symbol_test_a");
+    const SymbolId b = Symbol::intern("symbol_test_b");
+
+    ASSERT_NE(0, a);
+    ASSERT_NE(a, b);
+    ASSERT_EQ(a, Symbol::intern(std::string("symbol_") + "test_a"));
+    ASSERT_EQ("symbol_test_a", Symbol::getName(a));
+}
+
+TEST(SymbolTest, findDoesNotIntern)
+{
+    ASSERT_EQ(0, Symbol::find("symbol_test_never_interned"));
+    ASSERT_EQ(0, Symbol::find("symbol_test_never_interned"));
+
+    const SymbolId symbol = Symbol::intern("symbol_test_found");
+    ASSERT_EQ(symbol, Symbol::find("symbol_test_found"));
+}
+
+TEST(SymbolTest, invalidSymbolHasNoName)
+{
+    ASSERT_ANY_THROW(Symbol::getName(0));
+}
+
+TEST(SymbolMapTest, valuesSurviveGrowth)
+{
+    SymbolMap<int> map;
+    std::vector<SymbolId> symbols;
+
+    for (int i=0; i<200; i++) {
+        symbols.push_back(Symbol::intern("symbol_map_" + std::to_string(i)));
+        map[symbols.back()] = i;
+    }
+
+    ASSERT_EQ(200, map.size());
+    for (int i=0; i<200; i++) {
+        ASSERT_NE(nullptr, map.find(symbols[i]));
+        ASSERT_EQ(i, *map.find(symbols[i]));
+    }
+}
+
+TEST(SymbolMapTest, missingSymbolsAreNotFound)
+{
+    SymbolMap<int> map;
+    ASSERT_EQ(nullptr, map.find(Symbol::intern("symbol_map_missing")));
+
+    map[Symbol::intern("symbol_map_present")] = 1;
+    ASSERT_EQ(nullptr, map.find(Symbol::intern("symbol_map_missing")));
+    ASSERT_EQ(nullptr, map.find(0));
+    ASSERT_FALSE(map.contains(0));
+
+    map.clear();
+    ASSERT_EQ(0, map.size());
+    ASSERT_FALSE(map.contains(Symbol::intern("symbol_map_present")));
+}
@@ -21,8 +21,7 @@ void declareVariable(DeclarationContext &context, TypeDecl type, std::string nam
 void defineVariable(ExecutionContext &context, TypeDecl type, std::string name)
 {
     auto alloc = context.getMemory()->allocate(type.getSize());
-    Variable *var = new Variable(type, std::move(alloc));
-    context.getScope()->addVariable(name, var);
+    context.getScope()->addVariable(name, type, std::move(alloc));
 }
 
 template<typename To, typename From>
@@ -45,8 +44,7 @@ void testAssignmentCasting()
 
         auto alloc = memory.allocate(sizeof(To));
         auto rawAlloc = alloc.get();
-        Variable *var = new Variable(TypeDecl::getFromNative<To>(), std::move(alloc));
-        ec.getScope()->addVariable("var", var);
+        ec.getScope()->addVariable("var", TypeDecl::getFromNative<To>(), std::move(alloc));
 
         ExpressionValue exprValue(TypeDecl::getFromNative<From>(), val);
         auto expr = std::make_shared<LiteralExpression>(exprValue);
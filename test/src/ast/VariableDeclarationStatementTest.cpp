@@ -3,6 +3,7 @@
 #include "ast/VariableDeclarationStatement.h"
 #include "ast/LiteralExpression.h"
 #include "ast/DeclarationContext.h"
+#include "ast/DataSegment.h"
 #include "vm/Memory.h"
 #include "vm/ExecutionContext.h"
 
@@ -82,3 +83,30 @@ TEST(VariableDeclarationStatementTest, constVariablesDontNeedAnAssignedValue)
     auto expr = std::make_shared<LiteralExpression>(100);
     ASSERT_NO_THROW(VariableDeclarationStatement stmt(&dc, type, "i", nullptr));
 }
+
+TEST(VariableDeclarationStatementTest, constantInitializedGlobalsLiveInDataSegment)
+{
+    Memory memory(100, 1);
+    DeclarationContext dc;
+    ExecutionContext ec(&memory);
+    DataSegment segment;
+
+    auto value = std::make_shared<LiteralExpression>(ExpressionValue(TypeDecl::INT, 1234));
+    VariableDeclarationStatement initialized(&dc, TypeDecl::INT, "a", value);
+    VariableDeclarationStatement zeroed(&dc, TypeDecl::SHORT, "b", nullptr);
+    ASSERT_TRUE(initialized.allocateStatically(&segment));
+    ASSERT_TRUE(zeroed.allocateStatically(&segment));
+
+    ec.installDataSegment(&segment);
+    const uint32_t freeSize = memory.getFreeSize();
+
+    initialized.execute(&ec);
+    zeroed.execute(&ec);
+    ASSERT_EQ(freeSize, memory.getFreeSize());
+
+    Variable *a = ec.getScope()->getVariable("a");
+    Variable *b = ec.getScope()->getVariable("b");
+    ASSERT_EQ(ec.getDataSegmentAddress(), a->getHeapAddress());
+    ASSERT_EQ(1234, a->getAllocation()->read<int>());
+    ASSERT_EQ(0, b->getAllocation()->read<short>());
+}
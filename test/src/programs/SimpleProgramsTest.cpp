@@ -293,6 +293,105 @@ TEST(SimpleProgramsTest, doWhileLoop)
     assertExitCode(source, 5);
 }
 
+TEST(SimpleProgramsTest, breakTerminatesInnermostLoop)
+{
+    const std::string source =
+        "int main() {"
+        "   int n = 0;"
+        "   for (int i=0; i<10; i++) {"
+        "       int j = 0;"
+        "       while (true) {"
+        "           if (j == i) break;"
+        "           j++;"
+        "           n++;"
+        "       }"
+        "       if (i == 5) break;"
+        "   }"
+        "   return n;"
+        "}";
+    assertExitCode(source, 15);
+}
+
+TEST(SimpleProgramsTest, continueSkipsRestOfIteration)
+{
+    const std::string source =
+        "int main() {"
+        "   int sum = 0;"
+        "   for (int i=0; i<10; i++) {"
+        "       if (i % 2 == 0) continue;"
+        "       sum += i;"
+        "   }"
+        "   int n = 0;"
+        "   do {"
+        "       n++;"
+        "       if (n < 5) continue;"
+        "       sum += 100;"
+        "   } while (n < 5);"
+        "   return sum;"
+        "}";
+    assertExitCode(source, 125);
+}
+
+TEST(SimpleProgramsTest, returnFromWithinNestedLoops)
+{
+    const std::string source =
+        "int find(int target) {"
+        "   for (int i=0; i<10; i++) {"
+        "       for (int j=0; j<10; j++) {"
+        "           if (i * 10 + j == target) return i;"
+        "       }"
+        "   }"
+        "   return -1;"
+        "}"
+        "int main() { return find(42) + find(7); }";
+    assertExitCode(source, 4);
+}
+
+TEST(SimpleProgramsTest, switchStatement)
+{
+    const std::string source =
+        "int classify(int n) {"
+        "   int result = 0;"
+        "   switch (n) {"
+        "       case 0:"
+        "           return 100;"
+        "       case 1:"
+        "       case 2:"
+        "           result = 10;"
+        "           break;"
+        "       case 3:"
+        "           result = 20;"
+        "       case 4:"
+        "           result += 1;"
+        "           break;"
+        "       default:"
+        "           result = -1;"
+        "   }"
+        "   return result;"
+        "}"
+        "int main() {"
+        "   return classify(0) + classify(1) + classify(2) + classify(3) + classify(4) + classify(9);"
+        "}";
+    assertExitCode(source, 100 + 10 + 10 + 21 + 1 - 1);
+}
+
+TEST(SimpleProgramsTest, continueInsideSwitchContinuesLoop)
+{
+    const std::string source =
+        "int main() {"
+        "   int n = 0;"
+        "   for (int i=0; i<10; i++) {"
+        "       switch (i % 3) {"
+        "           case 0: continue;"
+        "           case 1000: n += 1000; break;"
+        "       }"
+        "       n++;"
+        "   }"
+        "   return n;"
+        "}";
+    assertExitCode(source, 6);
+}
+
 TEST(SimpleProgramsTest, doWhileLoopOnlyRunOnce)
 {
     const std::string source =
@@ -787,6 +886,8 @@ TEST(SimpleProgramsTest, pointerToIntToPointerCast)
         "   int b = 0xFF000000;"
         "   const int *aptr = &a;"
         ""
+        // Only locals whose address is taken are laid out in memory
+        "   int *unused = &b;"
         "   int bptrVal = (int)aptr + sizeof int; "
         ""
         "   int *bptr = (int*)bptrVal;"
@@ -1256,3 +1357,17 @@ TEST(SimpleProgramsTest, crashInducedMemoryLeakDoesNotFatallyCrash)
     );
 }
 
+TEST(SimpleProgramsTest, breakAndContinueOutsideLoopIsInvalid)
+{
+    assertCompilationFailure("int main() { break; return 0; }");
+    assertCompilationFailure("int main() { if (true) { continue; } return 0; }");
+}
+
+TEST(SimpleProgramsTest, invalidSwitchStatements)
+{
+    assertCompilationFailure("int main() { int n = 0; switch (n) { case n: return 1; } return 0; }");
+    assertCompilationFailure("int main() { switch (1) { case 1: case 1: return 1; } return 0; }");
+    assertCompilationFailure("int main() { switch (1) { default: default: return 1; } return 0; }");
+    assertCompilationFailure("int main() { switch (1.5f) { case 1: return 1; } return 0; }");
+    assertCompilationFailure("int main() { switch (1) { case 1: continue; } return 0; }");
+}
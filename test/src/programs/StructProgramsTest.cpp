@@ -327,6 +327,49 @@ TEST(StructProgramsTest, passStructFuncAsParam)
     );
 }
 
+TEST(StructProgramsTest, returnedStructsCanAliasTheAssignedVariable)
+{
+    assertExitCode(
+        "struct pair_t { int a; int b; };"
+        "struct pair_t swapped(struct pair_t *p) {"
+        "   struct pair_t r;"
+        "   r.a = p->b;"
+        "   r.b = p->a;"
+        "   p->a = 0;"
+        "   return r;"
+        "}"
+        "struct pair_t same(struct pair_t *p) {"
+        "   return *p;"
+        "}"
+        "int main() {"
+        "   struct pair_t s;"
+        "   s.a = 1;"
+        "   s.b = 2;"
+        "   s = swapped(&s);"
+        "   s = same(&s);"
+        "   return s.a * 10 + s.b;"
+        "}", 21
+    );
+}
+
+TEST(StructProgramsTest, manyLiveStructTemporaries)
+{
+    assertExitCode(
+        "struct wrapper_t { int value; int count; };"
+        "struct wrapper_t depth(int n) {"
+        "   struct wrapper_t w;"
+        "   w.value = 0;"
+        "   if (n > 0) {"
+        "       w.value = depth(n - 1).value + 1;"
+        "   }"
+        "   return w;"
+        "}"
+        "int main() {"
+        "   return depth(20).value;"
+        "}", 20
+    );
+}
+
 
 
 /* COMPILATION FAILURES */
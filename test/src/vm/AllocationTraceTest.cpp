@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+
+#include "vm/AllocationTrace.h"
+#include "vm/ExecutionContext.h"
+#include "vm/Memory.h"
+
+#include <fstream>
+#include <iterator>
+#include <stdio.h>
+
+using namespace cish::vm;
+
+
+static uint32_t readU32(const std::vector<uint8_t> &buf, size_t offset)
+{
+    return buf[offset] | (buf[offset+1] << 8) | (buf[offset+2] << 16) | (buf[offset+3] << 24);
+}
+
+
+TEST(AllocationTraceTest, allocationsAreTaggedWithCallingFunction)
+{
+    const std::string path = ::testing::TempDir() + "cish_alloc_trace.bin";
+    const std::string funcName = "foo";
+
+    Memory memory(1024, 4);
+    ExecutionContext context(&memory);
+    uint32_t address;
+
+    {
+        AllocationTrace trace(path, &context);
+        memory.setAllocationObserver(&trace);
+
+        context.pushFunctionFrame(&funcName);
+        auto alloc = memory.allocate(4);
+        address = alloc->getAddress();
+        alloc = nullptr;
+        context.popFunctionFrame();
+
+        memory.setAllocationObserver(nullptr);
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    std::vector<uint8_t> buf((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    remove(path.c_str());
+
+    // Magic, function definition, allocation and free
+    ASSERT_EQ(8 + (1 + 8 + 3) + 13 + 13, buf.size());
+    ASSERT_EQ("CISHTRC1", std::string(buf.begin(), buf.begin() + 8));
+
+    ASSERT_EQ('F', buf[8]);
+    ASSERT_EQ(1, readU32(buf, 9));
+    ASSERT_EQ(3, readU32(buf, 13));
+    ASSERT_EQ("foo", std::string(buf.begin() + 17, buf.begin() + 20));
+
+    ASSERT_EQ('A', buf[20]);
+    ASSERT_EQ(address, readU32(buf, 21));
+    ASSERT_EQ(4, readU32(buf, 25));
+    ASSERT_EQ(1, readU32(buf, 29));
+
+    ASSERT_EQ('D', buf[33]);
+    ASSERT_EQ(address, readU32(buf, 34));
+    ASSERT_EQ(1, readU32(buf, 42));
+}
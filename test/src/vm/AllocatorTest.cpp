@@ -150,3 +150,61 @@ TEST(AllocatorTest, semiAdvancedFragmenting)
     assertBlockStructure(alloc, {{0, 20}});
 }
 
+
+TEST(AllocatorTest, freeSizeIsTracked)
+{
+    Allocator alloc(20);
+    ASSERT_EQ(20, alloc.getFreeSize());
+
+    alloc.allocate(5);
+    alloc.allocate(5);
+    ASSERT_EQ(10, alloc.getFreeSize());
+
+    alloc.deallocate(0, 5);
+    ASSERT_EQ(15, alloc.getFreeSize());
+
+    alloc.deallocate(5, 5);
+    ASSERT_EQ(20, alloc.getFreeSize());
+}
+
+TEST(AllocatorTest, tryAllocateDoesNotThrow)
+{
+    Allocator alloc(8);
+    uint32_t offset = 0;
+
+    ASSERT_TRUE(alloc.tryAllocate(4, &offset));
+    ASSERT_EQ(0, offset);
+
+    ASSERT_FALSE(alloc.tryAllocate(8, &offset));
+    ASSERT_TRUE(alloc.tryAllocate(4, &offset));
+    ASSERT_EQ(4, offset);
+
+    ASSERT_FALSE(alloc.tryAllocate(1, &offset));
+}
+
+TEST(AllocatorTest, failedAllocationsSucceedAfterLargeEnoughFree)
+{
+    Allocator alloc(20);
+
+    ASSERT_EQ(0, alloc.allocate(5));
+    ASSERT_EQ(5, alloc.allocate(5));
+    ASSERT_EQ(10, alloc.allocate(5));
+    ASSERT_EQ(15, alloc.allocate(5));
+
+    alloc.deallocate(0, 5);
+    alloc.deallocate(10, 5);
+    ASSERT_EQ(10, alloc.getFreeSize());
+    ASSERT_EQ(5, alloc.getLargestFreeBlock());
+
+    // Enough memory in total, but too fragmented
+    uint32_t offset;
+    ASSERT_FALSE(alloc.tryAllocate(10, &offset));
+    ASSERT_FALSE(alloc.tryAllocate(6, &offset));
+    ASSERT_TRUE(alloc.tryAllocate(5, &offset));
+    ASSERT_EQ(0, offset);
+
+    // Freeing the neighbour coalesces into a block large enough
+    alloc.deallocate(5, 5);
+    ASSERT_TRUE(alloc.tryAllocate(10, &offset));
+    ASSERT_EQ(5, offset);
+}
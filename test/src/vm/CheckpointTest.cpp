@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+
+#include "vm/Checkpoint.h"
+#include "vm/ExecutionContext.h"
+#include "vm/Memory.h"
+
+#include "ast/Ast.h"
+#include "ast/DataSegment.h"
+
+#include "../TestHelpers.h"
+
+#include <stdio.h>
+#include <unistd.h>
+
+
+using namespace cish::vm;
+using namespace cish::ast;
+
+
+static std::string getCheckpointPath(const std::string &name)
+{
+    const std::string path = ::testing::TempDir() + name + ".ckpt";
+    remove(path.c_str());
+    return path;
+}
+
+static long getFileSize(const std::string &path)
+{
+    FILE *file = fopen(path.c_str(), "rb");
+    fseek(file, 0, SEEK_END);
+    const long size = ftell(file);
+    fclose(file);
+    return size;
+}
+
+
+TEST(CheckpointTest, latestCheckpointIsRestored)
+{
+    const std::string path = getCheckpointPath("latestCheckpointIsRestored");
+    Ast::Ptr ast = std::make_shared<Ast>();
+
+    Memory memory(1 << 20, 4);
+    ExecutionContext context(&memory);
+    context.getScope()->addVariable("a", TypeDecl::INT, memory.allocate(4));
+    context.getScope()->addVariable("p", TypeDecl::getPointer(TypeDecl::CHAR), memory.allocate(4));
+    context.getScope()->getVariable("a")->getAllocation()->write<int>(1);
+    const uint32_t block = context.getMallocContext()->allocate(64 * 1024, nullptr);
+
+    CheckpointWriter writer(path, ast.get());
+    writer.write(&memory, &context);
+    const long fullSize = getFileSize(path);
+
+    context.getScope()->getVariable("a")->getAllocation()->write<int>(2);
+    writer.write(&memory, &context);
+
+    // The second checkpoint only holds the page 'a' lives on
+    ASSERT_LT(getFileSize(path) - fullSize, fullSize / 4);
+    ASSERT_EQ(2, writer.getCheckpointCount());
+
+    CheckpointReader reader(path, ast);
+    Memory restoredMemory(*reader.getMemorySnapshot());
+    ExecutionContext restored(&restoredMemory);
+    restored.restoreSnapshot(reader.getContextSnapshot());
+
+    ASSERT_EQ(2, restored.getScope()->getVariable("a")->getAllocation()->read<int>());
+    ASSERT_EQ(TypeDecl::getPointer(TypeDecl::CHAR), restored.getScope()->getVariable("p")->getType());
+    ASSERT_EQ(memory.getFreeSize(), restoredMemory.getFreeSize());
+    ASSERT_TRUE(restored.getMallocContext()->attemptDeallocation(block));
+
+    remove(path.c_str());
+}
+
+TEST(CheckpointTest, tornRecordsAreIgnored)
+{
+    const std::string path = getCheckpointPath("tornRecordsAreIgnored");
+    Ast::Ptr ast = std::make_shared<Ast>();
+
+    Memory memory(1 << 20, 4);
+    ExecutionContext context(&memory);
+    context.getScope()->addVariable("a", TypeDecl::INT, memory.allocate(4));
+    context.getScope()->getVariable("a")->getAllocation()->write<int>(1);
+
+    CheckpointWriter writer(path, ast.get());
+    writer.write(&memory, &context);
+    const long fullSize = getFileSize(path);
+
+    context.getScope()->getVariable("a")->getAllocation()->write<int>(2);
+    writer.write(&memory, &context);
+
+    // Cut the incremental record in half, as a crash while writing would
+    const long tornSize = fullSize + (getFileSize(path) - fullSize) / 2;
+    ASSERT_EQ(0, truncate(path.c_str(), tornSize));
+
+    CheckpointReader reader(path, ast);
+    Memory restoredMemory(*reader.getMemorySnapshot());
+    ExecutionContext restored(&restoredMemory);
+    restored.restoreSnapshot(reader.getContextSnapshot());
+    ASSERT_EQ(1, restored.getScope()->getVariable("a")->getAllocation()->read<int>());
+
+    remove(path.c_str());
+}
+
+TEST(CheckpointTest, checkpointsOfOtherProgramsAreRejected)
+{
+    const std::string path = getCheckpointPath("checkpointsOfOtherProgramsAreRejected");
+    Ast::Ptr ast = std::make_shared<Ast>();
+
+    Memory memory(1024, 4);
+    ExecutionContext context(&memory);
+    CheckpointWriter(path, ast.get()).write(&memory, &context);
+
+    DataSegment::Ptr segment = std::make_unique<DataSegment>();
+    segment->addObject(TypeDecl::INT);
+    Ast::Ptr other = std::make_shared<Ast>();
+    other->setDataSegment(std::move(segment));
+
+    ASSERT_NO_THROW(CheckpointReader reader(path, ast));
+    ASSERT_THROW(CheckpointReader reader(path, other), CheckpointException);
+    ASSERT_THROW(CheckpointReader reader(path + ".missing", ast), CheckpointException);
+
+    remove(path.c_str());
+}
+
+TEST(CheckpointTest, checkpointsOfEditedFunctionsAreRejected)
+{
+    const std::string path = getCheckpointPath("checkpointsOfEditedFunctionsAreRejected");
+    const std::string source =
+        "int count(int n) { int total = 0; for (int i=0; i<n; i++) total++; return total; }"
+        "int main() { return count(10); }";
+
+    Memory memory(1024, 4);
+    ExecutionContext context(&memory);
+    CheckpointWriter(path, createAst(source).get()).write(&memory, &context);
+
+    // The same source always gives the same fingerprint
+    ASSERT_NO_THROW(CheckpointReader reader(path, createAst(source)));
+
+    // Only the bodies differ, names and strings are the same
+    ASSERT_THROW(CheckpointReader reader(path, createAst(
+        "int count(int n) { int total = 0; for (int i=0; i<n; i++) { total++; total++; } return total; }"
+        "int main() { return count(10); }")), CheckpointException);
+    ASSERT_THROW(CheckpointReader reader(path, createAst(
+        "int count(int n) { int total = 0; for (int i=0; i<n; i++) total++; return total; }"
+        "int main() { return count(11); }")), CheckpointException);
+
+    remove(path.c_str());
+}
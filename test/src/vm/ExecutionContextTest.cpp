@@ -2,8 +2,12 @@
 
 #include "vm/ExecutionContext.h"
 
+#include "ast/DeclarationContext.h"
+#include "ast/FunctionDefinition.h"
 #include "ast/LiteralExpression.h"
 #include "ast/StringTable.h"
+#include "ast/DataSegment.h"
+#include "ast/VariableDeclarationStatement.h"
 
 
 using namespace cish::vm;
@@ -68,21 +72,18 @@ TEST(ExecutionContextTest, functionFramesHidesNonGlobalScopes)
     Memory memory(100, 1);
     ExecutionContext context(&memory);
 
-    Variable *global = new Variable(TypeDecl::INT, memory.allocate(4));
-    context.getScope()->addVariable("global", global);
+    Variable *global = context.getScope()->addVariable("global", TypeDecl::INT, memory.allocate(4));
     ASSERT_EQ(global, context.getScope()->getVariable("global"));
 
     // Call a function
-    Variable *inFirst = new Variable(TypeDecl::INT, memory.allocate(4));
     context.pushFunctionFrame();
-    context.getScope()->addVariable("inFirst", inFirst);
+    Variable *inFirst = context.getScope()->addVariable("inFirst", TypeDecl::INT, memory.allocate(4));
     ASSERT_EQ(global, context.getScope()->getVariable("global"));
     ASSERT_EQ(inFirst, context.getScope()->getVariable("inFirst"));
 
     // Call a second function
-    Variable *inSecond= new Variable(TypeDecl::INT, memory.allocate(4));
     context.pushFunctionFrame();
-    context.getScope()->addVariable("inSecond", inSecond);
+    Variable *inSecond = context.getScope()->addVariable("inSecond", TypeDecl::INT, memory.allocate(4));
     ASSERT_EQ(global, context.getScope()->getVariable("global"));
     ASSERT_EQ(nullptr, context.getScope()->getVariable("inFirst"));
     ASSERT_EQ(inSecond, context.getScope()->getVariable("inSecond"));
@@ -216,6 +217,46 @@ TEST(ExecutionContextTest, gettingFunctionReturnBufferThrowsIfUndefined)
 }
 
 
+TEST(ExecutionContextTest, ephemeralVariablesShareOneArena)
+{
+    Memory memory(1024 * 16, 4);
+    ExecutionContext context(&memory);
+
+    context.pushEphemeralFrame();
+    const uint32_t first = context.allocateEphemeral(TypeDecl::INT)->getHeapAddress();
+    const uint32_t second = context.allocateEphemeral(TypeDecl::DOUBLE)->getHeapAddress();
+    ASSERT_EQ(first + 8, second);
+    context.popEphemeralFrame();
+
+    const uint32_t freeSize = memory.getFreeSize();
+    context.pushEphemeralFrame();
+    ASSERT_EQ(first, context.allocateEphemeral(TypeDecl::INT)->getHeapAddress());
+    context.popEphemeralFrame();
+    ASSERT_EQ(freeSize, memory.getFreeSize());
+}
+
+TEST(ExecutionContextTest, randSequencesAreKeptPerContext)
+{
+    Memory memory(1024, 4);
+    ExecutionContext seeded(&memory);
+    ExecutionContext unseeded(&memory);
+
+    seeded.getRandContext()->seed(7);
+    const int32_t first = seeded.getRandContext()->next();
+
+    // The same sequence as glibc's rand() before srand() is called
+    ASSERT_EQ(1804289383, unseeded.getRandContext()->next());
+    ASSERT_EQ(846930886, unseeded.getRandContext()->next());
+
+    seeded.getRandContext()->seed(7);
+    ASSERT_EQ(first, seeded.getRandContext()->next());
+
+    Memory restoredMemory(*memory.createSnapshot());
+    ExecutionContext restored(&restoredMemory);
+    restored.restoreSnapshot(seeded.createSnapshot());
+    ASSERT_EQ(seeded.getRandContext()->next(), restored.getRandContext()->next());
+}
+
 TEST(ExecutionContextTest, resolvingUndefinedStringsReturnsNull)
 {
     Memory memory(100, 1);
@@ -232,9 +273,11 @@ TEST(ExecutionContextTest, resolvingDefinedFunctionsAllocatesBytes)
 
     StringTable table;
     table.insert("abc");
+    DataSegment segment;
+    segment.addStrings(&table);
 
     ASSERT_EQ(100, memory.getFreeSize());
-    context.copyStringTable(&table);
+    context.installDataSegment(&segment);
     ASSERT_EQ(96, memory.getFreeSize());
 }
 
@@ -247,7 +290,9 @@ TEST(ExecutionContextTest, resolvingDefinedFunctionsReturnsUniqueAddresses)
     StringId id1 = table.insert("abc");
     StringId id2 = table.insert("hello world!");
     StringId id3 = table.insert("hi mom");
-    context.copyStringTable(&table);
+    DataSegment segment;
+    segment.addStrings(&table);
+    context.installDataSegment(&segment);
 
     MemoryView view1 = context.resolveString(id1);
     MemoryView view2 = context.resolveString(id2);
@@ -269,7 +314,9 @@ TEST(ExecutionContextTest, copiedStringsAreDefinedCorrectly)
 
     StringTable table;
     StringId id = table.insert("abc");
-    context.copyStringTable(&table);
+    DataSegment segment;
+    segment.addStrings(&table);
+    context.installDataSegment(&segment);
 
     MemoryView view = context.resolveString(id);
     ASSERT_EQ('a', view.read<char>(0));
@@ -277,3 +324,87 @@ TEST(ExecutionContextTest, copiedStringsAreDefinedCorrectly)
     ASSERT_EQ('c', view.read<char>(2));
     ASSERT_EQ(0, view.read<char>(3));
 }
+
+TEST(ExecutionContextTest, snapshotRestoresGlobalState)
+{
+    Memory memory(1024, 4);
+    ExecutionContext context(&memory);
+
+    StringTable table;
+    StringId id = table.insert("abc");
+    DataSegment segment;
+    const uint32_t offset = segment.addObject(TypeDecl::INT, ExpressionValue(TypeDecl::INT, 5));
+    segment.addStrings(&table);
+    context.installDataSegment(&segment);
+
+    context.getScope()->addVariable("a", TypeDecl::INT, context.getDataSegmentAllocation(offset));
+    context.getScope()->addVariable("b", TypeDecl::INT, memory.allocate(4));
+    context.getScope()->getVariable("b")->getAllocation()->write<int>(7);
+    const uint32_t block = context.getMallocContext()->allocate(32, nullptr);
+
+    const ExecutionContext::Snapshot snapshot = context.createSnapshot();
+    Memory restoredMemory(*memory.createSnapshot());
+    ExecutionContext restored(&restoredMemory);
+    restored.restoreSnapshot(snapshot);
+
+    ASSERT_EQ(context.getDataSegmentAddress(), restored.getDataSegmentAddress());
+    ASSERT_EQ('a', restored.resolveString(id).read<char>());
+    ASSERT_EQ(5, restored.getScope()->getVariable("a")->getAllocation()->read<int>());
+    ASSERT_EQ(7, restored.getScope()->getVariable("b")->getAllocation()->read<int>());
+    ASSERT_EQ(1, restored.getMallocContext()->getBlocks().count(block));
+    ASSERT_TRUE(restored.getMallocContext()->attemptDeallocation(block));
+}
+
+TEST(ExecutionContextTest, snapshotCannotBeTakenInsideFunction)
+{
+    Memory memory(1024, 4);
+    ExecutionContext context(&memory);
+
+    context.pushFunctionFrame();
+    ASSERT_ANY_THROW(context.createSnapshot());
+    context.popFunctionFrame();
+    ASSERT_NO_THROW(context.createSnapshot());
+}
+
+TEST(ExecutionContextTest, snapshotInsideEntryFunctionCapturesFrame)
+{
+    Memory memory(1024, 4);
+    ExecutionContext context(&memory);
+    DeclarationContext dc;
+
+    auto first = std::make_shared<VariableDeclarationStatement>(&dc, TypeDecl::INT, "a", nullptr);
+    auto second = std::make_shared<VariableDeclarationStatement>(&dc, TypeDecl::INT, "b", nullptr);
+    FunctionDefinition mainDef(&dc, FuncDeclaration(TypeDecl::INT, "main"));
+    mainDef.addStatement(first);
+    mainDef.addStatement(second);
+
+    context.pushFunctionFrame(&mainDef.getDeclaration()->name);
+    context.getScope()->addVariable("a", TypeDecl::INT, memory.allocate(4));
+    context.getScope()->getVariable("a")->getAllocation()->write<int>(3);
+    context.pushScope();
+
+    ResumePath path;
+    context.onStatementEnter(&mainDef);
+    ASSERT_FALSE(context.getResumePath(&path));
+    ASSERT_ANY_THROW(context.createSnapshot());
+
+    context.onStatementEnter(second.get());
+    ASSERT_TRUE(context.getResumePath(&path));
+    ASSERT_EQ(ResumePath({ 1 }), path);
+
+    const ExecutionContext::Snapshot snapshot = context.createSnapshot();
+    Memory restoredMemory(*memory.createSnapshot());
+    ExecutionContext restored(&restoredMemory);
+    restored.restoreSnapshot(snapshot);
+
+    ASSERT_EQ(&mainDef.getDeclaration()->name, restored.getCurrentFunctionName());
+    ASSERT_EQ(3, restored.getScope()->getVariable("a")->getAllocation()->read<int>());
+    ASSERT_NO_THROW(restored.popScope());
+    ASSERT_ANY_THROW(restored.popScope());
+    restored.popFunctionFrame();
+
+    context.onStatementExit(second.get());
+    context.onStatementExit(&mainDef);
+    context.popScope();
+    context.popFunctionFrame();
+}
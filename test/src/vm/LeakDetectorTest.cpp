@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+
+#include "vm/LeakDetector.h"
+#include "vm/ExecutionContext.h"
+#include "vm/MallocContext.h"
+#include "vm/Memory.h"
+
+using namespace cish::vm;
+using cish::ast::TypeDecl;
+
+
+static Variable* addPointer(ExecutionContext &context, const std::string &name, uint32_t value)
+{
+    Variable *var = context.getScope()->addVariable(name, TypeDecl::getPointer(TypeDecl::VOID),
+                                                    context.getMemory()->allocate(4));
+    var->getAllocation()->write<uint32_t>(value);
+    return var;
+}
+
+
+TEST(LeakDetectorTest, unreferencedBlocksAreLeaked)
+{
+    const std::string funcName = "leaker";
+    Memory memory(1024, 4);
+    ExecutionContext context(&memory);
+
+    context.pushFunctionFrame(&funcName);
+    const uint32_t leaked = context.getMallocContext()->allocate(16, context.getCurrentFunctionName());
+    const uint32_t kept = context.getMallocContext()->allocate(8, context.getCurrentFunctionName());
+    addPointer(context, "kept", kept);
+
+    LeakReport report = LeakDetector(&context).run(false);
+    ASSERT_EQ(1, report.leaks.size());
+    ASSERT_EQ(leaked, report.leaks[0].address);
+    ASSERT_EQ(16, report.leakedBytes);
+    ASSERT_EQ(1, report.reachableBlocks);
+    ASSERT_FALSE(report.reclaimed);
+
+    auto summary = report.getCallSiteSummary();
+    ASSERT_EQ(1, summary.size());
+    ASSERT_EQ("leaker", summary[0].callSite);
+    ASSERT_EQ(16, summary[0].bytes);
+
+    context.popFunctionFrame();
+}
+
+TEST(LeakDetectorTest, blocksReachableThroughOtherBlocksAreKept)
+{
+    Memory memory(1024, 4);
+    ExecutionContext context(&memory);
+    MallocContext *mc = context.getMallocContext();
+
+    const uint32_t head = mc->allocate(8, nullptr);
+    const uint32_t next = mc->allocate(8, nullptr);
+    const uint32_t last = mc->allocate(8, nullptr);
+
+    // Pointers at unaligned offsets and into the middle of blocks count
+    memory.getView(head).write<uint32_t>(next, 1);
+    memory.getView(next).write<uint32_t>(last + 4, 4);
+    addPointer(context, "head", head);
+
+    LeakReport report = LeakDetector(&context).run(false);
+    ASSERT_EQ(0, report.leaks.size());
+    ASSERT_EQ(3, report.reachableBlocks);
+}
+
+TEST(LeakDetectorTest, unreachableCyclesAreLeaked)
+{
+    Memory memory(1024, 4);
+    ExecutionContext context(&memory);
+    MallocContext *mc = context.getMallocContext();
+
+    const uint32_t a = mc->allocate(4, nullptr);
+    const uint32_t b = mc->allocate(4, nullptr);
+    memory.getView(a).write<uint32_t>(b);
+    memory.getView(b).write<uint32_t>(a);
+
+    LeakReport report = LeakDetector(&context).run(false);
+    ASSERT_EQ(2, report.leaks.size());
+    ASSERT_EQ(8, report.leakedBytes);
+}
+
+TEST(LeakDetectorTest, leaksAreReclaimedAtSafePoints)
+{
+    Memory memory(1024, 4);
+    ExecutionContext context(&memory);
+    MallocContext *mc = context.getMallocContext();
+
+    mc->allocate(16, nullptr);
+    const uint32_t freeBefore = memory.getFreeSize();
+
+    // Inside a nested call, values in flight are invisible to the scan
+    context.pushFunctionFrame();
+    context.pushFunctionFrame();
+    LeakReport report = LeakDetector(&context).run(true);
+    ASSERT_EQ(1, report.leaks.size());
+    ASSERT_FALSE(report.reclaimed);
+    ASSERT_EQ(1, mc->getBlocks().size());
+    context.popFunctionFrame();
+
+    report = LeakDetector(&context).run(true);
+    ASSERT_TRUE(report.reclaimed);
+    ASSERT_EQ(0, mc->getBlocks().size());
+    ASSERT_EQ(freeBefore + 16, memory.getFreeSize());
+    context.popFunctionFrame();
+}
+
+TEST(LeakDetectorTest, blocksReferencedFromRegistersAreKept)
+{
+    Memory memory(1024, 4);
+    ExecutionContext context(&memory);
+    MallocContext *mc = context.getMallocContext();
+
+    context.pushFunctionFrame();
+    context.allocateRegisters(2);
+    const uint32_t kept = mc->allocate(8, nullptr);
+    const uint32_t leaked = mc->allocate(8, nullptr);
+    context.getRegisterView(1).write<uint32_t>(kept);
+
+    LeakReport report = LeakDetector(&context).run(false);
+    ASSERT_EQ(1, report.leaks.size());
+    ASSERT_EQ(leaked, report.leaks[0].address);
+    context.popFunctionFrame();
+}
+
+TEST(LeakDetectorTest, mallocContextIsPerExecutionContext)
+{
+    Memory memory(1024, 4);
+    ExecutionContext first(&memory);
+    ExecutionContext second(&memory);
+
+    const uint32_t addr = first.getMallocContext()->allocate(4, nullptr);
+    ASSERT_FALSE(second.getMallocContext()->attemptDeallocation(addr));
+    ASSERT_TRUE(first.getMallocContext()->attemptDeallocation(addr));
+}
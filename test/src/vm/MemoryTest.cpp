@@ -220,3 +220,297 @@ TEST(MemoryTest, nullViewsAreOkUntilAccessed)
     ASSERT_THROW(view.read<uint32_t>(), InvalidAccessException);
     ASSERT_THROW(view.write<uint32_t>(1), InvalidAccessException);
 }
+
+TEST(MemoryTest, largeHeapIsNotCommittedUpFront)
+{
+    Memory memory(1u << 30, 4);
+    ASSERT_EQ(1u << 30, memory.getTotalSize());
+    ASSERT_EQ(0, memory.getCommittedSize());
+}
+
+TEST(MemoryTest, allocationsCommitMemoryOnDemand)
+{
+    Memory memory(1u << 30, 4);
+
+    auto small = memory.allocate(4);
+    ASSERT_EQ(HeapRegion::getPageSize(), memory.getCommittedSize());
+
+    auto large = memory.allocate(1 << 20);
+    ASSERT_GE(memory.getCommittedSize(), 1 << 20);
+    ASSERT_LT(memory.getCommittedSize(), (1 << 20) + 2 * HeapRegion::getPageSize());
+
+    large->write<uint32_t>(15);
+    MemoryView view = memory.getView(large->getAddress() + (1 << 20) - 4);
+    ASSERT_NO_THROW(view.write<uint32_t>(16));
+    ASSERT_EQ(16, view.read<uint32_t>());
+}
+
+TEST(MemoryTest, largeFreesAreReturnedToTheSystem)
+{
+    Memory memory(1u << 30, 4);
+
+    auto small = memory.allocate(4);
+    auto large = memory.allocate(16 << 20);
+    ASSERT_GE(memory.getCommittedSize(), 16 << 20);
+
+    large = nullptr;
+    ASSERT_LT(memory.getCommittedSize(), 1 << 20);
+
+    // The remaining allocation must be unaffected
+    small->write<uint32_t>(15);
+    ASSERT_EQ(15, small->read<uint32_t>());
+}
+
+TEST(MemoryTest, decommittedMemoryCanBeReused)
+{
+    Memory memory(1u << 30, 4);
+
+    auto large = memory.allocate(16 << 20);
+    large->write<uint32_t>(15);
+    large = nullptr;
+
+    large = memory.allocate(16 << 20);
+    large->write<uint32_t>(16);
+    ASSERT_EQ(16, large->read<uint32_t>());
+}
+
+TEST(MemoryTest, heapLimitIsEnforced)
+{
+    Memory memory(1 << 20, 4);
+
+    auto alloc = memory.allocate(1 << 19);
+    ASSERT_THROW(memory.allocate(1 << 20), AllocationFailedException);
+}
+
+TEST(MemoryTest, heapLargerThanAddressSpaceThrows)
+{
+    ASSERT_THROW(Memory(0xFFFFFFFF, 4), MemoryReservationException);
+}
+
+TEST(MemoryTest, statsTrackLiveAndPeakBytes)
+{
+    Memory memory(1024, 4);
+
+    auto a = memory.allocate(10);
+    auto b = memory.allocate(100);
+    ASSERT_EQ(112, memory.getStats().liveBytes);
+
+    a = nullptr;
+    MemoryStats stats = memory.getStats();
+    ASSERT_EQ(100, stats.liveBytes);
+    ASSERT_EQ(112, stats.peakBytes);
+    ASSERT_EQ(2, stats.allocationCount);
+    ASSERT_EQ(1, stats.freeCount);
+}
+
+TEST(MemoryTest, statsCountAllocationsBySizeClass)
+{
+    Memory memory(1024, 4);
+
+    auto a = memory.allocate(4);
+    auto b = memory.allocate(8);
+    auto c = memory.allocate(9);
+    auto d = memory.allocate(100);
+
+    MemoryStats stats = memory.getStats();
+    ASSERT_EQ(2, stats.allocationsBySizeClass[0]);
+    ASSERT_EQ(1, stats.allocationsBySizeClass[1]);
+    ASSERT_EQ(1, stats.allocationsBySizeClass[4]);
+}
+
+TEST(MemoryTest, statsReportFragmentation)
+{
+    Memory memory(64, 4);
+
+    auto a = memory.allocate(16);
+    auto b = memory.allocate(16);
+    auto c = memory.allocate(16);
+    auto d = memory.allocate(16);
+    ASSERT_EQ(0.0, memory.getStats().getFragmentation());
+
+    a = nullptr;
+    c = nullptr;
+
+    MemoryStats stats = memory.getStats();
+    ASSERT_EQ(32, stats.totalFreeBytes);
+    ASSERT_EQ(16, stats.largestFreeBlock);
+    ASSERT_DOUBLE_EQ(0.5, stats.getFragmentation());
+}
+
+TEST(MemoryTest, statsCountFailedAllocations)
+{
+    Memory memory(8, 4);
+
+    auto a = memory.allocate(8);
+    ASSERT_THROW(memory.allocate(4), AllocationFailedException);
+    ASSERT_EQ(1, memory.getStats().failedAllocationCount);
+}
+
+TEST(MemoryTest, timingIsOnlyMeasuredWhenEnabled)
+{
+    Memory memory(1024, 4);
+
+    memory.allocate(4);
+    ASSERT_EQ(0, memory.getStats().allocateNanos);
+    ASSERT_EQ(0, memory.getStats().freeNanos);
+
+    memory.setTimingEnabled(true);
+    for (int i=0; i<100; i++) {
+        memory.allocate(4);
+    }
+
+    ASSERT_LT(0, memory.getStats().allocateNanos);
+    ASSERT_LT(0, memory.getStats().freeNanos);
+}
+
+TEST(MemoryTest, observerIsNotifiedOfAllocationsAndFrees)
+{
+    struct Observer: public AllocationObserver
+    {
+        std::vector<std::pair<uint32_t,uint32_t>> allocs;
+        std::vector<std::pair<uint32_t,uint32_t>> frees;
+
+        void onAllocate(uint32_t address, uint32_t size) override { allocs.push_back({address, size}); }
+        void onFree(uint32_t address, uint32_t size) override { frees.push_back({address, size}); }
+    } observer;
+
+    Memory memory(1024, 4);
+    memory.setAllocationObserver(&observer);
+
+    auto a = memory.allocate(6);
+    const uint32_t addr = a->getAddress();
+    a = nullptr;
+
+    ASSERT_EQ(1, observer.allocs.size());
+    ASSERT_EQ(addr, observer.allocs[0].first);
+    ASSERT_EQ(8, observer.allocs[0].second);
+
+    ASSERT_EQ(1, observer.frees.size());
+    ASSERT_EQ(addr, observer.frees[0].first);
+    ASSERT_EQ(8, observer.frees[0].second);
+
+    memory.setAllocationObserver(nullptr);
+}
+
+TEST(MemoryTest, tryAllocateReturnsNullOnFailure)
+{
+    Memory memory(8, 4);
+
+    auto a = memory.tryAllocate(8);
+    ASSERT_NE(nullptr, a);
+
+    ASSERT_EQ(nullptr, memory.tryAllocate(4));
+    ASSERT_EQ(1, memory.getStats().failedAllocationCount);
+
+    a = nullptr;
+    ASSERT_NE(nullptr, memory.tryAllocate(4));
+}
+
+TEST(MemoryTest, interiorAllocationsDoNotFreeMemory)
+{
+    Memory memory(128, 4);
+    Allocation::Ptr outer = memory.allocate(16);
+    const uint32_t freeSize = memory.getFreeSize();
+
+    {
+        Allocation::Ptr inner = memory.createInteriorAllocation(outer->getAddress() + 8);
+        inner->write<int>(42);
+        ASSERT_EQ(42, outer->read<int>(8));
+    }
+
+    ASSERT_EQ(freeSize, memory.getFreeSize());
+    ASSERT_EQ(42, outer->read<int>(8));
+    ASSERT_THROW(memory.createInteriorAllocation(outer->getAddress() + 16), InvalidAccessException);
+}
+
+TEST(MemoryTest, restoredMemoryContainsSnapshotState)
+{
+    Memory memory(1 << 20, 4);
+    Allocation::Ptr a = memory.allocate(16);
+    Allocation::Ptr b = memory.allocate(64 * 1024);
+    a->write<int>(42);
+    b->write<int>(1337, 32 * 1024);
+
+    Memory::Snapshot::Ptr snapshot = memory.createSnapshot();
+    Memory restored(*snapshot);
+
+    ASSERT_EQ(memory.getFreeSize(), restored.getFreeSize());
+    ASSERT_EQ(16, restored.getAllocationSize(a->getAddress()));
+    ASSERT_EQ(2, restored.getStats().allocationCount);
+
+    Allocation::Ptr ra = restored.adoptAllocation(a->getAddress());
+    Allocation::Ptr rb = restored.adoptAllocation(b->getAddress());
+    ASSERT_EQ(42, ra->read<int>());
+    ASSERT_EQ(1337, rb->read<int>(32 * 1024));
+
+    // New allocations must not overlap the restored ones
+    Allocation::Ptr c = restored.allocate(16);
+    ASSERT_NE(a->getAddress(), c->getAddress());
+    ASSERT_NE(b->getAddress(), c->getAddress());
+
+    // Adopted allocations are freed like any other
+    const uint32_t freeSize = restored.getFreeSize();
+    rb = nullptr;
+    ASSERT_EQ(freeSize + 64 * 1024, restored.getFreeSize());
+}
+
+TEST(MemoryTest, restoredMemoryIsCopyOnWrite)
+{
+    Memory memory(1 << 20, 4);
+    Allocation::Ptr a = memory.allocate(16);
+    a->write<int>(1);
+
+    Memory::Snapshot::Ptr snapshot = memory.createSnapshot();
+    Memory first(*snapshot);
+    Memory second(*snapshot);
+
+    Allocation::Ptr fa = first.adoptAllocation(a->getAddress());
+    Allocation::Ptr sa = second.adoptAllocation(a->getAddress());
+    fa->write<int>(2);
+    a->write<int>(3);
+
+    ASSERT_EQ(3, a->read<int>());
+    ASSERT_EQ(2, fa->read<int>());
+    ASSERT_EQ(1, sa->read<int>());
+    ASSERT_EQ(1, Memory(*snapshot).getView(a->getAddress()).read<int>());
+}
+
+TEST(MemoryTest, onlyAllocationStartsCanBeAdopted)
+{
+    Memory memory(1024, 4);
+    Allocation::Ptr a = memory.allocate(16);
+
+    Memory restored(*memory.createSnapshot());
+    ASSERT_THROW(restored.adoptAllocation(a->getAddress() + 4), InvalidAccessException);
+    ASSERT_THROW(restored.adoptAllocation(a->getAddress() + 16), InvalidAccessException);
+    ASSERT_NO_THROW(restored.adoptAllocation(a->getAddress()));
+}
+
+TEST(MemoryTest, onlyWrittenPagesAreDirty)
+{
+    const uint32_t pageSize = HeapRegion::getPageSize();
+    Memory memory(1 << 20, 4);
+    Allocation::Ptr a = memory.allocate(16);
+    Allocation::Ptr b = memory.allocate(8 * pageSize);
+
+    memory.setDirtyTrackingEnabled(true);
+    b->write<int>(1337, 3 * pageSize + 8);
+    const uint64_t offset = b->getAddress() - Memory::firstUsableMemoryAddress() + 3 * pageSize + 8;
+
+    std::vector<std::pair<uint64_t,uint64_t>> runs;
+    memory.collectDirtyPages([&](uint64_t runOffset, const uint8_t *data, uint64_t len) {
+        runs.push_back({ runOffset, len });
+        ASSERT_EQ(1337, *(const int*)(data + offset % pageSize));
+    });
+
+    ASSERT_EQ(1, runs.size());
+    ASSERT_EQ(offset / pageSize * pageSize, runs[0].first);
+    ASSERT_EQ(pageSize, runs[0].second);
+
+    // Collecting marks the pages clean
+    runs.clear();
+    memory.collectDirtyPages([&](uint64_t offset, const uint8_t*, uint64_t len) {
+        runs.push_back({ offset, len });
+    });
+    ASSERT_TRUE(runs.empty());
+}
@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+
+#include "vm/ObjectPool.h"
+
+#include <stdexcept>
+#include <vector>
+
+using namespace cish::vm;
+
+
+struct Tracked
+{
+    Tracked(int *counter, bool fail = false): counter(counter)
+    {
+        if (fail) {
+            throw std::runtime_error("construction failed");
+        }
+        (*counter)++;
+    }
+
+    ~Tracked()
+    {
+        (*counter)--;
+    }
+
+    int *counter;
+};
+
+
+TEST(ObjectPoolTest, createdObjectsAreConstructedAndDestroyed)
+{
+    int counter = 0;
+    ObjectPool<Tracked> pool;
+
+    Tracked *a = pool.create(&counter);
+    Tracked *b = pool.create(&counter);
+    ASSERT_NE(a, b);
+    ASSERT_EQ(2, counter);
+    ASSERT_EQ(2, pool.getLiveCount());
+
+    pool.destroy(a);
+    pool.destroy(b);
+    ASSERT_EQ(0, counter);
+    ASSERT_EQ(0, pool.getLiveCount());
+}
+
+TEST(ObjectPoolTest, destroyedSlotsAreReused)
+{
+    int counter = 0;
+    ObjectPool<Tracked> pool;
+
+    Tracked *a = pool.create(&counter);
+    pool.destroy(a);
+
+    Tracked *b = pool.create(&counter);
+    ASSERT_EQ(a, b);
+    pool.destroy(b);
+}
+
+TEST(ObjectPoolTest, poolGrowsBySlabs)
+{
+    int counter = 0;
+    ObjectPool<Tracked, 4> pool;
+    std::vector<Tracked*> objects;
+
+    for (int i=0; i<5; i++) {
+        objects.push_back(pool.create(&counter));
+    }
+    ASSERT_EQ(8, pool.getCapacity());
+
+    for (Tracked *t: objects) {
+        pool.destroy(t);
+    }
+
+    // Freed slots are enough to satisfy the same working set again
+    for (int i=0; i<8; i++) {
+        objects[i % 5] = pool.create(&counter);
+        pool.destroy(objects[i % 5]);
+    }
+    ASSERT_EQ(8, pool.getCapacity());
+}
+
+TEST(ObjectPoolTest, failedConstructionReturnsSlot)
+{
+    int counter = 0;
+    ObjectPool<Tracked> pool;
+
+    ASSERT_THROW(pool.create(&counter, true), std::runtime_error);
+    ASSERT_EQ(0, pool.getLiveCount());
+
+    Tracked *a = pool.create(&counter);
+    ASSERT_EQ(1, pool.getLiveCount());
+    pool.destroy(a);
+}
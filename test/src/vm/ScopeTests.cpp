@@ -9,38 +9,39 @@
 using namespace cish::vm;
 
 
-Variable* createVariable(Memory &mem, uint32_t len)
+Variable* addVariable(Scope &scope, const std::string &name, Memory &mem, uint32_t len)
 {
     auto alloc = mem.allocate(len);
-    return new Variable(cish::ast::TypeDecl(cish::ast::TypeDecl::VOID), std::move(alloc));
+    return scope.addVariable(name, cish::ast::TypeDecl(cish::ast::TypeDecl::VOID), std::move(alloc));
 }
 
 
 TEST(ScopeTest, UndefinedVariablesReturnsNull)
 {
-    Scope frame;
+    Scope::VariablePool pool;
+    Scope frame(&pool);
     ASSERT_EQ(nullptr, frame.getVariable("var"));
 }
 
 TEST(ScopeTest, StoredVariablesAreRetrievable)
 {
     Memory mem(100, 4);
-    Scope frame;
+    Scope::VariablePool pool;
+    Scope frame(&pool);
 
-    Variable *var = createVariable(mem, 4);
-    frame.addVariable("var", var);
+    Variable *var = addVariable(frame, "var", mem, 4);
 
-    ASSERT_NE(nullptr, frame.getVariable("var"));
+    ASSERT_EQ(var, frame.getVariable("var"));
 }
 
 TEST(ScopeTest, ParentsVariablesAreAvailableInChildren)
 {
     Memory mem(100, 4);
-    Scope parent;
-    Scope child(&parent);
+    Scope::VariablePool pool;
+    Scope parent(&pool);
+    Scope child(&pool, &parent);
 
-    Variable *var = createVariable(mem, 4);
-    parent.addVariable("var", var);
+    addVariable(parent, "var", mem, 4);
 
     ASSERT_NE(nullptr, child.getVariable("var"));
 }
@@ -48,15 +49,68 @@ TEST(ScopeTest, ParentsVariablesAreAvailableInChildren)
 TEST(ScopeTest, ChildVariablesOvershadowParents)
 {
     Memory mem(100, 4);
-    Scope parent;
-    Scope child(&parent);
+    Scope::VariablePool pool;
+    Scope parent(&pool);
+    Scope child(&pool, &parent);
 
-    Variable *v1 = createVariable(mem, 4);
-    Variable *v2 = createVariable(mem, 8);
+    Variable *v1 = addVariable(parent, "var", mem, 4);
+    Variable *v2 = addVariable(child, "var", mem, 8);
 
-    parent.addVariable("var", v1);
-    child.addVariable("var", v2);
+    ASSERT_EQ(v1, parent.getVariable("var"));
+    ASSERT_EQ(v2, child.getVariable("var"));
 }
 
+TEST(ScopeTest, RedeclaredVariablesAreReplaced)
+{
+    Memory mem(100, 4);
+    Scope::VariablePool pool;
+    Scope frame(&pool);
 
+    addVariable(frame, "var", mem, 4);
+    Variable *v2 = addVariable(frame, "var", mem, 4);
 
+    ASSERT_EQ(v2, frame.getVariable("var"));
+    ASSERT_EQ(1, pool.getLiveCount());
+    ASSERT_EQ(96, mem.getFreeSize());
+}
+
+TEST(ScopeTest, ResetReleasesVariables)
+{
+    Memory mem(100, 4);
+    Scope::VariablePool pool;
+    Scope frame(&pool);
+
+    addVariable(frame, "a", mem, 4);
+    addVariable(frame, "b", mem, 4);
+    ASSERT_EQ(2, pool.getLiveCount());
+
+    frame.reset(nullptr);
+    ASSERT_EQ(0, pool.getLiveCount());
+    ASSERT_EQ(nullptr, frame.getVariable("a"));
+    ASSERT_EQ(100, mem.getFreeSize());
+}
+
+TEST(ScopeTest, LargeScopesFindAllVariables)
+{
+    Memory mem(1024, 4);
+    Scope::VariablePool pool;
+    Scope parent(&pool);
+    Scope child(&pool, &parent);
+
+    Variable *outer = addVariable(parent, "outer", mem, 4);
+
+    std::vector<Variable*> vars;
+    for (int i=0; i<40; i++) {
+        vars.push_back(addVariable(child, "var" + std::to_string(i), mem, 4));
+    }
+
+    for (int i=0; i<40; i++) {
+        ASSERT_EQ(vars[i], child.getVariable("var" + std::to_string(i)));
+    }
+
+    ASSERT_EQ(outer, child.getVariable("outer"));
+    ASSERT_EQ(nullptr, child.getVariable("var40"));
+
+    Variable *replaced = addVariable(child, "var3", mem, 4);
+    ASSERT_EQ(replaced, child.getVariable("var3"));
+}
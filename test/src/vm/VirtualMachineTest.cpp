@@ -153,3 +153,54 @@ TEST(VirtualMachineTest, startPostBlockingThrows)
     ASSERT_THROW(vm->executeBlocking(), VmException);
 }
 
+
+TEST(VirtualMachineTest, forkedVmsStartAtMainWithPrivateGlobals)
+{
+    Ast::Ptr ast = createAst(
+        "int calls = 0;"
+        "int init() { calls++; return 40; }"
+        "int a = init();"
+        "int main() { a += calls; return a; }");
+
+    VmSnapshot::Ptr snapshot = VirtualMachine::createSnapshot(VmOptions(), ast);
+
+    for (int i=0; i<3; i++) {
+        VirtualMachine vm(VmOptions(), snapshot);
+        ASSERT_EQ(40, vm.getExecutionContext()->getScope()->getVariable("a")->getAllocation()->read<int>());
+        vm.executeBlocking();
+        ASSERT_EQ(41, vm.getExitCode());
+    }
+}
+
+TEST(VirtualMachineTest, resumedVmsContinueFromTheLastCheckpoint)
+{
+    Ast::Ptr ast = createAst(
+        "int total = 0;"
+        "int main() {"
+        "    int acc = 0;"
+        "    for (int i = 0; i < 3000; i++) {"
+        "        if (i % 3 == 0) { acc += i % 7; }"
+        "        total++;"
+        "    }"
+        "    return (acc + total) % 256;"
+        "}");
+
+    const std::string path = ::testing::TempDir() + "resumedVmsContinueFromTheLastCheckpoint.ckpt";
+    remove(path.c_str());
+
+    VmOptions opts;
+    opts.checkpointFile = path;
+    opts.checkpointInterval = 0;
+
+    VirtualMachine vm(opts, ast);
+    vm.executeBlocking();
+    ASSERT_EQ(nullptr, vm.getRuntimeError());
+
+    VirtualMachine resumed(VmOptions(), VirtualMachine::loadCheckpoint(path, ast));
+    ASSERT_LT(0, resumed.getExecutionContext()->getScope()->getVariable("total")->getAllocation()->read<int>());
+    resumed.executeBlocking();
+    ASSERT_EQ(nullptr, resumed.getRuntimeError());
+    ASSERT_EQ(vm.getExitCode(), resumed.getExitCode());
+
+    remove(path.c_str());
+}